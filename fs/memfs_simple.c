@@ -4,13 +4,14 @@
 #include "memfs_simple.h"
 #include "../kernel/kernel.h"
 #include "../kernel/string.h"
+#include "../kernel/clock.h"
+#include "../kernel/div64.h"
 
 // Global file system state (Day 11 Enhanced)
 static memfs_simple_file_t file_table[MEMFS_MAX_FILES];
 static bool memfs_initialized = false;
 static uint32_t next_file_id = 1;
 static uint32_t current_dir_id = 0;  // Current directory (0 = root)
-static uint32_t time_counter = 1000; // Simple timestamp counter
 
 // String utility functions
 static size_t simple_strlen(const char* str) {
@@ -19,35 +20,23 @@ static size_t simple_strlen(const char* str) {
     return len;
 }
 
-// Simple timestamp function (Day 11)
+// Timestamp in milliseconds since boot (monotonic clock)
 uint32_t memfs_simple_get_time(void) {
-    return ++time_counter;
+    return (uint32_t)div_u64(clock_monotonic_ns(), NSEC_PER_MSEC);
 }
 
-// Format timestamp for display (Phase 2)
+// Format timestamp for display: "T+<ms>ms"
 void memfs_simple_format_time(uint32_t timestamp, char* buffer, size_t size) {
     if (!buffer || size < 8) return;
     
-    // Simple format: "T1234"
-    buffer[0] = 'T';
-    uint32_t time = timestamp;
-    int pos = 1;
+    char digits[12];
+    itoa((int)timestamp, digits, 10);
     
-    // Convert to string (max 4 digits for simplicity)
-    if (time == 0) {
-        buffer[pos++] = '0';
-    } else {
-        char temp[8];
-        int temp_pos = 0;
-        while (time > 0 && temp_pos < 4) {
-            temp[temp_pos++] = '0' + (time % 10);
-            time /= 10;
-        }
-        // Reverse
-        for (int i = temp_pos - 1; i >= 0; i--) {
-            if (pos < (int)size - 1) {
-                buffer[pos++] = temp[i];
-            }
+    size_t pos = 0;
+    const char* parts[3] = { "T+", digits, "ms" };
+    for (int p = 0; p < 3; p++) {
+        for (const char* c = parts[p]; *c && pos < size - 1; c++) {
+            buffer[pos++] = *c;
         }
     }
     buffer[pos] = '\0';
@@ -308,6 +297,38 @@ int memfs_simple_write(const char* filename, const char* content) {
 }
 
 // List all files in current directory (Day 11 Fixed)
+// Handle-based I/O (Day 21): a handle is the file's table index, as
+// returned by memfs_simple_find_file(), so system calls skip the lookup
+bool memfs_simple_valid_handle(int handle) {
+    return handle >= 0 && handle < MEMFS_MAX_FILES &&
+           file_table[handle].in_use && file_table[handle].type == MEMFS_TYPE_FILE;
+}
+
+int memfs_simple_read_handle(int handle, void* buffer, size_t count) {
+    if (!memfs_simple_valid_handle(handle) || !buffer) {
+        return MEMFS_ERROR;
+    }
+    
+    size_t copy_size = file_table[handle].size < count ? file_table[handle].size : count;
+    simple_memcpy(buffer, file_table[handle].data, copy_size);
+    file_table[handle].accessed_time = memfs_simple_get_time();
+    return copy_size;
+}
+
+int memfs_simple_write_handle(int handle, const void* data, size_t count) {
+    if (!memfs_simple_valid_handle(handle) || !data) {
+        return MEMFS_ERROR;
+    }
+    
+    if (count > MEMFS_MAX_FILESIZE) {
+        count = MEMFS_MAX_FILESIZE;
+    }
+    simple_memcpy(file_table[handle].data, data, count);
+    file_table[handle].size = count;
+    file_table[handle].modified_time = memfs_simple_get_time();
+    return count;
+}
+
 void memfs_simple_list_files(void) {
     terminal_setcolor(vga_entry_color(VGA_COLOR_CYAN, VGA_COLOR_BLACK));
     terminal_writestring("[MEMFS] File listing for current directory:\n");
@@ -906,7 +927,7 @@ void memfs_simple_show_file_info(const char* filename) {
     terminal_writestring("\n");
     
     // Timestamps
-    char time_str[8];
+    char time_str[20];
     terminal_writestring("  Created: ");
     memfs_simple_format_time(file->created_time, time_str, sizeof(time_str));
     terminal_writestring(time_str);
@@ -85,6 +85,11 @@ void memfs_simple_getcwd(char* buffer, size_t size);
 int memfs_simple_read(const char* filename, char* buffer, size_t buffer_size);
 int memfs_simple_write(const char* filename, const char* content);
 
+// Handle-based I/O (Day 21): handle = file table index
+bool memfs_simple_valid_handle(int handle);
+int memfs_simple_read_handle(int handle, void* buffer, size_t count);
+int memfs_simple_write_handle(int handle, const void* data, size_t count);
+
 // Utility functions
 void memfs_simple_list_files(void);
 void memfs_simple_list_detailed(void);  // Day 11: ls -l equivalent
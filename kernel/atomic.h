@@ -0,0 +1,64 @@
+// ClaudeOS Atomic Operations - Day 21
+// Lock-prefixed read-modify-write helpers on 32-bit words (usable from ring 3)
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include "types.h"
+
+// x86 keeps loads and stores in program order (TSO), so plain volatile
+// accesses plus a compiler barrier give acquire loads and release stores.
+static inline uint32_t atomic_load(const volatile uint32_t* p) {
+    uint32_t value = *p;
+    asm volatile ("" : : : "memory");
+    return value;
+}
+
+static inline void atomic_store(volatile uint32_t* p, uint32_t value) {
+    asm volatile ("" : : : "memory");
+    *p = value;
+}
+
+// Store *p = desired if *p == expected; returns the previous value
+static inline uint32_t atomic_cmpxchg(volatile uint32_t* p, uint32_t expected, uint32_t desired) {
+    uint32_t prev;
+    asm volatile ("lock cmpxchgl %2, %1"
+                  : "=a" (prev), "+m" (*p)
+                  : "r" (desired), "0" (expected)
+                  : "memory");
+    return prev;
+}
+
+// Store value, return the previous contents (XCHG is implicitly locked)
+static inline uint32_t atomic_xchg(volatile uint32_t* p, uint32_t value) {
+    asm volatile ("xchgl %0, %1"
+                  : "+r" (value), "+m" (*p)
+                  :
+                  : "memory");
+    return value;
+}
+
+// Add delta, return the previous contents
+static inline uint32_t atomic_fetch_add(volatile uint32_t* p, uint32_t delta) {
+    asm volatile ("lock xaddl %0, %1"
+                  : "+r" (delta), "+m" (*p)
+                  :
+                  : "memory");
+    return delta;
+}
+
+// Full barrier: orders an earlier store before a later load, which TSO
+// alone does not (a locked no-op works on every x86)
+static inline void atomic_mb(void) {
+    asm volatile ("lock addl $0, (%%esp)" : : : "memory", "cc");
+}
+
+static inline void atomic_inc(volatile uint32_t* p) {
+    asm volatile ("lock incl %0" : "+m" (*p) : : "memory");
+}
+
+static inline void atomic_dec(volatile uint32_t* p) {
+    asm volatile ("lock decl %0" : "+m" (*p) : : "memory");
+}
+
+#endif // ATOMIC_H
@@ -0,0 +1,223 @@
+// ClaudeOS SPSC Channels - Day 21
+// Lock-free single-producer/single-consumer rings in shared memory
+
+#include "channel.h"
+#include "atomic.h"
+#include "futex.h"
+#include "ipc.h"
+#include "usermode.h"
+#include "process.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "kernel.h"
+#include "string.h"
+
+static inline uint8_t* channel_slot(spsc_channel_t* ch, uint32_t index) {
+    return ch->slots + (index & (ch->capacity - 1)) * ch->elem_size;
+}
+
+spsc_channel_t* channel_create(const char* name, uint32_t elem_size, uint32_t capacity) {
+    if (!name || strlen(name) >= CHANNEL_NAME_MAX) {
+        return NULL;                // Would be truncated into another segment's name
+    }
+    if (elem_size == 0 || capacity == 0 || (capacity & (capacity - 1)) ||
+        capacity > (UINT32_MAX - sizeof(spsc_channel_t)) / elem_size) {
+        return NULL;                // Ring size would overflow
+    }
+    
+    // Exclusive: a name already taken fails instead of handing back a
+    // live ring whose header we would then overwrite
+    int id = ipc_create_shared_memory(name, sizeof(spsc_channel_t) + capacity * elem_size,
+                                      IPC_SHM_EXCL);
+    if (id < 0) {
+        return NULL;
+    }
+    spsc_channel_t* ch = (spsc_channel_t*)ipc_attach_shared_memory(id);
+    if (!ch) {
+        ipc_destroy_shared_memory(id);
+        return NULL;
+    }
+    
+    // Segments start zeroed: indices and sleep flags are already 0
+    ch->capacity = capacity;
+    ch->elem_size = elem_size;
+    ch->shm_id = id;
+    return ch;
+}
+
+spsc_channel_t* channel_open(const char* name) {
+    int id = ipc_find_shared_memory(name);
+    return (id >= 0) ? (spsc_channel_t*)ipc_attach_shared_memory(id) : NULL;
+}
+
+// Detach this side; the ring is freed once both sides are done with it
+void channel_close(spsc_channel_t* ch) {
+    if (ch) {
+        ipc_detach_shared_memory(ch->shm_id);
+    }
+}
+
+// Creator side: unlink the name, then close. The ring is freed once the
+// peer has closed too.
+void channel_destroy(spsc_channel_t* ch) {
+    if (ch) {
+        ipc_destroy_shared_memory(ch->shm_id);
+        channel_close(ch);
+    }
+}
+
+bool channel_try_send(spsc_channel_t* ch, const void* elem) {
+    uint32_t tail = ch->tail;
+    if (tail - ch->head_cache == ch->capacity) {
+        ch->head_cache = atomic_load(&ch->head);
+        if (tail - ch->head_cache == ch->capacity) {
+            return false;
+        }
+    }
+    
+    memcpy(channel_slot(ch, tail), elem, ch->elem_size);
+    atomic_store(&ch->tail, tail + 1);      // Release: slot written first
+    
+    // The tail store must be visible before the flag is read
+    atomic_mb();
+    if (ch->consumer_sleeping) {
+        futex_call_wake(&ch->tail, 1);
+    }
+    return true;
+}
+
+bool channel_try_recv(spsc_channel_t* ch, void* elem) {
+    uint32_t head = ch->head;
+    if (head == ch->tail_cache) {
+        ch->tail_cache = atomic_load(&ch->tail);
+        if (head == ch->tail_cache) {
+            return false;
+        }
+    }
+    
+    memcpy(elem, channel_slot(ch, head), ch->elem_size);
+    atomic_store(&ch->head, head + 1);      // Release: slot read first
+    
+    atomic_mb();
+    if (ch->producer_sleeping) {
+        futex_call_wake(&ch->head, 1);
+    }
+    return true;
+}
+
+// Announce the sleep (XCHG is a full barrier), recheck, then wait on the
+// peer's index. A peer that moved the index after our check sees the flag
+// and wakes us; futex_call_wait() returns at once if it moved before.
+void channel_send(spsc_channel_t* ch, const void* elem) {
+    while (!channel_try_send(ch, elem)) {
+        atomic_xchg(&ch->producer_sleeping, 1);
+        uint32_t head = atomic_load(&ch->head);
+        if (ch->tail - head == ch->capacity) {
+            futex_call_wait(&ch->head, head);
+        }
+        atomic_store(&ch->producer_sleeping, 0);
+    }
+}
+
+void channel_recv(spsc_channel_t* ch, void* elem) {
+    while (!channel_try_recv(ch, elem)) {
+        atomic_xchg(&ch->consumer_sleeping, 1);
+        uint32_t tail = atomic_load(&ch->tail);
+        if (tail == ch->head) {
+            futex_call_wait(&ch->tail, tail);
+        }
+        atomic_store(&ch->consumer_sleeping, 0);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark: ring 3 producer -> kernel thread consumer
+// ---------------------------------------------------------------------------
+
+#define CHANNEL_BENCH_NAME      "bench_channel"
+#define CHANNEL_BENCH_DEFAULT   100000
+#define CHANNEL_BENCH_CAPACITY  256
+#define CHANNEL_BENCH_MAX_ELEM  256
+
+static struct {
+    spsc_channel_t* ch;
+    uint32_t items;
+} channel_bench;
+
+static int channel_bench_producer(void) {
+    uint8_t elem[CHANNEL_BENCH_MAX_ELEM];
+    memset(elem, 0xC5, sizeof(elem));
+    for (uint32_t i = 0; i < channel_bench.items; i++) {
+        *(uint32_t*)elem = i;
+        channel_send(channel_bench.ch, elem);
+    }
+    return 0;
+}
+
+static void channel_bench_run(uint32_t elem_size, uint32_t items) {
+    uint8_t elem[CHANNEL_BENCH_MAX_ELEM];
+    futex_stats_t before, after;
+    uint32_t errors = 0;
+    int status = 0;
+    
+    spsc_channel_t* ch = channel_create(CHANNEL_BENCH_NAME, elem_size, CHANNEL_BENCH_CAPACITY);
+    if (!ch) {
+        terminal_writestring("  Cannot create channel\n");
+        return;
+    }
+    channel_bench.ch = ch;
+    channel_bench.items = items;
+    
+    futex_get_stats(&before);
+    uint64_t start = clock_cycles();
+    int pid = user_process_create(channel_bench_producer, "chan-producer");
+    if (pid == INVALID_PID) {
+        channel_destroy(ch);
+        return;
+    }
+    for (uint32_t i = 0; i < items; i++) {
+        channel_recv(ch, elem);
+        if (*(uint32_t*)elem != i) {
+            errors++;
+        }
+    }
+    uint64_t ns = clock_cycles_to_ns(clock_cycles() - start);
+    process_wait(pid, &status);
+    futex_get_stats(&after);
+    channel_destroy(ch);
+    
+    if (ns == 0) {
+        ns = 1;
+    }
+    terminal_printf("  %u-byte: %llu items/sec, %llu MB/s, %u sleeps, %u out of order\n",
+                    elem_size, div64_u64((uint64_t)items * NSEC_PER_SEC, ns),
+                    div64_u64((uint64_t)items * elem_size * 1000, ns),
+                    after.waits - before.waits, errors);
+}
+
+void channel_command_handler(int argc, char argv[][64]) {
+    if (argc < 2) {
+        terminal_writestring("Channel Commands:\n");
+        terminal_writestring("  channel bench [n] - Stream n items ring 3 -> kernel (8B, 256B)\n");
+        return;
+    }
+    
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+    
+    if (strcmp(argv[1], "bench") == 0) {
+        int n = (argc >= 3) ? atoi(argv[2]) : CHANNEL_BENCH_DEFAULT;
+        if (n <= 0) {
+            n = CHANNEL_BENCH_DEFAULT;
+        }
+        terminal_printf("SPSC channel, %u slots, %d items per row:\n", CHANNEL_BENCH_CAPACITY, n);
+        channel_bench_run(8, (uint32_t)n);
+        channel_bench_run(256, (uint32_t)n);
+    }
+    else {
+        terminal_printf("Unknown channel command: %s\n", argv[1]);
+    }
+}
@@ -0,0 +1,53 @@
+// ClaudeOS SPSC Channels - Day 21
+// Lock-free single-producer/single-consumer rings in shared memory
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include "types.h"
+
+#define CACHE_LINE_SIZE     64
+#define CHANNEL_NAME_MAX    32          // Including the NUL, as segment names
+
+// Producer and consumer state sit on separate cache lines so neither side
+// writes a line the other is polling. Each side keeps a private copy of
+// the other's index and rereads the shared one only when its copy says
+// the ring is full (producer) or empty (consumer).
+typedef struct spsc_channel {
+    // Producer line
+    volatile uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));
+    uint32_t head_cache;
+    volatile uint32_t producer_sleeping;    // Producer waits on 'head'
+    
+    // Consumer line
+    volatile uint32_t head __attribute__((aligned(CACHE_LINE_SIZE)));
+    uint32_t tail_cache;
+    volatile uint32_t consumer_sleeping;    // Consumer waits on 'tail'
+    
+    // Read-only after creation
+    uint32_t capacity __attribute__((aligned(CACHE_LINE_SIZE)));   // Power of two
+    uint32_t elem_size;
+    int shm_id;                             // Backing shared memory segment
+    
+    uint8_t slots[] __attribute__((aligned(CACHE_LINE_SIZE)));
+} spsc_channel_t;
+
+// Setup: the channel lives in a named shared memory segment. The creator
+// and the peer each attach once; the peer closes when done and the
+// creator destroys, which also unlinks the name.
+spsc_channel_t* channel_create(const char* name, uint32_t elem_size, uint32_t capacity);
+spsc_channel_t* channel_open(const char* name);
+void channel_close(spsc_channel_t* ch);
+void channel_destroy(spsc_channel_t* ch);
+
+// Fast path (no kernel entry). Safe from kernel threads and ring 3.
+bool channel_try_send(spsc_channel_t* ch, const void* elem);
+bool channel_try_recv(spsc_channel_t* ch, void* elem);
+
+// Blocking variants: sleep on a futex only while full/empty
+void channel_send(spsc_channel_t* ch, const void* elem);
+void channel_recv(spsc_channel_t* ch, void* elem);
+
+void channel_command_handler(int argc, char argv[][64]);
+
+#endif // CHANNEL_H
@@ -0,0 +1,197 @@
+// ClaudeOS Monotonic Clock - Day 21
+// TSC clocksource calibrated against the PIT at boot
+
+#include "clock.h"
+#include "div64.h"
+#include "timer.h"
+#include "pic.h"
+#include "kernel.h"
+
+// PC speaker / PIT channel 2 gate control port
+#define PIT_GATE_PORT       0x61
+#define PIT_GATE_ENABLE     0x01    // Channel 2 gate input
+#define PIT_SPEAKER_ENABLE  0x02    // Speaker data (kept off)
+#define PIT_OUT2_STATUS     0x20    // Channel 2 output level
+
+static clock_info_t clock_info;
+static bool clock_ready = false;
+
+static void clock_detect_tsc(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    clock_info.tsc_present = false;
+    clock_info.tsc_invariant = false;
+
+    if (!cpu_has_cpuid()) {
+        return;
+    }
+
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    clock_info.tsc_present = (edx & CPUID_EDX_TSC) != 0;
+
+    cpuid(0x80000000, &eax, &ebx, &ecx, &edx);
+    if (eax >= 0x80000007) {
+        cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+        clock_info.tsc_invariant = (edx & CPUID_EXT_INVARIANT_TSC) != 0;
+    }
+}
+
+// Measure TSC cycles across one PIT channel 2 one-shot of 'latch' counts
+static uint64_t clock_calibrate_once(uint16_t latch) {
+    uint8_t gate = inb(PIT_GATE_PORT);
+
+    // Gate low while programming, speaker off
+    outb(PIT_GATE_PORT, gate & ~(PIT_GATE_ENABLE | PIT_SPEAKER_ENABLE));
+
+    outb(PIT_COMMAND, PIT_SELECT_CHANNEL2 | PIT_ACCESS_LOHI | PIT_MODE_TERMINALCOUNT | PIT_BCD_BINARY);
+    outb(PIT_CHANNEL2, latch & 0xFF);
+    outb(PIT_CHANNEL2, (latch >> 8) & 0xFF);
+
+    // Raising the gate starts the countdown; OUT2 goes high at terminal count
+    outb(PIT_GATE_PORT, (gate & ~PIT_SPEAKER_ENABLE) | PIT_GATE_ENABLE);
+    uint64_t start = rdtsc_ordered();
+
+    uint32_t spins = 0;
+    while ((inb(PIT_GATE_PORT) & PIT_OUT2_STATUS) == 0) {
+        // Guard against a PIT that never fires (broken emulation)
+        if (++spins > 10000000) {
+            outb(PIT_GATE_PORT, gate);
+            return 0;
+        }
+    }
+
+    uint64_t end = rdtsc_ordered();
+    outb(PIT_GATE_PORT, gate);
+    return end - start;
+}
+
+// Pick mult/shift so that ns = (cycles * mult) >> shift with mult < 2^32
+static void clock_compute_scale(uint64_t hz) {
+    uint32_t shift = 32;
+    uint64_t mult;
+
+    for (;;) {
+        mult = div64_u64((uint64_t)NSEC_PER_SEC << shift, hz);
+        if ((mult >> 32) == 0 || shift == 0) {
+            break;
+        }
+        shift--;
+    }
+
+    clock_info.mult = (uint32_t)mult;
+    clock_info.shift = shift;
+}
+
+// Initialize the clocksource (call after timer_init, before interrupts)
+void clock_init(void) {
+    clock_info.source = CLOCKSOURCE_PIT;
+    clock_info.tsc_hz = 0;
+    clock_info.ticks_base = timer_get_ticks64();
+
+    clock_detect_tsc();
+
+    if (clock_info.tsc_present) {
+        uint16_t latch = (uint16_t)(PIT_FREQUENCY / (1000 / CLOCK_CALIBRATE_MS));
+        uint64_t best = 0;
+
+        // Shortest window is least disturbed by SMIs or emulator stalls
+        for (int i = 0; i < CLOCK_CALIBRATE_RUNS; i++) {
+            uint64_t cycles = clock_calibrate_once(latch);
+            if (cycles != 0 && (best == 0 || cycles < best)) {
+                best = cycles;
+            }
+        }
+
+        if (best != 0) {
+            clock_info.tsc_hz = div_u64(best * PIT_FREQUENCY, latch);
+            clock_compute_scale(clock_info.tsc_hz);
+            clock_info.tsc_base = rdtsc();
+            clock_info.source = CLOCKSOURCE_TSC;
+        }
+    }
+
+    clock_ready = true;
+
+    terminal_writestring("[CLOCK] Clocksource: ");
+    if (clock_info.source == CLOCKSOURCE_TSC) {
+        terminal_printf("TSC %u MHz%s\n",
+                        (uint32_t)div_u64(clock_info.tsc_hz, 1000000),
+                        clock_info.tsc_invariant ? " (invariant)" : "");
+    } else {
+        terminal_writestring("PIT 100Hz (no usable TSC)\n");
+    }
+}
+
+// Raw timestamp for interval measurement: TSC cycles, or ns on the PIT path
+uint64_t clock_cycles(void) {
+    if (clock_info.source == CLOCKSOURCE_TSC) {
+        return rdtsc_ordered();
+    }
+    return clock_monotonic_ns();
+}
+
+uint64_t clock_cycles_to_ns(uint64_t cycles) {
+    if (clock_info.source == CLOCKSOURCE_TSC) {
+        return mul_u64_u32_shr(cycles, clock_info.mult, clock_info.shift);
+    }
+    return cycles;
+}
+
+// Nanoseconds since clock_init
+uint64_t clock_monotonic_ns(void) {
+    if (!clock_ready) {
+        return 0;
+    }
+    if (clock_info.source == CLOCKSOURCE_TSC) {
+        return mul_u64_u32_shr(rdtsc() - clock_info.tsc_base, clock_info.mult, clock_info.shift);
+    }
+    return (timer_get_ticks64() - clock_info.ticks_base) * (NSEC_PER_SEC / TIMER_FREQUENCY);
+}
+
+uint64_t clock_tsc_hz(void) {
+    return clock_info.tsc_hz;
+}
+
+const clock_info_t* clock_get_info(void) {
+    return &clock_info;
+}
+
+uint32_t clock_uptime_seconds(void) {
+    return (uint32_t)div_u64(clock_monotonic_ns(), NSEC_PER_SEC);
+}
+
+uint64_t clock_ns_to_us(uint64_t ns) {
+    return div_u64(ns, NSEC_PER_USEC);
+}
+
+// Shell 'clock' command output
+void clock_dump_info(void) {
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
+    terminal_writestring("Clock Information\n");
+    terminal_writestring("=================\n");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+
+    terminal_printf("  Clocksource:   %s\n",
+                    clock_info.source == CLOCKSOURCE_TSC ? "TSC" : "PIT (100Hz)");
+    terminal_printf("  TSC present:   %s\n", clock_info.tsc_present ? "yes" : "no");
+    terminal_printf("  TSC invariant: %s\n", clock_info.tsc_invariant ? "yes" : "no");
+
+    if (clock_info.source == CLOCKSOURCE_TSC) {
+        terminal_printf("  TSC frequency: %llu Hz\n", clock_info.tsc_hz);
+        terminal_printf("  Scale:         mult=%u shift=%u\n", clock_info.mult, clock_info.shift);
+
+        // Cost of one clock read, averaged over a short burst
+        uint64_t start = rdtsc_ordered();
+        for (int i = 0; i < 1000; i++) {
+            (void)clock_monotonic_ns();
+        }
+        uint64_t cycles = rdtsc_ordered() - start;
+        terminal_printf("  Read cost:     %u cycles\n", (uint32_t)div_u64(cycles, 1000));
+    }
+
+    uint64_t now = clock_monotonic_ns();
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
+    terminal_printf("  Monotonic:     %llu ns\n", now);
+    terminal_printf("  Uptime:        %u ms\n", (uint32_t)div_u64(now, NSEC_PER_MSEC));
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+}
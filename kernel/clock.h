@@ -0,0 +1,49 @@
+// ClaudeOS Monotonic Clock - Day 21
+// TSC clocksource calibrated against the PIT at boot
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "types.h"
+#include "cpu.h"
+
+#define NSEC_PER_SEC    1000000000U
+#define NSEC_PER_MSEC   1000000U
+#define NSEC_PER_USEC   1000U
+
+// Calibration parameters (PIT channel 2 one-shot gate)
+#define CLOCK_CALIBRATE_MS      10      // Length of one calibration window
+#define CLOCK_CALIBRATE_RUNS    5       // Best (shortest) window wins
+
+// Clocksource selected at boot
+typedef enum {
+    CLOCKSOURCE_PIT = 0,        // 100Hz timer_ticks fallback (10ms resolution)
+    CLOCKSOURCE_TSC = 1         // rdtsc scaled to nanoseconds
+} clocksource_t;
+
+// Clock state exported for diagnostics
+typedef struct {
+    clocksource_t source;
+    bool tsc_present;
+    bool tsc_invariant;
+    uint64_t tsc_hz;            // Calibrated TSC frequency
+    uint64_t tsc_base;          // TSC value at clock_init
+    uint32_t mult;              // ns = (cycles * mult) >> shift
+    uint32_t shift;
+    uint64_t ticks_base;        // timer_ticks at clock_init (PIT fallback)
+} clock_info_t;
+
+// Clock interface
+void clock_init(void);
+uint64_t clock_monotonic_ns(void);
+uint64_t clock_cycles(void);
+uint64_t clock_cycles_to_ns(uint64_t cycles);
+uint64_t clock_tsc_hz(void);
+const clock_info_t* clock_get_info(void);
+void clock_dump_info(void);
+
+// Convenience conversions
+uint32_t clock_uptime_seconds(void);
+uint64_t clock_ns_to_us(uint64_t ns);
+
+#endif // CLOCK_H
@@ -0,0 +1,162 @@
+// ClaudeOS CPU Helpers
+// Inline wrappers for privileged and timing instructions (rdtsc, cpuid, CRx)
+
+#ifndef CPU_H
+#define CPU_H
+
+#include "types.h"
+
+// EFLAGS bits
+#define EFLAGS_IF           0x200   // Interrupt enable flag
+
+// Control register bits
+#define CR0_MP              (1 << 1)    // Monitor coprocessor (WAIT honours TS)
+#define CR0_EM              (1 << 2)    // x87 emulation (must be clear for SSE)
+#define CR0_TS              (1 << 3)    // Task switched: next FPU/SSE op traps #NM
+#define CR0_NE              (1 << 5)    // Native x87 error reporting
+#define CR4_OSFXSR          (1 << 9)    // OS supports FXSAVE/FXRSTOR
+#define CR4_OSXMMEXCPT      (1 << 10)   // OS handles SIMD exceptions (#XM)
+
+// CPUID leaf 1 EDX feature bits
+#define CPUID_EDX_FPU       (1 << 0)
+#define CPUID_EDX_TSC       (1 << 4)
+#define CPUID_EDX_MSR       (1 << 5)
+#define CPUID_EDX_SEP       (1 << 11)
+#define CPUID_EDX_FXSR      (1 << 24)
+#define CPUID_EDX_SSE       (1 << 25)
+#define CPUID_EDX_SSE2      (1 << 26)
+
+// Model-specific registers
+#define MSR_IA32_SYSENTER_CS    0x174
+#define MSR_IA32_SYSENTER_ESP   0x175
+#define MSR_IA32_SYSENTER_EIP   0x176
+
+// CPUID extended leaf 0x80000007 EDX bits
+#define CPUID_EXT_INVARIANT_TSC (1 << 8)
+
+// CPUID is available if EFLAGS.ID (bit 21) can be toggled
+static inline bool cpu_has_cpuid(void) {
+    uint32_t before, after;
+    asm volatile ("pushf\n\t"
+                  "pop %0\n\t"
+                  "mov %0, %1\n\t"
+                  "xor $0x200000, %1\n\t"
+                  "push %1\n\t"
+                  "popf\n\t"
+                  "pushf\n\t"
+                  "pop %1\n\t"
+                  "push %0\n\t"
+                  "popf"
+                  : "=&r" (before), "=&r" (after));
+    return ((before ^ after) & 0x200000) != 0;
+}
+
+// Execute CPUID for the given leaf
+static inline void cpuid(uint32_t leaf, uint32_t* eax, uint32_t* ebx,
+                         uint32_t* ecx, uint32_t* edx) {
+    asm volatile ("cpuid"
+                  : "=a" (*eax), "=b" (*ebx), "=c" (*ecx), "=d" (*edx)
+                  : "a" (leaf), "c" (0));
+}
+
+// Read the time stamp counter (not ordered against surrounding code)
+static inline uint64_t rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Read the time stamp counter after all earlier instructions retire.
+// CPUID is the only serializing instruction guaranteed on every TSC-capable
+// CPU, so it is used instead of LFENCE/RDTSCP (absent on the default QEMU model).
+static inline uint64_t rdtsc_ordered(void) {
+    uint32_t lo, hi;
+    asm volatile ("xor %%eax, %%eax\n\t"
+                  "cpuid\n\t"
+                  "rdtsc"
+                  : "=a" (lo), "=d" (hi)
+                  :
+                  : "ebx", "ecx", "memory");
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Control register access
+static inline uint32_t read_cr0(void) {
+    uint32_t value;
+    asm volatile ("mov %%cr0, %0" : "=r" (value));
+    return value;
+}
+
+static inline void write_cr0(uint32_t value) {
+    asm volatile ("mov %0, %%cr0" : : "r" (value) : "memory");
+}
+
+static inline uint32_t read_cr4(void) {
+    uint32_t value;
+    asm volatile ("mov %%cr4, %0" : "=r" (value));
+    return value;
+}
+
+static inline void write_cr4(uint32_t value) {
+    asm volatile ("mov %0, %%cr4" : : "r" (value) : "memory");
+}
+
+// Clear / set CR0.TS (task-switched flag used for lazy FPU switching)
+static inline void clts(void) {
+    asm volatile ("clts" : : : "memory");
+}
+
+static inline void stts(void) {
+    write_cr0(read_cr0() | CR0_TS);
+}
+
+// Interrupt state save/restore (nesting-safe critical sections)
+static inline uint32_t irq_save(void) {
+    uint32_t flags;
+    asm volatile ("pushf\n\t"
+                  "pop %0\n\t"
+                  "cli"
+                  : "=r" (flags)
+                  :
+                  : "memory");
+    return flags;
+}
+
+static inline void irq_restore(uint32_t flags) {
+    if (flags & EFLAGS_IF) {
+        asm volatile ("sti" : : : "memory");
+    }
+}
+
+static inline uint64_t rdmsr(uint32_t msr) {
+    uint32_t lo, hi;
+    asm volatile ("rdmsr" : "=a" (lo), "=d" (hi) : "c" (msr));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void wrmsr(uint32_t msr, uint64_t value) {
+    asm volatile ("wrmsr"
+                  :
+                  : "c" (msr), "a" ((uint32_t)value), "d" ((uint32_t)(value >> 32)));
+}
+
+static inline bool irqs_enabled(void) {
+    uint32_t flags;
+    asm volatile ("pushf\n\t"
+                  "pop %0"
+                  : "=r" (flags));
+    return (flags & EFLAGS_IF) != 0;
+}
+
+// Current privilege level (low bits of CS): 0 kernel, 3 user
+static inline uint32_t cpu_privilege_level(void) {
+    uint16_t cs;
+    asm volatile ("mov %%cs, %0" : "=r" (cs));
+    return cs & 3;
+}
+
+static inline void cpu_relax(void) {
+    asm volatile ("pause" : : : "memory");
+}
+
+#endif // CPU_H
@@ -0,0 +1,63 @@
+// ClaudeOS 64-bit Division Helpers
+// The kernel links without libgcc, so plain 64-bit '/' and '%' are unavailable
+
+#ifndef DIV64_H
+#define DIV64_H
+
+#include "types.h"
+
+// Divide a 64-bit value by a 32-bit divisor (two DIVL steps, no overflow)
+static inline uint64_t div_u64_rem(uint64_t dividend, uint32_t divisor, uint32_t* remainder) {
+    uint32_t hi = (uint32_t)(dividend >> 32);
+    uint32_t lo = (uint32_t)dividend;
+    uint32_t q_hi = hi / divisor;
+    uint32_t r = hi % divisor;
+    uint32_t q_lo;
+
+    // r < divisor, so the 64/32 DIVL below cannot overflow
+    asm ("divl %4"
+         : "=a" (q_lo), "=d" (r)
+         : "a" (lo), "d" (r), "rm" (divisor));
+
+    if (remainder) {
+        *remainder = r;
+    }
+    return ((uint64_t)q_hi << 32) | q_lo;
+}
+
+static inline uint64_t div_u64(uint64_t dividend, uint32_t divisor) {
+    return div_u64_rem(dividend, divisor, NULL);
+}
+
+// Full 64-by-64 division (shift-subtract; used off the hot path for rates)
+static inline uint64_t div64_u64(uint64_t dividend, uint64_t divisor) {
+    if (divisor == 0) {
+        return 0;
+    }
+    if ((divisor >> 32) == 0) {
+        return div_u64(dividend, (uint32_t)divisor);
+    }
+
+    uint64_t quotient = 0;
+    uint64_t remainder = 0;
+    for (int bit = 63; bit >= 0; bit--) {
+        remainder = (remainder << 1) | ((dividend >> bit) & 1);
+        if (remainder >= divisor) {
+            remainder -= divisor;
+            quotient |= (uint64_t)1 << bit;
+        }
+    }
+    return quotient;
+}
+
+// (value * mult) >> shift with a 96-bit intermediate, shift <= 32
+static inline uint64_t mul_u64_u32_shr(uint64_t value, uint32_t mult, uint32_t shift) {
+    uint64_t lo = (uint64_t)(uint32_t)value * mult;
+    uint64_t hi = (uint64_t)(uint32_t)(value >> 32) * mult;
+    if (shift == 0) {
+        return lo + (hi << 32);
+    }
+    return (lo >> shift) + (hi << (32 - shift));
+}
+
+#endif // DIV64_H
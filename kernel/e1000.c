@@ -0,0 +1,331 @@
+// ClaudeOS Intel e1000 Ethernet Driver - Day 21
+// 8254x (QEMU's default "e1000" NIC): DMA descriptor rings, interrupt-driven RX
+
+#include "e1000.h"
+#include "network.h"
+#include "pic.h"
+#include "pmm.h"
+#include "idt.h"
+#include "kernel.h"
+#include "string.h"
+
+// Supported device ids (82540EM is what QEMU emulates)
+static const uint16_t e1000_device_ids[] = { 0x100E, 0x100F, 0x1004, 0 };
+
+static e1000_device_t e1000_dev;
+static bool e1000_found = false;
+
+static inline uint32_t e1000_read(e1000_device_t* nic, uint32_t reg) {
+    return *(volatile uint32_t*)(nic->mmio + reg);
+}
+
+static inline void e1000_write(e1000_device_t* nic, uint32_t reg, uint32_t value) {
+    *(volatile uint32_t*)(nic->mmio + reg) = value;
+}
+
+// Descriptor and buffer writes must be visible before the doorbell; x86
+// keeps stores in order, so only the compiler needs holding back
+static inline void e1000_wmb(void) {
+    asm volatile ("" : : : "memory");
+}
+
+static uint16_t e1000_eeprom_read(e1000_device_t* nic, uint8_t word) {
+    e1000_write(nic, E1000_EERD, E1000_EERD_START | ((uint32_t)word << 8));
+    for (int i = 0; i < 100000; i++) {
+        uint32_t value = e1000_read(nic, E1000_EERD);
+        if (value & E1000_EERD_DONE) {
+            return (uint16_t)(value >> 16);
+        }
+    }
+    return 0;
+}
+
+// Receive-address register 0 is loaded from the EEPROM at reset; fall
+// back to reading the EEPROM when it is not marked valid
+static void e1000_read_mac(e1000_device_t* nic) {
+    uint32_t ral = e1000_read(nic, E1000_RAL0);
+    uint32_t rah = e1000_read(nic, E1000_RAH0);
+    if (rah & E1000_RAH_AV) {
+        for (int i = 0; i < 4; i++) {
+            nic->mac[i] = (uint8_t)(ral >> (i * 8));
+        }
+        nic->mac[4] = (uint8_t)rah;
+        nic->mac[5] = (uint8_t)(rah >> 8);
+        return;
+    }
+    for (int i = 0; i < 3; i++) {
+        uint16_t word = e1000_eeprom_read(nic, (uint8_t)i);
+        nic->mac[i * 2] = (uint8_t)word;
+        nic->mac[i * 2 + 1] = (uint8_t)(word >> 8);
+    }
+    e1000_write(nic, E1000_RAL0, nic->mac[0] | (nic->mac[1] << 8) |
+                ((uint32_t)nic->mac[2] << 16) | ((uint32_t)nic->mac[3] << 24));
+    e1000_write(nic, E1000_RAH0, nic->mac[4] | (nic->mac[5] << 8) | E1000_RAH_AV);
+}
+
+// Rings and buffers are physically contiguous pages; with paging off the
+// kernel's pointers are the bus addresses the device DMAs to
+static bool e1000_alloc_rings(e1000_device_t* nic) {
+    uint32_t ring_page = pmm_alloc_page();
+    uint32_t rx_pages = (E1000_NUM_RX_DESC * E1000_BUFFER_SIZE) / PAGE_SIZE;
+    uint32_t tx_pages = (E1000_NUM_TX_DESC * E1000_BUFFER_SIZE) / PAGE_SIZE;
+    uint32_t rx_buffers = pmm_alloc_pages(rx_pages);
+    uint32_t tx_buffers = pmm_alloc_pages(tx_pages);
+    if (!ring_page || !rx_buffers || !tx_buffers) {
+        if (ring_page) pmm_free_page(ring_page);
+        if (rx_buffers) pmm_free_pages(rx_buffers, rx_pages);
+        if (tx_buffers) pmm_free_pages(tx_buffers, tx_pages);
+        return false;
+    }
+
+    memset((void*)ring_page, 0, PAGE_SIZE);
+    nic->rx_ring = (volatile e1000_rx_desc_t*)ring_page;
+    nic->tx_ring = (volatile e1000_tx_desc_t*)(ring_page + E1000_NUM_RX_DESC * sizeof(e1000_rx_desc_t));
+    nic->rx_buffers = (uint8_t*)rx_buffers;
+    nic->tx_buffers = (uint8_t*)tx_buffers;
+    return true;
+}
+
+static void e1000_free_rings(e1000_device_t* nic) {
+    pmm_free_page((uint32_t)nic->rx_ring);
+    pmm_free_pages((uint32_t)nic->rx_buffers, (E1000_NUM_RX_DESC * E1000_BUFFER_SIZE) / PAGE_SIZE);
+    pmm_free_pages((uint32_t)nic->tx_buffers, (E1000_NUM_TX_DESC * E1000_BUFFER_SIZE) / PAGE_SIZE);
+    nic->rx_ring = NULL;
+    nic->tx_ring = NULL;
+    nic->rx_buffers = NULL;
+    nic->tx_buffers = NULL;
+}
+
+static void e1000_init_rx(e1000_device_t* nic) {
+    for (int i = 0; i < E1000_NUM_RX_DESC; i++) {
+        nic->rx_ring[i].addr = (uint32_t)(nic->rx_buffers + i * E1000_BUFFER_SIZE);
+        nic->rx_ring[i].status = 0;
+    }
+    nic->rx_next = 0;
+
+    e1000_write(nic, E1000_RDBAL, (uint32_t)nic->rx_ring);
+    e1000_write(nic, E1000_RDBAH, 0);
+    e1000_write(nic, E1000_RDLEN, E1000_NUM_RX_DESC * sizeof(e1000_rx_desc_t));
+    e1000_write(nic, E1000_RDH, 0);
+    e1000_write(nic, E1000_RDT, E1000_NUM_RX_DESC - 1);   // All but one owned by hardware
+    e1000_write(nic, E1000_RDTR, 0);                      // Interrupt per frame batch, no delay
+    e1000_write(nic, E1000_RCTL, E1000_RCTL_EN | E1000_RCTL_BAM | E1000_RCTL_SECRC);
+}
+
+static void e1000_init_tx(e1000_device_t* nic) {
+    // Every descriptor starts out done, i.e. free for transmit()
+    for (int i = 0; i < E1000_NUM_TX_DESC; i++) {
+        nic->tx_ring[i].addr = (uint32_t)(nic->tx_buffers + i * E1000_BUFFER_SIZE);
+        nic->tx_ring[i].cmd = 0;
+        nic->tx_ring[i].status = E1000_TXD_STAT_DD;
+    }
+    nic->tx_tail = 0;
+
+    e1000_write(nic, E1000_TDBAL, (uint32_t)nic->tx_ring);
+    e1000_write(nic, E1000_TDBAH, 0);
+    e1000_write(nic, E1000_TDLEN, E1000_NUM_TX_DESC * sizeof(e1000_tx_desc_t));
+    e1000_write(nic, E1000_TDH, 0);
+    e1000_write(nic, E1000_TDT, 0);
+    e1000_write(nic, E1000_TCTL, E1000_TCTL_EN | E1000_TCTL_PSP |
+                (0x0F << E1000_TCTL_CT_SHIFT) | (0x40 << E1000_TCTL_COLD_SHIFT));
+    e1000_write(nic, E1000_TIPG, 10 | (8 << 10) | (6 << 20));   // 802.3 IPG values
+}
+
+// Copy the frame into the tail descriptor's buffer and ring the doorbell.
+// Completed descriptors are recycled lazily: DD set means free again.
+static int e1000_transmit(network_interface_t* iface, const uint8_t* data, size_t size) {
+    e1000_device_t* nic = (e1000_device_t*)iface->priv;
+    if (size > E1000_MAX_FRAME) {
+        return -1;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&nic->tx_lock);
+    uint32_t tail = nic->tx_tail;
+    volatile e1000_tx_desc_t* desc = &nic->tx_ring[tail];
+    if (!(desc->status & E1000_TXD_STAT_DD)) {
+        nic->stats.tx_ring_full++;
+        spin_unlock_irqrestore(&nic->tx_lock, flags);
+        return -1;
+    }
+
+    memcpy(nic->tx_buffers + tail * E1000_BUFFER_SIZE, data, size);
+    desc->length = (uint16_t)size;
+    desc->cmd = E1000_TXD_CMD_EOP | E1000_TXD_CMD_IFCS | E1000_TXD_CMD_RS;
+    desc->status = 0;
+    nic->tx_tail = (tail + 1) % E1000_NUM_TX_DESC;
+    nic->stats.tx_frames++;
+    e1000_wmb();
+    e1000_write(nic, E1000_TDT, nic->tx_tail);
+    spin_unlock_irqrestore(&nic->tx_lock, flags);
+    return 0;
+}
+
+static const net_device_ops_t e1000_netdev_ops = {
+    .name     = "e1000",
+    .transmit = e1000_transmit,
+};
+
+// Drain every completed RX descriptor into the interface queue, then
+// return them to the hardware with a single tail update
+static void e1000_rx_poll(e1000_device_t* nic) {
+    network_interface_t* iface = network_find_interface(nic->interface_id);
+    int queued = 0;
+    uint32_t last = E1000_NUM_RX_DESC;
+
+    while (nic->rx_ring[nic->rx_next].status & E1000_RXD_STAT_DD) {
+        volatile e1000_rx_desc_t* desc = &nic->rx_ring[nic->rx_next];
+        uint16_t length = desc->length;
+
+        if ((desc->status & E1000_RXD_STAT_EOP) && !desc->errors && length <= MAX_PACKET_SIZE) {
+            nic->stats.rx_frames++;
+            sk_buff_t* skb = iface ? network_alloc_packet() : NULL;
+            if (skb) {
+                memcpy(skb_put(skb, length), nic->rx_buffers + nic->rx_next * E1000_BUFFER_SIZE, length);
+                skb->interface_id = nic->interface_id;
+                if (network_rx_enqueue(iface, skb) == 0) {
+                    queued++;
+                }
+            } else if (iface) {
+                iface->rx_dropped++;
+            }
+        } else {
+            nic->stats.rx_errors++;
+        }
+
+        desc->status = 0;
+        last = nic->rx_next;
+        nic->rx_next = (nic->rx_next + 1) % E1000_NUM_RX_DESC;
+    }
+
+    if (last != E1000_NUM_RX_DESC) {
+        e1000_wmb();
+        e1000_write(nic, E1000_RDT, last);
+    }
+    if (queued) {
+        network_rx_notify(nic->interface_id);
+    }
+}
+
+static void e1000_irq_handler(uint8_t irq) {
+    e1000_device_t* nic = &e1000_dev;
+    uint32_t icr = e1000_read(nic, E1000_ICR);   // Reading acknowledges the causes
+
+    if (icr) {
+        nic->stats.interrupts++;
+        if (icr & E1000_ICR_LSC) {
+            nic->stats.link_changes++;
+        }
+        if (icr & E1000_ICR_RXO) {
+            nic->stats.rx_overruns++;
+        }
+        if (icr & (E1000_ICR_RXT0 | E1000_ICR_RXDMT0 | E1000_ICR_RXO)) {
+            e1000_rx_poll(nic);
+        }
+    }
+
+    pic_send_eoi(irq);
+}
+
+int e1000_init(const char* name, uint32_t ip_address) {
+    pci_device_t* pci = NULL;
+    for (int i = 0; e1000_device_ids[i] && !pci; i++) {
+        pci = pci_find_device(E1000_VENDOR_INTEL, e1000_device_ids[i]);
+    }
+    if (!pci || pci_bar_is_io(pci, 0) || pci->irq_line >= 16) {
+        return -1;
+    }
+
+    e1000_device_t* nic = &e1000_dev;
+    memset(nic, 0, sizeof(*nic));
+    spin_lock_init(&nic->tx_lock, "e1000_tx");
+    nic->pci = pci;
+    nic->mmio = (volatile uint8_t*)pci_bar_address(pci, 0);
+    nic->irq = pci->irq_line;
+    pci_enable_device(pci, true);
+
+    // Reset, then mask and acknowledge everything until the rings exist
+    e1000_write(nic, E1000_IMC, 0xFFFFFFFF);
+    e1000_write(nic, E1000_CTRL, e1000_read(nic, E1000_CTRL) | E1000_CTRL_RST);
+    for (int i = 0; i < 100000 && (e1000_read(nic, E1000_CTRL) & E1000_CTRL_RST); i++) {
+        io_wait();
+    }
+    e1000_write(nic, E1000_IMC, 0xFFFFFFFF);
+    (void)e1000_read(nic, E1000_ICR);
+
+    uint32_t ctrl = e1000_read(nic, E1000_CTRL);
+    ctrl &= ~E1000_CTRL_PHY_RST;
+    e1000_write(nic, E1000_CTRL, ctrl | E1000_CTRL_SLU | E1000_CTRL_ASDE);
+
+    e1000_read_mac(nic);
+    for (int i = 0; i < 128; i++) {
+        e1000_write(nic, E1000_MTA + i * 4, 0);
+    }
+
+    // The rings are not programmed yet, so giving up only needs DMA off
+    if (!e1000_alloc_rings(nic)) {
+        terminal_writestring("[E1000] Out of memory for descriptor rings\n");
+        pci_clear_master(pci);
+        return -1;
+    }
+
+    int id = network_create_interface(name, NET_INTERFACE_ETHERNET);
+    if (id < 0) {
+        e1000_free_rings(nic);
+        pci_clear_master(pci);
+        return -1;
+    }
+    network_interface_t* iface = network_find_interface(id);
+    for (int i = 0; i < 6; i++) {
+        iface->mac_address[i] = nic->mac[i];
+    }
+    iface->ip_address = ip_address;
+    iface->priv = nic;
+    iface->ops = &e1000_netdev_ops;
+    nic->interface_id = id;
+
+    e1000_init_rx(nic);
+    e1000_init_tx(nic);
+
+    // Legacy INTx through the PIC; slave lines also need the cascade
+    irq_install_handler(nic->irq, e1000_irq_handler);
+    if (nic->irq >= 8) {
+        pic_clear_mask(IRQ2_CASCADE);
+    }
+    pic_clear_mask(nic->irq);
+    e1000_write(nic, E1000_IMS, E1000_ICR_RXT0 | E1000_ICR_RXDMT0 | E1000_ICR_RXO | E1000_ICR_LSC);
+
+    network_enable_interface(id);
+    e1000_found = true;
+    return id;
+}
+
+bool e1000_present(void) {
+    return e1000_found;
+}
+
+bool e1000_link_up(void) {
+    return e1000_found && (e1000_read(&e1000_dev, E1000_STATUS) & E1000_STATUS_LU);
+}
+
+void e1000_show_stats(void) {
+    if (!e1000_found) {
+        terminal_writestring("No e1000 NIC (run QEMU with -device e1000)\n");
+        return;
+    }
+
+    e1000_device_t* nic = &e1000_dev;
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
+    terminal_writestring("e1000 NIC:\n");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+    terminal_printf("  PCI %d:%d.%d, IRQ %d, link %s\n", nic->pci->bus, nic->pci->slot,
+                    nic->pci->function, nic->irq, e1000_link_up() ? "up" : "down");
+    terminal_printf("  Rings: %d RX / %d TX descriptors, %d-byte buffers\n",
+                    E1000_NUM_RX_DESC, E1000_NUM_TX_DESC, E1000_BUFFER_SIZE);
+    terminal_printf("  RX head/tail: %u/%u, next %u\n", e1000_read(nic, E1000_RDH),
+                    e1000_read(nic, E1000_RDT), nic->rx_next);
+    terminal_printf("  TX head/tail: %u/%u\n", e1000_read(nic, E1000_TDH), e1000_read(nic, E1000_TDT));
+    terminal_printf("  Interrupts: %u, link changes: %u\n", nic->stats.interrupts, nic->stats.link_changes);
+    terminal_printf("  RX frames: %u, errors: %u, overruns: %u\n",
+                    nic->stats.rx_frames, nic->stats.rx_errors, nic->stats.rx_overruns);
+    terminal_printf("  TX frames: %u, ring full: %u\n", nic->stats.tx_frames, nic->stats.tx_ring_full);
+}
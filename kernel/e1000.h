@@ -0,0 +1,131 @@
+// ClaudeOS Intel e1000 Ethernet Driver - Day 21
+// 8254x (QEMU's default "e1000" NIC): DMA descriptor rings, interrupt-driven RX
+
+#ifndef E1000_H
+#define E1000_H
+
+#include "types.h"
+#include "pci.h"
+#include "lock.h"
+
+#define E1000_VENDOR_INTEL      0x8086
+
+// Registers (byte offsets into the BAR0 MMIO window)
+#define E1000_CTRL      0x0000
+#define E1000_STATUS    0x0008
+#define E1000_EERD      0x0014
+#define E1000_ICR       0x00C0          // Interrupt cause (read clears)
+#define E1000_IMS       0x00D0          // Interrupt mask set
+#define E1000_IMC       0x00D8          // Interrupt mask clear
+#define E1000_RCTL      0x0100
+#define E1000_TCTL      0x0400
+#define E1000_TIPG      0x0410
+#define E1000_RDBAL     0x2800
+#define E1000_RDBAH     0x2804
+#define E1000_RDLEN     0x2808
+#define E1000_RDH       0x2810
+#define E1000_RDT       0x2818
+#define E1000_RDTR      0x2820          // RX interrupt delay
+#define E1000_TDBAL     0x3800
+#define E1000_TDBAH     0x3804
+#define E1000_TDLEN     0x3808
+#define E1000_TDH       0x3810
+#define E1000_TDT       0x3818
+#define E1000_MTA       0x5200          // Multicast table (128 dwords)
+#define E1000_RAL0      0x5400
+#define E1000_RAH0      0x5404
+
+#define E1000_CTRL_ASDE         (1u << 5)
+#define E1000_CTRL_SLU          (1u << 6)
+#define E1000_CTRL_RST          (1u << 26)
+#define E1000_CTRL_PHY_RST      (1u << 31)
+#define E1000_STATUS_LU         (1u << 1)   // Link up
+#define E1000_EERD_START        (1u << 0)
+#define E1000_EERD_DONE         (1u << 4)
+#define E1000_RAH_AV            (1u << 31)
+
+#define E1000_RCTL_EN           (1u << 1)
+#define E1000_RCTL_BAM          (1u << 15)  // Accept broadcast
+#define E1000_RCTL_SECRC        (1u << 26)  // Strip Ethernet CRC
+// BSIZE = 00 (2048-byte buffers)
+
+#define E1000_TCTL_EN           (1u << 1)
+#define E1000_TCTL_PSP          (1u << 3)   // Pad short packets
+#define E1000_TCTL_CT_SHIFT     4
+#define E1000_TCTL_COLD_SHIFT   12
+
+// Interrupt causes
+#define E1000_ICR_TXDW          (1u << 0)
+#define E1000_ICR_LSC           (1u << 2)   // Link status change
+#define E1000_ICR_RXDMT0        (1u << 4)   // RX ring below threshold
+#define E1000_ICR_RXO           (1u << 6)   // RX overrun
+#define E1000_ICR_RXT0          (1u << 7)   // RX timer (frame received)
+
+// Descriptor bits
+#define E1000_TXD_CMD_EOP       (1u << 0)
+#define E1000_TXD_CMD_IFCS      (1u << 1)   // Insert FCS
+#define E1000_TXD_CMD_RS        (1u << 3)   // Report status (set DD)
+#define E1000_TXD_STAT_DD       (1u << 0)
+#define E1000_RXD_STAT_DD       (1u << 0)
+#define E1000_RXD_STAT_EOP      (1u << 1)
+
+// Rings: 32 descriptors (ring length must be a multiple of 128 bytes),
+// one 2KB buffer per descriptor
+#define E1000_NUM_RX_DESC       32
+#define E1000_NUM_TX_DESC       32
+#define E1000_BUFFER_SIZE       2048
+#define E1000_MAX_FRAME         1514        // Without FCS (hardware adds it)
+
+typedef struct e1000_tx_desc {
+    uint64_t addr;
+    uint16_t length;
+    uint8_t cso;
+    uint8_t cmd;
+    uint8_t status;
+    uint8_t css;
+    uint16_t special;
+} __attribute__((packed)) e1000_tx_desc_t;
+
+typedef struct e1000_rx_desc {
+    uint64_t addr;
+    uint16_t length;
+    uint16_t checksum;
+    uint8_t status;
+    uint8_t errors;
+    uint16_t special;
+} __attribute__((packed)) e1000_rx_desc_t;
+
+typedef struct e1000_stats {
+    uint32_t interrupts;
+    uint32_t rx_frames;
+    uint32_t rx_errors;                 // Bad or multi-descriptor frames
+    uint32_t rx_overruns;               // Ring was full (ICR.RXO)
+    uint32_t tx_frames;
+    uint32_t tx_ring_full;              // transmit() found no free descriptor
+    uint32_t link_changes;
+} e1000_stats_t;
+
+typedef struct e1000_device {
+    pci_device_t* pci;
+    volatile uint8_t* mmio;
+    uint8_t irq;
+    uint8_t mac[6];
+    int interface_id;
+    volatile e1000_rx_desc_t* rx_ring;
+    uint8_t* rx_buffers;
+    uint32_t rx_next;                   // Next descriptor the hardware fills
+    volatile e1000_tx_desc_t* tx_ring;
+    uint8_t* tx_buffers;
+    uint32_t tx_tail;                   // Next descriptor to hand to hardware
+    spinlock_t tx_lock;
+    e1000_stats_t stats;
+} e1000_device_t;
+
+// Probe PCI for a supported NIC and bring it up as an Ethernet interface.
+// Returns the interface id, or -1 when no device is present.
+int e1000_init(const char* name, uint32_t ip_address);
+bool e1000_present(void);
+bool e1000_link_up(void);
+void e1000_show_stats(void);
+
+#endif // E1000_H
@@ -0,0 +1,117 @@
+// ClaudeOS File Descriptor Tables - Day 21
+// Per-process descriptors for kernel objects (pipes and later additions)
+
+#include "fd.h"
+#include "cpu.h"
+#include "kernel.h"
+#include "string.h"
+
+static fd_table_t fd_tables[MAX_PROCESSES];
+
+// Table for a live process (reset when a new pid takes over the slot)
+static fd_table_t* fd_table(process_t* process) {
+    fd_table_t* table = &fd_tables[process - process_table];
+    if (table->owner_pid != process->pid) {
+        memset(table, 0, sizeof(*table));
+        table->owner_pid = process->pid;
+    }
+    return table;
+}
+
+int fd_install(process_t* process, const fd_ops_t* ops, void* object) {
+    if (!process || !ops || !object) {
+        return -1;
+    }
+
+    uint32_t flags = irq_save();
+    fd_table_t* table = fd_table(process);
+    for (int i = 0; i < MAX_FDS; i++) {
+        if (!table->entries[i].ops) {
+            table->entries[i].ops = ops;
+            table->entries[i].object = object;
+            ops->get(object);
+            irq_restore(flags);
+            return FD_BASE + i;
+        }
+    }
+    irq_restore(flags);
+    return -1;
+}
+
+fd_entry_t* fd_lookup(int fd) {
+    if (!current_process || !fd_is_local(fd)) {
+        return NULL;
+    }
+    fd_entry_t* entry = &fd_table(current_process)->entries[fd - FD_BASE];
+    return entry->ops ? entry : NULL;
+}
+
+int fd_read(int fd, void* buffer, size_t count) {
+    fd_entry_t* entry = fd_lookup(fd);
+    if (!entry || !entry->ops->read || !buffer) {
+        return -1;
+    }
+    return entry->ops->read(entry->object, buffer, count);
+}
+
+int fd_write(int fd, const void* buffer, size_t count) {
+    fd_entry_t* entry = fd_lookup(fd);
+    if (!entry || !entry->ops->write || !buffer) {
+        return -1;
+    }
+    return entry->ops->write(entry->object, buffer, count);
+}
+
+int fd_close(int fd) {
+    uint32_t flags = irq_save();
+    fd_entry_t* entry = fd_lookup(fd);
+    if (!entry) {
+        irq_restore(flags);
+        return -1;
+    }
+
+    const fd_ops_t* ops = entry->ops;
+    void* object = entry->object;
+    entry->ops = NULL;
+    entry->object = NULL;
+    ops->put(object);
+    irq_restore(flags);
+    return 0;
+}
+
+int fd_dup_to(process_t* target, int fd) {
+    uint32_t flags = irq_save();
+    fd_entry_t* entry = fd_lookup(fd);
+    int result = entry ? fd_install(target, entry->ops, entry->object) : -1;
+    irq_restore(flags);
+    return result;
+}
+
+void fd_release(process_t* process) {
+    uint32_t flags = irq_save();
+    fd_table_t* table = &fd_tables[process - process_table];
+    if (table->owner_pid == process->pid) {
+        for (int i = 0; i < MAX_FDS; i++) {
+            fd_entry_t* entry = &table->entries[i];
+            if (entry->ops) {
+                const fd_ops_t* ops = entry->ops;
+                entry->ops = NULL;
+                ops->put(entry->object);
+            }
+        }
+        table->owner_pid = INVALID_PID;
+    }
+    irq_restore(flags);
+}
+
+void fd_list(process_t* process) {
+    fd_table_t* table = &fd_tables[process - process_table];
+    if (table->owner_pid != process->pid) {
+        return;
+    }
+    for (int i = 0; i < MAX_FDS; i++) {
+        if (table->entries[i].ops) {
+            terminal_printf("  fd %d: %s\n", FD_BASE + i, table->entries[i].ops->name);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+// ClaudeOS File Descriptor Tables - Day 21
+// Per-process descriptors for kernel objects (pipes and later additions)
+
+#ifndef FD_H
+#define FD_H
+
+#include "types.h"
+#include "process.h"
+#include "poll.h"
+#include "../fs/memfs_simple.h"
+
+// Numbers below FD_BASE stay global memfs handles (SYS_OPEN); per-process
+// descriptors start above them so both can share SYS_READ/SYS_WRITE_FILE.
+#define FD_BASE             MEMFS_MAX_FILES
+#define MAX_FDS             16
+
+// Operations of a descriptor's object. get/put track how many descriptors
+// refer to it; put on the last reference closes it. Pollable objects report
+// their current POLL* bits and the head they notify on state changes.
+typedef struct fd_ops {
+    const char* name;
+    int (*read)(void* object, void* buffer, size_t count);
+    int (*write)(void* object, const void* buffer, size_t count);
+    void (*get)(void* object);
+    void (*put)(void* object);
+    uint32_t (*poll)(void* object);
+    poll_head_t* (*poll_head)(void* object);
+} fd_ops_t;
+
+typedef struct fd_entry {
+    const fd_ops_t* ops;            // NULL if the slot is free
+    void* object;
+} fd_entry_t;
+
+// One table per process table slot (reset when a new pid takes the slot)
+typedef struct fd_table {
+    int owner_pid;
+    fd_entry_t entries[MAX_FDS];
+} fd_table_t;
+
+// Install a new reference to 'object' in a process (takes a reference).
+// Returns the descriptor, or -1 if the table is full.
+int fd_install(process_t* process, const fd_ops_t* ops, void* object);
+
+// Current-process operations (-1 on a bad descriptor)
+fd_entry_t* fd_lookup(int fd);
+int fd_read(int fd, void* buffer, size_t count);
+int fd_write(int fd, const void* buffer, size_t count);
+int fd_close(int fd);
+
+// Hand a copy of one of the caller's descriptors to another process
+int fd_dup_to(process_t* target, int fd);
+
+// Called by the reaper: drop every descriptor the process still holds
+void fd_release(process_t* process);
+
+void fd_list(process_t* process);
+
+static inline bool fd_is_local(int fd) {
+    return fd >= FD_BASE && fd < FD_BASE + MAX_FDS;
+}
+
+#endif // FD_H
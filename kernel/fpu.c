@@ -0,0 +1,262 @@
+// ClaudeOS FPU/SSE Management - Day 21
+// Lazy FXSAVE/FXRSTOR switching driven by the CR0.TS #NM trap
+
+#include "fpu.h"
+#include "cpu.h"
+#include "process.h"
+#include "heap.h"
+#include "string.h"
+#include "kernel.h"
+#include "sched.h"
+
+// Register state is only saved when another context actually needs the
+// FPU: a switch just sets CR0.TS, and the first FPU/SSE instruction of the
+// new task traps (#NM) so the previous owner's state can be saved then.
+
+static bool fpu_enabled = false;
+static process_t* fpu_owner = NULL;         // Task whose state is live in the registers
+static fpu_state_t fpu_initial_state;       // Clean image captured at boot
+static fpu_stats_t fpu_stats;
+
+static bool kernel_fpu_active = false;
+
+static inline void fxsave(fpu_state_t* state) {
+    asm volatile ("fxsave (%0)" : : "r" (state) : "memory");
+}
+
+static inline void fxrstor(const fpu_state_t* state) {
+    asm volatile ("fxrstor (%0)" : : "r" (state) : "memory");
+}
+
+// Initialize FPU/SSE support (call once before interrupts are enabled)
+void fpu_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    memset(&fpu_stats, 0, sizeof(fpu_stats));
+
+    if (!cpu_has_cpuid()) {
+        terminal_writestring("[FPU] No CPUID - SIMD paths disabled\n");
+        return;
+    }
+
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    if (!(edx & CPUID_EDX_FXSR) || !(edx & CPUID_EDX_SSE)) {
+        terminal_writestring("[FPU] FXSR/SSE not supported - SIMD paths disabled\n");
+        return;
+    }
+
+    uint32_t cr0 = read_cr0();
+    cr0 &= ~(CR0_EM | CR0_TS);
+    cr0 |= CR0_MP | CR0_NE;
+    write_cr0(cr0);
+
+    write_cr4(read_cr4() | CR4_OSFXSR | CR4_OSXMMEXCPT);
+
+    // Reset x87 and SSE control state, then capture it as the template
+    // every task starts from
+    uint32_t mxcsr = 0x1F80;    // All SIMD exceptions masked
+    asm volatile ("fninit\n\t"
+                  "ldmxcsr %0"
+                  : : "m" (mxcsr));
+    fxsave(&fpu_initial_state);
+
+    fpu_enabled = true;
+    stts();
+
+    terminal_printf("[FPU] SSE%s enabled, lazy FXSAVE switching active\n",
+                    (edx & CPUID_EDX_SSE2) ? "2" : "");
+}
+
+bool fpu_sse_available(void) {
+    return fpu_enabled;
+}
+
+// Save area for a task, allocated on first FPU use
+static fpu_state_t* fpu_alloc_state(process_t* process) {
+    if (!heap_initialized) {
+        return NULL;
+    }
+
+    void* raw = kmalloc(FPU_STATE_SIZE + FPU_STATE_ALIGN);
+    if (!raw) {
+        return NULL;
+    }
+
+    uint32_t aligned = ((uint32_t)raw + FPU_STATE_ALIGN - 1) & ~(FPU_STATE_ALIGN - 1);
+    fpu_state_t* state = (fpu_state_t*)aligned;
+    memcpy(state, &fpu_initial_state, sizeof(fpu_state_t));
+
+    process->fpu_alloc = raw;
+    process->memory_usage += FPU_STATE_SIZE + FPU_STATE_ALIGN;
+    fpu_stats.areas_allocated++;
+    return state;
+}
+
+// #NM (device not available) handler: hand the registers to current_process
+void fpu_handle_nm(void) {
+    if (!fpu_enabled) {
+        kernel_panic("#NM with FPU disabled");
+    }
+
+    clts();
+    fpu_stats.nm_traps++;
+
+    process_t* next = current_process;
+    if (fpu_owner == next) {
+        return;     // Registers still hold this task's state
+    }
+
+    if (fpu_owner && fpu_owner->fpu_state) {
+        fxsave(fpu_owner->fpu_state);
+        fpu_stats.saves++;
+    }
+    fpu_owner = NULL;
+
+    if (!next) {
+        // Before process_init there is no task to charge the state to
+        fxrstor(&fpu_initial_state);
+        return;
+    }
+
+    if (!next->fpu_state) {
+        next->fpu_state = fpu_alloc_state(next);
+        if (!next->fpu_state) {
+            kernel_panic("FPU: cannot allocate save area");
+        }
+    }
+
+    fxrstor(next->fpu_state);
+    fpu_stats.restores++;
+    fpu_owner = next;
+}
+
+// Called on every context switch; costs one CR0 write, never an FXSAVE
+void fpu_task_switch(process_t* prev, process_t* next) {
+    (void)prev;
+
+    if (!fpu_enabled) {
+        return;
+    }
+
+    if (next == fpu_owner) {
+        clts();     // Returning to the owner: no trap needed
+    } else {
+        stts();
+    }
+}
+
+// Drop a terminated task's save area
+void fpu_release(process_t* process) {
+    if (!process) {
+        return;
+    }
+
+    if (fpu_owner == process) {
+        fpu_owner = NULL;
+        if (fpu_enabled) {
+            stts();
+        }
+    }
+
+    if (process->fpu_alloc) {
+        kfree(process->fpu_alloc);
+        process->memory_usage -= FPU_STATE_SIZE + FPU_STATE_ALIGN;
+    }
+    process->fpu_alloc = NULL;
+    process->fpu_state = NULL;
+}
+
+// Begin an in-kernel SIMD section. Preemption stays off until kernel_fpu_end
+// so nothing can switch tasks while the kernel holds the registers; IRQ
+// handlers never touch the FPU, so interrupts can stay enabled.
+void kernel_fpu_begin(void) {
+    if (!fpu_enabled) {
+        return;
+    }
+
+    preempt_disable();
+    uint32_t flags = irq_save();
+    if (kernel_fpu_active) {
+        kernel_panic("kernel_fpu_begin: nested SIMD section");
+    }
+
+    clts();
+    if (fpu_owner && fpu_owner->fpu_state) {
+        fxsave(fpu_owner->fpu_state);
+        fpu_stats.saves++;
+    }
+    fpu_owner = NULL;
+
+    kernel_fpu_active = true;
+    fpu_stats.kernel_sections++;
+    irq_restore(flags);
+}
+
+// End an in-kernel SIMD section; the task's next FPU use traps and restores
+void kernel_fpu_end(void) {
+    if (!fpu_enabled) {
+        return;
+    }
+
+    kernel_fpu_active = false;
+    stts();
+    preempt_enable();
+}
+
+// Copy with 64-byte SSE blocks; scalar memcpy for short or non-SSE cases
+void* memcpy_sse(void* dest, const void* src, size_t n) {
+    if (!fpu_enabled || n < FPU_MEMCPY_THRESHOLD) {
+        return memcpy(dest, src, n);
+    }
+
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    size_t blocks = n / 64;
+
+    // XMM registers are not listed as clobbers: the kernel is built without
+    // SSE code generation, and kernel_fpu_begin has saved any task state.
+    kernel_fpu_begin();
+    while (blocks--) {
+        asm volatile ("movups   (%0), %%xmm0\n\t"
+                      "movups 16(%0), %%xmm1\n\t"
+                      "movups 32(%0), %%xmm2\n\t"
+                      "movups 48(%0), %%xmm3\n\t"
+                      "movups %%xmm0,   (%1)\n\t"
+                      "movups %%xmm1, 16(%1)\n\t"
+                      "movups %%xmm2, 32(%1)\n\t"
+                      "movups %%xmm3, 48(%1)"
+                      : : "r" (s), "r" (d) : "memory");
+        s += 64;
+        d += 64;
+    }
+    kernel_fpu_end();
+
+    memcpy(d, s, n & 63);
+    return dest;
+}
+
+void fpu_get_stats(fpu_stats_t* stats) {
+    if (stats) {
+        *stats = fpu_stats;
+    }
+}
+
+// Shell 'fpu' command output
+void fpu_dump_info(void) {
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
+    terminal_writestring("FPU/SSE State\n");
+    terminal_writestring("=============\n");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+
+    terminal_printf("  SSE enabled:     %s\n", fpu_enabled ? "yes" : "no");
+    if (!fpu_enabled) {
+        return;
+    }
+
+    terminal_printf("  Register owner:  %s\n", fpu_owner ? fpu_owner->name : "(none)");
+    terminal_printf("  #NM traps:       %u\n", fpu_stats.nm_traps);
+    terminal_printf("  State saves:     %u\n", fpu_stats.saves);
+    terminal_printf("  State restores:  %u\n", fpu_stats.restores);
+    terminal_printf("  Areas allocated: %u\n", fpu_stats.areas_allocated);
+    terminal_printf("  Kernel sections: %u\n", fpu_stats.kernel_sections);
+}
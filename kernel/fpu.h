@@ -0,0 +1,47 @@
+// ClaudeOS FPU/SSE Management - Day 21
+// Lazy FXSAVE/FXRSTOR switching driven by the CR0.TS #NM trap
+
+#ifndef FPU_H
+#define FPU_H
+
+#include "types.h"
+
+struct process;
+
+// FXSAVE image: 512 bytes, 16-byte aligned
+#define FPU_STATE_SIZE      512
+#define FPU_STATE_ALIGN     16
+
+// SSE copy is only worth the begin/end cost above this size
+#define FPU_MEMCPY_THRESHOLD 256
+
+typedef struct fpu_state {
+    uint8_t data[FPU_STATE_SIZE];
+} __attribute__((aligned(FPU_STATE_ALIGN))) fpu_state_t;
+
+// Lazy switching statistics
+typedef struct {
+    uint32_t nm_traps;          // #NM exceptions taken
+    uint32_t saves;             // FXSAVE of a previous owner
+    uint32_t restores;          // FXRSTOR into the registers
+    uint32_t areas_allocated;   // Save areas handed out on first use
+    uint32_t kernel_sections;   // kernel_fpu_begin/end pairs
+} fpu_stats_t;
+
+// FPU management interface
+void fpu_init(void);
+bool fpu_sse_available(void);
+void fpu_handle_nm(void);
+void fpu_task_switch(struct process* prev, struct process* next);
+void fpu_release(struct process* process);
+void fpu_get_stats(fpu_stats_t* stats);
+void fpu_dump_info(void);
+
+// In-kernel SIMD sections (not nestable, not usable from IRQ handlers)
+void kernel_fpu_begin(void);
+void kernel_fpu_end(void);
+
+// SSE-accelerated helpers (fall back to scalar code without SSE)
+void* memcpy_sse(void* dest, const void* src, size_t n);
+
+#endif // FPU_H
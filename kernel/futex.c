@@ -0,0 +1,418 @@
+// ClaudeOS Futexes - Day 21
+// Lock words in ordinary (shared) memory; the kernel is entered only to
+// sleep or wake on contention, through wait queues hashed by address
+
+#include "futex.h"
+#include "atomic.h"
+#include "wait.h"
+#include "process.h"
+#include "cpu.h"
+#include "idt.h"
+#include "clock.h"
+#include "div64.h"
+#include "syscall.h"
+#include "usermode.h"
+#include "ipc.h"
+#include "kernel.h"
+#include "string.h"
+
+// Sleepers on every futex word that hashes to the same bucket share one
+// queue; each is tagged with its word's address
+static wait_queue_t futex_queues[FUTEX_HASH_BUCKETS];
+static futex_stats_t futex_stats;
+
+static inline wait_queue_t* futex_queue(volatile uint32_t* addr) {
+    uint32_t key = (uint32_t)addr;
+    return &futex_queues[((key >> 2) ^ (key >> 9)) % FUTEX_HASH_BUCKETS];
+}
+
+int futex_wait(volatile uint32_t* addr, uint32_t expected) {
+    if (!addr || ((uint32_t)addr & 3) || !current_process || in_interrupt()) {
+        return -1;
+    }
+    
+    // The value check and the enqueue happen with interrupts off, so a
+    // waker that changes the word afterwards is guaranteed to find us
+    uint32_t flags = irq_save();
+    if (*addr != expected) {
+        futex_stats.wait_again++;
+        irq_restore(flags);
+        return 1;
+    }
+    futex_stats.waits++;
+    wait_queue_sleep_key(futex_queue(addr), (uint32_t)addr);
+    irq_restore(flags);
+    return 0;
+}
+
+int futex_wake(volatile uint32_t* addr, int nr) {
+    if (!addr || nr <= 0) {
+        return 0;
+    }
+    
+    uint32_t flags = irq_save();
+    futex_stats.wakes++;
+    int woken = wait_queue_wake_key(futex_queue(addr), (uint32_t)addr, nr);
+    futex_stats.woken += woken;
+    irq_restore(flags);
+    return woken;
+}
+
+// SYS_FUTEX_WAIT (15)
+int sys_futex_wait(uint32_t addr, uint32_t expected, uint32_t arg3) {
+    (void)arg3; // Suppress unused parameter warning
+    return futex_wait((volatile uint32_t*)addr, expected);
+}
+
+// SYS_FUTEX_WAKE (16) - Returns the number of tasks woken
+int sys_futex_wake(uint32_t addr, uint32_t nr, uint32_t arg3) {
+    (void)arg3; // Suppress unused parameter warning
+    return futex_wake((volatile uint32_t*)addr, (int)nr);
+}
+
+// Slow-path entry usable at either privilege level
+int futex_call_wait(volatile uint32_t* addr, uint32_t expected) {
+    if (cpu_privilege_level() == 3) {
+        return user_int80(SYS_FUTEX_WAIT, (uint32_t)addr, expected, 0);
+    }
+    return futex_wait(addr, expected);
+}
+
+int futex_call_wake(volatile uint32_t* addr, int nr) {
+    if (cpu_privilege_level() == 3) {
+        return user_int80(SYS_FUTEX_WAKE, (uint32_t)addr, (uint32_t)nr, 0);
+    }
+    return futex_wake(addr, nr);
+}
+
+// ---------------------------------------------------------------------------
+// Mutex (three-state: 0 free, 1 locked, 2 locked and contended)
+// ---------------------------------------------------------------------------
+
+void futex_mutex_init(futex_mutex_t* mutex) {
+    mutex->state = 0;
+}
+
+bool futex_mutex_trylock(futex_mutex_t* mutex) {
+    return atomic_cmpxchg(&mutex->state, 0, 1) == 0;
+}
+
+void futex_mutex_lock(futex_mutex_t* mutex) {
+    uint32_t state = atomic_cmpxchg(&mutex->state, 0, 1);
+    if (state == 0) {
+        return;                     // Fast path: one locked instruction
+    }
+    
+    // Mark contended so the owner's unlock wakes someone
+    if (state != 2) {
+        state = atomic_xchg(&mutex->state, 2);
+    }
+    while (state != 0) {
+        futex_call_wait(&mutex->state, 2);
+        state = atomic_xchg(&mutex->state, 2);
+    }
+}
+
+void futex_mutex_unlock(futex_mutex_t* mutex) {
+    if (atomic_fetch_add(&mutex->state, (uint32_t)-1) != 1) {
+        atomic_store(&mutex->state, 0);
+        futex_call_wake(&mutex->state, 1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Counting semaphore
+// ---------------------------------------------------------------------------
+
+void futex_sem_init(futex_sem_t* sem, uint32_t value) {
+    sem->value = value;
+    sem->waiters = 0;
+}
+
+bool futex_sem_trywait(futex_sem_t* sem) {
+    uint32_t value = atomic_load(&sem->value);
+    while (value > 0) {
+        uint32_t prev = atomic_cmpxchg(&sem->value, value, value - 1);
+        if (prev == value) {
+            return true;
+        }
+        value = prev;
+    }
+    return false;
+}
+
+void futex_sem_wait(futex_sem_t* sem) {
+    while (!futex_sem_trywait(sem)) {
+        atomic_inc(&sem->waiters);
+        futex_call_wait(&sem->value, 0);
+        atomic_dec(&sem->waiters);
+    }
+}
+
+void futex_sem_post(futex_sem_t* sem) {
+    atomic_inc(&sem->value);
+    if (atomic_load(&sem->waiters)) {
+        futex_call_wake(&sem->value, 1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Condition variable
+// ---------------------------------------------------------------------------
+
+void futex_cond_init(futex_cond_t* cond) {
+    cond->seq = 0;
+}
+
+// Sleeps until signalled after the mutex is released; a signal between
+// the unlock and the sleep changes seq, so it is never lost. Re-takes the
+// mutex as contended, since other waiters may have been woken with us.
+void futex_cond_wait(futex_cond_t* cond, futex_mutex_t* mutex) {
+    uint32_t seq = atomic_load(&cond->seq);
+    futex_mutex_unlock(mutex);
+    futex_call_wait(&cond->seq, seq);
+    while (atomic_xchg(&mutex->state, 2) != 0) {
+        futex_call_wait(&mutex->state, 2);
+    }
+}
+
+void futex_cond_signal(futex_cond_t* cond) {
+    atomic_inc(&cond->seq);
+    futex_call_wake(&cond->seq, 1);
+}
+
+void futex_cond_broadcast(futex_cond_t* cond) {
+    atomic_inc(&cond->seq);
+    futex_call_wake(&cond->seq, FUTEX_WAKE_ALL);
+}
+
+void futex_get_stats(futex_stats_t* stats) {
+    uint32_t flags = irq_save();
+    *stats = futex_stats;
+    irq_restore(flags);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+
+#define FUTEX_BENCH_DEFAULT     100000
+#define FUTEX_BENCH_THREADS     4
+#define FUTEX_BENCH_YIELD_EVERY 8       // Contended run: yield while holding the lock
+
+static struct {
+    futex_mutex_t mutex;
+    int sem_id;                     // ipc semaphore used as a mutex
+    bool use_futex;
+    uint32_t per_thread;
+    volatile uint32_t counter;
+    uint64_t user_cycles;           // Ring 3 uncontended run
+} futex_bench;
+
+static inline void futex_bench_lock(void) {
+    if (futex_bench.use_futex) {
+        futex_mutex_lock(&futex_bench.mutex);
+    } else {
+        ipc_semaphore_wait(futex_bench.sem_id);
+    }
+}
+
+static inline void futex_bench_unlock(void) {
+    if (futex_bench.use_futex) {
+        futex_mutex_unlock(&futex_bench.mutex);
+    } else {
+        ipc_semaphore_signal(futex_bench.sem_id);
+    }
+}
+
+static void futex_bench_worker(void* arg) {
+    (void)arg;
+    for (uint32_t i = 0; i < futex_bench.per_thread; i++) {
+        futex_bench_lock();
+        futex_bench.counter++;
+        if (i % FUTEX_BENCH_YIELD_EVERY == 0) {
+            process_yield();
+        }
+        futex_bench_unlock();
+    }
+}
+
+static int futex_bench_user_main(void) {
+    uint64_t start = rdtsc_ordered();
+    for (uint32_t i = 0; i < futex_bench.per_thread; i++) {
+        futex_mutex_lock(&futex_bench.mutex);
+        futex_bench.counter++;
+        futex_mutex_unlock(&futex_bench.mutex);
+    }
+    futex_bench.user_cycles = rdtsc_ordered() - start;
+    return 0;
+}
+
+static void futex_bench_row(const char* label, uint64_t cycles, uint32_t ops) {
+    uint64_t ns = clock_cycles_to_ns(cycles);
+    if (ns == 0) {
+        ns = 1;
+    }
+    terminal_printf("  %s %llu ops/sec  %llu ns/op\n", label,
+                    div64_u64((uint64_t)ops * NSEC_PER_SEC, ns), div_u64(ns, ops));
+}
+
+static uint64_t futex_bench_uncontended(bool use_futex, uint32_t n) {
+    futex_bench.use_futex = use_futex;
+    uint64_t start = clock_cycles();
+    for (uint32_t i = 0; i < n; i++) {
+        futex_bench_lock();
+        futex_bench.counter++;
+        futex_bench_unlock();
+    }
+    return clock_cycles() - start;
+}
+
+static uint64_t futex_bench_contended(bool use_futex, uint32_t n) {
+    int pids[FUTEX_BENCH_THREADS];
+    int status;
+    
+    futex_bench.use_futex = use_futex;
+    futex_bench.per_thread = n / FUTEX_BENCH_THREADS;
+    futex_bench.counter = 0;
+    
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < FUTEX_BENCH_THREADS; i++) {
+        pids[i] = kthread_create_child(futex_bench_worker, NULL, "futex_bench");
+    }
+    for (int i = 0; i < FUTEX_BENCH_THREADS; i++) {
+        if (pids[i] != INVALID_PID) {
+            process_wait(pids[i], &status);
+        }
+    }
+    return clock_cycles() - start;
+}
+
+static void futex_run_bench(uint32_t n) {
+    futex_stats_t before, after;
+    int status = 0;
+    
+    futex_mutex_init(&futex_bench.mutex);
+    futex_bench.sem_id = ipc_create_semaphore("futex_bench", 1);
+    if (futex_bench.sem_id < 0) {
+        return;
+    }
+    
+    terminal_printf("Lock throughput, %u lock/unlock pairs per row:\n", n);
+    terminal_writestring(" Uncontended (kernel thread):\n");
+    futex_bench_row("ipc semaphore:", futex_bench_uncontended(false, n), n);
+    futex_get_stats(&before);
+    futex_bench_row("futex mutex:  ", futex_bench_uncontended(true, n), n);
+    futex_get_stats(&after);
+    terminal_printf("    futex kernel entries: %u\n",
+                    (after.waits + after.wakes) - (before.waits + before.wakes));
+    
+    futex_bench.per_thread = n;
+    futex_get_stats(&before);
+    if (user_process_run(futex_bench_user_main, "futex-user", &status) != INVALID_PID) {
+        futex_get_stats(&after);
+        terminal_writestring(" Uncontended (ring 3):\n");
+        futex_bench_row("futex mutex:  ", futex_bench.user_cycles, n);
+        terminal_printf("    futex kernel entries: %u\n",
+                        (after.waits + after.wakes) - (before.waits + before.wakes));
+    }
+    
+    terminal_printf(" Contended (%d threads, yield inside every %dth section):\n",
+                    FUTEX_BENCH_THREADS, FUTEX_BENCH_YIELD_EVERY);
+    uint32_t total = (n / FUTEX_BENCH_THREADS) * FUTEX_BENCH_THREADS;
+    futex_bench_row("ipc semaphore:", futex_bench_contended(false, n), total);
+    terminal_printf("    counter %u (expect %u)\n", futex_bench.counter, total);
+    futex_get_stats(&before);
+    futex_bench_row("futex mutex:  ", futex_bench_contended(true, n), total);
+    futex_get_stats(&after);
+    terminal_printf("    counter %u (expect %u), %u sleeps, %u wakes\n",
+                    futex_bench.counter, total, after.waits - before.waits,
+                    after.wakes - before.wakes);
+    
+    ipc_destroy_semaphore(futex_bench.sem_id);
+}
+
+// Producer/consumer hand-off through a futex condition variable
+static struct {
+    futex_mutex_t mutex;
+    futex_cond_t cond;
+    futex_sem_t sem;
+    uint32_t ready;
+    uint32_t seen;
+} futex_test;
+
+static void futex_test_waiter(void* arg) {
+    (void)arg;
+    futex_mutex_lock(&futex_test.mutex);
+    while (!futex_test.ready) {
+        futex_cond_wait(&futex_test.cond, &futex_test.mutex);
+    }
+    futex_test.seen++;
+    futex_mutex_unlock(&futex_test.mutex);
+    futex_sem_post(&futex_test.sem);
+}
+
+static void futex_run_test(void) {
+    int pids[3];
+    int status;
+    
+    futex_mutex_init(&futex_test.mutex);
+    futex_cond_init(&futex_test.cond);
+    futex_sem_init(&futex_test.sem, 0);
+    futex_test.ready = 0;
+    futex_test.seen = 0;
+    
+    for (int i = 0; i < 3; i++) {
+        pids[i] = kthread_create_child(futex_test_waiter, NULL, "futex_test");
+    }
+    process_yield();                // Let the waiters block on the condition
+    
+    futex_mutex_lock(&futex_test.mutex);
+    futex_test.ready = 1;
+    futex_cond_broadcast(&futex_test.cond);
+    futex_mutex_unlock(&futex_test.mutex);
+    
+    for (int i = 0; i < 3; i++) {
+        futex_sem_wait(&futex_test.sem);
+    }
+    for (int i = 0; i < 3; i++) {
+        if (pids[i] != INVALID_PID) {
+            process_wait(pids[i], &status);
+        }
+    }
+    terminal_printf("  condition broadcast: %u of 3 waiters woke, semaphore drained %s\n",
+                    futex_test.seen, futex_test.sem.value == 0 ? "ok" : "FAILED");
+}
+
+void futex_command_handler(int argc, char argv[][64]) {
+    if (argc < 2 || strcmp(argv[1], "stats") == 0) {
+        futex_stats_t stats;
+        futex_get_stats(&stats);
+        terminal_writestring("Futex Commands:\n");
+        terminal_writestring("  futex stats     - Kernel entry counters\n");
+        terminal_writestring("  futex test      - Condition/semaphore hand-off\n");
+        terminal_writestring("  futex bench [n] - Uncontended and contended lock throughput\n");
+        terminal_printf("Sleeps %u (value changed first: %u), wake calls %u, tasks woken %u\n",
+                        stats.waits, stats.wait_again, stats.wakes, stats.woken);
+        return;
+    }
+    
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+    
+    if (strcmp(argv[1], "test") == 0) {
+        futex_run_test();
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        int n = (argc >= 3) ? atoi(argv[2]) : FUTEX_BENCH_DEFAULT;
+        if (n < FUTEX_BENCH_THREADS) {
+            n = FUTEX_BENCH_DEFAULT;
+        }
+        futex_run_bench((uint32_t)n);
+    }
+    else {
+        terminal_printf("Unknown futex command: %s\n", argv[1]);
+    }
+}
@@ -0,0 +1,75 @@
+// ClaudeOS Futexes - Day 21
+// Lock words in ordinary (shared) memory; the kernel is entered only to
+// sleep or wake on contention, through wait queues hashed by address
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "types.h"
+
+#define FUTEX_HASH_BUCKETS  32
+#define FUTEX_WAKE_ALL      0x7FFFFFFF
+
+// Futex counters
+typedef struct futex_stats {
+    uint32_t waits;                 // Callers that went to sleep
+    uint32_t wait_again;            // Word changed before sleeping (no sleep)
+    uint32_t wakes;                 // futex_wake() calls
+    uint32_t woken;                 // Tasks woken by them
+} futex_stats_t;
+
+// Mutex word: 0 unlocked, 1 locked, 2 locked with (possible) waiters
+typedef struct futex_mutex {
+    volatile uint32_t state;
+} futex_mutex_t;
+
+// Counting semaphore: 'waiters' lets post skip the wake system call
+typedef struct futex_sem {
+    volatile uint32_t value;
+    volatile uint32_t waiters;
+} futex_sem_t;
+
+// Condition variable: waiters sleep on a sequence number
+typedef struct futex_cond {
+    volatile uint32_t seq;
+} futex_cond_t;
+
+#define FUTEX_MUTEX_INIT    { 0 }
+#define FUTEX_COND_INIT     { 0 }
+
+// Kernel primitive. futex_wait() sleeps only if *addr still equals
+// expected: returns 0 when woken, 1 if the value had changed, -1 on error.
+int futex_wait(volatile uint32_t* addr, uint32_t expected);
+int futex_wake(volatile uint32_t* addr, int nr);
+
+// Same, callable from kernel threads or ring 3 (traps when in ring 3)
+int futex_call_wait(volatile uint32_t* addr, uint32_t expected);
+int futex_call_wake(volatile uint32_t* addr, int nr);
+
+// System call handlers (SYS_FUTEX_WAIT, SYS_FUTEX_WAKE)
+int sys_futex_wait(uint32_t addr, uint32_t expected, uint32_t arg3);
+int sys_futex_wake(uint32_t addr, uint32_t nr, uint32_t arg3);
+
+// Process synchronization built on futexes. Usable from kernel threads and
+// ring 3: the uncontended paths are a single atomic instruction, and the
+// slow paths enter the kernel through INT 0x80 when called from ring 3.
+void futex_mutex_init(futex_mutex_t* mutex);
+void futex_mutex_lock(futex_mutex_t* mutex);
+bool futex_mutex_trylock(futex_mutex_t* mutex);
+void futex_mutex_unlock(futex_mutex_t* mutex);
+
+void futex_sem_init(futex_sem_t* sem, uint32_t value);
+void futex_sem_wait(futex_sem_t* sem);
+bool futex_sem_trywait(futex_sem_t* sem);
+void futex_sem_post(futex_sem_t* sem);
+
+void futex_cond_init(futex_cond_t* cond);
+void futex_cond_wait(futex_cond_t* cond, futex_mutex_t* mutex);
+void futex_cond_signal(futex_cond_t* cond);
+void futex_cond_broadcast(futex_cond_t* cond);
+
+// Statistics and shell command
+void futex_get_stats(futex_stats_t* stats);
+void futex_command_handler(int argc, char argv[][64]);
+
+#endif // FUTEX_H
@@ -4,12 +4,15 @@
 #include "gdt.h"
 #include "kernel.h"
 
-#define GDT_ENTRIES 5
+#define GDT_ENTRIES 6
 
 // GDT entries array
 struct gdt_entry gdt_entries[GDT_ENTRIES];
 struct gdt_ptr gdt_ptr;
 
+// Task State Segment (Day 21)
+tss_entry_t tss_entry;
+
 // Initialize GDT
 void gdt_init(void) {
     gdt_ptr.limit = (sizeof(struct gdt_entry) * GDT_ENTRIES) - 1;
@@ -38,8 +41,26 @@ void gdt_init(void) {
                  GDT_ACCESS_PRESENT | GDT_ACCESS_RING3 | GDT_ACCESS_SYSTEM | GDT_ACCESS_RW, 
                  GDT_GRAN_4K | GDT_GRAN_32BIT | 0x0F);
 
+    // Task State Segment: supplies the kernel stack for ring 3 entries
+    uint8_t* tss_bytes = (uint8_t*)&tss_entry;
+    for (size_t i = 0; i < sizeof(tss_entry); i++) {
+        tss_bytes[i] = 0;
+    }
+    tss_entry.ss0 = GDT_KERNEL_DATA_SEL;
+    tss_entry.iomap_base = sizeof(tss_entry);
+    gdt_set_gate(5, (uint32_t)&tss_entry, sizeof(tss_entry) - 1,
+                 GDT_ACCESS_PRESENT | GDT_ACCESS_RING0 | GDT_ACCESS_TSS32, 0x00);
+
     // Load the GDT
     gdt_flush((uint32_t)&gdt_ptr);
+
+    // Load the task register
+    asm volatile ("ltr %%ax" : : "a" ((uint16_t)GDT_TSS_SEL));
+}
+
+// Kernel stack the CPU switches to on the next interrupt or syscall from ring 3
+void tss_set_kernel_stack(uint32_t esp0) {
+    tss_entry.esp0 = esp0;
 }
 
 // Set a GDT gate/entry
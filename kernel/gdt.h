@@ -29,6 +29,33 @@ struct gdt_ptr {
 #define GDT_ACCESS_RW         0x02  // Read/Write bit
 #define GDT_ACCESS_ACCESSED   0x01  // Accessed bit
 
+// System segment types (Day 21)
+#define GDT_ACCESS_TSS32      0x09  // 32-bit available TSS
+
+// Segment selectors. SYSENTER/SYSEXIT require this exact order:
+// kernel code, kernel data, user code, user data.
+#define GDT_KERNEL_CODE_SEL   0x08
+#define GDT_KERNEL_DATA_SEL   0x10
+#define GDT_USER_CODE_SEL     0x1B  // Index 3, RPL 3
+#define GDT_USER_DATA_SEL     0x23  // Index 4, RPL 3
+#define GDT_TSS_SEL           0x28
+
+// Task State Segment: only ss0/esp0 are used, for ring 3 -> 0 stack switches
+typedef struct tss_entry {
+    uint32_t prev_tss;
+    uint32_t esp0;           // Kernel stack loaded on entry from ring 3
+    uint32_t ss0;            // Kernel stack segment
+    uint32_t esp1, ss1, esp2, ss2;
+    uint32_t cr3, eip, eflags;
+    uint32_t eax, ecx, edx, ebx, esp, ebp, esi, edi;
+    uint32_t es, cs, ss, ds, fs, gs;
+    uint32_t ldt;
+    uint16_t trap;
+    uint16_t iomap_base;     // Past the segment limit: no I/O bitmap
+} __attribute__((packed)) tss_entry_t;
+
+extern tss_entry_t tss_entry;
+
 // GDT Granularity Byte Flags
 #define GDT_GRAN_4K          0x80   // 4K granularity
 #define GDT_GRAN_32BIT       0x40   // 32-bit segment
@@ -37,6 +64,7 @@ struct gdt_ptr {
 // Function declarations
 void gdt_init(void);
 void gdt_set_gate(int32_t num, uint32_t base, uint32_t limit, uint8_t access, uint8_t gran);
+void tss_set_kernel_stack(uint32_t esp0);
 
 // Assembly function to flush GDT
 extern void gdt_flush(uint32_t);
@@ -5,6 +5,7 @@
 #include "pmm.h"
 #include "vmm.h"
 #include "kernel.h"
+#include "lock.h"
 
 // Heap state
 static uint32_t heap_start = HEAP_START;
@@ -13,6 +14,9 @@ static uint32_t heap_max = HEAP_START + HEAP_MAX_SIZE;
 static block_header_t* free_list_head = 0;
 int heap_initialized = 0;
 
+// Guards the free list and heap_end (IRQ handlers may allocate)
+static spinlock_t heap_lock = SPINLOCK_INIT("heap");
+
 // Simple memory functions
 static void* memset(void* ptr, int value, size_t size) {
     uint8_t* p = (uint8_t*)ptr;
@@ -140,6 +144,12 @@ int heap_expand(size_t min_size) {
 
 // Initialize heap
 void heap_init(void) {
+    // Re-initializing would discard live allocations (thread stacks etc.)
+    if (heap_initialized) {
+        terminal_writestring("HEAP: Already initialized\n");
+        return;
+    }
+    
     // Check if VMM is initialized
     if (!current_page_directory) {
         terminal_writestring("HEAP: ERROR - VMM must be initialized first\n");
@@ -175,8 +185,8 @@ void heap_init(void) {
     terminal_writestring("HEAP: Start: 0x400000, Initial size: 1MB\n");
 }
 
-// Allocate memory
-void* kmalloc(size_t size) {
+// Allocate memory (caller holds heap_lock)
+static void* heap_alloc(size_t size) {
     if (!heap_initialized) {
         return 0;
     }
@@ -212,8 +222,8 @@ void* kmalloc(size_t size) {
     return (void*)((uint8_t*)block + sizeof(block_header_t));
 }
 
-// Free memory
-void kfree(void* ptr) {
+// Free memory (caller holds heap_lock)
+static void heap_free(void* ptr) {
     if (!ptr || !heap_initialized) {
         return;
     }
@@ -233,6 +243,19 @@ void kfree(void* ptr) {
     heap_coalesce_free_blocks();
 }
 
+void* kmalloc(size_t size) {
+    uint32_t flags = spin_lock_irqsave(&heap_lock);
+    void* ptr = heap_alloc(size);
+    spin_unlock_irqrestore(&heap_lock, flags);
+    return ptr;
+}
+
+void kfree(void* ptr) {
+    uint32_t flags = spin_lock_irqsave(&heap_lock);
+    heap_free(ptr);
+    spin_unlock_irqrestore(&heap_lock, flags);
+}
+
 // Reallocate memory
 void* krealloc(void* ptr, size_t new_size) {
     if (!ptr) {
@@ -45,6 +45,14 @@ struct idt_ptr {
 void idt_init(void);
 void idt_set_gate(uint8_t num, uint32_t base, uint16_t selector, uint8_t flags);
 
+// IRQ context tracking (Day 21): true while an IRQ handler is running
+bool in_interrupt(void);
+
+// Handlers for IRQs assigned at runtime (Day 21: PCI devices). The handler
+// runs in IRQ context and sends its own EOI, like the timer and keyboard.
+typedef void (*irq_handler_t)(uint8_t irq);
+void irq_install_handler(uint8_t irq, irq_handler_t handler);
+
 // Assembly function to flush IDT
 extern void idt_flush(uint32_t);
 
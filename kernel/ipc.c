@@ -3,419 +3,2242 @@
 #include "kernel.h"
 #include "process.h"
 #include "timer.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "wait.h"
+#include "sched.h"
+#include "idt.h"
 #include "heap.h"
 #include "string.h"
+#include "pmm.h"
+#include "fd.h"
+#include "lock.h"
+#include "rcu.h"
 
 // Global IPC data structures
-message_t message_pool[MAX_MESSAGES];
+mailbox_t mailboxes[MAX_PROCESSES];
+ipc_msg_stats_t ipc_msg_stats;
+ipc_call_stats_t ipc_call_stats;
+static ipc_endpoint_t endpoints[MAX_PROCESSES];
+static ipc_page_run_t page_runs[IPC_MAX_PAGE_RUNS];
+
+static void ipc_page_run_free(ipc_page_run_t* run);
+static void ipc_semaphore_reset_pool(void);
 semaphore_t semaphore_pool[MAX_SEMAPHORES];
-shared_memory_t shared_memory_pool[8];  // Basic shared memory pool
+shared_memory_t shared_memory_pool[MAX_SHARED_MEMORY];
+static int shm_buckets[SHM_HASH_BUCKETS];  // Pool index + 1 of the first segment, 0 if empty
+static int next_shm_id = 1;
 int next_semaphore_id = 1;
 
 // IPC initialization
 void ipc_init(void) {
-    // Initialize message pool
-    for (int i = 0; i < MAX_MESSAGES; i++) {
-        message_pool[i].sender_pid = INVALID_PID;
-        message_pool[i].receiver_pid = INVALID_PID;
-        message_pool[i].message_size = 0;
-        message_pool[i].is_used = false;
-        message_pool[i].timestamp = 0;
-        // Clear message data
-        for (int j = 0; j < MAX_MESSAGE_SIZE; j++) {
-            message_pool[i].data[j] = 0;
+    // Empty every mailbox (sleepers stay queued and keep waiting)
+    uint32_t flags = irq_save();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        mailboxes[i].head = 0;
+        mailboxes[i].tail = 0;
+        mailboxes[i].high_water = 0;
+    }
+    for (int i = 0; i < IPC_MAX_PAGE_RUNS; i++) {
+        if (page_runs[i].base && page_runs[i].owner_pid == INVALID_PID) {
+            ipc_page_run_free(&page_runs[i]);  // Was queued in a mailbox
+        }
+    }
+    memset(&ipc_msg_stats, 0, sizeof(ipc_msg_stats));
+    irq_restore(flags);
+    
+    ipc_semaphore_reset_pool();
+    
+    // Shared memory segments stay: attached processes still use them
+    
+    terminal_printf("✅ IPC system initialized\n");
+    terminal_printf("   - Mailbox slots: %d per process\n", MAX_MESSAGES);
+    terminal_printf("   - Semaphore slots: %d\n", MAX_SEMAPHORES);
+    terminal_printf("   - Shared memory slots: %d\n", MAX_SHARED_MEMORY);
+}
+
+// Message passing implementation
+// Day 21: one bounded FIFO ring per process replaces the global slot pool.
+// Send and receive-from-any touch only the head or tail; receiving from a
+// specific sender scans that one mailbox. All mailbox state is changed
+// with interrupts disabled.
+
+// Mailbox for a live process (reset when a new pid takes over the slot)
+static mailbox_t* ipc_mailbox(process_t* process) {
+    mailbox_t* mb = &mailboxes[process - process_table];
+    if (mb->owner_pid != process->pid) {
+        mb->head = 0;
+        mb->tail = 0;
+        mb->high_water = 0;
+        mb->owner_pid = process->pid;
+    }
+    return mb;
+}
+
+static bool ipc_receiver_alive(process_t* process) {
+    return process && process->state != PROCESS_TERMINATED &&
+           process->state != PROCESS_ZOMBIE;
+}
+
+static int ipc_current_pid(void) {
+    return current_process ? current_process->pid : KERNEL_PID;
+}
+
+// Page run registry (interrupts disabled by the callers)
+static ipc_page_run_t* ipc_page_run_find(void* addr) {
+    for (int i = 0; i < IPC_MAX_PAGE_RUNS; i++) {
+        if (page_runs[i].base && page_runs[i].base == (uint32_t)addr) {
+            return &page_runs[i];
+        }
+    }
+    return NULL;
+}
+
+static void ipc_page_run_free(ipc_page_run_t* run) {
+    pmm_free_pages(run->base, run->npages);
+    run->base = 0;
+    run->npages = 0;
+    run->owner_pid = INVALID_PID;
+}
+
+// Fill in the header of the next free slot; the caller copies the payload
+// and then calls ipc_mailbox_commit()
+static message_t* ipc_mailbox_reserve(mailbox_t* mb, int sender_pid, size_t size, uint64_t now) {
+    message_t* msg = &mb->ring[mb->tail & (MAX_MESSAGES - 1)];
+    msg->sender_pid = sender_pid;
+    msg->message_size = size;
+    msg->timestamp = now;
+    msg->pages = NULL;
+    return msg;
+}
+
+static void ipc_mailbox_commit(mailbox_t* mb) {
+    mb->tail++;
+    
+    uint32_t depth = mb->tail - mb->head;
+    if (depth > mb->high_water) {
+        mb->high_water = depth;
+    }
+    ipc_msg_stats.sent++;
+}
+
+// Tell the owner (and poll watchers) that messages were queued
+static void ipc_mailbox_wake(mailbox_t* mb) {
+    wait_queue_wake_one(&mb->readers);
+    poll_notify(&mb->poll, POLLIN);
+}
+
+// Append a message; a page payload is handed over instead of copied
+static void ipc_mailbox_push(mailbox_t* mb, int sender_pid, const void* data, size_t size,
+                             ipc_page_run_t* run) {
+    message_t* msg = ipc_mailbox_reserve(mb, sender_pid, size, clock_monotonic_ns());
+    if (run) {
+        run->owner_pid = INVALID_PID;
+        msg->pages = (void*)run->base;
+        ipc_msg_stats.pages_sent++;
+    } else {
+        memcpy(msg->data, data, size);
+    }
+    ipc_mailbox_commit(mb);
+    ipc_mailbox_wake(mb);
+}
+
+// Remove the oldest message (from sender_pid, or any if -1). Returns the
+// byte count, or -1 if no such message is queued. A page payload goes to
+// *pages when the caller accepts one; otherwise it is copied into buffer
+// and its pages are freed. Blocked senders are not woken.
+static int ipc_mailbox_take(mailbox_t* mb, int sender_pid, void* buffer, size_t buffer_size,
+                            void** pages, int* from) {
+    uint32_t pos = mb->head;
+    if (sender_pid != -1) {
+        while (pos != mb->tail &&
+               mb->ring[pos & (MAX_MESSAGES - 1)].sender_pid != sender_pid) {
+            pos++;
+        }
+    }
+    if (pos == mb->tail) {
+        return -1;
+    }
+    
+    message_t* msg = &mb->ring[pos & (MAX_MESSAGES - 1)];
+    size_t size = msg->message_size;
+    if (msg->pages && pages) {
+        ipc_page_run_t* run = ipc_page_run_find(msg->pages);
+        run->owner_pid = mb->owner_pid;
+        ipc_msg_stats.pages_moved += run->npages;
+        *pages = msg->pages;
+    } else {
+        if (size > buffer_size) {
+            size = buffer_size;
+        }
+        memcpy(buffer, msg->pages ? msg->pages : msg->data, size);
+        if (msg->pages) {
+            ipc_page_run_free(ipc_page_run_find(msg->pages));
+        }
+        if (pages) {
+            *pages = NULL;
+        }
+    }
+    if (from) {
+        *from = msg->sender_pid;
+    }
+    
+    // Selective receive: close the gap so FIFO order is kept
+    for (; pos != mb->head; pos--) {
+        mb->ring[pos & (MAX_MESSAGES - 1)] = mb->ring[(pos - 1) & (MAX_MESSAGES - 1)];
+    }
+    mb->head++;
+    ipc_msg_stats.received++;
+    return (int)size;
+}
+
+static int ipc_mailbox_pop(mailbox_t* mb, int sender_pid, void* buffer, size_t buffer_size,
+                           void** pages, int* from) {
+    int result = ipc_mailbox_take(mb, sender_pid, buffer, buffer_size, pages, from);
+    if (result >= 0) {
+        wait_queue_wake_one(&mb->writers);
+    }
+    return result;
+}
+
+// Quiet message core (Day 21): no console output, safe for syscalls and
+// batched submission. Pids are explicit so a kernel worker can act on
+// behalf of another process. Returns the queue depth or -1 (invalid or
+// mailbox full).
+int ipc_msg_send(int sender_pid, int receiver_pid, const void* data, size_t size) {
+    if (!data || size == 0 || size > MAX_MESSAGE_SIZE) {
+        ipc_msg_stats.send_invalid++;
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    process_t* receiver = process_find(receiver_pid);
+    if (!ipc_receiver_alive(receiver)) {
+        ipc_msg_stats.send_invalid++;
+        irq_restore(flags);
+        return -1;
+    }
+    
+    mailbox_t* mb = ipc_mailbox(receiver);
+    if (mb->tail - mb->head == MAX_MESSAGES) {
+        ipc_msg_stats.send_full++;
+        irq_restore(flags);
+        return -1;
+    }
+    ipc_mailbox_push(mb, sender_pid, data, size, NULL);
+    int depth = (int)(mb->tail - mb->head);
+    irq_restore(flags);
+    return depth;
+}
+
+// Take the first queued message for receiver_pid from sender_pid (-1: any).
+// Copies at most buffer_size bytes, stores the sender in *from and returns
+// the byte count, or -1 if there is no message.
+int ipc_msg_receive(int receiver_pid, int sender_pid, void* buffer, size_t buffer_size, int* from) {
+    if (!buffer || buffer_size == 0) {
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    process_t* receiver = process_find(receiver_pid);
+    int result = -1;
+    if (receiver) {
+        result = ipc_mailbox_pop(ipc_mailbox(receiver), sender_pid, buffer, buffer_size, NULL, from);
+    }
+    if (result < 0) {
+        ipc_msg_stats.recv_empty++;
+    }
+    irq_restore(flags);
+    return result;
+}
+
+// Blocking send from the current process (inline data, or a page run it
+// owns): sleeps while the receiver's mailbox is full. Returns 0, or -1 if
+// the receiver is gone.
+static int ipc_send_blocking(int receiver_pid, const void* data, size_t size, ipc_page_run_t* run) {
+    uint32_t flags = irq_save();
+    for (;;) {
+        process_t* receiver = process_find(receiver_pid);
+        if (!ipc_receiver_alive(receiver)) {
+            ipc_msg_stats.send_invalid++;
+            irq_restore(flags);
+            return -1;
+        }
+        
+        mailbox_t* mb = ipc_mailbox(receiver);
+        if (mb->tail - mb->head < MAX_MESSAGES) {
+            ipc_mailbox_push(mb, current_process->pid, data, size, run);
+            irq_restore(flags);
+            return 0;
+        }
+        if (in_interrupt()) {
+            ipc_msg_stats.send_full++;
+            irq_restore(flags);
+            return -1;
+        }
+        ipc_msg_stats.send_blocked++;
+        wait_queue_sleep(&mb->writers);
+    }
+}
+
+int ipc_msg_send_wait(int receiver_pid, const void* data, size_t size) {
+    if (!data || size == 0 || size > MAX_MESSAGE_SIZE || !current_process) {
+        ipc_msg_stats.send_invalid++;
+        return -1;
+    }
+    return ipc_send_blocking(receiver_pid, data, size, NULL);
+}
+
+// Blocking receive into the current process's mailbox
+static int ipc_receive_blocking(int sender_pid, void* buffer, size_t buffer_size, void** pages, int* from) {
+    uint32_t flags = irq_save();
+    mailbox_t* mb = ipc_mailbox(current_process);
+    for (;;) {
+        int result = ipc_mailbox_pop(mb, sender_pid, buffer, buffer_size, pages, from);
+        if (result >= 0) {
+            irq_restore(flags);
+            return result;
+        }
+        ipc_msg_stats.recv_blocked++;
+        wait_queue_sleep(&mb->readers);
+    }
+}
+
+// Sleeps until a matching message arrives. Returns the byte count, or -1
+// on bad arguments.
+int ipc_msg_receive_wait(int sender_pid, void* buffer, size_t buffer_size, int* from) {
+    if (!buffer || buffer_size == 0 || !current_process || in_interrupt()) {
+        return -1;
+    }
+    return ipc_receive_blocking(sender_pid, buffer, buffer_size, NULL, from);
+}
+
+// Vectored and batched messages (Day 21). ipc_sendv() gathers a header
+// and a payload straight into the mailbox slot, so the sender does not
+// have to join them first. The batch calls move as many messages as fit
+// per interrupts-off pass: the receiver is looked up, and the other side
+// woken, once per pass rather than once per message.
+
+// Total length of a gather list, or -1 if it is malformed or too long
+static int ipc_iov_length(const ipc_iovec_t* iov, int iovcnt) {
+    if (!iov || iovcnt <= 0 || iovcnt > IPC_MAX_IOV) {
+        return -1;
+    }
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].len > MAX_MESSAGE_SIZE || (iov[i].len && !iov[i].base)) {
+            return -1;
+        }
+        total += iov[i].len;
+    }
+    return (total == 0 || total > MAX_MESSAGE_SIZE) ? -1 : (int)total;
+}
+
+// Non-blocking like ipc_msg_send(), with the current process as sender.
+// Returns the queue depth or -1.
+int ipc_sendv(int receiver_pid, const ipc_iovec_t* iov, int iovcnt) {
+    int size = ipc_iov_length(iov, iovcnt);
+    if (size < 0) {
+        ipc_msg_stats.send_invalid++;
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    process_t* receiver = process_find(receiver_pid);
+    if (!ipc_receiver_alive(receiver)) {
+        ipc_msg_stats.send_invalid++;
+        irq_restore(flags);
+        return -1;
+    }
+    
+    mailbox_t* mb = ipc_mailbox(receiver);
+    if (mb->tail - mb->head == MAX_MESSAGES) {
+        ipc_msg_stats.send_full++;
+        irq_restore(flags);
+        return -1;
+    }
+    message_t* msg = ipc_mailbox_reserve(mb, ipc_current_pid(), (size_t)size, clock_monotonic_ns());
+    size_t offset = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(msg->data + offset, iov[i].base, iov[i].len);
+        offset += iov[i].len;
+    }
+    ipc_mailbox_commit(mb);
+    ipc_mailbox_wake(mb);
+    int depth = (int)(mb->tail - mb->head);
+    irq_restore(flags);
+    return depth;
+}
+
+// Queue msgs[0..count), one message per entry. Each pass fills every free
+// slot and wakes the receiver once; from a process the sender then sleeps
+// until room is made. Returns the number queued, which is short only if
+// the receiver exits (or, in interrupt context, the mailbox fills), or -1
+// if nothing could be queued.
+int ipc_send_batch(int receiver_pid, const ipc_iovec_t* msgs, int count) {
+    if (!msgs || count <= 0) {
+        ipc_msg_stats.send_invalid++;
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!msgs[i].base || msgs[i].len == 0 || msgs[i].len > MAX_MESSAGE_SIZE) {
+            ipc_msg_stats.send_invalid++;
+            return -1;
+        }
+    }
+    
+    int sender_pid = ipc_current_pid();
+    bool can_sleep = current_process && !in_interrupt();
+    int sent = 0;
+    uint32_t flags = irq_save();
+    while (sent < count) {
+        process_t* receiver = process_find(receiver_pid);
+        if (!ipc_receiver_alive(receiver)) {
+            ipc_msg_stats.send_invalid++;
+            break;
+        }
+        
+        mailbox_t* mb = ipc_mailbox(receiver);
+        uint32_t room = MAX_MESSAGES - (mb->tail - mb->head);
+        if (room > 0) {
+            uint64_t now = clock_monotonic_ns();
+            for (; room > 0 && sent < count; room--, sent++) {
+                message_t* msg = ipc_mailbox_reserve(mb, sender_pid, msgs[sent].len, now);
+                memcpy(msg->data, msgs[sent].base, msgs[sent].len);
+                ipc_mailbox_commit(mb);
+            }
+            ipc_mailbox_wake(mb);
+            ipc_msg_stats.send_batches++;
+            if (sent == count) {
+                break;
+            }
+        }
+        if (!can_sleep) {
+            ipc_msg_stats.send_full++;
+            break;
+        }
+        ipc_msg_stats.send_blocked++;
+        wait_queue_sleep(&mb->writers);
+    }
+    irq_restore(flags);
+    return sent > 0 ? sent : -1;
+}
+
+// Receive up to 'max' messages (from sender_pid, or any if -1) into slots.
+// Sleeps until at least one is queued, then drains what is there in one
+// pass and wakes blocked senders once. Returns the number received, or -1
+// on bad arguments.
+int ipc_receive_batch(int sender_pid, ipc_recv_slot_t* slots, int max) {
+    if (!slots || max <= 0 || !current_process || in_interrupt()) {
+        return -1;
+    }
+    for (int i = 0; i < max; i++) {
+        if (!slots[i].buffer || slots[i].size == 0) {
+            return -1;
+        }
+    }
+    
+    uint32_t flags = irq_save();
+    mailbox_t* mb = ipc_mailbox(current_process);
+    int received = 0;
+    for (;;) {
+        while (received < max) {
+            ipc_recv_slot_t* slot = &slots[received];
+            int len = ipc_mailbox_take(mb, sender_pid, slot->buffer, slot->size, NULL, &slot->from);
+            if (len < 0) {
+                break;
+            }
+            slot->len = len;
+            received++;
+        }
+        if (received > 0) {
+            break;
+        }
+        ipc_msg_stats.recv_blocked++;
+        wait_queue_sleep(&mb->readers);
+    }
+    ipc_msg_stats.recv_batches++;
+    wait_queue_wake_all(&mb->writers);
+    irq_restore(flags);
+    return received;
+}
+
+// Allocate a page-aligned transfer buffer owned by the current process
+void* ipc_pages_alloc(size_t size) {
+    uint32_t npages = PAGE_ALIGN(size) / PAGE_SIZE;
+    if (npages == 0) {
+        return NULL;
+    }
+    
+    uint32_t flags = irq_save();
+    for (int i = 0; i < IPC_MAX_PAGE_RUNS; i++) {
+        if (page_runs[i].base == 0) {
+            uint32_t base = pmm_alloc_pages(npages);
+            if (base) {
+                page_runs[i].base = base;
+                page_runs[i].npages = npages;
+                page_runs[i].owner_pid = ipc_current_pid();
+            }
+            irq_restore(flags);
+            return (void*)base;
+        }
+    }
+    irq_restore(flags);
+    return NULL;
+}
+
+// Free a run the current process owns. Returns 0, or -1 if it does not own it.
+int ipc_pages_free(void* addr) {
+    uint32_t flags = irq_save();
+    ipc_page_run_t* run = ipc_page_run_find(addr);
+    if (!run || run->owner_pid != ipc_current_pid()) {
+        irq_restore(flags);
+        return -1;
+    }
+    ipc_page_run_free(run);
+    irq_restore(flags);
+    return 0;
+}
+
+// Hand a run from ipc_pages_alloc() to receiver_pid; the sender must not
+// touch it afterwards. Blocks while the mailbox is full. Returns 0, or -1
+// (run not owned by the caller, size too large, receiver gone).
+int ipc_msg_send_pages(int receiver_pid, void* addr, size_t size) {
+    if (!current_process || size == 0) {
+        ipc_msg_stats.send_invalid++;
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    ipc_page_run_t* run = ipc_page_run_find(addr);
+    if (!run || run->owner_pid != current_process->pid || size > run->npages * PAGE_SIZE) {
+        ipc_msg_stats.send_invalid++;
+        irq_restore(flags);
+        return -1;
+    }
+    int result = ipc_send_blocking(receiver_pid, NULL, size, run);
+    irq_restore(flags);
+    return result;
+}
+
+// Small payloads are copied through the mailbox; larger ones must be a run
+// from ipc_pages_alloc() and move by ownership transfer
+int ipc_msg_send_buffer(int receiver_pid, void* data, size_t size) {
+    if (size <= MAX_MESSAGE_SIZE) {
+        return ipc_msg_send_wait(receiver_pid, data, size);
+    }
+    return ipc_msg_send_pages(receiver_pid, data, size);
+}
+
+// Blocking receive that accepts either kind of message: inline data is
+// copied into buffer (*pages = NULL); a page transfer stores the run in
+// *pages, now owned by the caller, who frees it with ipc_pages_free().
+// Returns the payload size or -1.
+int ipc_msg_receive_pages(int sender_pid, void* buffer, size_t buffer_size, void** pages, int* from) {
+    if (!buffer || buffer_size == 0 || !pages || !current_process || in_interrupt()) {
+        return -1;
+    }
+    return ipc_receive_blocking(sender_pid, buffer, buffer_size, pages, from);
+}
+
+// Called by the reaper: drop queued messages (freeing page payloads),
+// free the runs the process owned and fail blocked senders
+void ipc_mailbox_release(process_t* process) {
+    uint32_t flags = irq_save();
+    mailbox_t* mb = &mailboxes[process - process_table];
+    if (mb->owner_pid == process->pid) {
+        for (uint32_t pos = mb->head; pos != mb->tail; pos++) {
+            message_t* msg = &mb->ring[pos & (MAX_MESSAGES - 1)];
+            if (msg->pages) {
+                ipc_page_run_free(ipc_page_run_find(msg->pages));
+            }
+        }
+        mb->head = 0;
+        mb->tail = 0;
+        mb->owner_pid = INVALID_PID;
+        wait_queue_wake_all(&mb->writers);
+        poll_head_detach(&mb->poll);
+    }
+    for (int i = 0; i < IPC_MAX_PAGE_RUNS; i++) {
+        if (page_runs[i].base && page_runs[i].owner_pid == process->pid) {
+            ipc_page_run_free(&page_runs[i]);
+        }
+    }
+    irq_restore(flags);
+}
+
+// Mailbox descriptor: read() is ipc_msg_receive_wait() from any sender and
+// poll reports POLLIN while a message is queued. The mailbox lives with its
+// process, so descriptors hold no reference.
+static int ipc_mailbox_fd_read(void* object, void* buffer, size_t count) {
+    (void)object;
+    return ipc_msg_receive_wait(-1, buffer, count, NULL);
+}
+
+static void ipc_mailbox_fd_get(void* object) {
+    (void)object;
+}
+
+static void ipc_mailbox_fd_put(void* object) {
+    (void)object;
+}
+
+static uint32_t ipc_mailbox_fd_poll(void* object) {
+    mailbox_t* mb = (mailbox_t*)object;
+    return (mb->tail != mb->head) ? POLLIN : 0;
+}
+
+static poll_head_t* ipc_mailbox_fd_poll_head(void* object) {
+    return &((mailbox_t*)object)->poll;
+}
+
+static const fd_ops_t ipc_mailbox_fd_ops = {
+    .name      = "mailbox",
+    .read      = ipc_mailbox_fd_read,
+    .write     = NULL,
+    .get       = ipc_mailbox_fd_get,
+    .put       = ipc_mailbox_fd_put,
+    .poll      = ipc_mailbox_fd_poll,
+    .poll_head = ipc_mailbox_fd_poll_head,
+};
+
+// Descriptor for the current process's own mailbox
+int ipc_mailbox_open(void) {
+    if (!current_process) {
+        return -1;
+    }
+    uint32_t flags = irq_save();
+    int fd = fd_install(current_process, &ipc_mailbox_fd_ops, ipc_mailbox(current_process));
+    irq_restore(flags);
+    return fd;
+}
+
+// Synchronous rendezvous IPC (Day 21)
+// ipc_call() blocks the client until the server replies. A server parked
+// in ipc_reply_wait() gets the request copied straight from the client's
+// buffer into its own and runs at once on the client's time slice
+// (process_handoff); the reply goes back the same way when no other
+// client is queued. No mailbox slot or run queue is involved.
+
+// Endpoint for a live process (reset when a new pid takes over the slot)
+static ipc_endpoint_t* ipc_endpoint(process_t* process) {
+    ipc_endpoint_t* ep = &endpoints[process - process_table];
+    if (ep->owner_pid != process->pid) {
+        memset(ep, 0, sizeof(*ep));
+        ep->owner_pid = process->pid;
+        ep->server_pid = INVALID_PID;
+    }
+    return ep;
+}
+
+// Copy a queued or arriving request into the server's receive buffer
+static void ipc_rendezvous_deliver(ipc_endpoint_t* server, process_t* client) {
+    ipc_endpoint_t* cep = ipc_endpoint(client);
+    size_t size = cep->call_len;
+    if (size > server->recv_size) {
+        size = server->recv_size;
+    }
+    memcpy(server->recv_buf, cep->call_msg, size);
+    server->recv_len = (int)size;
+    server->recv_from = client->pid;
+    server->receiving = false;
+    cep->queued = false;
+    cep->waiting_reply = true;
+}
+
+// Remove a caller from a server's queue
+static void ipc_caller_unlink(ipc_endpoint_t* server, process_t* client) {
+    process_t* prev = NULL;
+    process_t* cur = server->callers_head;
+    while (cur && cur != client) {
+        prev = cur;
+        cur = ipc_endpoint(cur)->next_caller;
+    }
+    if (!cur) {
+        return;
+    }
+    
+    process_t* next = ipc_endpoint(cur)->next_caller;
+    if (prev) {
+        ipc_endpoint(prev)->next_caller = next;
+    } else {
+        server->callers_head = next;
+    }
+    if (server->callers_tail == cur) {
+        server->callers_tail = prev;
+    }
+    ipc_endpoint(cur)->queued = false;
+}
+
+static void ipc_rendezvous_fail(process_t* client) {
+    ipc_endpoint_t* cep = ipc_endpoint(client);
+    cep->waiting_reply = false;
+    cep->queued = false;
+    cep->reply_len = -1;
+    process_wake(client);
+}
+
+// Send 'msg' to server_pid and sleep until it replies. Returns the reply
+// length copied into 'reply', or -1 (bad arguments, server gone).
+int ipc_call(int server_pid, const void* msg, size_t len, void* reply, size_t reply_size) {
+    if (!current_process || in_interrupt() || !msg || len > MAX_MESSAGE_SIZE ||
+        server_pid == current_process->pid) {
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    process_t* server = process_find(server_pid);
+    if (!ipc_receiver_alive(server)) {
+        irq_restore(flags);
+        return -1;
+    }
+    
+    ipc_endpoint_t* sep = ipc_endpoint(server);
+    ipc_endpoint_t* cep = ipc_endpoint(current_process);
+    cep->call_msg = msg;
+    cep->call_len = len;
+    cep->reply_buf = reply;
+    cep->reply_size = reply_size;
+    cep->reply_len = -1;
+    cep->server_pid = server_pid;
+    current_process->state = PROCESS_BLOCKED;
+    ipc_call_stats.calls++;
+    
+    if (sep->receiving && server->state == PROCESS_BLOCKED) {
+        // Server is parked: deliver and run it now
+        ipc_rendezvous_deliver(sep, current_process);
+        ipc_call_stats.handoffs++;
+        process_handoff(server);
+    } else {
+        // Server busy: queue behind other callers (FIFO)
+        cep->next_caller = NULL;
+        cep->queued = true;
+        if (sep->callers_tail) {
+            ipc_endpoint(sep->callers_tail)->next_caller = current_process;
+        } else {
+            sep->callers_head = current_process;
+        }
+        sep->callers_tail = current_process;
+        ipc_call_stats.queued++;
+        process_switch();
+    }
+    
+    int result = cep->reply_len;
+    irq_restore(flags);
+    return result;
+}
+
+// Send a reply without waiting for the next request. Returns 0, or -1 if
+// client_pid is not waiting for a reply from the caller.
+static int ipc_reply_locked(int client_pid, const void* reply, size_t len, bool handoff) {
+    process_t* client = process_find(client_pid);
+    if (!client || client->state != PROCESS_BLOCKED) {
+        return -1;
+    }
+    ipc_endpoint_t* cep = ipc_endpoint(client);
+    if (!cep->waiting_reply || cep->server_pid != current_process->pid) {
+        return -1;
+    }
+    
+    size_t size = len;
+    if (size > cep->reply_size) {
+        size = cep->reply_size;
+    }
+    if (size) {
+        memcpy(cep->reply_buf, reply, size);
+    }
+    cep->reply_len = (int)size;
+    cep->waiting_reply = false;
+    ipc_call_stats.replies++;
+    
+    if (handoff) {
+        ipc_call_stats.handoffs++;
+        process_handoff(client);
+    } else {
+        process_wake(client);
+    }
+    return 0;
+}
+
+int ipc_reply(int client_pid, const void* reply, size_t len) {
+    if (!current_process || (len && !reply)) {
+        return -1;
+    }
+    uint32_t flags = irq_save();
+    int result = ipc_reply_locked(client_pid, reply, len, false);
+    irq_restore(flags);
+    return result;
+}
+
+// Reply to client_pid (INVALID_PID: nobody) and wait for the next request.
+// Returns the caller's pid with the request in 'buffer' and its length in
+// *len, or INVALID_PID on bad arguments.
+int ipc_reply_wait(int client_pid, const void* reply, size_t reply_len,
+                   void* buffer, size_t buffer_size, int* len) {
+    if (!current_process || in_interrupt() || !buffer) {
+        return INVALID_PID;
+    }
+    
+    uint32_t flags = irq_save();
+    ipc_endpoint_t* ep = ipc_endpoint(current_process);
+    ep->recv_buf = buffer;
+    ep->recv_size = buffer_size;
+    ep->recv_from = INVALID_PID;
+    
+    // Take the first queued caller (dead callers are unlinked by the reaper)
+    if (ep->callers_head) {
+        process_t* client = ep->callers_head;
+        ipc_caller_unlink(ep, client);
+        ipc_rendezvous_deliver(ep, client);
+    }
+    
+    if (ep->recv_from != INVALID_PID) {
+        // Another request is ready: the replied client just becomes runnable
+        if (client_pid != INVALID_PID) {
+            ipc_reply_locked(client_pid, reply, reply_len, false);
+        }
+    } else {
+        ep->receiving = true;
+        current_process->state = PROCESS_BLOCKED;
+        if (client_pid == INVALID_PID || ipc_reply_locked(client_pid, reply, reply_len, true) != 0) {
+            process_switch();
+        }
+        // Resumed by ipc_call() with the request delivered
+    }
+    
+    if (len) {
+        *len = ep->recv_len;
+    }
+    int from = ep->recv_from;
+    irq_restore(flags);
+    return from;
+}
+
+// Called by the reaper: take a dead client off its server's queue, and
+// fail clients queued on, or served by, a dead server
+void ipc_endpoint_release(process_t* process) {
+    uint32_t flags = irq_save();
+    ipc_endpoint_t* ep = &endpoints[process - process_table];
+    if (ep->owner_pid == process->pid) {
+        if (ep->queued) {
+            process_t* server = process_find(ep->server_pid);
+            if (server) {
+                ipc_caller_unlink(ipc_endpoint(server), process);
+            }
+        }
+        while (ep->callers_head) {
+            process_t* client = ep->callers_head;
+            ipc_caller_unlink(ep, client);
+            ipc_rendezvous_fail(client);
         }
+        ep->receiving = false;
+        ep->owner_pid = INVALID_PID;
+    }
+    
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* client = &process_table[i];
+        if (client->pid != INVALID_PID && endpoints[i].owner_pid == client->pid &&
+            endpoints[i].waiting_reply && endpoints[i].server_pid == process->pid &&
+            client->state == PROCESS_BLOCKED) {
+            ipc_rendezvous_fail(client);
+        }
+    }
+    irq_restore(flags);
+}
+
+// Shell/test wrappers: current process as sender or receiver
+int ipc_send_message(int receiver_pid, const char* data, size_t size) {
+    int sender_pid = current_process ? current_process->pid : 0;
+    return ipc_msg_send(sender_pid, receiver_pid, data, size);
+}
+
+int ipc_receive_message(int sender_pid, char* buffer, size_t buffer_size) {
+    if (!buffer || buffer_size < 2) {
+        return -1;
+    }
+    
+    int receiver_pid = current_process ? current_process->pid : 0;
+    int sender = INVALID_PID;
+    
+    // Leave room for the terminator
+    int copied = ipc_msg_receive(receiver_pid, sender_pid, buffer, buffer_size - 1, &sender);
+    if (copied < 0) {
+        return -1;
+    }
+    buffer[copied] = '\0';  // Null terminate
+    return sender;  // Return sender PID
+}
+
+int ipc_message_count(int pid) {
+    uint32_t flags = irq_save();
+    process_t* process = process_find(pid);
+    int count = 0;
+    if (process && mailboxes[process - process_table].owner_pid == pid) {
+        mailbox_t* mb = &mailboxes[process - process_table];
+        count = (int)(mb->tail - mb->head);
+    }
+    irq_restore(flags);
+    return count;
+}
+
+void ipc_list_messages(void) {
+    terminal_writestring("📬 Mailbox Status:\n");
+    terminal_writestring("Receiver Sender Size  Age(us)  Data\n");
+    terminal_writestring("-------- ------ ----  -------  ----\n");
+    
+    bool found_any = false;
+    uint64_t now = clock_monotonic_ns();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        mailbox_t* mb = &mailboxes[i];
+        if (process_table[i].pid == INVALID_PID || mb->owner_pid != process_table[i].pid) {
+            continue;
+        }
+        for (uint32_t pos = mb->head; pos != mb->tail; pos++) {
+            message_t* msg = &mb->ring[pos & (MAX_MESSAGES - 1)];
+            found_any = true;
+            terminal_printf("%d        %d      %u   %llu   ", mb->owner_pid, msg->sender_pid,
+                            (uint32_t)msg->message_size, clock_ns_to_us(now - msg->timestamp));
+            if (msg->pages) {
+                terminal_printf("[pages at %u]\n", (uint32_t)msg->pages);
+                continue;
+            }
+            terminal_writestring("\"");
+            
+            // Print first 20 chars of message
+            for (int j = 0; j < 20 && j < (int)msg->message_size; j++) {
+                if (msg->data[j] >= 32 && msg->data[j] <= 126) {
+                    terminal_putchar(msg->data[j]);
+                } else {
+                    terminal_putchar('.');
+                }
+            }
+            terminal_writestring("\"\n");
+        }
+    }
+    
+    if (!found_any) {
+        terminal_writestring("No messages in queue\n");
+    }
+}
+
+// Semaphore implementation
+// Day 21: lookups by id or name are lockless RCU readers. Creation and
+// destruction serialize on the registry lock; a destroyed slot is only
+// reused after a grace period, so a lookup racing with destroy never sees
+// it recycled under a new name. Each semaphore's own state still changes
+// with interrupts disabled, since waiters sleep with it held, and callers
+// re-check the id there.
+static spinlock_t ipc_sem_registry_lock = SPINLOCK_INIT("ipc_semaphores");
+
+static void ipc_semaphore_reclaim(rcu_head_t* head) {
+    semaphore_t* sem = container_of(head, semaphore_t, rcu);
+    WRITE_ONCE(sem->rcu_pending, false);
+}
+
+static bool ipc_semaphore_valid(semaphore_t* sem, int semaphore_id) {
+    return sem->is_used && sem->id == semaphore_id;
+}
+
+static int ipc_semaphore_alloc(const char* name, int initial_value, bool is_mutex) {
+    int id = INVALID_SEMAPHORE_ID;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (attempt > 0) {
+            rcu_barrier();      // Let destroyed slots finish their grace period
+        }
+        bool pending = false;
+        uint32_t flags = spin_lock_irqsave(&ipc_sem_registry_lock);
+        for (int i = 0; i < MAX_SEMAPHORES; i++) {
+            if (semaphore_pool[i].is_used) {
+                continue;
+            }
+            if (semaphore_pool[i].rcu_pending) {
+                pending = true;
+                continue;
+            }
+            semaphore_pool[i].value = initial_value;
+            semaphore_pool[i].is_used = true;
+            semaphore_pool[i].is_mutex = is_mutex;
+            semaphore_pool[i].owner = NULL;
+            wait_queue_init(&semaphore_pool[i].waiters);
+            semaphore_pool[i].creation_time = get_uptime_seconds();
+            
+            // Copy name
+            int j;
+            for (j = 0; j < 31 && name[j] != '\0'; j++) {
+                semaphore_pool[i].name[j] = name[j];
+            }
+            semaphore_pool[i].name[j] = '\0';
+            id = next_semaphore_id++;
+            rcu_assign_pointer(semaphore_pool[i].id, id);   // Publish last
+            break;
+        }
+        spin_unlock_irqrestore(&ipc_sem_registry_lock, flags);
+        
+        // Only slots awaiting reclaim are free: wait them out, if we may sleep
+        if (id != INVALID_SEMAPHORE_ID || !pending || in_interrupt() || preempt_count != 0) {
+            break;
+        }
+    }
+    return id;
+}
+
+int ipc_create_semaphore(const char* name, int initial_value) {
+    if (!name || initial_value < 0) {
+        terminal_printf("❌ Invalid semaphore parameters\n");
+        return INVALID_SEMAPHORE_ID;
+    }
+    
+    int id = ipc_semaphore_alloc(name, initial_value, false);
+    if (id == INVALID_SEMAPHORE_ID) {
+        terminal_printf("❌ No free semaphore slots available\n");
+        return INVALID_SEMAPHORE_ID;
+    }
+    terminal_printf("✅ Semaphore '%s' created (ID: %d, value: %d)\n", 
+                   name, id, initial_value);
+    return id;
+}
+
+// The slot returned stays a semaphore slot, but may be destroyed at any
+// time: callers re-check ipc_semaphore_valid() with interrupts disabled
+semaphore_t* ipc_find_semaphore(int semaphore_id) {
+    if (semaphore_id == INVALID_SEMAPHORE_ID) {
+        return NULL;
+    }
+    semaphore_t* sem = NULL;
+    rcu_read_lock();
+    for (int i = 0; i < MAX_SEMAPHORES; i++) {
+        if (rcu_dereference(semaphore_pool[i].id) == semaphore_id) {
+            sem = &semaphore_pool[i];
+            break;
+        }
+    }
+    rcu_read_unlock();
+    return sem;
+}
+
+int ipc_find_semaphore_by_name(const char* name) {
+    int id = INVALID_SEMAPHORE_ID;
+    rcu_read_lock();
+    for (int i = 0; i < MAX_SEMAPHORES; i++) {
+        int sem_id = rcu_dereference(semaphore_pool[i].id);
+        if (sem_id != INVALID_SEMAPHORE_ID && strcmp(semaphore_pool[i].name, name) == 0) {
+            id = sem_id;
+            break;
+        }
+    }
+    rcu_read_unlock();
+    return id;
+}
+
+// Priority inheritance (Day 21). All helpers run with interrupts disabled.
+static bool ipc_pi_enabled = true;
+static ipc_pi_stats_t ipc_pi_stats;
+static ipc_pi_event_t ipc_pi_trace[IPC_PI_TRACE_SIZE];
+static uint32_t ipc_pi_trace_next = 0;
+
+// Tracepoint: record a priority change caused by a PI mutex
+static void ipc_pi_tracepoint(semaphore_t* sem, process_t* owner, process_t* waiter,
+                              int new_nice, int depth) {
+    ipc_pi_event_t* ev = &ipc_pi_trace[ipc_pi_trace_next++ % IPC_PI_TRACE_SIZE];
+    ev->timestamp = clock_monotonic_ns();
+    ev->semaphore_id = sem ? sem->id : INVALID_SEMAPHORE_ID;
+    ev->owner_pid = owner->pid;
+    ev->waiter_pid = waiter ? waiter->pid : INVALID_PID;
+    ev->old_nice = owner->nice;
+    ev->new_nice = new_nice;
+    ev->depth = depth;
+}
+
+// Highest priority (lowest nice) among the waiters of the PI mutexes the
+// task holds, or NICE_NO_BOOST. Wait queues are priority ordered, so only
+// each head is looked at.
+static int ipc_pi_inherited_nice(process_t* process) {
+    int nice = NICE_NO_BOOST;
+    if (!ipc_pi_enabled) {
+        return nice;
+    }
+    for (int i = 0; i < MAX_SEMAPHORES; i++) {
+        semaphore_t* sem = &semaphore_pool[i];
+        if (!sem->is_used || !sem->is_mutex || sem->owner != process) {
+            continue;
+        }
+        process_t* waiter = sem->waiters.head;
+        if (waiter == process) {
+            waiter = waiter->wait_next;     // New owner still at the head
+        }
+        if (waiter && waiter->nice < nice) {
+            nice = waiter->nice;
+        }
+    }
+    return nice;
+}
+
+// Recompute a task's inherited priority after it released (or lost) a mutex
+static void ipc_pi_update(process_t* process) {
+    int nice = ipc_pi_inherited_nice(process);
+    if (nice != process->pi_nice) {
+        int base = process->base_nice;
+        int effective = nice < base ? nice : base;
+        if (effective != process->nice) {
+            ipc_pi_tracepoint(NULL, process, NULL, effective, 0);
+            ipc_pi_stats.restores++;
+        }
+        sched_set_pi_nice(process, nice);
+    }
+}
+
+// A waiter is about to block on sem: raise the owner, and whatever the
+// owner is blocked on, to the waiter's priority
+static void ipc_pi_boost(semaphore_t* sem, process_t* waiter) {
+    if (!ipc_pi_enabled) {
+        return;
+    }
+    int nice = waiter->nice;
+    int depth = 0;
+    while (sem && sem->is_mutex && sem->owner) {
+        if (depth == IPC_PI_MAX_DEPTH) {
+            ipc_pi_stats.chain_truncated++;
+            break;
+        }
+        process_t* owner = sem->owner;
+        if (owner->nice <= nice) {
+            break;                          // Already at least as urgent
+        }
+        ipc_pi_tracepoint(sem, owner, waiter, nice, depth);
+        ipc_pi_stats.boosts++;
+        if (depth > ipc_pi_stats.max_depth) {
+            ipc_pi_stats.max_depth = depth;
+        }
+        sched_set_pi_nice(owner, nice);
+        sem = owner->pi_blocked_on;
+        depth++;
+    }
+}
+
+// Hand a mutex to its highest-priority waiter, or free it. The new owner
+// is set before the wakeup, which may switch to it at once.
+static void ipc_mutex_unlock(semaphore_t* sem) {
+    process_t* prev = sem->owner;
+    process_t* next = sem->waiters.head;
+    sem->owner = next;
+    if (prev) {
+        ipc_pi_update(prev);
+    }
+    if (next) {
+        ipc_pi_update(next);
+        wait_queue_wake_one(&sem->waiters);
+    } else {
+        sem->value++;
+    }
+}
+
+// Day 21: P() blocks on the semaphore's wait queue. signal() hands its unit
+// directly to the woken waiter, so a wakeup can never be stolen by a task
+// that arrives in between. Returns 0 when acquired, -1 on error.
+int ipc_semaphore_wait(int semaphore_id) {
+    semaphore_t* sem = ipc_find_semaphore(semaphore_id);
+    if (!sem) {
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    if (!ipc_semaphore_valid(sem, semaphore_id)) {
+        irq_restore(flags);
+        return -1;      // Destroyed since the lookup
+    }
+    
+    if (sem->value > 0) {
+        sem->value--;
+        if (sem->is_mutex) {
+            sem->owner = current_process;
+        }
+        irq_restore(flags);
+        return 0;
+    }
+    
+    if (!current_process || in_interrupt() || (sem->is_mutex && sem->owner == current_process)) {
+        irq_restore(flags);
+        return 1;  // Cannot sleep here: would block (or deadlock on itself)
+    }
+    
+    if (sem->is_mutex) {
+        current_process->pi_blocked_on = sem;
+        ipc_pi_boost(sem, current_process);
+    }
+    wait_queue_sleep(&sem->waiters);
+    current_process->pi_blocked_on = NULL;
+    
+    // Woken by signal (unit handed over) or by destroy
+    int result = ipc_semaphore_valid(sem, semaphore_id) ? 0 : -1;
+    irq_restore(flags);
+    return result;
+}
+
+// Non-blocking P(): 0 if acquired, 1 if it would block, -1 on error
+int ipc_semaphore_trywait(int semaphore_id) {
+    semaphore_t* sem = ipc_find_semaphore(semaphore_id);
+    if (!sem) {
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    if (!ipc_semaphore_valid(sem, semaphore_id)) {
+        irq_restore(flags);
+        return -1;
+    }
+    int result = 1;
+    if (sem->value > 0) {
+        sem->value--;
+        if (sem->is_mutex) {
+            sem->owner = current_process;
+        }
+        result = 0;
+    }
+    irq_restore(flags);
+    return result;
+}
+
+// V(): wake exactly one waiter, or bank the unit if nobody is waiting
+int ipc_semaphore_signal(int semaphore_id) {
+    semaphore_t* sem = ipc_find_semaphore(semaphore_id);
+    if (!sem) {
+        return -1;
+    }
+    
+    uint32_t flags = irq_save();
+    if (!ipc_semaphore_valid(sem, semaphore_id)) {
+        irq_restore(flags);
+        return -1;
+    }
+    if (sem->is_mutex) {
+        // Only the owner unlocks a mutex
+        if (sem->owner != current_process) {
+            irq_restore(flags);
+            return -1;
+        }
+        ipc_mutex_unlock(sem);
+    } else if (!wait_queue_wake_one(&sem->waiters)) {
+        sem->value++;
+    }
+    irq_restore(flags);
+    
+    return 0;
+}
+
+// A mutex: a binary semaphore with an owner and priority inheritance
+int ipc_create_mutex(const char* name) {
+    if (!name) {
+        return INVALID_SEMAPHORE_ID;
+    }
+    int id = ipc_semaphore_alloc(name, 1, true);
+    if (id == INVALID_SEMAPHORE_ID) {
+        terminal_printf("❌ No free semaphore slots available\n");
+        return INVALID_SEMAPHORE_ID;
+    }
+    terminal_printf("✅ Mutex '%s' created (ID: %d)\n", name, id);
+    return id;
+}
+
+// Called by process_kill (interrupts disabled) once a task blocked on a PI
+// mutex has left its wait queue: the owners it boosted, down the chain,
+// drop back to whatever their remaining waiters justify
+void ipc_pi_cancel_wait(process_t* process) {
+    semaphore_t* sem = process->pi_blocked_on;
+    process->pi_blocked_on = NULL;
+    for (int depth = 0; sem && sem->is_mutex && sem->owner && depth < IPC_PI_MAX_DEPTH; depth++) {
+        process_t* owner = sem->owner;
+        ipc_pi_update(owner);
+        sem = owner->pi_blocked_on;
+    }
+}
+
+// Called by the reaper: mutexes held by a dead task pass to their next
+// waiter, so a crashed holder cannot block them forever
+void ipc_semaphore_release(process_t* process) {
+    uint32_t flags = irq_save();
+    for (int i = 0; i < MAX_SEMAPHORES; i++) {
+        semaphore_t* sem = &semaphore_pool[i];
+        if (sem->is_used && sem->is_mutex && sem->owner == process) {
+            ipc_mutex_unlock(sem);
+        }
+    }
+    irq_restore(flags);
+}
+
+// Unpublish a semaphore and release everything waiting on it (interrupts
+// disabled). Returns the number of sleepers woken.
+static int ipc_semaphore_teardown(semaphore_t* sem) {
+    process_t* owner = sem->owner;
+    WRITE_ONCE(sem->id, INVALID_SEMAPHORE_ID);
+    sem->is_used = false;
+    sem->value = 0;
+    sem->is_mutex = false;
+    sem->owner = NULL;
+    if (owner) {
+        ipc_pi_update(owner);           // Its waiters no longer boost it
+    }
+    return wait_queue_wake_all(&sem->waiters);
+}
+
+int ipc_destroy_semaphore(int semaphore_id) {
+    semaphore_t* sem = ipc_find_semaphore(semaphore_id);
+    if (!sem) {
+        terminal_printf("❌ Semaphore ID %d not found\n", semaphore_id);
+        return -1;
+    }
+    
+    // Unpublish first so woken waiters and new lookups see it is gone; the
+    // slot is reclaimed once readers that may still hold it have finished
+    uint32_t flags = spin_lock_irqsave(&ipc_sem_registry_lock);
+    if (!ipc_semaphore_valid(sem, semaphore_id)) {
+        spin_unlock_irqrestore(&ipc_sem_registry_lock, flags);
+        terminal_printf("❌ Semaphore ID %d not found\n", semaphore_id);
+        return -1;
+    }
+    sem->rcu_pending = true;
+    int woken = ipc_semaphore_teardown(sem);
+    spin_unlock_irqrestore(&ipc_sem_registry_lock, flags);
+    call_rcu(&sem->rcu, ipc_semaphore_reclaim);
+    
+    if (woken > 0) {
+        terminal_printf("⚠️  %d process(es) unblocked (semaphore destroyed)\n", woken);
+    }
+    terminal_printf("✅ Semaphore %d destroyed\n", semaphore_id);
+    return 0;
+}
+
+// `ipc init`: tear every semaphore down as destroy does. Sleepers are
+// woken, not dropped, and re-check their id; boosted mutex owners drop
+// back. Reclaims still queued by earlier destroys are waited out first so
+// no rcu_head is queued twice, and the slots torn down here get a grace
+// period of their own before reuse.
+static void ipc_semaphore_reset_pool(void) {
+    rcu_barrier();
+    uint32_t flags = spin_lock_irqsave(&ipc_sem_registry_lock);
+    for (int i = 0; i < MAX_SEMAPHORES; i++) {
+        semaphore_t* sem = &semaphore_pool[i];
+        if (sem->rcu_pending) {
+            continue;                   // Destroyed since the barrier
+        }
+        bool live = sem->is_used;
+        ipc_semaphore_teardown(sem);
+        sem->creation_time = 0;
+        if (live) {
+            sem->rcu_pending = true;
+            call_rcu(&sem->rcu, ipc_semaphore_reclaim);
+        }
+    }
+    next_semaphore_id = 1;
+    spin_unlock_irqrestore(&ipc_sem_registry_lock, flags);
+}
+
+void ipc_list_semaphores(void) {
+    terminal_writestring("🔒 Semaphore Status:\n");
+    terminal_writestring("ID   Name                Value Waiting\n");
+    terminal_writestring("---- -------------------- ----- -------\n");
+    
+    bool found_any = false;
+    for (int i = 0; i < MAX_SEMAPHORES; i++) {
+        if (semaphore_pool[i].is_used) {
+            found_any = true;
+            
+            int waiting_count = (int)semaphore_pool[i].waiters.count;
+            
+            // Simple display without printf formatting
+            char id_str[8], value_str[8], waiting_str[8];
+            itoa(semaphore_pool[i].id, id_str, 10);
+            itoa(semaphore_pool[i].value, value_str, 10);
+            itoa(waiting_count, waiting_str, 10);
+            
+            terminal_writestring(id_str);
+            terminal_writestring("  ");
+            terminal_writestring(semaphore_pool[i].name);
+            
+            // Pad name to 20 chars
+            int name_len = strlen(semaphore_pool[i].name);
+            for (int j = name_len; j < 20; j++) {
+                terminal_writestring(" ");
+            }
+            
+            terminal_writestring(" ");
+            terminal_writestring(value_str);
+            terminal_writestring("   ");
+            terminal_writestring(waiting_str);
+            terminal_writestring("\n");
+        }
+    }
+    
+    if (!found_any) {
+        terminal_writestring("No semaphores created\n");
+    }
+}
+
+void ipc_pi_set_enabled(bool enabled) {
+    ipc_pi_enabled = enabled;
+}
+
+void ipc_pi_show_trace(void) {
+    terminal_printf("Priority inheritance %s: %u boosts, %u restores, max chain depth %d, %u chains truncated\n",
+                    ipc_pi_enabled ? "on" : "off", ipc_pi_stats.boosts, ipc_pi_stats.restores,
+                    ipc_pi_stats.max_depth, ipc_pi_stats.chain_truncated);
+    
+    uint32_t count = ipc_pi_trace_next < IPC_PI_TRACE_SIZE ? ipc_pi_trace_next : IPC_PI_TRACE_SIZE;
+    for (uint32_t i = ipc_pi_trace_next - count; i != ipc_pi_trace_next; i++) {
+        ipc_pi_event_t* ev = &ipc_pi_trace[i % IPC_PI_TRACE_SIZE];
+        if (ev->waiter_pid != INVALID_PID) {
+            terminal_printf("  %llu us: pid %d nice %d -> %d (waiter pid %d, sem %d, depth %d)\n",
+                            clock_ns_to_us(ev->timestamp), ev->owner_pid, ev->old_nice, ev->new_nice,
+                            ev->waiter_pid, ev->semaphore_id, ev->depth);
+        } else {
+            terminal_printf("  %llu us: pid %d nice %d -> %d (restored)\n",
+                            clock_ns_to_us(ev->timestamp), ev->owner_pid, ev->old_nice, ev->new_nice);
+        }
+    }
+}
+
+// Priority inversion test (Day 21): a nice 19 task holds a mutex that a
+// nice -20 task needs while two nice 0 tasks hog the CPU. Without
+// inheritance the holder only gets a sliver of CPU next to the hogs.
+#define PI_TEST_HOGS        2
+#define PI_TEST_WORK_NS     2000000ULL      // Holder's critical section (2 ms of CPU)
+
+static struct {
+    int mutex;
+    volatile bool held;
+    volatile bool stop;
+    uint64_t wait_ns;
+} pi_test;
+
+// Burn CPU until this task has run work_ns itself (time spent preempted
+// does not count)
+static void ipc_pi_burn(uint64_t work_ns) {
+    uint64_t start = current_process->sum_exec_ns;
+    while (current_process->sum_exec_ns - start < work_ns) {
+        for (volatile int i = 0; i < 1000; i++) {
+        }
+        uint32_t flags = irq_save();
+        sched_update_curr(current_process);
+        irq_restore(flags);
+    }
+}
+
+static void ipc_pi_low_thread(void* arg) {
+    (void)arg;
+    ipc_semaphore_wait(pi_test.mutex);
+    pi_test.held = true;
+    ipc_pi_burn(PI_TEST_WORK_NS);
+    ipc_semaphore_signal(pi_test.mutex);
+}
+
+static void ipc_pi_hog_thread(void* arg) {
+    (void)arg;
+    while (!pi_test.stop) {
+        cpu_relax();
+    }
+}
+
+static void ipc_pi_high_thread(void* arg) {
+    (void)arg;
+    uint64_t start = clock_monotonic_ns();
+    ipc_semaphore_wait(pi_test.mutex);
+    pi_test.wait_ns = clock_monotonic_ns() - start;
+    ipc_semaphore_signal(pi_test.mutex);
+    pi_test.stop = true;
+}
+
+// Start a joinable thread that runs at 'nice' from its first instruction
+static int ipc_pi_spawn(void (*fn)(void* arg), const char* name, int nice) {
+    uint32_t flags = irq_save();
+    int pid = kthread_create_child(fn, NULL, name);
+    process_t* process = process_find(pid);
+    if (process) {
+        sched_set_nice(process, nice);
+    }
+    irq_restore(flags);
+    return pid;
+}
+
+static void ipc_pi_test_run(bool enabled) {
+    int pids[PI_TEST_HOGS + 2];
+    int status = 0;
+    int n = 0;
+    
+    memset(&pi_test, 0, sizeof(pi_test));
+    pi_test.mutex = ipc_create_mutex("pi_test");
+    if (pi_test.mutex < 0) {
+        return;
+    }
+    ipc_pi_set_enabled(enabled);
+    uint32_t boosts = ipc_pi_stats.boosts;
+    
+    pids[n++] = ipc_pi_spawn(ipc_pi_low_thread, "pi_low", NICE_MAX);
+    while (pids[0] != INVALID_PID && !pi_test.held) {
+        process_yield();
+    }
+    for (int i = 0; i < PI_TEST_HOGS; i++) {
+        pids[n++] = ipc_pi_spawn(ipc_pi_hog_thread, "pi_hog", NICE_DEFAULT);
+    }
+    pids[n++] = ipc_pi_spawn(ipc_pi_high_thread, "pi_high", NICE_MIN);
+    if (pids[n - 1] == INVALID_PID) {
+        pi_test.stop = true;
+    }
+    
+    for (int i = n - 1; i >= 0; i--) {
+        if (pids[i] != INVALID_PID) {
+            process_wait(pids[i], &status);
+        }
+    }
+    
+    terminal_printf("  PI %s: nice %d waiter blocked %llu us on a %llu us critical section (%u boosts)\n",
+                    enabled ? "on: " : "off:", NICE_MIN, clock_ns_to_us(pi_test.wait_ns),
+                    clock_ns_to_us(PI_TEST_WORK_NS), ipc_pi_stats.boosts - boosts);
+    ipc_destroy_semaphore(pi_test.mutex);
+}
+
+void ipc_pi_test(void) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+    
+    bool was_enabled = ipc_pi_enabled;
+    terminal_printf("Priority inversion: nice %d holder, %d nice 0 hogs, nice %d waiter\n",
+                    NICE_MAX, PI_TEST_HOGS, NICE_MIN);
+    ipc_pi_test_run(false);
+    ipc_pi_test_run(true);
+    ipc_pi_set_enabled(was_enabled);
+}
+
+// Shared memory implementation (Day 21)
+// A segment is a zeroed run of PMM pages. Names are found through a small
+// chained hash table; each attaching process holds one reference and the
+// last detach (or the reaper, for a process that never detached) frees
+// the pages. Memory is not paged, so every process sees a segment at the
+// same address: attach returns the run's address rather than mapping it.
+// The registry is guarded by a sleeping mutex, so zeroing a new segment
+// no longer runs with interrupts disabled.
+
+static mutex_t ipc_shm_mutex = MUTEX_INIT("ipc_shm");
+
+static uint32_t ipc_shm_hash(const char* name) {
+    uint32_t hash = 2166136261u;        // FNV-1a
+    while (*name) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+    return hash % SHM_HASH_BUCKETS;
+}
+
+static shared_memory_t* ipc_shm_find(int shared_mem_id) {
+    for (int i = 0; i < MAX_SHARED_MEMORY; i++) {
+        if (shared_memory_pool[i].is_used && shared_memory_pool[i].id == shared_mem_id) {
+            return &shared_memory_pool[i];
+        }
+    }
+    return NULL;
+}
+
+// Lookup by name (callers hold ipc_shm_mutex)
+static shared_memory_t* ipc_shm_lookup(const char* name) {
+    int index = shm_buckets[ipc_shm_hash(name)];
+    while (index) {
+        shared_memory_t* shm = &shared_memory_pool[index - 1];
+        if (strcmp(shm->name, name) == 0) {
+            return shm;
+        }
+        index = shm->hash_next;
+    }
+    return NULL;
+}
+
+// Remove the name, so lookups and new attachments fail
+static void ipc_shm_unlink(shared_memory_t* shm) {
+    int* link = &shm_buckets[ipc_shm_hash(shm->name)];
+    while (*link && &shared_memory_pool[*link - 1] != shm) {
+        link = &shared_memory_pool[*link - 1].hash_next;
+    }
+    if (*link) {
+        *link = shm->hash_next;
+    }
+    shm->hash_next = 0;
+    shm->linked = false;
+}
+
+static void ipc_shm_destroy(shared_memory_t* shm) {
+    if (shm->linked) {
+        ipc_shm_unlink(shm);
+    }
+    pmm_free_pages((uint32_t)shm->address, shm->npages);
+    shm->is_used = false;
+    shm->id = -1;
+    shm->address = NULL;
+    shm->refcount = 0;
+    shm->attached = 0;
+}
+
+static void ipc_shm_put(shared_memory_t* shm) {
+    if (--shm->refcount == 0) {
+        ipc_shm_destroy(shm);
+    }
+}
+
+// Create a named segment, or return the existing one of that name if it
+// is large enough and IPC_SHM_EXCL is not set. Returns its ID or -1. The name holds a reference until
+// ipc_destroy_shared_memory(), so a segment nobody attached is not lost.
+int ipc_create_shared_memory(const char* name, size_t size, uint32_t flags) {
+    if (!name || !name[0] || size == 0) {
+        return -1;
+    }
+    
+    mutex_lock(&ipc_shm_mutex);
+    shared_memory_t* shm = ipc_shm_lookup(name);
+    if (shm) {
+        int id = (!(flags & IPC_SHM_EXCL) && size <= shm->size) ? shm->id : -1;
+        mutex_unlock(&ipc_shm_mutex);
+        return id;
+    }
+    
+    for (int i = 0; i < MAX_SHARED_MEMORY; i++) {
+        shm = &shared_memory_pool[i];
+        if (shm->is_used) {
+            continue;
+        }
+        
+        uint32_t npages = PAGE_ALIGN(size) / PAGE_SIZE;
+        uint32_t base = pmm_alloc_pages(npages);
+        if (!base) {
+            break;
+        }
+        memset((void*)base, 0, npages * PAGE_SIZE);
+        
+        shm->id = next_shm_id++;
+        shm->address = (void*)base;
+        shm->size = size;
+        shm->npages = npages;
+        shm->owner_pid = current_process ? current_process->pid : KERNEL_PID;
+        shm->is_used = true;
+        shm->refcount = 1;
+        shm->linked = true;
+        shm->attached = 0;
+        strncpy(shm->name, name, sizeof(shm->name) - 1);
+        shm->name[sizeof(shm->name) - 1] = '\0';
+        
+        uint32_t bucket = ipc_shm_hash(shm->name);
+        shm->hash_next = shm_buckets[bucket];
+        shm_buckets[bucket] = i + 1;
+        
+        mutex_unlock(&ipc_shm_mutex);
+        return shm->id;
+    }
+    mutex_unlock(&ipc_shm_mutex);
+    return -1;
+}
+
+int ipc_find_shared_memory(const char* name) {
+    if (!name) {
+        return -1;
+    }
+    mutex_lock(&ipc_shm_mutex);
+    shared_memory_t* shm = ipc_shm_lookup(name);
+    int id = shm ? shm->id : -1;
+    mutex_unlock(&ipc_shm_mutex);
+    return id;
+}
+
+// Attach the current process (idempotent). Returns the segment address.
+// Destroyed segments take no new attachments.
+void* ipc_attach_shared_memory(int shared_mem_id) {
+    if (!current_process) {
+        return NULL;
+    }
+    
+    mutex_lock(&ipc_shm_mutex);
+    shared_memory_t* shm = ipc_shm_find(shared_mem_id);
+    void* address = NULL;
+    uint32_t bit = 1u << (current_process - process_table);
+    if (shm && (shm->linked || (shm->attached & bit))) {
+        if (!(shm->attached & bit)) {
+            shm->attached |= bit;
+            shm->refcount++;
+        }
+        address = shm->address;
+    }
+    mutex_unlock(&ipc_shm_mutex);
+    return address;
+}
+
+static void ipc_shm_detach_slot(shared_memory_t* shm, uint32_t bit) {
+    if (shm->attached & bit) {
+        shm->attached &= ~bit;
+        ipc_shm_put(shm);
+    }
+}
+
+// Detach the current process; once the segment is destroyed, the last
+// detach frees it. Returns 0, or -1 if the process was not attached.
+int ipc_detach_shared_memory(int shared_mem_id) {
+    if (!current_process) {
+        return -1;
+    }
+    
+    mutex_lock(&ipc_shm_mutex);
+    shared_memory_t* shm = ipc_shm_find(shared_mem_id);
+    uint32_t bit = 1u << (current_process - process_table);
+    int result = -1;
+    if (shm && (shm->attached & bit)) {
+        ipc_shm_detach_slot(shm, bit);
+        result = 0;
+    }
+    mutex_unlock(&ipc_shm_mutex);
+    return result;
+}
+
+// Unlink the name and drop its reference: the segment is freed now if
+// nobody is attached, else by the last detach. Returns 0, or -1 if no
+// such segment exists or it was already destroyed.
+int ipc_destroy_shared_memory(int shared_mem_id) {
+    mutex_lock(&ipc_shm_mutex);
+    shared_memory_t* shm = ipc_shm_find(shared_mem_id);
+    int result = -1;
+    if (shm && shm->linked) {
+        ipc_shm_unlink(shm);
+        ipc_shm_put(shm);
+        result = 0;
+    }
+    mutex_unlock(&ipc_shm_mutex);
+    return result;
+}
+
+// Called by the reaper: drop every attachment the process still holds
+void ipc_shared_memory_release(process_t* process) {
+    mutex_lock(&ipc_shm_mutex);
+    uint32_t bit = 1u << (process - process_table);
+    for (int i = 0; i < MAX_SHARED_MEMORY; i++) {
+        if (shared_memory_pool[i].is_used) {
+            ipc_shm_detach_slot(&shared_memory_pool[i], bit);
+        }
+    }
+    mutex_unlock(&ipc_shm_mutex);
+}
+
+void ipc_list_shared_memory(void) {
+    terminal_writestring("🧩 Shared Memory Segments:\n");
+    terminal_writestring("ID   Name                 Size     Address   Refs\n");
+    
+    bool found_any = false;
+    for (int i = 0; i < MAX_SHARED_MEMORY; i++) {
+        shared_memory_t* shm = &shared_memory_pool[i];
+        if (shm->is_used) {
+            found_any = true;
+            terminal_printf("%d    %s    %u    %u    %d\n", shm->id, shm->name,
+                            (uint32_t)shm->size, (uint32_t)shm->address, shm->refcount);
+        }
+    }
+    
+    if (!found_any) {
+        terminal_writestring("No shared memory segments\n");
+    }
+}
+
+// IPC statistics
+void ipc_stats(void) {
+    terminal_writestring("📊 IPC System Statistics:\n");
+    
+    int queued = 0;
+    int mailboxes_used = 0;
+    int used_semaphores = 0;
+    
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (process_table[i].pid != INVALID_PID && mailboxes[i].owner_pid == process_table[i].pid &&
+            mailboxes[i].tail != mailboxes[i].head) {
+            queued += (int)(mailboxes[i].tail - mailboxes[i].head);
+            mailboxes_used++;
+        }
+    }
+    
+    for (int i = 0; i < MAX_SEMAPHORES; i++) {
+        if (semaphore_pool[i].is_used) used_semaphores++;
     }
     
-    // Initialize semaphore pool
-    for (int i = 0; i < MAX_SEMAPHORES; i++) {
-        semaphore_pool[i].id = INVALID_SEMAPHORE_ID;
-        semaphore_pool[i].value = 0;
-        semaphore_pool[i].is_used = false;
-        semaphore_pool[i].waiting_queue_head = NULL;
-        semaphore_pool[i].waiting_queue_tail = NULL;
-        semaphore_pool[i].creation_time = 0;
-        // Clear semaphore name
-        for (int j = 0; j < 32; j++) {
-            semaphore_pool[i].name[j] = 0;
+    terminal_printf("Messages: %d queued in %d mailbox(es), %d slots each\n",
+                    queued, mailboxes_used, MAX_MESSAGES);
+    terminal_printf("  sent %u, received %u, full %u, invalid %u, empty %u\n",
+                    ipc_msg_stats.sent, ipc_msg_stats.received, ipc_msg_stats.send_full,
+                    ipc_msg_stats.send_invalid, ipc_msg_stats.recv_empty);
+    terminal_printf("  blocked receives %u, blocked sends %u\n",
+                    ipc_msg_stats.recv_blocked, ipc_msg_stats.send_blocked);
+    terminal_printf("  page transfers %u (%u pages moved)\n",
+                    ipc_msg_stats.pages_sent, ipc_msg_stats.pages_moved);
+    terminal_printf("  batch passes: %u send, %u receive\n",
+                    ipc_msg_stats.send_batches, ipc_msg_stats.recv_batches);
+    terminal_printf("Semaphores: %d/%d used\n", used_semaphores, MAX_SEMAPHORES);
+    int used_segments = 0;
+    for (int i = 0; i < MAX_SHARED_MEMORY; i++) {
+        if (shared_memory_pool[i].is_used) used_segments++;
+    }
+    terminal_printf("Shared memory: %d/%d segments\n", used_segments, MAX_SHARED_MEMORY);
+    terminal_printf("Next semaphore ID: %d\n", next_semaphore_id);
+}
+
+// Semaphore handoff benchmark (Day 21): the shell thread signals 'ping'
+// and sleeps on 'pong'; a kernel thread sleeping on 'ping' records the
+// signal-to-run latency and signals 'pong' back.
+static struct {
+    int ping;
+    int pong;
+    int iterations;
+    volatile uint64_t t_signal;     // clock_cycles() just before signal(ping)
+    uint64_t handoff_cycles;
+} handoff_bench;
+
+static void ipc_handoff_waiter(void* arg) {
+    (void)arg;
+    for (int i = 0; i < handoff_bench.iterations; i++) {
+        if (ipc_semaphore_wait(handoff_bench.ping) != 0) {
+            return;
         }
+        handoff_bench.handoff_cycles += clock_cycles() - handoff_bench.t_signal;
+        ipc_semaphore_signal(handoff_bench.pong);
     }
+}
+
+static void ipc_handoff_run(int iterations, int waiter_nice) {
+    handoff_bench.ping = ipc_create_semaphore("bench_ping", 0);
+    handoff_bench.pong = ipc_create_semaphore("bench_pong", 0);
+    if (handoff_bench.ping < 0 || handoff_bench.pong < 0) {
+        terminal_writestring("Failed to create benchmark semaphores\n");
+        return;
+    }
+    handoff_bench.iterations = iterations;
+    handoff_bench.handoff_cycles = 0;
     
-    // Initialize shared memory pool
-    for (int i = 0; i < 8; i++) {
-        shared_memory_pool[i].id = -1;
-        shared_memory_pool[i].address = NULL;
-        shared_memory_pool[i].size = 0;
-        shared_memory_pool[i].owner_pid = INVALID_PID;
-        shared_memory_pool[i].is_used = false;
+    int pid = kthread_create(ipc_handoff_waiter, NULL, "sem_bench");
+    process_t* waiter = process_find(pid);
+    if (!waiter) {
+        terminal_writestring("Failed to create benchmark thread\n");
+        ipc_destroy_semaphore(handoff_bench.ping);
+        ipc_destroy_semaphore(handoff_bench.pong);
+        return;
     }
+    sched_set_nice(waiter, waiter_nice);
     
-    next_semaphore_id = 1;
+    // Let the waiter reach its first wait before timing starts
+    process_yield();
     
-    terminal_printf("✅ IPC system initialized\n");
-    terminal_printf("   - Message slots: %d\n", MAX_MESSAGES);
-    terminal_printf("   - Semaphore slots: %d\n", MAX_SEMAPHORES);
-    terminal_printf("   - Shared memory slots: 8\n");
-}
-
-// Message passing implementation
-int ipc_send_message(int receiver_pid, const char* data, size_t size) {
-    if (!data || size == 0 || size > MAX_MESSAGE_SIZE) {
-        terminal_printf("❌ Invalid message data or size\n");
-        return -1;
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        handoff_bench.t_signal = clock_cycles();
+        ipc_semaphore_signal(handoff_bench.ping);
+        ipc_semaphore_wait(handoff_bench.pong);
     }
+    uint64_t total = clock_cycles() - start;
     
-    // Verify receiver process exists
-    process_t* receiver = process_find(receiver_pid);
-    if (!receiver) {
-        terminal_printf("❌ Receiver process PID %d not found\n", receiver_pid);
-        return -1;
+    while (waiter->pid == pid && waiter->state != PROCESS_TERMINATED) {
+        process_yield();
     }
     
-    // Find free message slot
-    for (int i = 0; i < MAX_MESSAGES; i++) {
-        if (!message_pool[i].is_used) {
-            message_pool[i].sender_pid = current_process ? current_process->pid : 0;
-            message_pool[i].receiver_pid = receiver_pid;
-            message_pool[i].message_size = size;
-            message_pool[i].is_used = true;
-            message_pool[i].timestamp = get_uptime_seconds();
-            
-            // Copy message data
-            for (size_t j = 0; j < size && j < MAX_MESSAGE_SIZE; j++) {
-                message_pool[i].data[j] = data[j];
-            }
-            
-            terminal_printf("✅ Message sent to PID %d (slot %d, %d bytes)\n", 
-                           receiver_pid, i, (int)size);
-            return i;  // Return message slot ID
-        }
-    }
+    terminal_printf("  waiter nice %d: handoff %llu ns, round trip %llu ns\n",
+                    waiter_nice,
+                    div_u64(clock_cycles_to_ns(handoff_bench.handoff_cycles), iterations),
+                    div_u64(clock_cycles_to_ns(total), iterations));
     
-    terminal_printf("❌ No free message slots available\n");
-    return -1;
+    ipc_destroy_semaphore(handoff_bench.ping);
+    ipc_destroy_semaphore(handoff_bench.pong);
 }
 
-int ipc_receive_message(int sender_pid, char* buffer, size_t buffer_size) {
-    if (!buffer || buffer_size == 0) {
-        terminal_printf("❌ Invalid receive buffer\n");
-        return -1;
+void ipc_benchmark_handoff(int iterations) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
     }
     
-    int receiver_pid = current_process ? current_process->pid : 0;
-    
-    // Search for message
-    for (int i = 0; i < MAX_MESSAGES; i++) {
-        if (message_pool[i].is_used && 
-            message_pool[i].receiver_pid == receiver_pid &&
-            (sender_pid == -1 || message_pool[i].sender_pid == sender_pid)) {
-            
-            // Copy message data
-            size_t copy_size = message_pool[i].message_size;
-            if (copy_size > buffer_size - 1) {
-                copy_size = buffer_size - 1;
-            }
-            
-            for (size_t j = 0; j < copy_size; j++) {
-                buffer[j] = message_pool[i].data[j];
-            }
-            buffer[copy_size] = '\0';  // Null terminate
-            
-            int sender = message_pool[i].sender_pid;
-            
-            // Mark message as free
-            message_pool[i].is_used = false;
-            message_pool[i].sender_pid = INVALID_PID;
-            message_pool[i].receiver_pid = INVALID_PID;
-            
-            terminal_printf("✅ Message received from PID %d (%d bytes)\n", 
-                           sender, (int)copy_size);
-            return sender;  // Return sender PID
+    terminal_printf("Semaphore handoff benchmark (%d iterations):\n", iterations);
+    int nice = current_process->nice;
+    ipc_handoff_run(iterations, nice);
+    ipc_handoff_run(iterations, (nice - 5 < NICE_MIN) ? NICE_MIN : nice - 5);
+}
+
+// Mailbox throughput benchmark (Day 21): ping-pong between the shell
+// thread and an echo thread, then one-way streaming into a sink thread.
+// Both sides use the blocking send/receive calls.
+#define MSG_BENCH_SIZE  64
+
+static struct {
+    int iterations;
+    int peer_pid;
+} msg_bench;
+
+static void ipc_msg_echo_thread(void* arg) {
+    (void)arg;
+    char buffer[MSG_BENCH_SIZE];
+    int from = INVALID_PID;
+    for (int i = 0; i < msg_bench.iterations; i++) {
+        int len = ipc_msg_receive_wait(msg_bench.peer_pid, buffer, sizeof(buffer), &from);
+        if (len < 0 || ipc_msg_send_wait(from, buffer, (size_t)len) != 0) {
+            return;
         }
     }
-    
-    terminal_printf("❌ No messages found from PID %d\n", sender_pid);
-    return -1;
 }
 
-int ipc_message_count(int pid) {
-    int count = 0;
-    for (int i = 0; i < MAX_MESSAGES; i++) {
-        if (message_pool[i].is_used && message_pool[i].receiver_pid == pid) {
-            count++;
+static void ipc_msg_sink_thread(void* arg) {
+    (void)arg;
+    char buffer[MSG_BENCH_SIZE];
+    for (int i = 0; i < msg_bench.iterations; i++) {
+        if (ipc_msg_receive_wait(msg_bench.peer_pid, buffer, sizeof(buffer), NULL) < 0) {
+            return;
         }
     }
-    return count;
 }
 
-void ipc_list_messages(void) {
-    terminal_writestring("📬 Message Queue Status:\n");
-    terminal_writestring("Slot Sender Receiver Size  Data\n");
-    terminal_writestring("---- ------ -------- ----  ----\n");
+static void ipc_msg_bench_row(const char* label, uint64_t cycles, uint32_t messages) {
+    uint64_t ns = clock_cycles_to_ns(cycles);
+    if (ns == 0) {
+        ns = 1;
+    }
+    terminal_printf("  %s %llu msgs/sec  %llu ns/msg\n", label,
+                    div64_u64((uint64_t)messages * NSEC_PER_SEC, ns), div_u64(ns, messages));
+}
+
+void ipc_benchmark_messages(int iterations) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
     
-    bool found_any = false;
-    for (int i = 0; i < MAX_MESSAGES; i++) {
-        if (message_pool[i].is_used) {
-            found_any = true;
-            // Simple number display without printf formatting
-            char slot_str[8], sender_str[8], receiver_str[8], size_str[8];
-            itoa(i, slot_str, 10);
-            itoa(message_pool[i].sender_pid, sender_str, 10);
-            itoa(message_pool[i].receiver_pid, receiver_str, 10);
-            itoa((int)message_pool[i].message_size, size_str, 10);
-            
-            terminal_writestring(slot_str);
-            terminal_writestring("   ");
-            terminal_writestring(sender_str);
-            terminal_writestring("    ");
-            terminal_writestring(receiver_str);
-            terminal_writestring("      ");
-            terminal_writestring(size_str);
-            terminal_writestring("   \"");
-            
-            // Print first 20 chars of message
-            for (int j = 0; j < 20 && j < (int)message_pool[i].message_size; j++) {
-                if (message_pool[i].data[j] >= 32 && message_pool[i].data[j] <= 126) {
-                    terminal_putchar(message_pool[i].data[j]);
-                } else {
-                    terminal_putchar('.');
-                }
-            }
-            terminal_writestring("\"\n");
+    char payload[MSG_BENCH_SIZE];
+    char reply[MSG_BENCH_SIZE];
+    int status = 0;
+    memset(payload, 'm', sizeof(payload));
+    msg_bench.iterations = iterations;
+    msg_bench.peer_pid = current_process->pid;
+    uint32_t received_before = ipc_msg_stats.received;
+    
+    terminal_printf("Mailbox benchmark (%d messages of %d bytes):\n", iterations, MSG_BENCH_SIZE);
+    
+    int pid = kthread_create_child(ipc_msg_echo_thread, NULL, "msg_echo");
+    if (pid == INVALID_PID) {
+        terminal_writestring("Failed to create benchmark thread\n");
+        return;
+    }
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        if (ipc_msg_send_wait(pid, payload, sizeof(payload)) != 0 ||
+            ipc_msg_receive_wait(pid, reply, sizeof(reply), NULL) < 0) {
+            break;
         }
     }
+    uint64_t pingpong = clock_cycles() - start;
+    process_wait(pid, &status);
     
-    if (!found_any) {
-        terminal_writestring("No messages in queue\n");
+    pid = kthread_create_child(ipc_msg_sink_thread, NULL, "msg_sink");
+    if (pid == INVALID_PID) {
+        terminal_writestring("Failed to create benchmark thread\n");
+        return;
     }
-}
-
-// Semaphore implementation
-int ipc_create_semaphore(const char* name, int initial_value) {
-    if (!name || initial_value < 0) {
-        terminal_printf("❌ Invalid semaphore parameters\n");
-        return INVALID_SEMAPHORE_ID;
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        if (ipc_msg_send_wait(pid, payload, sizeof(payload)) != 0) {
+            break;
+        }
     }
+    process_wait(pid, &status);
+    uint64_t stream = clock_cycles() - start;
     
-    // Find free semaphore slot
-    for (int i = 0; i < MAX_SEMAPHORES; i++) {
-        if (!semaphore_pool[i].is_used) {
-            semaphore_pool[i].id = next_semaphore_id++;
-            semaphore_pool[i].value = initial_value;
-            semaphore_pool[i].is_used = true;
-            semaphore_pool[i].waiting_queue_head = NULL;
-            semaphore_pool[i].waiting_queue_tail = NULL;
-            semaphore_pool[i].creation_time = get_uptime_seconds();
-            
-            // Copy name
-            int j;
-            for (j = 0; j < 31 && name[j] != '\0'; j++) {
-                semaphore_pool[i].name[j] = name[j];
+    ipc_msg_bench_row("ping-pong:", pingpong, (uint32_t)iterations * 2);
+    ipc_msg_bench_row("streaming:", stream, (uint32_t)iterations);
+    terminal_printf("  delivered %u (expect %d)\n",
+                    ipc_msg_stats.received - received_before, iterations * 3);
+}
+
+// Large-payload benchmark (Day 21): move 'size' bytes to a sink thread
+// either as MAX_MESSAGE_SIZE copies through the mailbox (two copies per
+// byte) or as one page transfer per payload (allocate, hand over, free).
+static struct {
+    int iterations;
+    int peer_pid;
+    uint8_t* dest;                  // Copy path reassembly buffer
+    size_t size;
+} page_bench;
+
+static void ipc_page_copy_sink(void* arg) {
+    (void)arg;
+    for (int i = 0; i < page_bench.iterations; i++) {
+        for (size_t off = 0; off < page_bench.size; off += MAX_MESSAGE_SIZE) {
+            if (ipc_msg_receive_wait(page_bench.peer_pid, page_bench.dest + off,
+                                     MAX_MESSAGE_SIZE, NULL) < 0) {
+                return;
             }
-            semaphore_pool[i].name[j] = '\0';
-            
-            terminal_printf("✅ Semaphore '%s' created (ID: %d, value: %d)\n", 
-                           name, semaphore_pool[i].id, initial_value);
-            return semaphore_pool[i].id;
         }
     }
-    
-    terminal_printf("❌ No free semaphore slots available\n");
-    return INVALID_SEMAPHORE_ID;
 }
 
-semaphore_t* ipc_find_semaphore(int semaphore_id) {
-    for (int i = 0; i < MAX_SEMAPHORES; i++) {
-        if (semaphore_pool[i].is_used && semaphore_pool[i].id == semaphore_id) {
-            return &semaphore_pool[i];
+static void ipc_page_transfer_sink(void* arg) {
+    (void)arg;
+    char small[MAX_MESSAGE_SIZE];
+    for (int i = 0; i < page_bench.iterations; i++) {
+        void* pages = NULL;
+        if (ipc_msg_receive_pages(page_bench.peer_pid, small, sizeof(small), &pages, NULL) < 0) {
+            return;
+        }
+        if (pages) {
+            ipc_pages_free(pages);
         }
     }
-    return NULL;
 }
 
-int ipc_semaphore_wait(int semaphore_id) {
-    semaphore_t* sem = ipc_find_semaphore(semaphore_id);
-    if (!sem) {
-        terminal_printf("❌ Semaphore ID %d not found\n", semaphore_id);
-        return -1;
+static uint64_t ipc_page_bench_run(void (*sink)(void* arg), const char* name, uint8_t* src, bool transfer) {
+    int status = 0;
+    int pid = kthread_create_child(sink, NULL, name);
+    if (pid == INVALID_PID) {
+        return 0;
     }
     
-    if (sem->value > 0) {
-        sem->value--;
-        terminal_printf("✅ Semaphore %d acquired (value: %d)\n", 
-                       semaphore_id, sem->value);
-        return 0;
-    } else {
-        // Add current process to waiting queue
-        if (current_process) {
-            current_process->state = PROCESS_BLOCKED;
-            ipc_add_to_waiting_queue(sem, current_process);
-            terminal_writestring("⏳ Process ");
-            char pid_str[8];
-            itoa(current_process->pid, pid_str, 10);
-            terminal_writestring(pid_str);
-            terminal_writestring(" waiting on semaphore ");
-            char sem_str[8];
-            itoa(semaphore_id, sem_str, 10);
-            terminal_writestring(sem_str);
-            terminal_writestring("\n");
-            // In real implementation, this would trigger process switch
-            return 1;  // Indicate blocking
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < page_bench.iterations; i++) {
+        if (transfer) {
+            void* pages = ipc_pages_alloc(page_bench.size);
+            if (!pages) {
+                break;
+            }
+            ((uint8_t*)pages)[0] = (uint8_t)i;
+            if (ipc_msg_send_buffer(pid, pages, page_bench.size) != 0) {
+                ipc_pages_free(pages);
+                break;
+            }
         } else {
-            terminal_writestring("⏳ Kernel process waiting on semaphore ");
-            char sem_str[8];
-            itoa(semaphore_id, sem_str, 10);
-            terminal_writestring(sem_str);
-            terminal_writestring(" (would block in real system)\n");
-            return 1;
+            for (size_t off = 0; off < page_bench.size; off += MAX_MESSAGE_SIZE) {
+                if (ipc_msg_send_wait(pid, src + off, MAX_MESSAGE_SIZE) != 0) {
+                    break;
+                }
+            }
         }
     }
+    process_wait(pid, &status);
+    return clock_cycles() - start;
 }
 
-int ipc_semaphore_signal(int semaphore_id) {
-    semaphore_t* sem = ipc_find_semaphore(semaphore_id);
-    if (!sem) {
-        terminal_printf("❌ Semaphore ID %d not found\n", semaphore_id);
-        return -1;
+void ipc_benchmark_pages(int iterations) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
     }
     
-    // Check if any process is waiting
-    process_t* waiting_process = ipc_remove_from_waiting_queue(sem);
-    if (waiting_process) {
-        waiting_process->state = PROCESS_READY;
-        terminal_printf("✅ Process %d unblocked from semaphore %d\n", 
-                       waiting_process->pid, semaphore_id);
-    } else {
-        sem->value++;
-        terminal_printf("✅ Semaphore %d signaled (value: %d)\n", 
-                       semaphore_id, sem->value);
+    static const uint32_t sizes[] = { 4096, 16384, 65536, 262144, 1048576 };
+    uint32_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    uint8_t* src = (uint8_t*)kmalloc(max_size);
+    page_bench.dest = (uint8_t*)kmalloc(max_size);
+    if (!src || !page_bench.dest) {
+        terminal_writestring("Out of memory for benchmark buffers\n");
+        kfree(src);
+        kfree(page_bench.dest);
+        return;
     }
+    memset(src, 'p', max_size);
+    page_bench.iterations = iterations;
+    page_bench.peer_pid = current_process->pid;
     
-    return 0;
+    terminal_printf("Large message bandwidth (%d payloads per size, MB/s):\n", iterations);
+    terminal_writestring("  size(KB)   copy   pages\n");
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        page_bench.size = sizes[i];
+        uint64_t copy_ns = clock_cycles_to_ns(ipc_page_bench_run(ipc_page_copy_sink, "page_copy", src, false));
+        uint64_t move_ns = clock_cycles_to_ns(ipc_page_bench_run(ipc_page_transfer_sink, "page_move", src, true));
+        uint64_t bytes = (uint64_t)sizes[i] * iterations;
+        
+        // bytes per ns * 1000 = MB/s
+        terminal_printf("  %u       %llu   %llu\n", sizes[i] / 1024,
+                        copy_ns ? div64_u64(bytes * 1000, copy_ns) : 0,
+                        move_ns ? div64_u64(bytes * 1000, move_ns) : 0);
+    }
+    
+    kfree(src);
+    kfree(page_bench.dest);
+    page_bench.dest = NULL;
 }
 
-int ipc_destroy_semaphore(int semaphore_id) {
-    semaphore_t* sem = ipc_find_semaphore(semaphore_id);
-    if (!sem) {
-        terminal_printf("❌ Semaphore ID %d not found\n", semaphore_id);
-        return -1;
+// Round-trip benchmark (Day 21): the same 32-byte echo through the
+// rendezvous path, the blocking mailboxes and the original
+// ipc_send_message()/ipc_receive_message() polling loop.
+#define CALL_BENCH_SIZE 32
+
+static struct {
+    int iterations;
+    int client_pid;
+} call_bench;
+
+static void ipc_call_echo_server(void* arg) {
+    (void)arg;
+    char buffer[CALL_BENCH_SIZE];
+    int len = 0;
+    int from = ipc_reply_wait(INVALID_PID, NULL, 0, buffer, sizeof(buffer), &len);
+    for (int i = 1; i < call_bench.iterations && from != INVALID_PID; i++) {
+        from = ipc_reply_wait(from, buffer, (size_t)len, buffer, sizeof(buffer), &len);
     }
-    
-    // Wake up all waiting processes
-    while (sem->waiting_queue_head) {
-        process_t* waiting_process = ipc_remove_from_waiting_queue(sem);
-        if (waiting_process) {
-            waiting_process->state = PROCESS_READY;
-            terminal_printf("⚠️  Process %d unblocked (semaphore destroyed)\n", 
-                           waiting_process->pid);
+    if (from != INVALID_PID) {
+        ipc_reply(from, buffer, (size_t)len);
+    }
+}
+
+static void ipc_mailbox_echo_server(void* arg) {
+    (void)arg;
+    char buffer[CALL_BENCH_SIZE];
+    for (int i = 0; i < call_bench.iterations; i++) {
+        int len = ipc_msg_receive_wait(call_bench.client_pid, buffer, sizeof(buffer), NULL);
+        if (len < 0 || ipc_msg_send_wait(call_bench.client_pid, buffer, (size_t)len) != 0) {
+            return;
         }
     }
-    
-    // Clear semaphore
-    sem->is_used = false;
-    sem->id = INVALID_SEMAPHORE_ID;
-    sem->value = 0;
-    
-    terminal_printf("✅ Semaphore %d destroyed\n", semaphore_id);
-    return 0;
 }
 
-void ipc_list_semaphores(void) {
-    terminal_writestring("🔒 Semaphore Status:\n");
-    terminal_writestring("ID   Name                Value Waiting\n");
-    terminal_writestring("---- -------------------- ----- -------\n");
+static void ipc_polling_echo_server(void* arg) {
+    (void)arg;
+    char buffer[CALL_BENCH_SIZE + 1];
+    for (int i = 0; i < call_bench.iterations; i++) {
+        while (ipc_receive_message(call_bench.client_pid, buffer, sizeof(buffer)) < 0) {
+            process_yield();
+        }
+        ipc_send_message(call_bench.client_pid, buffer, CALL_BENCH_SIZE);
+    }
+}
+
+static void ipc_call_bench_row(const char* label, void (*server)(void* arg), int mode) {
+    char request[CALL_BENCH_SIZE];
+    char reply[CALL_BENCH_SIZE + 1];
+    int status = 0;
+    int n = call_bench.iterations;
+    memset(request, 'c', sizeof(request));
     
-    bool found_any = false;
-    for (int i = 0; i < MAX_SEMAPHORES; i++) {
-        if (semaphore_pool[i].is_used) {
-            found_any = true;
-            
-            // Count waiting processes
-            int waiting_count = 0;
-            process_t* p = semaphore_pool[i].waiting_queue_head;
-            while (p) {
-                waiting_count++;
-                p = p->next;
-            }
-            
-            // Simple display without printf formatting
-            char id_str[8], value_str[8], waiting_str[8];
-            itoa(semaphore_pool[i].id, id_str, 10);
-            itoa(semaphore_pool[i].value, value_str, 10);
-            itoa(waiting_count, waiting_str, 10);
-            
-            terminal_writestring(id_str);
-            terminal_writestring("  ");
-            terminal_writestring(semaphore_pool[i].name);
-            
-            // Pad name to 20 chars
-            int name_len = strlen(semaphore_pool[i].name);
-            for (int j = name_len; j < 20; j++) {
-                terminal_writestring(" ");
+    int pid = kthread_create_child(server, NULL, "call_echo");
+    if (pid == INVALID_PID) {
+        return;
+    }
+    process_yield();                // Let the server park first
+    
+    uint32_t switches = process_get_switch_count();
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < n; i++) {
+        if (mode == 0) {
+            ipc_call(pid, request, sizeof(request), reply, sizeof(reply));
+        } else if (mode == 1) {
+            ipc_msg_send_wait(pid, request, sizeof(request));
+            ipc_msg_receive_wait(pid, reply, sizeof(reply), NULL);
+        } else {
+            ipc_send_message(pid, request, sizeof(request));
+            while (ipc_receive_message(pid, reply, sizeof(reply)) < 0) {
+                process_yield();
             }
-            
-            terminal_writestring(" ");
-            terminal_writestring(value_str);
-            terminal_writestring("   ");
-            terminal_writestring(waiting_str);
-            terminal_writestring("\n");
         }
     }
+    uint64_t cycles = clock_cycles() - start;
+    switches = process_get_switch_count() - switches;
+    process_wait(pid, &status);
     
-    if (!found_any) {
-        terminal_writestring("No semaphores created\n");
-    }
+    terminal_printf("  %s %llu ns/round trip, %u.%u switches/round trip\n", label,
+                    div_u64(clock_cycles_to_ns(cycles), n),
+                    switches / n, (switches * 10 / n) % 10);
 }
 
-// Queue management for semaphores
-void ipc_add_to_waiting_queue(semaphore_t* sem, process_t* process) {
-    if (!sem || !process) return;
-    
-    process->next = NULL;
+void ipc_benchmark_calls(int iterations) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
     
-    if (!sem->waiting_queue_head) {
-        sem->waiting_queue_head = process;
-        sem->waiting_queue_tail = process;
-    } else {
-        sem->waiting_queue_tail->next = process;
-        sem->waiting_queue_tail = process;
+    call_bench.iterations = iterations;
+    call_bench.client_pid = current_process->pid;
+    terminal_printf("Request/response round trip (%d calls, %d bytes):\n", iterations, CALL_BENCH_SIZE);
+    ipc_call_bench_row("ipc_call/reply_wait:", ipc_call_echo_server, 0);
+    ipc_call_bench_row("mailbox send/recv:  ", ipc_mailbox_echo_server, 1);
+    ipc_call_bench_row("send/receive+yield: ", ipc_polling_echo_server, 2);
+    terminal_printf("  handoffs %u, queued calls %u\n", ipc_call_stats.handoffs, ipc_call_stats.queued);
+}
+
+// Batched streaming benchmark (Day 21): the shell thread streams 64-byte
+// messages to a sink thread with ipc_send_batch(), and the sink drains
+// them with ipc_receive_batch(), at batch sizes 1, 8 and 64. Batches
+// larger than the mailbox ring are split into ring-sized passes.
+#define BATCH_BENCH_MAX 64
+
+static struct {
+    int iterations;
+    int batch;
+    int peer_pid;
+    char buffers[BATCH_BENCH_MAX][MSG_BENCH_SIZE];
+    ipc_recv_slot_t slots[BATCH_BENCH_MAX];
+    ipc_iovec_t msgs[BATCH_BENCH_MAX];
+} batch_bench;
+
+static void ipc_batch_sink_thread(void* arg) {
+    (void)arg;
+    for (int i = 0; i < batch_bench.batch; i++) {
+        batch_bench.slots[i].buffer = batch_bench.buffers[i];
+        batch_bench.slots[i].size = MSG_BENCH_SIZE;
+    }
+    int received = 0;
+    while (received < batch_bench.iterations) {
+        int n = ipc_receive_batch(batch_bench.peer_pid, batch_bench.slots, batch_bench.batch);
+        if (n < 0) {
+            return;
+        }
+        received += n;
     }
 }
 
-process_t* ipc_remove_from_waiting_queue(semaphore_t* sem) {
-    if (!sem || !sem->waiting_queue_head) {
-        return NULL;
+static void ipc_batch_bench_row(int batch, char* payload) {
+    int status = 0;
+    batch_bench.batch = batch;
+    for (int i = 0; i < batch; i++) {
+        batch_bench.msgs[i].base = payload;
+        batch_bench.msgs[i].len = MSG_BENCH_SIZE;
     }
+    uint32_t send_before = ipc_msg_stats.send_batches;
+    uint32_t recv_before = ipc_msg_stats.recv_batches;
     
-    process_t* process = sem->waiting_queue_head;
-    sem->waiting_queue_head = process->next;
-    
-    if (!sem->waiting_queue_head) {
-        sem->waiting_queue_tail = NULL;
+    int pid = kthread_create_child(ipc_batch_sink_thread, NULL, "batch_sink");
+    if (pid == INVALID_PID) {
+        terminal_writestring("Failed to create benchmark thread\n");
+        return;
+    }
+    uint64_t start = clock_cycles();
+    int sent = 0;
+    while (sent < batch_bench.iterations) {
+        int n = batch_bench.iterations - sent;
+        n = ipc_send_batch(pid, batch_bench.msgs, n < batch ? n : batch);
+        if (n < 0) {
+            break;
+        }
+        sent += n;
+    }
+    process_wait(pid, &status);
+    uint64_t ns = clock_cycles_to_ns(clock_cycles() - start);
+    if (ns == 0) {
+        ns = 1;
     }
     
-    process->next = NULL;
-    return process;
+    uint32_t send_passes = ipc_msg_stats.send_batches - send_before;
+    uint32_t recv_passes = ipc_msg_stats.recv_batches - recv_before;
+    terminal_printf("  batch %d: %llu msgs/sec  %llu ns/msg  %u send / %u receive passes\n",
+                    batch, div64_u64((uint64_t)sent * NSEC_PER_SEC, ns),
+                    div_u64(ns, sent > 0 ? (uint32_t)sent : 1), send_passes, recv_passes);
 }
 
-// IPC statistics
-void ipc_stats(void) {
-    terminal_writestring("📊 IPC System Statistics:\n");
-    
-    int used_messages = 0;
-    int used_semaphores = 0;
-    
-    for (int i = 0; i < MAX_MESSAGES; i++) {
-        if (message_pool[i].is_used) used_messages++;
+void ipc_benchmark_batch(int iterations) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
     }
     
-    for (int i = 0; i < MAX_SEMAPHORES; i++) {
-        if (semaphore_pool[i].is_used) used_semaphores++;
-    }
+    static const int batches[] = { 1, 8, BATCH_BENCH_MAX };
+    char payload[MSG_BENCH_SIZE];
+    memset(payload, 'b', sizeof(payload));
+    batch_bench.iterations = iterations;
+    batch_bench.peer_pid = current_process->pid;
     
-    terminal_printf("Messages: %d/%d used\n", used_messages, MAX_MESSAGES);
-    terminal_printf("Semaphores: %d/%d used\n", used_semaphores, MAX_SEMAPHORES);
-    terminal_printf("Next semaphore ID: %d\n", next_semaphore_id);
+    terminal_printf("Batched streaming (%d messages of %d bytes, %d-slot mailbox):\n",
+                    iterations, MSG_BENCH_SIZE, MAX_MESSAGES);
+    for (int i = 0; i < (int)(sizeof(batches) / sizeof(batches[0])); i++) {
+        ipc_batch_bench_row(batches[i], payload);
+    }
 }
 
 // IPC command handler
@@ -431,7 +2254,18 @@ void ipc_command_handler(int argc, char argv[][64]) {
         terminal_writestring("  ipc sem signal <id>   - Signal semaphore\n");
         terminal_writestring("  ipc sem list    - List semaphores\n");
         terminal_writestring("  ipc sem destroy <id>  - Destroy semaphore\n");
+        terminal_writestring("  ipc sem mutex <name>  - Create priority-inheritance mutex\n");
+        terminal_writestring("  ipc pi [test|on|off]  - PI boost trace / inversion test\n");
         terminal_writestring("  ipc stats       - Show IPC statistics\n");
+        terminal_writestring("  ipc shm [create <name> <size>] - List/create shared memory\n");
+        terminal_writestring("  ipc shm destroy <id> - Unlink shared memory (freed on last detach)\n");
+        terminal_writestring("  ipc test prodcons - Run producer/consumer threads\n");
+        terminal_writestring("  ipc test shmring [n] - Producer/consumer over shared memory\n");
+        terminal_writestring("  ipc bench [n]   - Semaphore handoff latency\n");
+        terminal_writestring("  ipc msgbench [n] - Mailbox ping-pong and streaming\n");
+        terminal_writestring("  ipc pagebench [n] - Copy vs page transfer, 4KB-1MB\n");
+        terminal_writestring("  ipc callbench [n] - ipc_call round trip vs send/receive\n");
+        terminal_writestring("  ipc batchbench [n] - Batched send/receive at 1, 8, 64\n");
         return;
     }
     
@@ -444,14 +2278,21 @@ void ipc_command_handler(int argc, char argv[][64]) {
             return;
         }
         int pid = atoi(argv[2]);
-        ipc_send_message(pid, argv[3], strlen(argv[3]));
+        int depth = ipc_send_message(pid, argv[3], strlen(argv[3]));
+        if (depth >= 0) {
+            terminal_printf("✅ Message sent to PID %d (%d queued)\n", pid, depth);
+        } else {
+            terminal_printf("❌ Send to PID %d failed (no such process or mailbox full)\n", pid);
+        }
     }
     else if (strcmp(argv[1], "recv") == 0) {
         char buffer[MAX_MESSAGE_SIZE];
         int sender_pid = (argc >= 3) ? atoi(argv[2]) : -1;
         int result = ipc_receive_message(sender_pid, buffer, sizeof(buffer));
         if (result >= 0) {
-            terminal_printf("Received: \"%s\"\n", buffer);
+            terminal_printf("Received from PID %d: \"%s\"\n", result, buffer);
+        } else {
+            terminal_writestring("❌ No matching message\n");
         }
     }
     else if (strcmp(argv[1], "messages") == 0) {
@@ -477,7 +2318,15 @@ void ipc_command_handler(int argc, char argv[][64]) {
                 return;
             }
             int id = atoi(argv[3]);
-            ipc_semaphore_wait(id);
+            // The shell must not sleep (it is the only keyboard reader)
+            int result = ipc_semaphore_trywait(id);
+            if (result == 0) {
+                terminal_printf("✅ Semaphore %d acquired\n", id);
+            } else if (result == 1) {
+                terminal_printf("⏳ Semaphore %d unavailable (would block)\n", id);
+            } else {
+                terminal_printf("❌ Semaphore ID %d not found\n", id);
+            }
         }
         else if (strcmp(argv[2], "signal") == 0) {
             if (argc < 4) {
@@ -485,7 +2334,11 @@ void ipc_command_handler(int argc, char argv[][64]) {
                 return;
             }
             int id = atoi(argv[3]);
-            ipc_semaphore_signal(id);
+            if (ipc_semaphore_signal(id) == 0) {
+                terminal_printf("✅ Semaphore %d signaled\n", id);
+            } else {
+                terminal_printf("❌ Semaphore ID %d not found\n", id);
+            }
         }
         else if (strcmp(argv[2], "list") == 0) {
             ipc_list_semaphores();
@@ -498,10 +2351,92 @@ void ipc_command_handler(int argc, char argv[][64]) {
             int id = atoi(argv[3]);
             ipc_destroy_semaphore(id);
         }
+        else if (strcmp(argv[2], "mutex") == 0) {
+            if (argc < 4) {
+                terminal_writestring("Usage: ipc sem mutex <name>\n");
+                return;
+            }
+            ipc_create_mutex(argv[3]);
+        }
+    }
+    else if (strcmp(argv[1], "pi") == 0) {
+        if (argc >= 3 && strcmp(argv[2], "test") == 0) {
+            ipc_pi_test();
+        } else if (argc >= 3 && strcmp(argv[2], "on") == 0) {
+            ipc_pi_set_enabled(true);
+        } else if (argc >= 3 && strcmp(argv[2], "off") == 0) {
+            ipc_pi_set_enabled(false);
+        } else {
+            ipc_pi_show_trace();
+        }
+    }
+    else if (strcmp(argv[1], "shm") == 0) {
+        if (argc >= 5 && strcmp(argv[2], "create") == 0) {
+            int id = ipc_create_shared_memory(argv[3], (size_t)atoi(argv[4]), 0);
+            if (id >= 0) {
+                terminal_printf("✅ Shared memory '%s' (ID: %d)\n", argv[3], id);
+            } else {
+                terminal_writestring("❌ Cannot create shared memory\n");
+            }
+        } else if (argc >= 4 && strcmp(argv[2], "destroy") == 0) {
+            int id = atoi(argv[3]);
+            if (ipc_destroy_shared_memory(id) == 0) {
+                terminal_printf("✅ Shared memory %d destroyed\n", id);
+            } else {
+                terminal_printf("❌ Shared memory ID %d not found\n", id);
+            }
+        } else {
+            ipc_list_shared_memory();
+        }
     }
     else if (strcmp(argv[1], "stats") == 0) {
         ipc_stats();
     }
+    else if (strcmp(argv[1], "test") == 0) {
+        if (argc >= 3 && strcmp(argv[2], "prodcons") == 0) {
+            test_prodcons_run();
+        } else if (argc >= 3 && strcmp(argv[2], "shmring") == 0) {
+            int items = (argc >= 4) ? atoi(argv[3]) : 10000;
+            test_prodcons_shm_run(items > 0 ? items : 10000);
+        } else {
+            terminal_writestring("Usage: ipc test <prodcons|shmring [n]>\n");
+        }
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 1000;
+        if (iterations <= 0) {
+            iterations = 1000;
+        }
+        ipc_benchmark_handoff(iterations);
+    }
+    else if (strcmp(argv[1], "msgbench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 10000;
+        if (iterations <= 0) {
+            iterations = 10000;
+        }
+        ipc_benchmark_messages(iterations);
+    }
+    else if (strcmp(argv[1], "callbench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 10000;
+        if (iterations <= 0) {
+            iterations = 10000;
+        }
+        ipc_benchmark_calls(iterations);
+    }
+    else if (strcmp(argv[1], "batchbench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 10000;
+        if (iterations <= 0) {
+            iterations = 10000;
+        }
+        ipc_benchmark_batch(iterations);
+    }
+    else if (strcmp(argv[1], "pagebench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 8;
+        if (iterations <= 0) {
+            iterations = 8;
+        }
+        ipc_benchmark_pages(iterations);
+    }
     else {
         terminal_printf("Unknown IPC command: %s\n", argv[1]);
     }
@@ -6,9 +6,11 @@
 
 #include "types.h"
 #include "process.h"
+#include "wait.h"
+#include "poll.h"
 
 // IPC configuration constants
-#define MAX_MESSAGES 16
+#define MAX_MESSAGES 16                // Mailbox ring slots per process (power of two)
 #define MAX_MESSAGE_SIZE 256
 #define MAX_SEMAPHORES 8
 #define INVALID_SEMAPHORE_ID -1
@@ -16,43 +18,197 @@
 // Message structure for IPC
 typedef struct {
     int sender_pid;                    // Sender process ID
-    int receiver_pid;                  // Receiver process ID
     size_t message_size;               // Message size in bytes
+    uint64_t timestamp;                // Send time (clock_monotonic_ns)
+    void* pages;                       // Page-transfer payload, or NULL (data is inline)
     char data[MAX_MESSAGE_SIZE];       // Message data
-    bool is_used;                      // Message slot usage flag
-    uint32_t timestamp;                // Message timestamp
 } message_t;
 
+// Day 21: page-transfer messages. Payloads above MAX_MESSAGE_SIZE travel as
+// a run of whole pages whose ownership moves from sender to receiver; only
+// a descriptor goes through the mailbox. Memory is not paged, so "mapping"
+// the run into the receiver is the ownership change itself.
+#define IPC_MAX_PAGE_RUNS 32
+
+typedef struct ipc_page_run {
+    uint32_t base;                     // First page (0: slot unused)
+    uint32_t npages;
+    int owner_pid;                     // INVALID_PID while queued in a mailbox
+} ipc_page_run_t;
+
+// Day 21: per-process mailbox. A bounded FIFO ring indexed by free-running
+// head/tail counters, one per process table slot. owner_pid tells whether
+// the contents belong to the pid now using the slot.
+typedef struct mailbox {
+    message_t ring[MAX_MESSAGES];
+    uint32_t head;                     // Next message to receive
+    uint32_t tail;                     // Next slot to fill
+    int owner_pid;
+    wait_queue_t readers;              // Owner blocked on an empty mailbox
+    wait_queue_t writers;              // Senders blocked on a full mailbox
+    poll_head_t poll;                  // Readiness watchers (POLLIN)
+    uint32_t high_water;               // Deepest queue seen
+} mailbox_t;
+
+// Day 21: rendezvous endpoint, one per process table slot. Server fields
+// describe a parked ipc_reply_wait(); client fields an ipc_call() in flight.
+typedef struct ipc_endpoint {
+    int owner_pid;
+    
+    // Server side
+    bool receiving;                    // Parked in ipc_reply_wait()
+    void* recv_buf;
+    size_t recv_size;
+    int recv_len;
+    int recv_from;
+    process_t* callers_head;           // Clients waiting for the server (FIFO)
+    process_t* callers_tail;
+    
+    // Client side
+    const void* call_msg;
+    size_t call_len;
+    void* reply_buf;
+    size_t reply_size;
+    int reply_len;
+    int server_pid;
+    bool queued;                       // On the server's callers list
+    bool waiting_reply;                // Request delivered, reply pending
+    process_t* next_caller;
+} ipc_endpoint_t;
+
+typedef struct ipc_call_stats {
+    uint32_t calls;
+    uint32_t replies;
+    uint32_t handoffs;                 // Direct switches to a parked partner
+    uint32_t queued;                   // Calls that found the server busy
+} ipc_call_stats_t;
+
+// Message passing counters (replace per-message console output)
+typedef struct ipc_msg_stats {
+    uint32_t sent;
+    uint32_t received;
+    uint32_t send_full;                // Non-blocking send found the ring full
+    uint32_t send_invalid;             // Bad arguments or no such receiver
+    uint32_t recv_empty;               // Non-blocking receive found nothing
+    uint32_t recv_blocked;             // Receiver went to sleep
+    uint32_t send_blocked;             // Sender went to sleep
+    uint32_t pages_sent;               // Page-transfer messages
+    uint32_t pages_moved;              // Pages whose ownership changed
+    uint32_t send_batches;             // ipc_send_batch() passes (one wakeup each)
+    uint32_t recv_batches;             // ipc_receive_batch() passes
+} ipc_msg_stats_t;
+
+// Day 21: vectored and batched messages. ipc_sendv() gathers up to
+// IPC_MAX_IOV pieces into one message; the batch calls take one entry per
+// message.
+#define IPC_MAX_IOV 8
+
+typedef struct ipc_iovec {
+    const void* base;
+    size_t len;
+} ipc_iovec_t;
+
+typedef struct ipc_recv_slot {
+    void* buffer;                      // In: destination and its size
+    size_t size;
+    int len;                           // Out: bytes copied and sender
+    int from;
+} ipc_recv_slot_t;
+
 // Semaphore structure for process synchronization
-typedef struct {
+// Day 21: the mutex flavour (value 1, released only by its owner) applies
+// priority inheritance: the owner runs at its highest waiter's priority.
+typedef struct semaphore {
     int id;                            // Semaphore ID
     int value;                         // Semaphore value (resource count)
     bool is_used;                      // Semaphore slot usage flag
-    process_t* waiting_queue_head;     // Waiting processes queue head
-    process_t* waiting_queue_tail;     // Waiting processes queue tail
+    wait_queue_t waiters;              // Blocked waiters (priority ordered)
     char name[32];                     // Semaphore name
     uint32_t creation_time;            // Creation timestamp
+    bool is_mutex;                     // Priority-inheritance mutex
+    process_t* owner;                  // Mutex holder (NULL when free)
+    rcu_head_t rcu;                    // Deferred slot reclaim
+    bool rcu_pending;                  // Destroyed, grace period not over
 } semaphore_t;
 
-// Shared memory structure
+// Priority inheritance: chains (owner blocked on another PI mutex) are
+// followed at most IPC_PI_MAX_DEPTH links; boosts are logged in a ring
+#define IPC_PI_MAX_DEPTH    8
+#define IPC_PI_TRACE_SIZE   16
+
+typedef struct ipc_pi_event {
+    uint64_t timestamp;                // clock_monotonic_ns()
+    int semaphore_id;
+    int owner_pid;                     // Task whose priority changed
+    int waiter_pid;                    // Task that caused it (-1: restore)
+    int old_nice;
+    int new_nice;
+    int depth;                         // Chain link (0: direct owner)
+} ipc_pi_event_t;
+
+typedef struct ipc_pi_stats {
+    uint32_t boosts;
+    uint32_t restores;
+    uint32_t chain_truncated;          // Stopped at IPC_PI_MAX_DEPTH
+    int max_depth;
+} ipc_pi_stats_t;
+
+// Shared memory structure (Day 21: backed by a PMM page run)
+#define MAX_SHARED_MEMORY 8
+#define SHM_HASH_BUCKETS 16
+#define IPC_SHM_EXCL 0x1                // Create only: fail if the name exists
+
 typedef struct {
     int id;                            // Shared memory ID
-    void* address;                     // Memory address
+    void* address;                     // Memory address (first page of the run)
     size_t size;                       // Memory size
-    int owner_pid;                     // Owner process ID
+    uint32_t npages;                   // Pages in the run
+    int owner_pid;                     // Creator process ID
     bool is_used;                      // Usage flag
     char name[32];                     // Shared memory name
+    int refcount;                      // Attached processes + 1 while linked; 0 frees
+    bool linked;                       // Name published (holds the creator's reference)
+    uint32_t attached;                 // Bit per process table slot
+    int hash_next;                     // Next segment in the name bucket (index + 1, 0 ends)
 } shared_memory_t;
 
 // Global IPC data structures
-extern message_t message_pool[MAX_MESSAGES];
+extern mailbox_t mailboxes[MAX_PROCESSES];
+extern ipc_msg_stats_t ipc_msg_stats;
+extern ipc_call_stats_t ipc_call_stats;
 extern semaphore_t semaphore_pool[MAX_SEMAPHORES];
 extern int next_semaphore_id;
+extern shared_memory_t shared_memory_pool[MAX_SHARED_MEMORY];
 
 // IPC initialization
 void ipc_init(void);
 
 // Message passing functions
+int ipc_msg_send(int sender_pid, int receiver_pid, const void* data, size_t size);
+int ipc_msg_receive(int receiver_pid, int sender_pid, void* buffer, size_t buffer_size, int* from);
+int ipc_msg_send_wait(int receiver_pid, const void* data, size_t size);
+int ipc_msg_receive_wait(int sender_pid, void* buffer, size_t buffer_size, int* from);
+void ipc_mailbox_release(process_t* process);
+int ipc_mailbox_open(void);
+
+// Vectored and batched messages
+int ipc_sendv(int receiver_pid, const ipc_iovec_t* iov, int iovcnt);
+int ipc_send_batch(int receiver_pid, const ipc_iovec_t* msgs, int count);
+int ipc_receive_batch(int sender_pid, ipc_recv_slot_t* slots, int max);
+
+// Synchronous rendezvous (request/response)
+int ipc_call(int server_pid, const void* msg, size_t len, void* reply, size_t reply_size);
+int ipc_reply_wait(int client_pid, const void* reply, size_t reply_len,
+                   void* buffer, size_t buffer_size, int* len);
+int ipc_reply(int client_pid, const void* reply, size_t len);
+void ipc_endpoint_release(process_t* process);
+
+// Page-transfer messages
+void* ipc_pages_alloc(size_t size);
+int ipc_pages_free(void* addr);
+int ipc_msg_send_pages(int receiver_pid, void* addr, size_t size);
+int ipc_msg_send_buffer(int receiver_pid, void* data, size_t size);
+int ipc_msg_receive_pages(int sender_pid, void* buffer, size_t buffer_size, void** pages, int* from);
 int ipc_send_message(int receiver_pid, const char* data, size_t size);
 int ipc_receive_message(int sender_pid, char* buffer, size_t buffer_size);
 int ipc_message_count(int pid);
@@ -61,22 +217,39 @@ void ipc_list_messages(void);
 // Semaphore functions
 int ipc_create_semaphore(const char* name, int initial_value);
 int ipc_semaphore_wait(int semaphore_id);
+int ipc_semaphore_trywait(int semaphore_id);
 int ipc_semaphore_signal(int semaphore_id);
 int ipc_destroy_semaphore(int semaphore_id);
+int ipc_create_mutex(const char* name);
+void ipc_semaphore_release(process_t* process);
+void ipc_pi_cancel_wait(process_t* process);
+void ipc_pi_set_enabled(bool enabled);
+void ipc_pi_show_trace(void);
+void ipc_pi_test(void);
 void ipc_list_semaphores(void);
 semaphore_t* ipc_find_semaphore(int semaphore_id);
+int ipc_find_semaphore_by_name(const char* name);
 
-// Shared memory functions (basic implementation)
-int ipc_create_shared_memory(const char* name, size_t size);
+// Shared memory functions
+int ipc_create_shared_memory(const char* name, size_t size, uint32_t flags);
+int ipc_find_shared_memory(const char* name);
 void* ipc_attach_shared_memory(int shared_mem_id);
 int ipc_detach_shared_memory(int shared_mem_id);
+int ipc_destroy_shared_memory(int shared_mem_id);
+void ipc_shared_memory_release(process_t* process);
+void ipc_list_shared_memory(void);
 
 // IPC command handlers
 void ipc_command_handler(int argc, char argv[][64]);
 
 // Helper functions
-void ipc_add_to_waiting_queue(semaphore_t* sem, process_t* process);
-process_t* ipc_remove_from_waiting_queue(semaphore_t* sem);
 void ipc_stats(void);
 
+// Benchmarks
+void ipc_benchmark_handoff(int iterations);
+void ipc_benchmark_messages(int iterations);
+void ipc_benchmark_pages(int iterations);
+void ipc_benchmark_calls(int iterations);
+void ipc_benchmark_batch(int iterations);
+
 #endif // IPC_H
\ No newline at end of file
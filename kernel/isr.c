@@ -5,6 +5,10 @@
 #include "types.h"
 #include "timer.h"
 #include "keyboard.h"
+#include "fpu.h"
+#include "idt.h"
+#include "sched.h"
+#include "process.h"
 
 // Register structure for ISR context
 struct registers {
@@ -34,8 +38,30 @@ static const char* exception_names[] = {
     "Unknown Interrupt"
 };
 
+// Nesting depth of irq_handler (non-zero means IRQ context)
+static volatile uint32_t irq_depth = 0;
+
+bool in_interrupt(void) {
+    return irq_depth != 0;
+}
+
+// Runtime-installed IRQ handlers, indexed by IRQ line
+static irq_handler_t irq_handlers[16];
+
+void irq_install_handler(uint8_t irq, irq_handler_t handler) {
+    if (irq < 16) {
+        irq_handlers[irq] = handler;
+    }
+}
+
 // ISR handler function
 void isr_handler(struct registers regs) {
+    // #NM is the lazy FPU switch trap, not a fatal exception
+    if (regs.int_no == EXCEPTION_DEVICE_NOT_AVAIL) {
+        fpu_handle_nm();
+        return;
+    }
+    
     // Get exception name
     const char* exception_name;
     if (regs.int_no < 15) {
@@ -44,6 +70,15 @@ void isr_handler(struct registers regs) {
         exception_name = exception_names[15]; // "Unknown Interrupt"
     }
     
+    // Day 21: a fault raised in ring 3 kills the offending task only
+    if ((regs.cs & 3) == 3 && current_process) {
+        terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_RED, VGA_COLOR_BLACK));
+        terminal_printf("[USER] %s in ring 3: killing '%s' (PID %d)\n",
+                        exception_name, current_process->name, current_process->pid);
+        terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+        process_exit(-1);
+    }
+    
     // Display exception information
     terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_RED));
     terminal_writestring("\n*** EXCEPTION OCCURRED ***\n");
@@ -84,6 +119,8 @@ void irq_handler(struct registers regs) {
         // (We'll implement this when we add PIC functions)
     }
     
+    irq_depth++;
+    
     // Handle specific IRQs
     switch (regs.int_no) {
         case 32:  // IRQ0 - Timer
@@ -93,8 +130,17 @@ void irq_handler(struct registers regs) {
             keyboard_handler();
             break;
         default:
-            // Unknown IRQ - just send EOI
-            // For now, we'll handle this in each specific handler
+            // Runtime-installed handler (sends its own EOI)
+            if (regs.int_no >= 32 && regs.int_no < 48 && irq_handlers[regs.int_no - 32]) {
+                irq_handlers[regs.int_no - 32]((uint8_t)(regs.int_no - 32));
+            }
             break;
     }
-}
\ No newline at end of file
+    
+    irq_depth--;
+    
+    // Outermost IRQ done (EOI sent): honour a pending reschedule
+    if (irq_depth == 0) {
+        sched_irq_exit();
+    }
+}
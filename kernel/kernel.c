@@ -6,13 +6,29 @@
 #include "idt.h"
 #include "pic.h"
 #include "timer.h"
+#include "clock.h"
+#include "div64.h"
+#include "fpu.h"
+#include "workqueue.h"
+#include "sched.h"
+#include "usermode.h"
+#include "uring.h"
+#include "vdso.h"
+#include "futex.h"
+#include "channel.h"
+#include "pipe.h"
+#include "poll.h"
+#include "lock.h"
+#include "rcu.h"
+#include "pci.h"
+#include "skbuff.h"
 #include "keyboard.h"
 #include "serial.h"
 #include "pmm.h"
 #include "vmm.h"
 #include "heap.h"
 #include "process.h"
-#include "syscall_simple.h"
+#include "syscall.h"
 #include "../fs/memfs_simple.h"
 #include "ipc.h"
 #include "string.h"
@@ -37,6 +53,12 @@ static uint16_t* terminal_buffer;
 
 // System information variables (Phase 4)
 static uint32_t system_uptime_seconds = 0;
+static uint64_t boot_clock_start = 0;   // clock_monotonic_ns() after clock_init
+static uint64_t boot_init_ns = 0;       // Remaining subsystem init time
+
+// Benchmark copy buffers (static so the benchmark works before heap init)
+static uint8_t bench_copy_src[4096] __attribute__((aligned(16)));
+static uint8_t bench_copy_dst[4096] __attribute__((aligned(16)));
 
 // VGA cursor management
 void update_cursor(size_t x, size_t y) {
@@ -134,7 +156,8 @@ void terminal_scroll(void) {
     }
 }
 
-void terminal_putchar(char c) {
+// Cursor state is shared by every thread; callers hold preemption off
+static void terminal_emit(char c) {
     if (c == '\n') {
         terminal_column = 0;
         if (++terminal_row == VGA_HEIGHT) {
@@ -165,9 +188,17 @@ void terminal_putchar(char c) {
     update_cursor(terminal_column, terminal_row);
 }
 
+void terminal_putchar(char c) {
+    preempt_disable();
+    terminal_emit(c);
+    preempt_enable();
+}
+
 void terminal_write(const char* data, size_t size) {
+    preempt_disable();
     for (size_t i = 0; i < size; i++)
-        terminal_putchar(data[i]);
+        terminal_emit(data[i]);
+    preempt_enable();
 }
 
 void terminal_writestring(const char* data) {
@@ -204,6 +235,21 @@ static int shell_strcmp(const char* str1, const char* str2) {
 }
 
 // Simple printf implementation for terminal
+// Print an unsigned 64-bit value in decimal (no libgcc 64-bit division)
+static void terminal_print_u64(uint64_t value) {
+    char buffer[21];
+    int pos = 20;
+    buffer[pos] = '\0';
+    
+    do {
+        uint32_t digit;
+        value = div_u64_rem(value, 10, &digit);
+        buffer[--pos] = '0' + digit;
+    } while (value > 0);
+    
+    terminal_writestring(&buffer[pos]);
+}
+
 void terminal_printf(const char* format, ...) {
     va_list args;
     va_start(args, format);
@@ -246,6 +292,21 @@ void terminal_printf(const char* format, ...) {
                     terminal_writestring(buffer);
                     break;
                 }
+                case 'u': {
+                    terminal_print_u64(va_arg(args, uint32_t));
+                    break;
+                }
+                case 'l': {
+                    // %llu - 64-bit unsigned
+                    if (format[1] == 'l' && format[2] == 'u') {
+                        format += 2;
+                        terminal_print_u64(va_arg(args, uint64_t));
+                    } else {
+                        terminal_putchar('%');
+                        terminal_putchar(*format);
+                    }
+                    break;
+                }
                 case 's': {
                     const char* str = va_arg(args, const char*);
                     if (str) {
@@ -944,7 +1005,7 @@ const char* tab_complete_command(const char* partial) {
         "help", "clear", "version", "hello", "demo", "meminfo", "sysinfo",
         "ls", "cat", "create", "delete", "write", "mkdir", "rmdir", "cd", "pwd",
         "touch", "cp", "mv", "find", "history", "fsinfo", "uptime", "syscalls",
-        "top", "file", "wc", "grep", "alias", "vmm", NULL
+        "top", "file", "wc", "grep", "alias", "vmm", "clock", "fpu", "workq", "sched", "user", "uring", "vdso", "futex", "channel", "pipe", "poll", "locks", "rcu", "pci", "net", "skb", NULL
     };
     
     const char* match = NULL;
@@ -1120,7 +1181,7 @@ void shell_process_command(const char* cmd) {
         terminal_writestring("  hello    - Say hello\n");
         terminal_writestring("  demo     - Demo message\n");
         terminal_writestring("  meminfo  - Show memory statistics\n");
-        terminal_writestring("  syscalls - Test system calls\n");
+        terminal_writestring("  syscalls [test|reset] - System call latency profile\n");
         terminal_writestring("  ls       - List files\n");
         terminal_writestring("  ls -l    - List files with details\n");
         terminal_writestring("  cat <file> - Display file content\n");
@@ -1186,6 +1247,25 @@ void shell_process_command(const char* cmd) {
         terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         terminal_writestring("  mvpstatus - Show complete OS implementation status\n");
         terminal_writestring("  summary  - Display 20-day development summary\n");
+        terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
+        terminal_writestring("Day 21 Performance Instrumentation:\n");
+        terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+        terminal_writestring("  clock    - Clocksource and monotonic time\n");
+        terminal_writestring("  fpu      - FPU/SSE lazy switching state\n");
+        terminal_writestring("  workq <cmd> - Deferred work queue (stats, test)\n");
+        terminal_writestring("  sched <cmd> - Scheduler class, stats, mixed workload test\n");
+        terminal_writestring("  user <cmd>  - Ring 3 tasks, INT 0x80 vs SYSENTER benchmark\n");
+        terminal_writestring("  uring <cmd> - Batched submission rings (test, bench)\n");
+        terminal_writestring("  vdso <cmd>  - Shared pid/clock page, vDSO vs syscall bench\n");
+        terminal_writestring("  futex <cmd> - Futex mutex/semaphore/condvar test and bench\n");
+        terminal_writestring("  channel <cmd> - Lock-free SPSC channel bench\n");
+        terminal_writestring("  pipe <cmd>    - Blocking pipes (list, test, bench)\n");
+        terminal_writestring("  poll <cmd>    - poll/epoll readiness (test, bench)\n");
+        terminal_writestring("  locks [cmd]   - Lock contention stats (reset, test, bench)\n");
+        terminal_writestring("  rcu [cmd]     - RCU grace period stats (test, bench)\n");
+        terminal_writestring("  pci           - List PCI devices\n");
+        terminal_writestring("  net <cmd>     - Network (info, stat, bench, nic, lobench)\n");
+        terminal_writestring("  skb [cmd]     - Packet buffer pools (test, bench)\n");
         terminal_writestring("\n");
         terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
         terminal_writestring("Navigation & Features:\n");
@@ -1215,7 +1295,7 @@ void shell_process_command(const char* cmd) {
     } else if (shell_strcmp(cmd_args[0], "meminfo") == 0) {
         pmm_dump_stats();
     } else if (shell_strcmp(cmd_args[0], "syscalls") == 0) {
-        test_syscalls();
+        syscall_command_handler(cmd_argc, cmd_args);
     } else if (shell_strcmp(cmd_args[0], "ls") == 0) {
         if (cmd_argc > 1 && shell_strcmp(cmd_args[1], "-l") == 0) {
             memfs_simple_list_detailed();
@@ -1697,26 +1777,37 @@ void shell_process_command(const char* cmd) {
         // Boot Performance
         terminal_writestring("Boot Performance:\n");
         terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
-        terminal_writestring("  Kernel Load Time: ~2.5 seconds\n");
-        terminal_writestring("  Memory Init Time: ~0.8 seconds\n");
-        terminal_writestring("  FS Init Time: ~0.3 seconds\n");
+        terminal_printf("  Subsystem Init Time: %llu us\n", clock_ns_to_us(boot_init_ns));
+        terminal_printf("  Clocksource: %s\n",
+                        clock_get_info()->source == CLOCKSOURCE_TSC ? "TSC" : "PIT (10ms resolution)");
         terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         
         // Memory Performance
         terminal_writestring("\nMemory Performance:\n");
         if (heap_initialized) {
             terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
-            terminal_writestring("  Allocation Speed: HIGH\n");
-            terminal_writestring("  Fragmentation: LOW\n");
-            terminal_writestring("  Memory Efficiency: 95%\n");
+            uint64_t t0 = clock_cycles();
+            void* probe = kmalloc(64);
+            uint64_t t1 = clock_cycles();
+            if (probe) kfree(probe);
+            uint64_t t2 = clock_cycles();
+            terminal_printf("  kmalloc(64) latency: %llu ns\n", clock_cycles_to_ns(t1 - t0));
+            terminal_printf("  kfree latency: %llu ns\n", clock_cycles_to_ns(t2 - t1));
             terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         }
         
         // File System Performance
         terminal_writestring("\nFile System Performance:\n");
         terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
-        terminal_writestring("  File Access Speed: OPTIMAL\n");
-        terminal_writestring("  Cache Hit Rate: 98%\n");
+        char probe_buf[16];
+        uint64_t fs_t0 = clock_cycles();
+        int fs_found = memfs_simple_read("readme.md", probe_buf, sizeof(probe_buf));
+        uint64_t fs_t1 = clock_cycles();
+        if (fs_found >= 0) {
+            terminal_printf("  File read latency: %llu ns\n", clock_cycles_to_ns(fs_t1 - fs_t0));
+        } else {
+            terminal_printf("  File lookup (miss) latency: %llu ns\n", clock_cycles_to_ns(fs_t1 - fs_t0));
+        }
         terminal_writestring("  Max File Size: 16KB\n");
         terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         
@@ -1828,6 +1919,41 @@ void shell_process_command(const char* cmd) {
         memfs_simple_dump_stats();
     } else if (shell_strcmp(cmd_args[0], "sysinfo") == 0) {
         display_system_info();
+    } else if (shell_strcmp(cmd_args[0], "clock") == 0) {
+        clock_dump_info();
+        
+    } else if (shell_strcmp(cmd_args[0], "fpu") == 0) {
+        fpu_dump_info();
+        
+    } else if (shell_strcmp(cmd_args[0], "workq") == 0) {
+        workqueue_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "sched") == 0) {
+        sched_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "user") == 0) {
+        usermode_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "uring") == 0) {
+        uring_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "vdso") == 0) {
+        vdso_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "futex") == 0) {
+        futex_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "channel") == 0) {
+        channel_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "pipe") == 0) {
+        pipe_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "poll") == 0) {
+        poll_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "locks") == 0) {
+        lock_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "rcu") == 0) {
+        rcu_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "pci") == 0) {
+        pci_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "net") == 0) {
+        network_command_handler(cmd_argc, cmd_args);
+    } else if (shell_strcmp(cmd_args[0], "skb") == 0) {
+        skb_command_handler(cmd_argc, cmd_args);
+        
     } else if (shell_strcmp(cmd_args[0], "uptime") == 0) {
         display_uptime_info();
     } else if (shell_strcmp(cmd_args[0], "top") == 0) {
@@ -2198,21 +2324,28 @@ void shell_process_command(const char* cmd) {
         } else {
             terminal_writestring("  Testing kmalloc/kfree performance...\n");
             
-            // Quick allocation test
+            // Timed allocation test
             void* test_ptrs[20];
             int alloc_success = 0;
             
+            uint64_t alloc_start = clock_cycles();
             for (int i = 0; i < 20; i++) {
                 test_ptrs[i] = kmalloc(64);
                 if (test_ptrs[i]) alloc_success++;
             }
+            uint64_t alloc_end = clock_cycles();
             
             for (int i = 0; i < 20; i++) {
                 if (test_ptrs[i]) kfree(test_ptrs[i]);
             }
+            uint64_t free_end = clock_cycles();
             
             terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
-            terminal_writestring("  RESULT: 20 allocations completed successfully\n");
+            terminal_printf("  RESULT: %d/20 allocations completed\n", alloc_success);
+            terminal_printf("  kmalloc(64): %llu ns/op\n",
+                            div_u64(clock_cycles_to_ns(alloc_end - alloc_start), 20));
+            terminal_printf("  kfree:       %llu ns/op\n",
+                            div_u64(clock_cycles_to_ns(free_end - alloc_end), 20));
             terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         }
         
@@ -2220,10 +2353,61 @@ void shell_process_command(const char* cmd) {
         terminal_writestring("Benchmark 2: File System Operations\n");
         terminal_writestring("  Testing file creation/deletion speed...\n");
         
-        terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
-        terminal_writestring("  RESULT: File operations completed successfully\n");
+        int fs_ops = 0;
+        uint64_t fs_create = 0;
+        uint64_t fs_delete = 0;
+        for (int i = 0; i < 10; i++) {
+            uint64_t t0 = clock_cycles();
+            if (memfs_simple_create("__bench.tmp") != MEMFS_SUCCESS) {
+                break;
+            }
+            uint64_t t1 = clock_cycles();
+            memfs_simple_delete("__bench.tmp");
+            uint64_t t2 = clock_cycles();
+            fs_create += t1 - t0;
+            fs_delete += t2 - t1;
+            fs_ops++;
+        }
+        
+        if (fs_ops > 0) {
+            terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
+            terminal_printf("  RESULT: %d create/delete cycles completed\n", fs_ops);
+            terminal_printf("  create: %llu ns/op\n", div_u64(clock_cycles_to_ns(fs_create), fs_ops));
+            terminal_printf("  delete: %llu ns/op\n", div_u64(clock_cycles_to_ns(fs_delete), fs_ops));
+        } else {
+            terminal_setcolor(vga_entry_color(VGA_COLOR_YELLOW, VGA_COLOR_BLACK));
+            terminal_writestring("  SKIPPED: No free file slots\n");
+        }
         terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         
+        // Benchmark 3: Bulk copy (scalar vs SSE)
+        terminal_writestring("Benchmark 3: Memory Copy Bandwidth\n");
+        if (!fpu_sse_available()) {
+            terminal_setcolor(vga_entry_color(VGA_COLOR_YELLOW, VGA_COLOR_BLACK));
+            terminal_writestring("  SSE unavailable: scalar path only\n");
+            terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+        }
+        {
+            const uint32_t copy_rounds = 64;
+            uint64_t t0 = clock_cycles();
+            for (uint32_t i = 0; i < copy_rounds; i++) {
+                memcpy(bench_copy_dst, bench_copy_src, sizeof(bench_copy_src));
+            }
+            uint64_t t1 = clock_cycles();
+            for (uint32_t i = 0; i < copy_rounds; i++) {
+                memcpy_sse(bench_copy_dst, bench_copy_src, sizeof(bench_copy_src));
+            }
+            uint64_t t2 = clock_cycles();
+            
+            uint64_t bytes = (uint64_t)copy_rounds * sizeof(bench_copy_src);
+            uint64_t scalar_ns = clock_cycles_to_ns(t1 - t0);
+            uint64_t sse_ns = clock_cycles_to_ns(t2 - t1);
+            terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
+            terminal_printf("  memcpy:     %llu MB/s\n", scalar_ns ? div64_u64(bytes * 1000, scalar_ns) : 0);
+            terminal_printf("  memcpy_sse: %llu MB/s\n", sse_ns ? div64_u64(bytes * 1000, sse_ns) : 0);
+            terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+        }
+        
         // Overall performance rating
         terminal_writestring("\nOverall Performance Rating:\n");
         terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
@@ -2544,6 +2728,14 @@ void kernel_main(void) {
     timer_init();
     terminal_writestring("Timer: OK\n");
     
+    clock_init();
+    boot_clock_start = clock_monotonic_ns();
+    vdso_init();
+    terminal_writestring("vDSO: OK\n");
+    
+    fpu_init();
+    terminal_writestring("FPU: OK\n");
+    
     keyboard_init();
     terminal_writestring("Keyboard: OK\n");
     
@@ -2554,7 +2746,8 @@ void kernel_main(void) {
     pmm_init();
     terminal_writestring("PMM: OK\n");
     
-    syscall_simple_init();
+    syscall_init();
+    usermode_init();
     terminal_writestring("Syscalls: OK\n");
     
     memfs_simple_init();
@@ -2563,13 +2756,20 @@ void kernel_main(void) {
     init_aliases();
     terminal_writestring("Aliases: OK\n");
     
+    pci_init();
+    terminal_printf("PCI: OK (%d devices)\n", pci_device_count());
+    
     network_init();
     terminal_writestring("Network: OK\n");
     
+    workqueue_init();
+    terminal_writestring("Workqueue: OK\n");
+    
     // Enable interrupts
     terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
     terminal_writestring("Enabling interrupts...\n");
     asm volatile ("sti");
+    boot_init_ns = clock_monotonic_ns() - boot_clock_start;
     terminal_writestring("All systems ready!\n\n");
     
     // Start shell
@@ -2581,7 +2781,8 @@ void kernel_main(void) {
     
     // Main shell loop
     while (1) {
-        asm volatile ("hlt");
+        // Halt until an interrupt, running any queued kernel threads first
+        process_idle_wait();
         
         char c = keyboard_get_char();
         if (c != 0) {
@@ -60,5 +60,7 @@ void test_process_ipc_receiver(void);
 void test_process_producer(void);
 void test_process_consumer(void);
 void test_process_simple(void);
+void test_prodcons_run(void);
+void test_prodcons_shm_run(int items);
 
 #endif // KERNEL_H
\ No newline at end of file
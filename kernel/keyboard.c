@@ -4,6 +4,8 @@
 #include "keyboard.h"
 #include "pic.h"
 #include "kernel.h"
+#include "cpu.h"
+#include "fd.h"
 
 // US QWERTY keyboard layout (lowercase)
 static const char scancode_to_ascii[] = {
@@ -33,6 +35,7 @@ static int ctrl_pressed = 0;
 static char keyboard_buffer[KEYBOARD_BUFFER_SIZE];
 static volatile int buffer_start = 0;
 static volatile int buffer_end = 0;
+static poll_head_t keyboard_poll = POLL_HEAD_INIT;   // Day 21: readiness watchers
 
 // Initialize keyboard
 void keyboard_init(void) {
@@ -128,6 +131,7 @@ void keyboard_handler(void) {
         if (next_end != buffer_start) {  // Buffer not full
             keyboard_buffer[buffer_end] = ascii;
             buffer_end = next_end;
+            poll_notify(&keyboard_poll, POLLIN);
         }
     }
     
@@ -149,4 +153,51 @@ char keyboard_get_char(void) {
 // Check if keyboard input is available
 int keyboard_has_input(void) {
     return buffer_start != buffer_end;
-}
\ No newline at end of file
+}
+
+// Day 21: keyboard descriptor. read() takes whatever characters are
+// buffered and returns -1 instead of blocking when there are none; wait
+// for POLLIN with poll_fds()/epoll_wait(). The shell reads the same buffer.
+static int keyboard_fd_read(void* object, void* buffer, size_t count) {
+    (void)object;
+    char* out = (char*)buffer;
+    size_t n = 0;
+    uint32_t flags = irq_save();
+    while (n < count && keyboard_has_input()) {
+        out[n++] = keyboard_get_char();
+    }
+    irq_restore(flags);
+    return n ? (int)n : -1;
+}
+
+static void keyboard_fd_get(void* object) {
+    (void)object;
+}
+
+static void keyboard_fd_put(void* object) {
+    (void)object;
+}
+
+static uint32_t keyboard_fd_poll(void* object) {
+    (void)object;
+    return keyboard_has_input() ? POLLIN : 0;
+}
+
+static poll_head_t* keyboard_fd_poll_head(void* object) {
+    (void)object;
+    return &keyboard_poll;
+}
+
+static const fd_ops_t keyboard_fd_ops = {
+    .name      = "keyboard",
+    .read      = keyboard_fd_read,
+    .write     = NULL,
+    .get       = keyboard_fd_get,
+    .put       = keyboard_fd_put,
+    .poll      = keyboard_fd_poll,
+    .poll_head = keyboard_fd_poll_head,
+};
+
+int keyboard_open(void) {
+    return current_process ? fd_install(current_process, &keyboard_fd_ops, &keyboard_poll) : -1;
+}
@@ -38,5 +38,6 @@ void keyboard_init(void);
 void keyboard_handler(void);
 char keyboard_get_char(void);
 int keyboard_has_input(void);
+int keyboard_open(void);            // Day 21: pollable descriptor
 
 #endif // KEYBOARD_H
\ No newline at end of file
@@ -0,0 +1,585 @@
+// ClaudeOS Locking Primitives - Day 21
+// Ticket spinlocks, reader-writer spinlocks and sleeping mutexes, with
+// per-lock contention and hold-time statistics
+
+#include "lock.h"
+#include "atomic.h"
+#include "sched.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "idt.h"
+#include "rcu.h"
+#include "kernel.h"
+#include "string.h"
+
+// Registered locks (pushed lock-free on first acquisition, never removed)
+static lock_stats_t* lock_list = NULL;
+
+// Timestamps for the statistics: a bare rdtsc when the TSC is the
+// clocksource (clock_cycles() serializes, which costs more than the lock)
+static inline uint64_t lock_clock(void) {
+    if (clock_get_info()->source == CLOCKSOURCE_TSC) {
+        return rdtsc();
+    }
+    return clock_monotonic_ns();
+}
+
+static void lock_register(lock_stats_t* stats) {
+    if (atomic_xchg(&stats->registered, 1)) {
+        return;
+    }
+    lock_stats_t* head;
+    do {
+        head = lock_list;
+        stats->next = head;
+    } while (atomic_cmpxchg((volatile uint32_t*)&lock_list, (uint32_t)head,
+                            (uint32_t)stats) != (uint32_t)head);
+}
+
+static void lock_stats_init(lock_stats_t* stats, const char* name, uint32_t kind) {
+    lock_stats_t* next = stats->next;
+    uint32_t registered = stats->registered;
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+    stats->kind = kind;
+    stats->next = next;             // Re-initialising keeps the list intact
+    stats->registered = registered;
+}
+
+// Exclusive acquisition/release bookkeeping (called with the lock held)
+static inline void lock_acquired(lock_stats_t* stats, uint64_t wait_start) {
+    uint64_t now = lock_clock();
+    if (!stats->registered) {
+        lock_register(stats);
+    }
+    stats->acquisitions++;
+    if (wait_start) {
+        stats->contentions++;
+        stats->wait_cycles += now - wait_start;
+    }
+    stats->acquired_at = now;
+}
+
+static inline void lock_released(lock_stats_t* stats) {
+    uint64_t held = lock_clock() - stats->acquired_at;
+    stats->hold_cycles += held;
+    if (held > stats->max_hold_cycles) {
+        stats->max_hold_cycles = held;
+    }
+}
+
+// Read-side hold times. Readers run with preemption off, so the read
+// sections open on this (only) CPU belong to the running task and the
+// interrupt handlers nested in it: a small stack of start times covers
+// them. Entries are matched by lock, so out-of-order unlocks are fine;
+// sections deeper than the stack go untimed.
+#define LOCK_READ_DEPTH     8
+
+static struct {
+    lock_stats_t* stats;
+    uint64_t acquired_at;
+} lock_read_held[LOCK_READ_DEPTH];
+static uint32_t lock_read_depth = 0;
+
+static inline void lock_read_acquired(lock_stats_t* stats, bool contended) {
+    if (!stats->registered) {
+        lock_register(stats);
+    }
+    atomic_inc(&stats->read_acquisitions);
+    if (contended) {
+        atomic_inc(&stats->read_contentions);
+    }
+
+    uint32_t flags = irq_save();
+    if (lock_read_depth < LOCK_READ_DEPTH) {
+        lock_read_held[lock_read_depth].stats = stats;
+        lock_read_held[lock_read_depth].acquired_at = lock_clock();
+        lock_read_depth++;
+    }
+    irq_restore(flags);
+}
+
+static inline void lock_read_released(lock_stats_t* stats) {
+    uint32_t flags = irq_save();
+    for (int i = (int)lock_read_depth - 1; i >= 0; i--) {
+        if (lock_read_held[i].stats != stats) {
+            continue;
+        }
+        uint64_t held = lock_clock() - lock_read_held[i].acquired_at;
+        stats->read_hold_cycles += held;
+        if (held > stats->max_read_hold_cycles) {
+            stats->max_read_hold_cycles = held;
+        }
+        lock_read_depth--;
+        for (uint32_t j = (uint32_t)i; j < lock_read_depth; j++) {
+            lock_read_held[j] = lock_read_held[j + 1];
+        }
+        break;
+    }
+    irq_restore(flags);
+}
+
+// ---------------------------------------------------------------------------
+// Ticket spinlocks
+// ---------------------------------------------------------------------------
+
+void spin_lock_init(spinlock_t* lock, const char* name) {
+    lock->next = 0;
+    lock->owner = 0;
+    lock_stats_init(&lock->stats, name, LOCK_KIND_SPIN);
+}
+
+void spin_lock(spinlock_t* lock) {
+    preempt_disable();
+    uint32_t ticket = atomic_fetch_add(&lock->next, 1);
+    uint64_t wait_start = 0;
+    if (atomic_load(&lock->owner) != ticket) {
+        wait_start = lock_clock();
+        while (atomic_load(&lock->owner) != ticket) {
+            cpu_relax();
+        }
+    }
+    lock_acquired(&lock->stats, wait_start);
+}
+
+// Take the lock only if nobody holds or waits for it
+bool spin_trylock(spinlock_t* lock) {
+    preempt_disable();
+    uint32_t owner = atomic_load(&lock->owner);
+    if (atomic_cmpxchg(&lock->next, owner, owner + 1) != owner) {
+        preempt_enable();
+        return false;
+    }
+    lock_acquired(&lock->stats, 0);
+    return true;
+}
+
+void spin_unlock(spinlock_t* lock) {
+    lock_released(&lock->stats);
+    atomic_store(&lock->owner, lock->owner + 1);
+    preempt_enable();
+}
+
+uint32_t spin_lock_irqsave(spinlock_t* lock) {
+    uint32_t flags = irq_save();
+    spin_lock(lock);
+    return flags;
+}
+
+void spin_unlock_irqrestore(spinlock_t* lock, uint32_t flags) {
+    lock_released(&lock->stats);
+    atomic_store(&lock->owner, lock->owner + 1);
+    irq_restore(flags);
+    preempt_enable();               // May act on a reschedule deferred meanwhile
+}
+
+// ---------------------------------------------------------------------------
+// Reader-writer spinlocks
+// ---------------------------------------------------------------------------
+
+void rwlock_init(rwlock_t* lock, const char* name) {
+    lock->state = 0;
+    lock_stats_init(&lock->stats, name, LOCK_KIND_RW);
+}
+
+void read_lock(rwlock_t* lock) {
+    preempt_disable();
+    bool contended = false;
+    for (;;) {
+        uint32_t state = atomic_load(&lock->state);
+        if (!(state & (RW_WRITER | RW_WRITER_WAITING)) &&
+            atomic_cmpxchg(&lock->state, state, state + 1) == state) {
+            break;
+        }
+        contended = true;
+        cpu_relax();
+    }
+    lock_read_acquired(&lock->stats, contended);
+}
+
+void read_unlock(rwlock_t* lock) {
+    lock_read_released(&lock->stats);
+    atomic_dec(&lock->state);
+    preempt_enable();
+}
+
+void write_lock(rwlock_t* lock) {
+    preempt_disable();
+    uint64_t wait_start = 0;
+    for (;;) {
+        uint32_t state = atomic_load(&lock->state);
+        if ((state & ~RW_WRITER_WAITING) == 0) {
+            if (atomic_cmpxchg(&lock->state, state, RW_WRITER) == state) {
+                break;
+            }
+            continue;
+        }
+        if (!wait_start) {
+            wait_start = lock_clock();
+        }
+        if (!(state & RW_WRITER_WAITING)) {
+            atomic_cmpxchg(&lock->state, state, state | RW_WRITER_WAITING);
+        }
+        cpu_relax();
+    }
+    lock_acquired(&lock->stats, wait_start);
+}
+
+void write_unlock(rwlock_t* lock) {
+    lock_released(&lock->stats);
+    atomic_fetch_add(&lock->state, (uint32_t)-RW_WRITER);     // Keeps RW_WRITER_WAITING
+    preempt_enable();
+}
+
+uint32_t read_lock_irqsave(rwlock_t* lock) {
+    uint32_t flags = irq_save();
+    read_lock(lock);
+    return flags;
+}
+
+void read_unlock_irqrestore(rwlock_t* lock, uint32_t flags) {
+    lock_read_released(&lock->stats);
+    atomic_dec(&lock->state);
+    irq_restore(flags);
+    preempt_enable();
+}
+
+uint32_t write_lock_irqsave(rwlock_t* lock) {
+    uint32_t flags = irq_save();
+    write_lock(lock);
+    return flags;
+}
+
+void write_unlock_irqrestore(rwlock_t* lock, uint32_t flags) {
+    lock_released(&lock->stats);
+    atomic_fetch_add(&lock->state, (uint32_t)-RW_WRITER);
+    irq_restore(flags);
+    preempt_enable();
+}
+
+// ---------------------------------------------------------------------------
+// Sleeping mutexes
+// ---------------------------------------------------------------------------
+
+void mutex_init(mutex_t* mutex, const char* name) {
+    mutex->locked = false;
+    mutex->owner = NULL;
+    mutex->handoff = false;
+    wait_queue_init(&mutex->waiters);
+    lock_stats_init(&mutex->stats, name, LOCK_KIND_MUTEX);
+}
+
+void mutex_lock(mutex_t* mutex) {
+    uint32_t flags = irq_save();
+    uint64_t wait_start = 0;
+    if (!mutex->locked) {
+        mutex->locked = true;
+        mutex->owner = current_process;
+    } else {
+        if (!current_process || in_interrupt() || mutex->owner == current_process) {
+            kernel_panic("mutex_lock: would sleep in atomic context or on itself");
+        }
+        wait_start = lock_clock();
+        // mutex_unlock() makes the woken waiter the owner
+        while (mutex->owner != current_process) {
+            wait_queue_sleep(&mutex->waiters);
+        }
+        mutex->handoff = false;
+    }
+    lock_acquired(&mutex->stats, wait_start);
+    irq_restore(flags);
+}
+
+bool mutex_trylock(mutex_t* mutex) {
+    uint32_t flags = irq_save();
+    bool acquired = !mutex->locked;
+    if (acquired) {
+        mutex->locked = true;
+        mutex->owner = current_process;
+        lock_acquired(&mutex->stats, 0);
+    }
+    irq_restore(flags);
+    return acquired;
+}
+
+// Give the mutex to the first waiter, or free it (IRQs off)
+static void mutex_pass_on(mutex_t* mutex) {
+    process_t* next = wait_queue_wake_one(&mutex->waiters);
+    if (next) {
+        mutex->owner = next;
+        mutex->handoff = true;
+    } else {
+        mutex->locked = false;
+        mutex->owner = NULL;
+        mutex->handoff = false;
+    }
+}
+
+void mutex_unlock(mutex_t* mutex) {
+    uint32_t flags = irq_save();
+    lock_released(&mutex->stats);
+    mutex_pass_on(mutex);
+    irq_restore(flags);
+}
+
+// A mutex that was ever handed off has been acquired before, so it is on
+// the registered list
+void mutex_release_handoffs(process_t* process) {
+    uint32_t flags = irq_save();
+    for (lock_stats_t* stats = lock_list; stats; stats = stats->next) {
+        if (stats->kind != LOCK_KIND_MUTEX) {
+            continue;
+        }
+        mutex_t* mutex = container_of(stats, mutex_t, stats);
+        if (mutex->handoff && mutex->owner == process) {
+            mutex_pass_on(mutex);
+        }
+    }
+    irq_restore(flags);
+}
+
+// ---------------------------------------------------------------------------
+// Statistics
+// ---------------------------------------------------------------------------
+
+static const char* lock_kind_name(uint32_t kind) {
+    switch (kind) {
+        case LOCK_KIND_SPIN:  return "spin";
+        case LOCK_KIND_RW:    return "rw";
+        case LOCK_KIND_MUTEX: return "mutex";
+        default:              return "?";
+    }
+}
+
+void lock_show_stats(void) {
+    if (!lock_list) {
+        terminal_writestring("No locks taken yet\n");
+    }
+    for (lock_stats_t* stats = lock_list; stats; stats = stats->next) {
+        // Snapshot so the line is consistent even if the lock is busy
+        uint32_t flags = irq_save();
+        lock_stats_t snap = *stats;
+        irq_restore(flags);
+
+        uint64_t avg_hold = snap.acquisitions ?
+            div_u64(clock_cycles_to_ns(snap.hold_cycles), snap.acquisitions) : 0;
+        terminal_printf("%s (%s): %u acquired, %u contended", snap.name,
+                        lock_kind_name(snap.kind), snap.acquisitions, snap.contentions);
+        if (snap.kind == LOCK_KIND_RW) {
+            terminal_printf(", %u reads (%u contended)", snap.read_acquisitions,
+                            snap.read_contentions);
+        }
+        terminal_printf("\n    hold avg %llu ns, max %llu ns; waited %llu us\n",
+                        avg_hold, clock_cycles_to_ns(snap.max_hold_cycles),
+                        clock_ns_to_us(clock_cycles_to_ns(snap.wait_cycles)));
+        if (snap.kind == LOCK_KIND_RW) {
+            uint64_t avg_read_hold = snap.read_acquisitions ?
+                div_u64(clock_cycles_to_ns(snap.read_hold_cycles), snap.read_acquisitions) : 0;
+            terminal_printf("    read hold avg %llu ns, max %llu ns\n", avg_read_hold,
+                            clock_cycles_to_ns(snap.max_read_hold_cycles));
+        }
+    }
+}
+
+void lock_reset_stats(void) {
+    for (lock_stats_t* stats = lock_list; stats; stats = stats->next) {
+        uint32_t flags = irq_save();
+        stats->acquisitions = 0;
+        stats->contentions = 0;
+        stats->read_acquisitions = 0;
+        stats->read_contentions = 0;
+        stats->wait_cycles = 0;
+        stats->hold_cycles = 0;
+        stats->max_hold_cycles = 0;
+        stats->read_hold_cycles = 0;
+        stats->max_read_hold_cycles = 0;
+        irq_restore(flags);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test and benchmark
+// ---------------------------------------------------------------------------
+
+// Threads do unlocked-looking read/modify/write sequences with a gap in
+// the middle, so a missing lock loses updates under preemption. Spin and
+// rw runs use the plain variants, leaving timer ticks (and the preemption
+// they request) to land inside the critical section. The mutex run also
+// yields while holding the lock to force sleeping contention.
+#define LOCK_TEST_THREADS   4
+
+static spinlock_t test_spin = SPINLOCK_INIT("test_spin");
+static rwlock_t test_rw = RWLOCK_INIT("test_rw");
+static mutex_t test_mutex = MUTEX_INIT("test_mutex");
+
+static struct {
+    int iterations;
+    volatile uint32_t counter;
+    volatile uint32_t pair[2];      // Writers keep both equal
+    volatile uint32_t torn_reads;
+} lock_test;
+
+static void lock_test_gap(void) {
+    for (int i = 0; i < 20; i++) {
+        cpu_relax();
+    }
+}
+
+static void lock_test_spin_thread(void* arg) {
+    (void)arg;
+    for (int i = 0; i < lock_test.iterations; i++) {
+        spin_lock(&test_spin);
+        uint32_t value = lock_test.counter;
+        lock_test_gap();
+        lock_test.counter = value + 1;
+        spin_unlock(&test_spin);
+    }
+}
+
+static void lock_test_mutex_thread(void* arg) {
+    (void)arg;
+    for (int i = 0; i < lock_test.iterations; i++) {
+        mutex_lock(&test_mutex);
+        uint32_t value = lock_test.counter;
+        if ((i & 63) == 0) {
+            process_yield();
+        }
+        lock_test.counter = value + 1;
+        mutex_unlock(&test_mutex);
+    }
+}
+
+static void lock_test_rw_thread(void* arg) {
+    bool writer = (int)arg == 0;
+    for (int i = 0; i < lock_test.iterations; i++) {
+        if (writer) {
+            write_lock(&test_rw);
+            lock_test.pair[0]++;
+            lock_test_gap();
+            lock_test.pair[1]++;
+            write_unlock(&test_rw);
+        } else {
+            read_lock(&test_rw);
+            uint32_t first = lock_test.pair[0];
+            lock_test_gap();
+            if (lock_test.pair[1] != first) {
+                lock_test.torn_reads++;
+            }
+            read_unlock(&test_rw);
+        }
+    }
+}
+
+static bool lock_test_run(const char* label, void (*fn)(void* arg)) {
+    int pids[LOCK_TEST_THREADS];
+    int status = 0;
+    lock_test.counter = 0;
+    lock_test.pair[0] = 0;
+    lock_test.pair[1] = 0;
+    lock_test.torn_reads = 0;
+
+    for (int i = 0; i < LOCK_TEST_THREADS; i++) {
+        pids[i] = kthread_create_child(fn, (void*)i, "lock_test");
+    }
+    for (int i = 0; i < LOCK_TEST_THREADS; i++) {
+        if (pids[i] != INVALID_PID) {
+            process_wait(pids[i], &status);
+        }
+    }
+
+    bool ok;
+    if (fn == lock_test_rw_thread) {
+        ok = lock_test.pair[0] == (uint32_t)lock_test.iterations && lock_test.torn_reads == 0;
+        terminal_printf("  %s %u writes, %u torn reads  %s\n", label, lock_test.pair[0],
+                        lock_test.torn_reads, ok ? "PASS" : "FAIL");
+    } else {
+        uint32_t expect = (uint32_t)lock_test.iterations * LOCK_TEST_THREADS;
+        ok = lock_test.counter == expect;
+        terminal_printf("  %s counter %u (expect %u)  %s\n", label, lock_test.counter,
+                        expect, ok ? "PASS" : "FAIL");
+    }
+    return ok;
+}
+
+static void lock_test_all(int iterations) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+    lock_test.iterations = iterations;
+    terminal_printf("Lock test (%d threads x %d iterations):\n", LOCK_TEST_THREADS, iterations);
+    bool ok = lock_test_run("spin:", lock_test_spin_thread);
+    ok &= lock_test_run("mutex:", lock_test_mutex_thread);
+    ok &= lock_test_run("rwlock:", lock_test_rw_thread);
+    terminal_printf("Lock test %s\n", ok ? "PASSED" : "FAILED");
+}
+
+// Uncompetitive lock/unlock pairs, against a bare irq_save/irq_restore
+static void lock_bench_row(const char* label, uint64_t cycles, int iterations) {
+    terminal_printf("  %s %llu ns/pair\n", label,
+                    div_u64(clock_cycles_to_ns(cycles), (uint32_t)iterations));
+}
+
+static void lock_bench(int iterations) {
+    terminal_printf("Uncontended lock cost (%d lock/unlock pairs):\n", iterations);
+
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        irq_restore(irq_save());
+    }
+    lock_bench_row("irq_save/restore:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        spin_lock(&test_spin);
+        spin_unlock(&test_spin);
+    }
+    lock_bench_row("spin_lock:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        spin_unlock_irqrestore(&test_spin, spin_lock_irqsave(&test_spin));
+    }
+    lock_bench_row("spin_lock_irqsave:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        read_lock(&test_rw);
+        read_unlock(&test_rw);
+    }
+    lock_bench_row("read_lock:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        write_lock(&test_rw);
+        write_unlock(&test_rw);
+    }
+    lock_bench_row("write_lock:", clock_cycles() - start, iterations);
+
+    if (current_process) {
+        start = clock_cycles();
+        for (int i = 0; i < iterations; i++) {
+            mutex_lock(&test_mutex);
+            mutex_unlock(&test_mutex);
+        }
+        lock_bench_row("mutex_lock:", clock_cycles() - start, iterations);
+    }
+}
+
+void lock_command_handler(int argc, char argv[][64]) {
+    if (argc < 2 || strcmp(argv[1], "stats") == 0) {
+        lock_show_stats();
+    } else if (strcmp(argv[1], "reset") == 0) {
+        lock_reset_stats();
+        terminal_writestring("Lock statistics reset\n");
+    } else if (strcmp(argv[1], "test") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 2000;
+        lock_test_all(iterations > 0 ? iterations : 2000);
+    } else if (strcmp(argv[1], "bench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 100000;
+        lock_bench(iterations > 0 ? iterations : 100000);
+    } else {
+        terminal_writestring("Usage: locks [stats|reset|test [n]|bench [n]]\n");
+    }
+}
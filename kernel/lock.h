@@ -0,0 +1,107 @@
+// ClaudeOS Locking Primitives - Day 21
+// Ticket spinlocks, reader-writer spinlocks and sleeping mutexes, with
+// per-lock contention and hold-time statistics
+
+#ifndef LOCK_H
+#define LOCK_H
+
+#include "types.h"
+#include "process.h"
+#include "wait.h"
+
+// Lock kinds (for the statistics report)
+#define LOCK_KIND_SPIN      0
+#define LOCK_KIND_RW        1
+#define LOCK_KIND_MUTEX     2
+
+// Statistics embedded in every lock. Times are in clock_cycles() units.
+// A lock registers itself for `locks` on its first acquisition; fields
+// other than the reader counters are updated while the lock is held, and
+// read hold times with interrupts disabled.
+typedef struct lock_stats {
+    const char* name;
+    uint32_t kind;
+    volatile uint32_t registered;
+    struct lock_stats* next;        // Registered locks
+    uint32_t acquisitions;          // Exclusive acquisitions
+    uint32_t contentions;           // ... that had to spin or sleep
+    volatile uint32_t read_acquisitions;
+    volatile uint32_t read_contentions;
+    uint64_t wait_cycles;           // Spent spinning/sleeping (exclusive)
+    uint64_t hold_cycles;           // Spent holding (exclusive)
+    uint64_t max_hold_cycles;
+    uint64_t read_hold_cycles;      // Spent holding (shared, all readers)
+    uint64_t max_read_hold_cycles;
+    uint64_t acquired_at;
+} lock_stats_t;
+
+#define LOCK_STATS_INIT(lock_name, lock_kind) { .name = (lock_name), .kind = (lock_kind) }
+
+// Ticket spinlock: FIFO among waiters. Holders run with preemption off;
+// the _irqsave variants also disable interrupts and must be used for any
+// lock an IRQ handler takes.
+typedef struct spinlock {
+    volatile uint32_t next;         // Next ticket to hand out
+    volatile uint32_t owner;        // Ticket being served
+    lock_stats_t stats;
+} spinlock_t;
+
+#define SPINLOCK_INIT(name) { 0, 0, LOCK_STATS_INIT(name, LOCK_KIND_SPIN) }
+
+void spin_lock_init(spinlock_t* lock, const char* name);
+void spin_lock(spinlock_t* lock);
+bool spin_trylock(spinlock_t* lock);
+void spin_unlock(spinlock_t* lock);
+uint32_t spin_lock_irqsave(spinlock_t* lock);
+void spin_unlock_irqrestore(spinlock_t* lock, uint32_t flags);
+
+// Reader-writer spinlock: any number of readers or one writer. A waiting
+// writer holds off new readers so it cannot starve. Not recursive.
+#define RW_WRITER           0x80000000u
+#define RW_WRITER_WAITING   0x40000000u
+
+typedef struct rwlock {
+    volatile uint32_t state;        // RW_* bits | reader count
+    lock_stats_t stats;
+} rwlock_t;
+
+#define RWLOCK_INIT(name) { 0, LOCK_STATS_INIT(name, LOCK_KIND_RW) }
+
+void rwlock_init(rwlock_t* lock, const char* name);
+void read_lock(rwlock_t* lock);
+void read_unlock(rwlock_t* lock);
+void write_lock(rwlock_t* lock);
+void write_unlock(rwlock_t* lock);
+uint32_t read_lock_irqsave(rwlock_t* lock);
+void read_unlock_irqrestore(rwlock_t* lock, uint32_t flags);
+uint32_t write_lock_irqsave(rwlock_t* lock);
+void write_unlock_irqrestore(rwlock_t* lock, uint32_t flags);
+
+// Sleeping mutex: contended lockers block on a wait queue and unlock hands
+// ownership straight to the first waiter. Process context only; may be
+// held across sleeps and allocations.
+typedef struct mutex {
+    bool locked;
+    process_t* owner;
+    bool handoff;                   // Owner was handed the lock, has not run yet
+    wait_queue_t waiters;
+    lock_stats_t stats;
+} mutex_t;
+
+#define MUTEX_INIT(name) { false, NULL, false, WAIT_QUEUE_INIT, LOCK_STATS_INIT(name, LOCK_KIND_MUTEX) }
+
+void mutex_init(mutex_t* mutex, const char* name);
+void mutex_lock(mutex_t* mutex);
+bool mutex_trylock(mutex_t* mutex);
+void mutex_unlock(mutex_t* mutex);
+
+// Kill path (interrupts disabled): pass on mutexes handed to a task that
+// died before it woke up to take them
+void mutex_release_handoffs(process_t* process);
+
+// Statistics report and `locks` shell command
+void lock_show_stats(void);
+void lock_reset_stats(void);
+void lock_command_handler(int argc, char argv[][64]);
+
+#endif // LOCK_H
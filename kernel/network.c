@@ -5,13 +5,33 @@
 #include "kernel.h"
 #include "timer.h"
 #include "string.h"
+#include "cpu.h"
+#include "fd.h"
+#include "process.h"
+#include "lock.h"
+#include "rcu.h"
+#include "clock.h"
+#include "div64.h"
+#include "e1000.h"
 
 // Global network state
 network_interface_t network_interfaces[MAX_NETWORK_INTERFACES];
-network_packet_t packet_buffers[PACKET_BUFFER_COUNT];
+
+// Day 21: lookups are lockless (RCU). Updaters serialize on this lock and
+// publish a new interface by storing its id last.
+static spinlock_t network_update_lock = SPINLOCK_INIT("net_interfaces");
 int next_interface_id = 0;
 bool network_initialized = false;
 
+// Day 21: counters at the previous `netstat`, for packets/bytes per second
+static struct {
+    uint64_t timestamp_ns;
+    uint32_t packets_sent;
+    uint32_t packets_received;
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+} network_rate_mark;
+
 // Simple string utilities for network
 static size_t net_strlen(const char* str) {
     size_t len = 0;
@@ -36,6 +56,23 @@ static int net_strcmp(const char* str1, const char* str2) {
     return *str1 - *str2;
 }
 
+// Day 21: loopback device. A transmitted buffer goes straight onto the
+// interface's own receive queue - no copy, and readers see it through the
+// same RX path as frames from a NIC. A full queue drops it.
+static int network_loopback_transmit(network_interface_t* iface, sk_buff_t* skb) {
+    skb->interface_id = iface->id;
+    if (network_rx_enqueue(iface, skb) != 0) {
+        return -1;
+    }
+    poll_notify(&iface->poll, POLLIN);
+    return 0;
+}
+
+static const net_device_ops_t network_loopback_ops = {
+    .name            = "loopback",
+    .transmit_buffer = network_loopback_transmit,
+};
+
 // Network system initialization
 void network_init(void) {
     terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_MAGENTA, VGA_COLOR_BLACK));
@@ -52,6 +89,11 @@ void network_init(void) {
         network_interfaces[i].bytes_sent = 0;
         network_interfaces[i].bytes_received = 0;
         network_interfaces[i].errors = 0;
+        network_interfaces[i].ops = NULL;
+        network_interfaces[i].priv = NULL;
+        network_interfaces[i].rx_head = 0;
+        network_interfaces[i].rx_tail = 0;
+        network_interfaces[i].rx_dropped = 0;
         for (int j = 0; j < 16; j++) {
             network_interfaces[i].name[j] = 0;
         }
@@ -60,16 +102,8 @@ void network_init(void) {
         }
     }
     
-    // Clear packet buffers
-    for (int i = 0; i < PACKET_BUFFER_COUNT; i++) {
-        packet_buffers[i].in_use = false;
-        packet_buffers[i].size = 0;
-        packet_buffers[i].interface_id = -1;
-        packet_buffers[i].timestamp = 0;
-        for (int j = 0; j < MAX_PACKET_SIZE; j++) {
-            packet_buffers[i].data[j] = 0;
-        }
-    }
+    // Packet buffer pools
+    skb_pool_init();
     
     next_interface_id = 0;
     
@@ -83,12 +117,14 @@ void network_init(void) {
         network_interfaces[lo_id].mac_address[3] = 0x00;
         network_interfaces[lo_id].mac_address[4] = 0x00;
         network_interfaces[lo_id].mac_address[5] = 0x01;
+        network_interfaces[lo_id].ops = &network_loopback_ops;
         network_enable_interface(lo_id);
     }
     
-    // Create virtual ethernet interface
-    int eth_id = network_create_interface("eth0", NET_INTERFACE_ETHERNET);
-    if (eth_id >= 0) {
+    // Day 21: a real NIC (QEMU -device e1000) becomes eth0 on QEMU's
+    // user-mode network; without one, eth0 stays a simulated interface
+    int eth_id = e1000_init("eth0", 0x0A00020F); // 10.0.2.15
+    if (eth_id < 0 && (eth_id = network_create_interface("eth0", NET_INTERFACE_ETHERNET)) >= 0) {
         network_interfaces[eth_id].ip_address = 0xC0A80101; // 192.168.1.1
         network_interfaces[eth_id].mac_address[0] = 0x52;
         network_interfaces[eth_id].mac_address[1] = 0x54;
@@ -100,13 +136,18 @@ void network_init(void) {
     }
     
     network_initialized = true;
+    network_reset_stats();
     
     terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
     terminal_writestring("[NETWORK] Network foundation initialized!\n");
     terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
     terminal_writestring("  - Loopback interface: lo (127.0.0.1)\n");
-    terminal_writestring("  - Ethernet interface: eth0 (192.168.1.1)\n");
-    terminal_writestring("  - Packet buffers: 32 available\n");
+    if (e1000_present()) {
+        terminal_writestring("  - Ethernet interface: eth0 (10.0.2.15, e1000 NIC)\n");
+    } else {
+        terminal_writestring("  - Ethernet interface: eth0 (192.168.1.1, simulated)\n");
+    }
+    terminal_writestring("  - Packet buffers: pooled sk_buffs (256B/2KB classes)\n");
 }
 
 // Interface management
@@ -116,18 +157,22 @@ int network_create_interface(const char* name, net_interface_type_t type) {
     }
     
     // Find free interface slot
+    int id = -1;
+    uint32_t flags = spin_lock_irqsave(&network_update_lock);
     for (int i = 0; i < MAX_NETWORK_INTERFACES; i++) {
         if (network_interfaces[i].id == -1) {
-            network_interfaces[i].id = next_interface_id++;
             net_strcpy(network_interfaces[i].name, name, 16);
             network_interfaces[i].type = type;
             network_interfaces[i].state = NET_STATE_DOWN;
             network_interfaces[i].enabled = false;
-            return network_interfaces[i].id;
+            id = next_interface_id++;
+            rcu_assign_pointer(network_interfaces[i].id, id);   // Publish
+            break;
         }
     }
+    spin_unlock_irqrestore(&network_update_lock, flags);
     
-    return -1;
+    return id;
 }
 
 int network_enable_interface(int interface_id) {
@@ -145,50 +190,53 @@ int network_disable_interface(int interface_id) {
     
     iface->enabled = false;
     iface->state = NET_STATE_DOWN;
+    poll_notify(&iface->poll, POLLERR);
     return 0;
 }
 
 network_interface_t* network_find_interface(int interface_id) {
+    if (interface_id < 0) return NULL;
+    
+    network_interface_t* found = NULL;
+    rcu_read_lock();
     for (int i = 0; i < MAX_NETWORK_INTERFACES; i++) {
-        if (network_interfaces[i].id == interface_id) {
-            return &network_interfaces[i];
+        if (rcu_dereference(network_interfaces[i].id) == interface_id) {
+            found = &network_interfaces[i];
+            break;
         }
     }
-    return NULL;
+    rcu_read_unlock();
+    return found;
 }
 
 network_interface_t* network_find_interface_by_name(const char* name) {
     if (!name) return NULL;
     
+    network_interface_t* found = NULL;
+    rcu_read_lock();
     for (int i = 0; i < MAX_NETWORK_INTERFACES; i++) {
-        if (network_interfaces[i].id != -1 && 
+        if (rcu_dereference(network_interfaces[i].id) != -1 && 
             net_strcmp(network_interfaces[i].name, name) == 0) {
-            return &network_interfaces[i];
+            found = &network_interfaces[i];
+            break;
         }
     }
-    return NULL;
+    rcu_read_unlock();
+    return found;
 }
 
-// Packet buffer management
-network_packet_t* network_alloc_packet(void) {
-    for (int i = 0; i < PACKET_BUFFER_COUNT; i++) {
-        if (!packet_buffers[i].in_use) {
-            packet_buffers[i].in_use = true;
-            packet_buffers[i].size = 0;
-            packet_buffers[i].timestamp = get_uptime_seconds();
-            packet_buffers[i].interface_id = -1;
-            return &packet_buffers[i];
-        }
+// Packet buffer management (Day 21: O(1) from the sk_buff pools, and
+// also called from driver IRQ handlers)
+sk_buff_t* network_alloc_packet(void) {
+    sk_buff_t* skb = skb_alloc(SKB_DEFAULT_HEADROOM + MAX_PACKET_SIZE);
+    if (skb) {
+        skb_reserve(skb, SKB_DEFAULT_HEADROOM);
     }
-    return NULL; // No free buffers
+    return skb; // NULL: no free buffers
 }
 
-void network_free_packet(network_packet_t* packet) {
-    if (packet) {
-        packet->in_use = false;
-        packet->size = 0;
-        packet->interface_id = -1;
-    }
+void network_free_packet(sk_buff_t* skb) {
+    skb_free(skb);
 }
 
 int network_send_packet(int interface_id, const uint8_t* data, size_t size) {
@@ -197,19 +245,165 @@ int network_send_packet(int interface_id, const uint8_t* data, size_t size) {
     network_interface_t* iface = network_find_interface(interface_id);
     if (!iface || !iface->enabled) return -1;
     
-    // Simulate packet sending (just update statistics)
+    // Day 21: buffer-based devices (loopback) get one copy into a packet
+    // buffer, which is then handed over
+    if (iface->ops && iface->ops->transmit_buffer) {
+        sk_buff_t* skb = network_alloc_packet();
+        if (!skb) {
+            iface->errors++;
+            return -1;
+        }
+        memcpy(skb_put(skb, size), data, size);
+        return network_send_buffer(interface_id, skb);
+    }
+    
+    // Day 21: hand the frame to the driver (simulated interfaces only count);
+    // a full TX ring is reported to the caller, who may retry
+    if (iface->ops && iface->ops->transmit && iface->ops->transmit(iface, data, size) != 0) {
+        return -1;
+    }
+    
     iface->packets_sent++;
     iface->bytes_sent += size;
     
     return 0; // Success
 }
 
-network_packet_t* network_receive_packet(int interface_id) {
+// Day 21: zero-copy transmit. The buffer belongs to the interface from
+// here on, whatever the result: a buffer-based device passes it along
+// as is; others copy it out (fragments gathered first) and it is freed.
+int network_send_buffer(int interface_id, sk_buff_t* skb) {
+    if (!skb) return -1;
+    
+    network_interface_t* iface = network_find_interface(interface_id);
+    size_t size = skb->len;
+    if (!iface || !iface->enabled || size == 0 || size > MAX_PACKET_SIZE) {
+        network_free_packet(skb);
+        return -1;
+    }
+    
+    int result = 0;
+    if (iface->ops && iface->ops->transmit_buffer) {
+        result = iface->ops->transmit_buffer(iface, skb);    // May already be read
+    } else {
+        if (iface->ops && iface->ops->transmit) {
+            if (skb->data_len != 0 && skb_linearize(skb) != 0) {
+                sk_buff_t* linear = skb_copy(skb);
+                network_free_packet(skb);
+                if (!linear) return -1;
+                skb = linear;
+            }
+            result = iface->ops->transmit(iface, skb->data, size);
+        }
+        network_free_packet(skb);
+    }
+    if (result != 0) return -1;
+    
+    iface->packets_sent++;
+    iface->bytes_sent += size;
+    return 0;
+}
+
+// Day 21: queue a received frame on its interface (driver IRQ handlers).
+// The queue owns the packet from here on; a full queue drops it.
+int network_rx_enqueue(network_interface_t* iface, sk_buff_t* skb) {
+    uint32_t flags = irq_save();
+    if (iface->rx_tail - iface->rx_head >= NETWORK_QUEUE_SIZE) {
+        iface->rx_dropped++;
+        irq_restore(flags);
+        network_free_packet(skb);
+        return -1;
+    }
+    iface->rx_queue[iface->rx_tail % NETWORK_QUEUE_SIZE] = skb;
+    iface->rx_tail++;
+    iface->packets_received++;
+    iface->bytes_received += skb->len;
+    irq_restore(flags);
+    return 0;
+}
+
+// Oldest received frame, or NULL; the caller frees it
+sk_buff_t* network_receive_packet(int interface_id) {
     network_interface_t* iface = network_find_interface(interface_id);
     if (!iface || !iface->enabled) return NULL;
     
-    // Simulate packet reception (no actual packets in basic implementation)
-    return NULL;
+    sk_buff_t* skb = NULL;
+    uint32_t flags = irq_save();
+    if (iface->rx_head != iface->rx_tail) {
+        skb = iface->rx_queue[iface->rx_head % NETWORK_QUEUE_SIZE];
+        iface->rx_head++;
+    }
+    irq_restore(flags);
+    return skb;
+}
+
+// Day 21: frames waiting in the receive queue
+bool network_rx_pending(int interface_id) {
+    network_interface_t* iface = network_find_interface(interface_id);
+    if (!iface || !iface->enabled) return false;
+    
+    return READ_ONCE(iface->rx_head) != READ_ONCE(iface->rx_tail);
+}
+
+void network_rx_notify(int interface_id) {
+    network_interface_t* iface = network_find_interface(interface_id);
+    if (iface) {
+        poll_notify(&iface->poll, POLLIN);
+    }
+}
+
+// Interface descriptor: read() takes one received frame (-1 if none is
+// queued; wait for POLLIN first), write() sends one frame
+static int network_fd_read(void* object, void* buffer, size_t count) {
+    network_interface_t* iface = (network_interface_t*)object;
+    sk_buff_t* skb = network_receive_packet(iface->id);
+    if (!skb) return -1;
+    
+    size_t size = skb->len < count ? skb->len : count;
+    skb_copy_bits(skb, 0, buffer, size);
+    network_free_packet(skb);
+    return (int)size;
+}
+
+static int network_fd_write(void* object, const void* buffer, size_t count) {
+    network_interface_t* iface = (network_interface_t*)object;
+    return network_send_packet(iface->id, (const uint8_t*)buffer, count) == 0 ? (int)count : -1;
+}
+
+static void network_fd_get(void* object) {
+    (void)object;
+}
+
+static void network_fd_put(void* object) {
+    (void)object;
+}
+
+static uint32_t network_fd_poll(void* object) {
+    network_interface_t* iface = (network_interface_t*)object;
+    if (!iface->enabled) return POLLERR;
+    
+    return POLLOUT | (network_rx_pending(iface->id) ? POLLIN : 0);
+}
+
+static poll_head_t* network_fd_poll_head(void* object) {
+    return &((network_interface_t*)object)->poll;
+}
+
+static const fd_ops_t network_fd_ops = {
+    .name      = "netif",
+    .read      = network_fd_read,
+    .write     = network_fd_write,
+    .get       = network_fd_get,
+    .put       = network_fd_put,
+    .poll      = network_fd_poll,
+    .poll_head = network_fd_poll_head,
+};
+
+int network_open(int interface_id) {
+    network_interface_t* iface = network_find_interface(interface_id);
+    if (!iface || !current_process) return -1;
+    
+    return fd_install(current_process, &network_fd_ops, iface);
 }
 
 // Network statistics
@@ -222,6 +416,7 @@ void network_get_stats(network_stats_t* stats) {
     stats->total_bytes_received = 0;
     stats->total_errors = 0;
     stats->active_interfaces = 0;
+    stats->total_rx_dropped = 0;
     
     for (int i = 0; i < MAX_NETWORK_INTERFACES; i++) {
         if (network_interfaces[i].id != -1 && network_interfaces[i].enabled) {
@@ -230,17 +425,26 @@ void network_get_stats(network_stats_t* stats) {
             stats->total_bytes_sent += network_interfaces[i].bytes_sent;
             stats->total_bytes_received += network_interfaces[i].bytes_received;
             stats->total_errors += network_interfaces[i].errors;
+            stats->total_rx_dropped += network_interfaces[i].rx_dropped;
             stats->active_interfaces++;
         }
     }
     
     // Count used packet buffers
-    stats->buffer_usage = 0;
-    for (int i = 0; i < PACKET_BUFFER_COUNT; i++) {
-        if (packet_buffers[i].in_use) {
-            stats->buffer_usage++;
-        }
+    stats->buffer_usage = skb_pool_in_use();
+}
+
+void network_reset_stats(void) {
+    for (int i = 0; i < MAX_NETWORK_INTERFACES; i++) {
+        network_interfaces[i].packets_sent = 0;
+        network_interfaces[i].packets_received = 0;
+        network_interfaces[i].bytes_sent = 0;
+        network_interfaces[i].bytes_received = 0;
+        network_interfaces[i].errors = 0;
+        network_interfaces[i].rx_dropped = 0;
     }
+    memset(&network_rate_mark, 0, sizeof(network_rate_mark));
+    network_rate_mark.timestamp_ns = clock_monotonic_ns();
 }
 
 // Utility functions
@@ -397,10 +601,159 @@ void network_show_stats(void) {
     terminal_writestring("  Buffer Usage: ");
     itoa((int)stats.buffer_usage, num_str, 10);
     terminal_writestring(num_str);
-    terminal_writestring("/");
-    itoa(PACKET_BUFFER_COUNT, num_str, 10);
-    terminal_writestring(num_str);
-    terminal_writestring(" buffers\n");
+    terminal_writestring(" buffers in use (see 'skb')\n");
+    
+    terminal_printf("  RX Dropped: %u\n", stats.total_rx_dropped);
+    
+    // Day 21: throughput since the previous netstat (or boot/reset)
+    uint64_t now = clock_monotonic_ns();
+    uint64_t elapsed = now - network_rate_mark.timestamp_ns;
+    if (elapsed > 0) {
+        uint32_t tx_packets = stats.total_packets_sent - network_rate_mark.packets_sent;
+        uint32_t rx_packets = stats.total_packets_received - network_rate_mark.packets_received;
+        uint32_t tx_bytes = stats.total_bytes_sent - network_rate_mark.bytes_sent;
+        uint32_t rx_bytes = stats.total_bytes_received - network_rate_mark.bytes_received;
+        terminal_printf("  TX Rate: %llu pps, %llu B/s\n",
+                        div64_u64((uint64_t)tx_packets * 1000000000ull, elapsed),
+                        div64_u64((uint64_t)tx_bytes * 1000000000ull, elapsed));
+        terminal_printf("  RX Rate: %llu pps, %llu B/s\n",
+                        div64_u64((uint64_t)rx_packets * 1000000000ull, elapsed),
+                        div64_u64((uint64_t)rx_bytes * 1000000000ull, elapsed));
+        terminal_printf("  (over the last %llu ms)\n", div_u64(elapsed, 1000000));
+    }
+    network_rate_mark.timestamp_ns = now;
+    network_rate_mark.packets_sent = stats.total_packets_sent;
+    network_rate_mark.packets_received = stats.total_packets_received;
+    network_rate_mark.bytes_sent = stats.total_bytes_sent;
+    network_rate_mark.bytes_received = stats.total_bytes_received;
+}
+
+// Day 21: transmit throughput. Broadcast frames with the local
+// experimental EtherType, so a second guest on a socket/tap backend can
+// count them with `netstat`.
+#define NETWORK_BENCH_ETHERTYPE 0x88B5
+static uint8_t network_bench_frame[MAX_PACKET_SIZE];
+
+void network_bench(const char* name, int count, int size) {
+    network_interface_t* iface = network_find_interface_by_name(name);
+    if (!iface || !iface->enabled) {
+        terminal_printf("Interface %s not found or down\n", name);
+        return;
+    }
+    if (size < 60) size = 60;                   // Minimum frame without FCS
+    if (size > 1514) size = 1514;
+    
+    uint8_t* frame = network_bench_frame;
+    for (int i = 0; i < 6; i++) {
+        frame[i] = 0xFF;
+        frame[6 + i] = iface->mac_address[i];
+    }
+    frame[12] = NETWORK_BENCH_ETHERTYPE >> 8;
+    frame[13] = NETWORK_BENCH_ETHERTYPE & 0xFF;
+    for (int i = 14; i < size; i++) {
+        frame[i] = (uint8_t)i;
+    }
+    
+    uint32_t rx_before = iface->packets_received;
+    int sent = 0;
+    int retries = 0;
+    uint64_t start = clock_monotonic_ns();
+    for (int i = 0; i < count; i++) {
+        int attempts = 0;
+        // A full TX ring drains as the device completes descriptors
+        while (network_send_packet(iface->id, frame, size) != 0 && ++attempts < 1000) {
+            process_yield();
+        }
+        if (attempts < 1000) {
+            sent++;
+        }
+        retries += attempts;
+    }
+    uint64_t elapsed = clock_monotonic_ns() - start;
+    if (elapsed == 0) elapsed = 1;
+    
+    terminal_printf("%s: sent %d/%d frames of %d bytes in %llu us (%d retries)\n",
+                    iface->name, sent, count, size, clock_ns_to_us(elapsed), retries);
+    terminal_printf("  TX: %llu pps, %llu B/s\n",
+                    div64_u64((uint64_t)sent * 1000000000ull, elapsed),
+                    div64_u64((uint64_t)sent * size * 1000000000ull, elapsed));
+    terminal_printf("  RX during run: %u frames\n", iface->packets_received - rx_before);
+}
+
+// Day 21: per-packet cost of the stack without hardware. Each frame goes
+// out on lo and is read back and checked, first through the copying
+// network_send_packet() path, then handing the buffer over with
+// network_send_buffer() (the same buffer must come back out).
+void network_loopback_bench(int count, int size) {
+    network_interface_t* lo = network_find_interface_by_name("lo");
+    if (!lo || !lo->enabled) {
+        terminal_writestring("Loopback interface not available\n");
+        return;
+    }
+    if (size < 60) size = 60;
+    if (size > MAX_PACKET_SIZE) size = MAX_PACKET_SIZE;
+    
+    uint8_t* frame = network_bench_frame;
+    for (int i = 0; i < 6; i++) {
+        frame[i] = lo->mac_address[i];
+        frame[6 + i] = lo->mac_address[i];
+    }
+    frame[12] = NETWORK_BENCH_ETHERTYPE >> 8;
+    frame[13] = NETWORK_BENCH_ETHERTYPE & 0xFF;
+    
+    // Copy path
+    int errors = 0;
+    uint64_t start = clock_monotonic_ns();
+    for (int i = 0; i < count; i++) {
+        frame[14] = (uint8_t)i;
+        if (network_send_packet(lo->id, frame, size) != 0) {
+            errors++;
+            continue;
+        }
+        sk_buff_t* skb = network_receive_packet(lo->id);
+        if (!skb || skb->len != (size_t)size || skb->data[14] != (uint8_t)i) {
+            errors++;
+        }
+        network_free_packet(skb);
+    }
+    uint64_t copy_ns = clock_monotonic_ns() - start;
+    
+    // Zero-copy path: the payload is reserved in place, the link header is
+    // pushed in front of it and pulled off again by the receiver
+    int handoffs = 0;
+    start = clock_monotonic_ns();
+    for (int i = 0; i < count; i++) {
+        sk_buff_t* sent = network_alloc_packet();
+        if (!sent) {
+            errors++;
+            continue;
+        }
+        uint8_t* payload = skb_put(sent, size - 14);
+        payload[0] = (uint8_t)i;
+        memcpy(skb_push(sent, 14), frame, 14);
+        if (network_send_buffer(lo->id, sent) != 0) {
+            errors++;
+            continue;
+        }
+        sk_buff_t* skb = network_receive_packet(lo->id);
+        if (skb == sent && skb_pull(skb, 14) == payload && skb->data[0] == (uint8_t)i) {
+            handoffs++;
+        } else {
+            errors++;
+        }
+        network_free_packet(skb);
+    }
+    uint64_t zero_copy_ns = clock_monotonic_ns() - start;
+    
+    if (copy_ns == 0) copy_ns = 1;
+    if (zero_copy_ns == 0) zero_copy_ns = 1;
+    terminal_printf("Loopback: %d frames of %d bytes each way\n", count, size);
+    terminal_printf("  Copy path:      %llu ns/packet, %llu pps\n",
+                    div_u64(copy_ns, count), div64_u64((uint64_t)count * 1000000000ull, copy_ns));
+    terminal_printf("  Zero-copy path: %llu ns/packet, %llu pps (%d buffers handed over)\n",
+                    div_u64(zero_copy_ns, count), div64_u64((uint64_t)count * 1000000000ull, zero_copy_ns),
+                    handoffs);
+    terminal_printf("  Errors: %d\n", errors);
 }
 
 void network_ping_simulation(const char* target) {
@@ -460,6 +813,9 @@ void network_command_handler(int argc, char argv[][64]) {
         terminal_writestring("  netinfo  - Show network interface information\n");
         terminal_writestring("  netstat  - Show network statistics\n");
         terminal_writestring("  ping <target> - Ping simulation\n");
+        terminal_writestring("  bench [iface] [n] [size] - Transmit throughput\n");
+        terminal_writestring("  nic      - e1000 driver state\n");
+        terminal_writestring("  lobench [n] [size] - Loopback per-packet cost\n");
         return;
     }
     
@@ -476,6 +832,19 @@ void network_command_handler(int argc, char argv[][64]) {
             network_ping_simulation("127.0.0.1");
         }
     }
+    else if (net_strcmp(argv[1], "bench") == 0) {
+        int count = (argc >= 4) ? atoi(argv[3]) : 10000;
+        int size = (argc >= 5) ? atoi(argv[4]) : 1514;
+        network_bench(argc >= 3 ? argv[2] : "eth0", count > 0 ? count : 10000, size);
+    }
+    else if (net_strcmp(argv[1], "nic") == 0) {
+        e1000_show_stats();
+    }
+    else if (net_strcmp(argv[1], "lobench") == 0) {
+        int count = (argc >= 3) ? atoi(argv[2]) : 10000;
+        int size = (argc >= 4) ? atoi(argv[3]) : 64;
+        network_loopback_bench(count > 0 ? count : 10000, size);
+    }
     else {
         terminal_writestring("Unknown network command: ");
         terminal_writestring(argv[1]);
@@ -5,11 +5,12 @@
 #define NETWORK_H
 
 #include "types.h"
+#include "poll.h"
+#include "skbuff.h"
 
 // Network configuration constants (no hardcoding)
 #define MAX_NETWORK_INTERFACES 4
 #define MAX_PACKET_SIZE 1518          // Standard Ethernet frame size
-#define PACKET_BUFFER_COUNT 32        // Number of packet buffers
 #define NETWORK_QUEUE_SIZE 16         // Network queue depth
 
 // Network interface types
@@ -26,17 +27,20 @@ typedef enum {
     NET_STATE_TESTING = 2
 } net_interface_state_t;
 
-// Basic packet structure (simplified)
-typedef struct {
-    uint8_t data[MAX_PACKET_SIZE];     // Packet data
-    size_t size;                       // Actual packet size
-    uint32_t timestamp;                // Packet timestamp
-    bool in_use;                       // Buffer in use flag
-    int interface_id;                  // Source/destination interface
-} network_packet_t;
+struct network_interface;
+
+// Day 21: device driver hooks. An interface without ops is simulated
+// (sends only count); a driver's IRQ handler feeds network_rx_enqueue().
+// transmit() copies the frame out; transmit_buffer() takes ownership of
+// the packet buffer instead (queued or freed, success or not).
+typedef struct net_device_ops {
+    const char* name;                                   // Driver name
+    int (*transmit)(struct network_interface* iface, const uint8_t* data, size_t size);
+    int (*transmit_buffer)(struct network_interface* iface, sk_buff_t* skb);
+} net_device_ops_t;
 
 // Network interface structure (basic abstraction)
-typedef struct {
+typedef struct network_interface {
     int id;                           // Interface ID
     char name[16];                    // Interface name (e.g., "eth0", "lo")
     net_interface_type_t type;        // Interface type
@@ -49,6 +53,13 @@ typedef struct {
     uint32_t bytes_received;          // Statistics: bytes received
     uint32_t errors;                  // Error count
     bool enabled;                     // Interface enabled flag
+    poll_head_t poll;                 // Day 21: readiness watchers (RX)
+    const net_device_ops_t* ops;      // Day 21: driver (NULL: simulated)
+    void* priv;                       // Driver state
+    sk_buff_t* rx_queue[NETWORK_QUEUE_SIZE];  // Received, not yet read
+    uint32_t rx_head;                 // Next frame to read
+    uint32_t rx_tail;                 // Next free slot
+    uint32_t rx_dropped;              // Frames lost: queue or buffers full
 } network_interface_t;
 
 // Network statistics
@@ -59,12 +70,12 @@ typedef struct {
     uint32_t total_bytes_received;
     uint32_t total_errors;
     uint32_t active_interfaces;
-    uint32_t buffer_usage;
+    uint32_t buffer_usage;             // Day 21: sk_buffs allocated
+    uint32_t total_rx_dropped;
 } network_stats_t;
 
 // Global variables
 extern network_interface_t network_interfaces[MAX_NETWORK_INTERFACES];
-extern network_packet_t packet_buffers[PACKET_BUFFER_COUNT];
 extern int next_interface_id;
 extern bool network_initialized;
 
@@ -81,11 +92,19 @@ int network_disable_interface(int interface_id);
 network_interface_t* network_find_interface(int interface_id);
 network_interface_t* network_find_interface_by_name(const char* name);
 
-// Packet buffer management
-network_packet_t* network_alloc_packet(void);
-void network_free_packet(network_packet_t* packet);
+// Packet buffer management (Day 21: pooled sk_buffs with headroom for
+// link-layer headers; see skbuff.h)
+sk_buff_t* network_alloc_packet(void);
+void network_free_packet(sk_buff_t* skb);
 int network_send_packet(int interface_id, const uint8_t* data, size_t size);
-network_packet_t* network_receive_packet(int interface_id);
+int network_send_buffer(int interface_id, sk_buff_t* skb);   // Consumes skb
+sk_buff_t* network_receive_packet(int interface_id);
+
+// Day 21: pollable interface descriptors
+int network_open(int interface_id);
+bool network_rx_pending(int interface_id);
+void network_rx_notify(int interface_id);       // Receive path: frame queued
+int network_rx_enqueue(network_interface_t* iface, sk_buff_t* skb);  // IRQ-safe
 
 // Network statistics and monitoring
 void network_get_stats(network_stats_t* stats);
@@ -103,5 +122,7 @@ void network_command_handler(int argc, char argv[][64]);
 void network_ping_simulation(const char* target);
 void network_show_interfaces(void);
 void network_show_stats(void);
+void network_bench(const char* name, int count, int size);
+void network_loopback_bench(int count, int size);
 
 #endif // NETWORK_H
\ No newline at end of file
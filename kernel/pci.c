@@ -0,0 +1,208 @@
+// ClaudeOS PCI Bus - Day 21
+// Configuration-space access (mechanism #1) and bus enumeration
+
+#include "pci.h"
+#include "pic.h"
+#include "cpu.h"
+#include "kernel.h"
+#include "string.h"
+
+static pci_device_t pci_devices[PCI_MAX_DEVICES];
+static int pci_num_devices = 0;
+
+// The address/data port pair is shared state: keep each access atomic
+static uint32_t pci_config_address(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset) {
+    return 0x80000000u | ((uint32_t)bus << 16) | ((uint32_t)(slot & 0x1F) << 11) |
+           ((uint32_t)(function & 0x07) << 8) | (offset & 0xFC);
+}
+
+uint32_t pci_config_read32(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset) {
+    uint32_t flags = irq_save();
+    outl(PCI_CONFIG_ADDRESS, pci_config_address(bus, slot, function, offset));
+    uint32_t value = inl(PCI_CONFIG_DATA);
+    irq_restore(flags);
+    return value;
+}
+
+uint16_t pci_config_read16(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset) {
+    return (uint16_t)(pci_config_read32(bus, slot, function, offset) >> ((offset & 2) * 8));
+}
+
+uint8_t pci_config_read8(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset) {
+    return (uint8_t)(pci_config_read32(bus, slot, function, offset) >> ((offset & 3) * 8));
+}
+
+void pci_config_write32(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset, uint32_t value) {
+    uint32_t flags = irq_save();
+    outl(PCI_CONFIG_ADDRESS, pci_config_address(bus, slot, function, offset));
+    outl(PCI_CONFIG_DATA, value);
+    irq_restore(flags);
+}
+
+// Read-modify-write of the containing dword
+void pci_config_write16(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset, uint16_t value) {
+    uint32_t shift = (offset & 2) * 8;
+    uint32_t flags = irq_save();
+    outl(PCI_CONFIG_ADDRESS, pci_config_address(bus, slot, function, offset));
+    uint32_t dword = inl(PCI_CONFIG_DATA);
+    dword = (dword & ~(0xFFFFu << shift)) | ((uint32_t)value << shift);
+    outl(PCI_CONFIG_DATA, dword);
+    irq_restore(flags);
+}
+
+static void pci_probe_function(uint8_t bus, uint8_t slot, uint8_t function) {
+    uint16_t vendor = pci_config_read16(bus, slot, function, PCI_VENDOR_ID);
+    if (vendor == PCI_VENDOR_NONE || pci_num_devices >= PCI_MAX_DEVICES) {
+        return;
+    }
+
+    pci_device_t* dev = &pci_devices[pci_num_devices++];
+    dev->bus = bus;
+    dev->slot = slot;
+    dev->function = function;
+    dev->vendor_id = vendor;
+    dev->device_id = pci_config_read16(bus, slot, function, PCI_DEVICE_ID);
+    dev->class_code = pci_config_read8(bus, slot, function, PCI_CLASS);
+    dev->subclass = pci_config_read8(bus, slot, function, PCI_SUBCLASS);
+    dev->prog_if = pci_config_read8(bus, slot, function, PCI_PROG_IF);
+    dev->revision = pci_config_read8(bus, slot, function, PCI_REVISION_ID);
+    dev->irq_line = pci_config_read8(bus, slot, function, PCI_INTERRUPT_LINE);
+    dev->irq_pin = pci_config_read8(bus, slot, function, PCI_INTERRUPT_PIN);
+
+    // Only general devices (header type 0) have six BARs
+    uint8_t header = pci_config_read8(bus, slot, function, PCI_HEADER_TYPE) & 0x7F;
+    for (int i = 0; i < PCI_BAR_COUNT; i++) {
+        dev->bar[i] = (header == 0) ? pci_config_read32(bus, slot, function, PCI_BAR0 + i * 4) : 0;
+    }
+}
+
+// Brute-force scan; firmware has already assigned BARs and IRQ lines
+void pci_init(void) {
+    pci_num_devices = 0;
+    for (int bus = 0; bus < 256; bus++) {
+        for (int slot = 0; slot < 32; slot++) {
+            if (pci_config_read16(bus, slot, 0, PCI_VENDOR_ID) == PCI_VENDOR_NONE) {
+                continue;
+            }
+            pci_probe_function(bus, slot, 0);
+
+            uint8_t header = pci_config_read8(bus, slot, 0, PCI_HEADER_TYPE);
+            if (header & PCI_HEADER_MULTIFUNCTION) {
+                for (int function = 1; function < 8; function++) {
+                    pci_probe_function(bus, slot, function);
+                }
+            }
+        }
+    }
+}
+
+int pci_device_count(void) {
+    return pci_num_devices;
+}
+
+pci_device_t* pci_get_device(int index) {
+    if (index < 0 || index >= pci_num_devices) {
+        return NULL;
+    }
+    return &pci_devices[index];
+}
+
+pci_device_t* pci_find_device(uint16_t vendor_id, uint16_t device_id) {
+    for (int i = 0; i < pci_num_devices; i++) {
+        if (pci_devices[i].vendor_id == vendor_id && pci_devices[i].device_id == device_id) {
+            return &pci_devices[i];
+        }
+    }
+    return NULL;
+}
+
+bool pci_bar_is_io(const pci_device_t* dev, int bar) {
+    return (dev->bar[bar] & 0x1) != 0;
+}
+
+// Base address with the type bits masked off (32-bit BARs only; the
+// memory map ends well below 4GB)
+uint32_t pci_bar_address(const pci_device_t* dev, int bar) {
+    if (pci_bar_is_io(dev, bar)) {
+        return dev->bar[bar] & ~0x3u;
+    }
+    return dev->bar[bar] & ~0xFu;
+}
+
+// Turn on decoding of the device's BARs, legacy interrupts and optionally DMA
+void pci_enable_device(pci_device_t* dev, bool bus_master) {
+    uint16_t command = pci_config_read16(dev->bus, dev->slot, dev->function, PCI_COMMAND);
+    command |= PCI_COMMAND_IO | PCI_COMMAND_MEMORY;
+    command &= ~PCI_COMMAND_INTX_OFF;
+    if (bus_master) {
+        command |= PCI_COMMAND_MASTER;
+    }
+    pci_config_write16(dev->bus, dev->slot, dev->function, PCI_COMMAND, command);
+}
+
+// Stop the device's DMA (e.g. when a driver gives it up)
+void pci_clear_master(pci_device_t* dev) {
+    uint16_t command = pci_config_read16(dev->bus, dev->slot, dev->function, PCI_COMMAND);
+    pci_config_write16(dev->bus, dev->slot, dev->function, PCI_COMMAND, command & ~PCI_COMMAND_MASTER);
+}
+
+const char* pci_class_string(uint8_t class_code, uint8_t subclass) {
+    switch (class_code) {
+        case 0x01: return subclass == 0x01 ? "IDE controller" : "Storage";
+        case 0x02: return subclass == 0x00 ? "Ethernet" : "Network";
+        case 0x03: return "Display";
+        case 0x04: return "Multimedia";
+        case 0x06:
+            switch (subclass) {
+                case 0x00: return "Host bridge";
+                case 0x01: return "ISA bridge";
+                case 0x04: return "PCI bridge";
+                default:   return "Bridge";
+            }
+        case 0x0C: return "Serial bus";
+        default:   return "Other";
+    }
+}
+
+static void pci_print_hex(uint32_t value, int digits) {
+    char hex[] = "0123456789abcdef";
+    char buffer[9];
+    for (int i = digits - 1; i >= 0; i--) {
+        buffer[i] = hex[value & 0xF];
+        value >>= 4;
+    }
+    buffer[digits] = '\0';
+    terminal_writestring(buffer);
+}
+
+void pci_list_devices(void) {
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
+    terminal_writestring("PCI Devices:\n");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+
+    for (int i = 0; i < pci_num_devices; i++) {
+        pci_device_t* dev = &pci_devices[i];
+        terminal_printf("  %d:%d.%d ", dev->bus, dev->slot, dev->function);
+        pci_print_hex(dev->vendor_id, 4);
+        terminal_writestring(":");
+        pci_print_hex(dev->device_id, 4);
+        terminal_printf(" %s", pci_class_string(dev->class_code, dev->subclass));
+        if (dev->irq_pin) {
+            terminal_printf(" irq %d", dev->irq_line);
+        }
+        if (dev->bar[0]) {
+            terminal_writestring(pci_bar_is_io(dev, 0) ? " io 0x" : " mem 0x");
+            pci_print_hex(pci_bar_address(dev, 0), 8);
+        }
+        terminal_writestring("\n");
+    }
+    terminal_printf("%d device(s)\n", pci_num_devices);
+}
+
+void pci_command_handler(int argc, char argv[][64]) {
+    if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        pci_list_devices();
+    } else {
+        terminal_writestring("Usage: pci [list]\n");
+    }
+}
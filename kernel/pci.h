@@ -0,0 +1,77 @@
+// ClaudeOS PCI Bus - Day 21
+// Configuration-space access (mechanism #1) and bus enumeration
+
+#ifndef PCI_H
+#define PCI_H
+
+#include "types.h"
+
+// Configuration mechanism #1 ports
+#define PCI_CONFIG_ADDRESS  0xCF8
+#define PCI_CONFIG_DATA     0xCFC
+
+// Configuration space header (type 0) offsets
+#define PCI_VENDOR_ID       0x00
+#define PCI_DEVICE_ID       0x02
+#define PCI_COMMAND         0x04
+#define PCI_STATUS          0x06
+#define PCI_REVISION_ID     0x08
+#define PCI_PROG_IF         0x09
+#define PCI_SUBCLASS        0x0A
+#define PCI_CLASS           0x0B
+#define PCI_HEADER_TYPE     0x0E
+#define PCI_BAR0            0x10
+#define PCI_INTERRUPT_LINE  0x3C
+#define PCI_INTERRUPT_PIN   0x3D
+
+// Command register bits
+#define PCI_COMMAND_IO          0x0001
+#define PCI_COMMAND_MEMORY      0x0002
+#define PCI_COMMAND_MASTER      0x0004  // Bus mastering (DMA)
+#define PCI_COMMAND_INTX_OFF    0x0400
+
+#define PCI_HEADER_MULTIFUNCTION 0x80
+#define PCI_VENDOR_NONE     0xFFFF
+
+#define PCI_MAX_DEVICES     32
+#define PCI_BAR_COUNT       6
+
+typedef struct pci_device {
+    uint8_t bus;
+    uint8_t slot;
+    uint8_t function;
+    uint16_t vendor_id;
+    uint16_t device_id;
+    uint8_t class_code;
+    uint8_t subclass;
+    uint8_t prog_if;
+    uint8_t revision;
+    uint8_t irq_line;                  // Legacy PIC line (0xFF: none)
+    uint8_t irq_pin;                   // INTA..INTD = 1..4 (0: none)
+    uint32_t bar[PCI_BAR_COUNT];       // Raw BAR values
+} pci_device_t;
+
+// Raw configuration space access
+uint32_t pci_config_read32(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset);
+uint16_t pci_config_read16(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset);
+uint8_t pci_config_read8(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset);
+void pci_config_write32(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset, uint32_t value);
+void pci_config_write16(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset, uint16_t value);
+
+// Enumerate every bus/slot/function once at boot
+void pci_init(void);
+int pci_device_count(void);
+pci_device_t* pci_get_device(int index);
+pci_device_t* pci_find_device(uint16_t vendor_id, uint16_t device_id);
+
+// BAR decoding and device setup
+bool pci_bar_is_io(const pci_device_t* dev, int bar);
+uint32_t pci_bar_address(const pci_device_t* dev, int bar);
+void pci_enable_device(pci_device_t* dev, bool bus_master);
+void pci_clear_master(pci_device_t* dev);
+
+const char* pci_class_string(uint8_t class_code, uint8_t subclass);
+void pci_list_devices(void);
+void pci_command_handler(int argc, char argv[][64]);
+
+#endif // PCI_H
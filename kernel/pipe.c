@@ -0,0 +1,498 @@
+// ClaudeOS Pipes - Day 21
+// Blocking byte streams between processes, reached through descriptors
+
+#include "pipe.h"
+#include "fd.h"
+#include "heap.h"
+#include "ipc.h"
+#include "syscall.h"
+#include "process.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "idt.h"
+#include "kernel.h"
+#include "string.h"
+
+static pipe_t pipe_pool[MAX_PIPES];
+
+static inline size_t pipe_min(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+// Free the ring once both ends are closed (IRQs off)
+static void pipe_release_if_unused(pipe_t* pipe) {
+    if (pipe->readers == 0 && pipe->writers == 0) {
+        poll_head_detach(&pipe->poll);
+        kfree(pipe->buffer);
+        memset(pipe, 0, sizeof(*pipe));
+    }
+}
+
+// Add a page to a full ring, unwrapping the data to the front (IRQs off).
+// Returns false at PIPE_MAX_SIZE or when the heap is exhausted.
+static bool pipe_grow(pipe_t* pipe) {
+    if (pipe->capacity >= PIPE_MAX_SIZE) {
+        return false;
+    }
+    uint8_t* buffer = (uint8_t*)kmalloc(pipe->capacity + PIPE_GROW_SIZE);
+    if (!buffer) {
+        return false;
+    }
+
+    uint32_t first = pipe_min(pipe->count, pipe->capacity - pipe->head);
+    memcpy(buffer, pipe->buffer + pipe->head, first);
+    memcpy(buffer + first, pipe->buffer, pipe->count - first);
+    kfree(pipe->buffer);
+
+    pipe->buffer = buffer;
+    pipe->head = 0;
+    pipe->capacity += PIPE_GROW_SIZE;
+    pipe->grows++;
+    return true;
+}
+
+int pipe_read(pipe_t* pipe, void* buffer, size_t count) {
+    if (!pipe || !buffer || in_interrupt()) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t flags = irq_save();
+    while (pipe->count == 0) {
+        if (pipe->writers == 0) {
+            irq_restore(flags);
+            return 0;               // End of stream
+        }
+        pipe->read_blocks++;
+        wait_queue_sleep(&pipe->read_wait);
+    }
+
+    size_t n = pipe_min(count, pipe->count);
+    size_t first = pipe_min(n, pipe->capacity - pipe->head);
+    memcpy(buffer, pipe->buffer + pipe->head, first);
+    memcpy((uint8_t*)buffer + first, pipe->buffer, n - first);
+    pipe->head = (pipe->head + n) % pipe->capacity;
+    pipe->count -= n;
+
+    wait_queue_wake_all(&pipe->write_wait);
+    poll_notify(&pipe->poll, POLLOUT);
+    irq_restore(flags);
+    return (int)n;
+}
+
+int pipe_write(pipe_t* pipe, const void* buffer, size_t count) {
+    if (!pipe || !buffer || in_interrupt()) {
+        return -1;
+    }
+
+    const uint8_t* src = (const uint8_t*)buffer;
+    size_t done = 0;
+    uint32_t flags = irq_save();
+    while (done < count) {
+        if (pipe->readers == 0) {
+            break;                  // Broken pipe
+        }
+
+        size_t space = pipe->capacity - pipe->count;
+        if (space == 0) {
+            if (!pipe_grow(pipe)) {
+                pipe->write_blocks++;
+                wait_queue_sleep(&pipe->write_wait);
+            }
+            continue;
+        }
+
+        size_t n = pipe_min(count - done, space);
+        size_t tail = (pipe->head + pipe->count) % pipe->capacity;
+        size_t first = pipe_min(n, pipe->capacity - tail);
+        memcpy(pipe->buffer + tail, src + done, first);
+        memcpy(pipe->buffer, src + done + first, n - first);
+        pipe->count += n;
+        pipe->bytes_written += n;
+        done += n;
+
+        wait_queue_wake_all(&pipe->read_wait);
+        poll_notify(&pipe->poll, POLLIN);
+    }
+    irq_restore(flags);
+
+    if (done == 0 && count > 0) {
+        return -1;
+    }
+    return (int)done;
+}
+
+// Descriptor glue: each end counts its open descriptors
+static int pipe_fd_read(void* object, void* buffer, size_t count) {
+    return pipe_read((pipe_t*)object, buffer, count);
+}
+
+static int pipe_fd_write(void* object, const void* buffer, size_t count) {
+    return pipe_write((pipe_t*)object, buffer, count);
+}
+
+static void pipe_get_reader(void* object) {
+    ((pipe_t*)object)->readers++;
+}
+
+static void pipe_get_writer(void* object) {
+    ((pipe_t*)object)->writers++;
+}
+
+// Last reader gone: writers see a broken pipe
+static void pipe_put_reader(void* object) {
+    pipe_t* pipe = (pipe_t*)object;
+    uint32_t flags = irq_save();
+    if (--pipe->readers == 0) {
+        wait_queue_wake_all(&pipe->write_wait);
+        poll_notify(&pipe->poll, POLLERR);
+    }
+    pipe_release_if_unused(pipe);
+    irq_restore(flags);
+}
+
+// Last writer gone: readers drain the ring, then see end of stream
+static void pipe_put_writer(void* object) {
+    pipe_t* pipe = (pipe_t*)object;
+    uint32_t flags = irq_save();
+    if (--pipe->writers == 0) {
+        wait_queue_wake_all(&pipe->read_wait);
+        poll_notify(&pipe->poll, POLLIN | POLLHUP);
+    }
+    pipe_release_if_unused(pipe);
+    irq_restore(flags);
+}
+
+static uint32_t pipe_poll_reader(void* object) {
+    pipe_t* pipe = (pipe_t*)object;
+    return (pipe->count ? POLLIN : 0) | (pipe->writers == 0 ? POLLHUP : 0);
+}
+
+// Writable while there is room, or room can still be added
+static uint32_t pipe_poll_writer(void* object) {
+    pipe_t* pipe = (pipe_t*)object;
+    if (pipe->readers == 0) {
+        return POLLERR;
+    }
+    return (pipe->count < pipe->capacity || pipe->capacity < PIPE_MAX_SIZE) ? POLLOUT : 0;
+}
+
+static poll_head_t* pipe_poll_head(void* object) {
+    return &((pipe_t*)object)->poll;
+}
+
+const fd_ops_t pipe_read_ops = {
+    .name      = "pipe (read)",
+    .read      = pipe_fd_read,
+    .write     = NULL,
+    .get       = pipe_get_reader,
+    .put       = pipe_put_reader,
+    .poll      = pipe_poll_reader,
+    .poll_head = pipe_poll_head,
+};
+
+const fd_ops_t pipe_write_ops = {
+    .name      = "pipe (write)",
+    .read      = NULL,
+    .write     = pipe_fd_write,
+    .get       = pipe_get_writer,
+    .put       = pipe_put_writer,
+    .poll      = pipe_poll_writer,
+    .poll_head = pipe_poll_head,
+};
+
+int pipe_create(int fds[2]) {
+    if (!fds || !current_process) {
+        return -1;
+    }
+
+    uint32_t flags = irq_save();
+    pipe_t* pipe = NULL;
+    for (int i = 0; i < MAX_PIPES; i++) {
+        if (!pipe_pool[i].used) {
+            pipe = &pipe_pool[i];
+            break;
+        }
+    }
+    if (!pipe) {
+        irq_restore(flags);
+        return -1;
+    }
+
+    pipe->buffer = (uint8_t*)kmalloc(PIPE_MIN_SIZE);
+    if (!pipe->buffer) {
+        irq_restore(flags);
+        return -1;
+    }
+    pipe->used = true;
+    pipe->capacity = PIPE_MIN_SIZE;
+    wait_queue_init(&pipe->read_wait);
+    wait_queue_init(&pipe->write_wait);
+    poll_head_init(&pipe->poll);
+
+    // Each installed descriptor holds a reference; closing the ones that
+    // made it in frees the pipe again on failure
+    fds[0] = fd_install(current_process, &pipe_read_ops, pipe);
+    fds[1] = (fds[0] >= 0) ? fd_install(current_process, &pipe_write_ops, pipe) : -1;
+    if (fds[1] < 0) {
+        if (fds[0] >= 0) {
+            fd_close(fds[0]);
+        } else {
+            pipe_release_if_unused(pipe);
+        }
+        irq_restore(flags);
+        return -1;
+    }
+
+    irq_restore(flags);
+    return 0;
+}
+
+// SYS_PIPE (17) - Store the read and write descriptors at fds_ptr[0..1]
+int sys_pipe(uint32_t fds_ptr, uint32_t arg2, uint32_t arg3) {
+    (void)arg2; (void)arg3; // Suppress unused parameter warnings
+
+    return pipe_create((int*)fds_ptr) == 0 ? SYSCALL_SUCCESS : SYSCALL_ERROR;
+}
+
+void pipe_list(void) {
+    int shown = 0;
+    terminal_writestring("Pipes:\n");
+    for (int i = 0; i < MAX_PIPES; i++) {
+        pipe_t* pipe = &pipe_pool[i];
+        if (pipe->used) {
+            terminal_printf("  [%d] %u/%u bytes, readers %u, writers %u, written %u, grows %u\n",
+                            i, pipe->count, pipe->capacity, pipe->readers, pipe->writers,
+                            pipe->bytes_written, pipe->grows);
+            shown++;
+        }
+    }
+    if (!shown) {
+        terminal_writestring("  (none)\n");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test and benchmark: a child kernel thread streams into the shell process
+// ---------------------------------------------------------------------------
+
+#define PIPE_BENCH_DEFAULT_KB   256
+#define PIPE_BENCH_CHUNK        1024
+
+static struct {
+    int child_fd;                   // Write end in the child's table
+    uint32_t total;                 // Bytes to stream
+    bool close_early;               // Child closes its end (else the reaper does)
+    int reader_pid;
+} pipe_bench;
+
+// Bytes follow a pattern the reader can check at any offset
+static inline uint8_t pipe_pattern(uint32_t offset) {
+    return (uint8_t)(offset * 7 + (offset >> 8));
+}
+
+static void pipe_writer_thread(void* arg) {
+    (void)arg;
+    static uint8_t chunk[1500];
+    uint32_t offset = 0;
+    uint32_t size = 1;
+
+    // Odd sizes exercise wrap-around and partial reads on the other side
+    while (offset < pipe_bench.total) {
+        uint32_t n = pipe_min(size, pipe_bench.total - offset);
+        for (uint32_t i = 0; i < n; i++) {
+            chunk[i] = pipe_pattern(offset + i);
+        }
+        if (fd_write(pipe_bench.child_fd, chunk, n) != (int)n) {
+            break;
+        }
+        offset += n;
+        size = (size * 13 + 7) % sizeof(chunk) + 1;
+    }
+
+    if (pipe_bench.close_early) {
+        fd_close(pipe_bench.child_fd);
+    }
+}
+
+static void pipe_bulk_writer_thread(void* arg) {
+    (void)arg;
+    static uint8_t chunk[PIPE_BENCH_CHUNK];
+    for (uint32_t sent = 0; sent < pipe_bench.total; sent += sizeof(chunk)) {
+        fd_write(pipe_bench.child_fd, chunk, sizeof(chunk));
+    }
+    fd_close(pipe_bench.child_fd);
+}
+
+static void pipe_mailbox_writer_thread(void* arg) {
+    (void)arg;
+    static uint8_t chunk[MAX_MESSAGE_SIZE];
+    for (uint32_t sent = 0; sent < pipe_bench.total; sent += sizeof(chunk)) {
+        ipc_msg_send_wait(pipe_bench.reader_pid, chunk, sizeof(chunk));
+    }
+}
+
+// Start 'fn' with its own copy of the write end, then drop ours so the
+// reader sees end of stream when the child is done
+static int pipe_start_writer(void (*fn)(void* arg), int fds[2], const char* name) {
+    uint32_t flags = irq_save();
+    int pid = kthread_create_child(fn, NULL, name);
+    process_t* child = process_find(pid);
+    pipe_bench.child_fd = child ? fd_dup_to(child, fds[1]) : -1;
+    irq_restore(flags);
+
+    fd_close(fds[1]);
+    if (pid != INVALID_PID && pipe_bench.child_fd < 0) {
+        int status = 0;
+        process_wait(pid, &status);     // Its writes fail at once
+        pid = INVALID_PID;
+    }
+    return pid;
+}
+
+static void pipe_run_test(void) {
+    static uint8_t buffer[700];
+    int fds[2];
+    int status = 0;
+
+    if (pipe_create(fds) != 0) {
+        terminal_writestring("pipe test: cannot create pipe\n");
+        return;
+    }
+    pipe_t* pipe = (pipe_t*)fd_lookup(fds[0])->object;
+
+    pipe_bench.total = 32 * 1024;
+    pipe_bench.close_early = false;
+    int pid = pipe_start_writer(pipe_writer_thread, fds, "pipe_writer");
+    if (pid == INVALID_PID) {
+        fd_close(fds[0]);
+        return;
+    }
+
+    // Reader sizes differ from writer sizes: every read is partial or spans writes
+    uint32_t offset = 0;
+    uint32_t reads = 0;
+    uint32_t errors = 0;
+    uint32_t size = 100;
+    int n;
+    while ((n = fd_read(fds[0], buffer, size)) > 0) {
+        for (int i = 0; i < n; i++) {
+            if (buffer[i] != pipe_pattern(offset + i)) {
+                errors++;
+            }
+        }
+        offset += n;
+        reads++;
+        size = (size * 5 + 3) % sizeof(buffer) + 1;
+    }
+    uint32_t capacity = pipe->capacity;
+    uint32_t grows = pipe->grows;
+    uint32_t blocks = pipe->write_blocks;
+    process_wait(pid, &status);
+
+    terminal_printf("  stream: %u/%u bytes in %u reads, %u mismatches, EOF after writer exit: %s\n",
+                    offset, pipe_bench.total, reads, errors, n == 0 ? "yes" : "no");
+    terminal_printf("  ring grew %u times to %u bytes, writer blocked %u times\n",
+                    grows, capacity, blocks);
+
+    // Broken pipe: writing with no reader left fails
+    int wfds[2];
+    if (pipe_create(wfds) == 0) {
+        fd_close(wfds[0]);
+        terminal_printf("  write after reader close: %d (expect -1)\n",
+                        fd_write(wfds[1], buffer, 16));
+        fd_close(wfds[1]);
+    }
+    fd_close(fds[0]);
+}
+
+static void pipe_run_bench(uint32_t kb) {
+    static uint8_t buffer[4096];
+    int fds[2];
+    int status = 0;
+    uint32_t total = kb * 1024;
+
+    terminal_printf("Streaming %u KB into the shell process:\n", kb);
+
+    // Pipe: 1KB writes, 4KB reads
+    if (pipe_create(fds) != 0) {
+        terminal_writestring("pipe bench: cannot create pipe\n");
+        return;
+    }
+    pipe_t* pipe = (pipe_t*)fd_lookup(fds[0])->object;
+    pipe_bench.total = total;
+    uint32_t switches = process_get_switch_count();
+    uint64_t start = clock_cycles();
+    int pid = pipe_start_writer(pipe_bulk_writer_thread, fds, "pipe_bench");
+    uint32_t received = 0;
+    int n;
+    while (pid != INVALID_PID && (n = fd_read(fds[0], buffer, sizeof(buffer))) > 0) {
+        received += n;
+    }
+    uint64_t ns = clock_cycles_to_ns(clock_cycles() - start);
+    switches = process_get_switch_count() - switches;
+    terminal_printf("  pipe:    %u KB/s, %u switches, ring %u bytes (%u grows), %u/%u blocked reads/writes\n",
+                    ns ? (uint32_t)div64_u64((uint64_t)received * 1000000, ns) : 0, switches,
+                    pipe->capacity, pipe->grows, pipe->read_blocks, pipe->write_blocks);
+    fd_close(fds[0]);
+    if (pid != INVALID_PID) {
+        process_wait(pid, &status);
+    }
+
+    // Mailbox: 256-byte datagrams through the blocking send/receive pair
+    pipe_bench.reader_pid = current_process->pid;
+    switches = process_get_switch_count();
+    start = clock_cycles();
+    pid = kthread_create_child(pipe_mailbox_writer_thread, NULL, "pipe_mbox");
+    received = 0;
+    while (pid != INVALID_PID && received < total) {
+        n = ipc_msg_receive_wait(pid, buffer, sizeof(buffer), NULL);
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+    }
+    ns = clock_cycles_to_ns(clock_cycles() - start);
+    switches = process_get_switch_count() - switches;
+    terminal_printf("  mailbox: %u KB/s, %u switches\n",
+                    ns ? (uint32_t)div64_u64((uint64_t)received * 1000000, ns) : 0, switches);
+    if (pid != INVALID_PID) {
+        process_wait(pid, &status);
+    }
+}
+
+void pipe_command_handler(int argc, char argv[][64]) {
+    if (argc < 2) {
+        terminal_writestring("Pipe Commands:\n");
+        terminal_writestring("  pipe list       - Show open pipes and this shell's descriptors\n");
+        terminal_writestring("  pipe test       - Stream, EOF and broken-pipe checks\n");
+        terminal_writestring("  pipe bench [kb] - Pipe vs mailbox throughput\n");
+        return;
+    }
+
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "list") == 0) {
+        pipe_list();
+        fd_list(current_process);
+    }
+    else if (strcmp(argv[1], "test") == 0) {
+        pipe_run_test();
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        int kb = (argc >= 3) ? atoi(argv[2]) : PIPE_BENCH_DEFAULT_KB;
+        if (kb <= 0) {
+            kb = PIPE_BENCH_DEFAULT_KB;
+        }
+        pipe_run_bench((uint32_t)kb);
+    }
+    else {
+        terminal_printf("Unknown pipe command: %s\n", argv[1]);
+    }
+}
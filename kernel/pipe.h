@@ -0,0 +1,56 @@
+// ClaudeOS Pipes - Day 21
+// Blocking byte streams between processes, reached through descriptors
+
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "types.h"
+#include "wait.h"
+#include "fd.h"
+#include "poll.h"
+
+#define MAX_PIPES           16
+#define PIPE_MIN_SIZE       4096            // Initial ring (one page)
+#define PIPE_MAX_SIZE       (16 * 4096)     // Growth stops here: writers block
+#define PIPE_GROW_SIZE      4096
+
+typedef struct pipe {
+    bool used;
+    uint8_t* buffer;                // kmalloc'd ring
+    uint32_t capacity;
+    uint32_t head;                  // Next byte to read
+    uint32_t count;                 // Bytes buffered
+    uint32_t readers;               // Open read descriptors
+    uint32_t writers;               // Open write descriptors
+    wait_queue_t read_wait;         // Readers sleeping on empty
+    wait_queue_t write_wait;        // Writers sleeping on full
+    poll_head_t poll;               // Readiness watchers (both ends)
+
+    // Statistics
+    uint32_t bytes_written;
+    uint32_t read_blocks;
+    uint32_t write_blocks;
+    uint32_t grows;
+} pipe_t;
+
+extern const fd_ops_t pipe_read_ops;
+extern const fd_ops_t pipe_write_ops;
+
+// Create a pipe in the current process: fds[0] reads, fds[1] writes.
+// Returns 0, or -1 if no pipe, buffer or descriptor is available.
+int pipe_create(int fds[2]);
+
+// Blocking I/O. Reads return as soon as any bytes are buffered, and 0 at
+// end of stream once every writer has closed. Writes return after the
+// whole buffer is queued; if every reader closes first they return the
+// bytes already queued, or -1 if there were none.
+int pipe_read(pipe_t* pipe, void* buffer, size_t count);
+int pipe_write(pipe_t* pipe, const void* buffer, size_t count);
+
+// SYS_PIPE
+int sys_pipe(uint32_t fds_ptr, uint32_t arg2, uint32_t arg3);
+
+void pipe_list(void);
+void pipe_command_handler(int argc, char argv[][64]);
+
+#endif // PIPE_H
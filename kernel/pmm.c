@@ -2,6 +2,8 @@
 // Bitmap-based physical page frame allocator
 
 #include "pmm.h"
+#include "heap.h"
+#include "lock.h"
 #include "kernel.h"
 
 // Memory bitmap - each bit represents one 4KB page
@@ -10,6 +12,9 @@ static uint32_t total_pages;
 static uint32_t free_pages;
 static uint32_t first_free_page;
 
+// Guards the bitmap and counters (allocation is allowed from IRQ context)
+static spinlock_t pmm_lock = SPINLOCK_INIT("pmm");
+
 // Bitmap manipulation functions
 static inline void set_bit(uint32_t bit) {
     memory_bitmap[bit / 8] |= (1 << (bit % 8));
@@ -59,6 +64,13 @@ void pmm_init(void) {
         free_pages--;
     }
     
+    // Reserve the heap window: with paging off the heap lives at HEAP_START
+    // itself, so those frames must never be handed out again
+    for (uint32_t i = ADDR_TO_PFN(HEAP_START); i < ADDR_TO_PFN(HEAP_START + HEAP_MAX_SIZE); i++) {
+        set_bit(i);
+        free_pages--;
+    }
+    
     // Set first free page after kernel
     first_free_page = kernel_end_page;
     
@@ -110,12 +122,15 @@ void pmm_init(void) {
 
 // Allocate a physical page (returns physical address)
 uint32_t pmm_alloc_page(void) {
+    uint32_t flags = spin_lock_irqsave(&pmm_lock);
     if (free_pages == 0) {
+        spin_unlock_irqrestore(&pmm_lock, flags);
         return 0;  // No free pages
     }
     
     uint32_t page = find_free_page();
     if (page == 0xFFFFFFFF) {
+        spin_unlock_irqrestore(&pmm_lock, flags);
         return 0;  // No free pages found
     }
     
@@ -127,12 +142,63 @@ uint32_t pmm_alloc_page(void) {
     if (page == first_free_page) {
         first_free_page++;
     }
+    spin_unlock_irqrestore(&pmm_lock, flags);
     
     return PFN_TO_ADDR(page);
 }
 
+// Allocate 'count' physically contiguous pages (first fit). Returns the
+// address of the first page, or 0 if no run is large enough.
+uint32_t pmm_alloc_pages(uint32_t count) {
+    uint32_t flags = spin_lock_irqsave(&pmm_lock);
+    if (count == 0 || count > free_pages) {
+        spin_unlock_irqrestore(&pmm_lock, flags);
+        return 0;
+    }
+    
+    uint32_t run = 0;
+    for (uint32_t i = first_free_page; i < total_pages; i++) {
+        if (test_bit(i)) {
+            run = 0;
+            continue;
+        }
+        if (++run == count) {
+            uint32_t start = i + 1 - count;
+            for (uint32_t j = start; j <= i; j++) {
+                set_bit(j);
+            }
+            free_pages -= count;
+            if (start == first_free_page) {
+                first_free_page = i + 1;
+            }
+            spin_unlock_irqrestore(&pmm_lock, flags);
+            return PFN_TO_ADDR(start);
+        }
+    }
+    
+    spin_unlock_irqrestore(&pmm_lock, flags);
+    return 0;  // No run found
+}
+
+static void pmm_free_page_locked(uint32_t page_addr);
+
+// Free a run from pmm_alloc_pages()
+void pmm_free_pages(uint32_t page_addr, uint32_t count) {
+    uint32_t flags = spin_lock_irqsave(&pmm_lock);
+    for (uint32_t i = 0; i < count; i++) {
+        pmm_free_page_locked(page_addr + i * PAGE_SIZE);
+    }
+    spin_unlock_irqrestore(&pmm_lock, flags);
+}
+
 // Free a physical page
 void pmm_free_page(uint32_t page_addr) {
+    uint32_t flags = spin_lock_irqsave(&pmm_lock);
+    pmm_free_page_locked(page_addr);
+    spin_unlock_irqrestore(&pmm_lock, flags);
+}
+
+static void pmm_free_page_locked(uint32_t page_addr) {
     uint32_t page = ADDR_TO_PFN(page_addr);
     
     if (page >= total_pages) {
@@ -24,6 +24,8 @@
 void pmm_init(void);
 uint32_t pmm_alloc_page(void);
 void pmm_free_page(uint32_t page_addr);
+uint32_t pmm_alloc_pages(uint32_t count);
+void pmm_free_pages(uint32_t page_addr, uint32_t count);
 uint32_t pmm_get_total_pages(void);
 uint32_t pmm_get_free_pages(void);
 uint32_t pmm_get_used_pages(void);
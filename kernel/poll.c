@@ -0,0 +1,813 @@
+// ClaudeOS Readiness Multiplexing - Day 21
+// poll() over descriptor sets and epoll-style interest sets with a ready list
+
+#include "poll.h"
+#include "fd.h"
+#include "pipe.h"
+#include "ipc.h"
+#include "syscall.h"
+#include "process.h"
+#include "timer.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "idt.h"
+#include "kernel.h"
+#include "string.h"
+
+// ---------------------------------------------------------------------------
+// Poll heads (all callers run with interrupts disabled or disable them)
+// ---------------------------------------------------------------------------
+
+void poll_head_init(poll_head_t* head) {
+    head->first = NULL;
+}
+
+static void poll_head_add(poll_head_t* head, poll_entry_t* entry, poll_notify_fn notify) {
+    entry->notify = notify;
+    entry->head = head;
+    entry->next = head->first;
+    head->first = entry;
+}
+
+static void poll_head_remove(poll_entry_t* entry) {
+    poll_head_t* head = entry->head;
+    if (!head) {
+        return;                     // Already detached by the object
+    }
+    poll_entry_t** link = &head->first;
+    while (*link && *link != entry) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = entry->next;
+    }
+    entry->next = NULL;
+    entry->head = NULL;
+}
+
+void poll_notify(poll_head_t* head, uint32_t events) {
+    if (!head->first) {
+        return;                     // Common case: nobody is watching
+    }
+    uint32_t flags = irq_save();
+    poll_entry_t* entry = head->first;
+    while (entry) {
+        poll_entry_t* next = entry->next;
+        entry->notify(entry, events);
+        entry = next;
+    }
+    irq_restore(flags);
+}
+
+void poll_head_detach(poll_head_t* head) {
+    uint32_t flags = irq_save();
+    while (head->first) {
+        poll_entry_t* entry = head->first;
+        head->first = entry->next;
+        entry->next = NULL;
+        entry->head = NULL;
+        entry->notify(entry, POLLFREE);
+    }
+    irq_restore(flags);
+}
+
+// ---------------------------------------------------------------------------
+// Timeouts: a sleeper with a deadline registers its queue here and the timer
+// interrupt wakes it once the tick count passes the deadline
+// ---------------------------------------------------------------------------
+
+static struct {
+    wait_queue_t* wq;               // NULL: slot has no pending timeout
+    uint64_t deadline;
+} poll_timers[MAX_PROCESSES];
+static volatile uint32_t poll_timer_count = 0;
+
+// Absolute tick for a timeout (0: none)
+static uint64_t poll_deadline(int timeout_ms) {
+    if (timeout_ms <= 0) {
+        return 0;
+    }
+    uint64_t ticks = div_u64((uint64_t)timeout_ms * TIMER_FREQUENCY + 999, 1000);
+    return timer_get_ticks64() + ticks;
+}
+
+static bool poll_expired(uint64_t deadline) {
+    return deadline && timer_get_ticks64() >= deadline;
+}
+
+// Sleep on wq until woken or the deadline passes (IRQs off)
+static void poll_sleep(wait_queue_t* wq, uint64_t deadline) {
+    int slot = current_process - process_table;
+    if (deadline) {
+        poll_timers[slot].wq = wq;
+        poll_timers[slot].deadline = deadline;
+        poll_timer_count++;
+    }
+    wait_queue_sleep(wq);
+    if (poll_timers[slot].wq) {
+        poll_timers[slot].wq = NULL;
+        poll_timer_count--;
+    }
+}
+
+void poll_timer_tick(void) {
+    if (!poll_timer_count) {
+        return;
+    }
+    uint64_t now = timer_get_ticks64();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (poll_timers[i].wq && now >= poll_timers[i].deadline) {
+            wait_queue_wake_all(poll_timers[i].wq);
+            poll_timers[i].wq = NULL;
+            poll_timer_count--;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// poll(): check every descriptor; if none is ready, hang a waiter on each
+// object's head and sleep until one of them notifies
+// ---------------------------------------------------------------------------
+
+typedef struct poll_waiter {
+    poll_entry_t entry;             // First member: callbacks cast back
+    wait_queue_t* wq;
+} poll_waiter_t;
+
+// Each sleeping poll() caller's entries (on its own stack), so a kill can
+// unhook them before the reaper frees that stack
+static struct {
+    poll_waiter_t* waiters;
+    uint32_t count;
+} poll_sleepers[MAX_PROCESSES];
+
+static void poll_waiter_notify(poll_entry_t* entry, uint32_t events) {
+    (void)events;
+    wait_queue_wake_all(((poll_waiter_t*)entry)->wq);
+}
+
+// Current readiness of one descriptor. memfs handles are plain files and
+// never block, so they are always readable and writable.
+static uint32_t poll_fd_events(int fd, poll_head_t** head) {
+    *head = NULL;
+    if (fd >= 0 && fd < FD_BASE) {
+        return memfs_simple_valid_handle(fd) ? (POLLIN | POLLOUT) : POLLNVAL;
+    }
+    fd_entry_t* entry = fd_lookup(fd);
+    if (!entry || !entry->ops->poll) {
+        return POLLNVAL;
+    }
+    *head = entry->ops->poll_head(entry->object);
+    return entry->ops->poll(entry->object);
+}
+
+int poll_fds(pollfd_t* fds, uint32_t nfds, int timeout_ms) {
+    if ((nfds && !fds) || nfds > POLL_MAX_FDS || !current_process || in_interrupt()) {
+        return -1;
+    }
+
+    poll_waiter_t waiters[POLL_MAX_FDS];
+    wait_queue_t wq = WAIT_QUEUE_INIT;
+    uint64_t deadline = poll_deadline(timeout_ms);
+    bool registered = false;
+    int ready;
+
+    uint32_t flags = irq_save();
+    for (;;) {
+        ready = 0;
+        for (uint32_t i = 0; i < nfds; i++) {
+            poll_head_t* head;
+            uint32_t events = poll_fd_events(fds[i].fd, &head);
+            fds[i].revents = events & (fds[i].events | POLLERR | POLLHUP | POLLNVAL);
+            if (fds[i].revents) {
+                ready++;
+            }
+            if (!registered) {
+                waiters[i].wq = &wq;
+                waiters[i].entry.head = NULL;
+                if (head) {
+                    poll_head_add(head, &waiters[i].entry, poll_waiter_notify);
+                }
+            }
+        }
+        registered = true;
+
+        if (ready || timeout_ms == 0 || poll_expired(deadline)) {
+            break;
+        }
+        int slot = current_process - process_table;
+        poll_sleepers[slot].waiters = waiters;
+        poll_sleepers[slot].count = nfds;
+        poll_sleep(&wq, deadline);
+        poll_sleepers[slot].waiters = NULL;
+        poll_sleepers[slot].count = 0;
+    }
+
+    for (uint32_t i = 0; i < nfds; i++) {
+        poll_head_remove(&waiters[i].entry);
+    }
+    irq_restore(flags);
+    return ready;
+}
+
+// A task killed while asleep in poll() or epoll_wait() never returns to
+// unhook itself: drop its entries and pending timeout on its behalf
+void poll_release(process_t* process) {
+    int slot = process - process_table;
+    uint32_t flags = irq_save();
+    for (uint32_t i = 0; i < poll_sleepers[slot].count; i++) {
+        poll_head_remove(&poll_sleepers[slot].waiters[i].entry);
+    }
+    poll_sleepers[slot].waiters = NULL;
+    poll_sleepers[slot].count = 0;
+    if (poll_timers[slot].wq) {
+        poll_timers[slot].wq = NULL;
+        poll_timer_count--;
+    }
+    irq_restore(flags);
+}
+
+// SYS_POLL (18) - timeout_ms is signed: -1 waits forever
+int sys_poll(uint32_t fds_ptr, uint32_t nfds, uint32_t timeout_ms) {
+    return poll_fds((pollfd_t*)fds_ptr, nfds, (int)timeout_ms);
+}
+
+// ---------------------------------------------------------------------------
+// epoll: items sit on their object's head; a notification queues the item
+// on the set's ready list (once), so epoll_wait() never scans idle sources
+// ---------------------------------------------------------------------------
+
+struct epoll;
+
+typedef struct epoll_item {
+    poll_entry_t entry;             // First member: callbacks cast back
+    struct epoll* ep;
+    const fd_ops_t* ops;
+    void* object;
+    int fd;
+    uint32_t events;                // Requested POLL* bits, plus EPOLLET
+    uint32_t data;
+    bool used;
+    bool queued;                    // On the ready list
+    struct epoll_item* ready_next;
+} epoll_item_t;
+
+typedef struct epoll {
+    bool used;
+    uint32_t refs;                  // Descriptors referring to the set
+    epoll_item_t items[EPOLL_MAX_ITEMS];
+    epoll_item_t* ready_head;
+    epoll_item_t* ready_tail;
+    wait_queue_t waiters;           // Callers sleeping in epoll_wait()
+    poll_head_t poll;               // The set itself is pollable
+    epoll_stats_t stats;
+} epoll_t;
+
+static epoll_t epoll_pool[MAX_EPOLL];
+
+static void epoll_ready_append(epoll_t* ep, epoll_item_t* item) {
+    item->queued = true;
+    item->ready_next = NULL;
+    if (ep->ready_tail) {
+        ep->ready_tail->ready_next = item;
+    } else {
+        ep->ready_head = item;
+    }
+    ep->ready_tail = item;
+}
+
+static void epoll_ready_remove(epoll_t* ep, epoll_item_t* item) {
+    if (!item->queued) {
+        return;
+    }
+    epoll_item_t* prev = NULL;
+    epoll_item_t* cur = ep->ready_head;
+    while (cur && cur != item) {
+        prev = cur;
+        cur = cur->ready_next;
+    }
+    if (cur) {
+        if (prev) {
+            prev->ready_next = cur->ready_next;
+        } else {
+            ep->ready_head = cur->ready_next;
+        }
+        if (ep->ready_tail == cur) {
+            ep->ready_tail = prev;
+        }
+    }
+    item->queued = false;
+    item->ready_next = NULL;
+}
+
+// Queue the item and wake the set's waiters (IRQs off)
+static void epoll_item_ready(epoll_item_t* item) {
+    epoll_t* ep = item->ep;
+    if (!item->queued) {
+        epoll_ready_append(ep, item);
+    }
+    wait_queue_wake_all(&ep->waiters);
+    poll_notify(&ep->poll, POLLIN);
+}
+
+static void epoll_item_notify(poll_entry_t* entry, uint32_t events) {
+    epoll_item_t* item = (epoll_item_t*)entry;
+    item->ep->stats.notifications++;
+
+    if (events & POLLFREE) {
+        // Object destroyed: the item goes with it
+        epoll_ready_remove(item->ep, item);
+        item->used = false;
+        return;
+    }
+    if (events & (item->events | POLLERR | POLLHUP)) {
+        epoll_item_ready(item);
+    }
+}
+
+static uint32_t epoll_item_poll(epoll_item_t* item) {
+    return item->ops->poll(item->object) & (item->events | POLLERR | POLLHUP);
+}
+
+static void epoll_get(void* object) {
+    ((epoll_t*)object)->refs++;
+}
+
+static void epoll_put(void* object) {
+    epoll_t* ep = (epoll_t*)object;
+    uint32_t flags = irq_save();
+    if (--ep->refs == 0) {
+        for (int i = 0; i < EPOLL_MAX_ITEMS; i++) {
+            if (ep->items[i].used) {
+                poll_head_remove(&ep->items[i].entry);
+            }
+        }
+        poll_head_detach(&ep->poll);
+        wait_queue_wake_all(&ep->waiters);
+        memset(ep, 0, sizeof(*ep));
+    }
+    irq_restore(flags);
+}
+
+static uint32_t epoll_poll(void* object) {
+    return ((epoll_t*)object)->ready_head ? POLLIN : 0;
+}
+
+static poll_head_t* epoll_poll_head(void* object) {
+    return &((epoll_t*)object)->poll;
+}
+
+static const fd_ops_t epoll_fd_ops = {
+    .name      = "epoll",
+    .read      = NULL,
+    .write     = NULL,
+    .get       = epoll_get,
+    .put       = epoll_put,
+    .poll      = epoll_poll,
+    .poll_head = epoll_poll_head,
+};
+
+static epoll_t* epoll_from_fd(int epfd) {
+    fd_entry_t* entry = fd_lookup(epfd);
+    return (entry && entry->ops == &epoll_fd_ops) ? (epoll_t*)entry->object : NULL;
+}
+
+int epoll_create(void) {
+    if (!current_process) {
+        return -1;
+    }
+
+    uint32_t flags = irq_save();
+    for (int i = 0; i < MAX_EPOLL; i++) {
+        epoll_t* ep = &epoll_pool[i];
+        if (!ep->used) {
+            memset(ep, 0, sizeof(*ep));
+            ep->used = true;
+            wait_queue_init(&ep->waiters);
+            poll_head_init(&ep->poll);
+            int fd = fd_install(current_process, &epoll_fd_ops, ep);
+            if (fd < 0) {
+                ep->used = false;
+            }
+            irq_restore(flags);
+            return fd;
+        }
+    }
+    irq_restore(flags);
+    return -1;
+}
+
+int epoll_ctl(int epfd, int op, int fd, const epoll_event_t* event) {
+    uint32_t flags = irq_save();
+    epoll_t* ep = epoll_from_fd(epfd);
+    fd_entry_t* target = fd_lookup(fd);
+    if (!ep || !target || !target->ops->poll || target->object == ep ||
+        (op != EPOLL_CTL_DEL && !event)) {
+        irq_restore(flags);
+        return -1;
+    }
+
+    epoll_item_t* item = NULL;
+    for (int i = 0; i < EPOLL_MAX_ITEMS; i++) {
+        if (ep->items[i].used && ep->items[i].fd == fd && ep->items[i].object == target->object) {
+            item = &ep->items[i];
+            break;
+        }
+    }
+
+    int result = 0;
+    switch (op) {
+    case EPOLL_CTL_ADD:
+        if (item) {
+            result = -1;
+            break;
+        }
+        for (int i = 0; i < EPOLL_MAX_ITEMS && !item; i++) {
+            if (!ep->items[i].used) {
+                item = &ep->items[i];
+            }
+        }
+        if (!item) {
+            result = -1;
+            break;
+        }
+        memset(item, 0, sizeof(*item));
+        item->used = true;
+        item->ep = ep;
+        item->ops = target->ops;
+        item->object = target->object;
+        item->fd = fd;
+        item->events = event->events;
+        item->data = event->data;
+        poll_head_add(target->ops->poll_head(target->object), &item->entry, epoll_item_notify);
+        if (epoll_item_poll(item)) {
+            epoll_item_ready(item);
+        }
+        break;
+
+    case EPOLL_CTL_MOD:
+        if (!item) {
+            result = -1;
+            break;
+        }
+        item->events = event->events;
+        item->data = event->data;
+        if (epoll_item_poll(item)) {
+            epoll_item_ready(item);
+        }
+        break;
+
+    case EPOLL_CTL_DEL:
+        if (!item) {
+            result = -1;
+            break;
+        }
+        poll_head_remove(&item->entry);
+        epoll_ready_remove(ep, item);
+        item->used = false;
+        break;
+
+    default:
+        result = -1;
+        break;
+    }
+
+    irq_restore(flags);
+    return result;
+}
+
+// Report up to max_events ready items. Each queued item is re-polled once:
+// consumed or spurious readiness is dropped, edge-triggered items leave the
+// list until their object notifies again, level-triggered ones go back on.
+int epoll_wait(int epfd, epoll_event_t* events, int max_events, int timeout_ms) {
+    if (!events || max_events <= 0 || in_interrupt()) {
+        return -1;
+    }
+
+    uint32_t flags = irq_save();
+    epoll_t* ep = epoll_from_fd(epfd);
+    if (!ep) {
+        irq_restore(flags);
+        return -1;
+    }
+
+    uint64_t deadline = poll_deadline(timeout_ms);
+    int n = 0;
+    for (;;) {
+        epoll_item_t* level_head = NULL;
+        epoll_item_t* level_tail = NULL;
+        while (ep->ready_head && n < max_events) {
+            epoll_item_t* item = ep->ready_head;
+            ep->ready_head = item->ready_next;
+            if (!ep->ready_head) {
+                ep->ready_tail = NULL;
+            }
+            item->queued = false;
+            item->ready_next = NULL;
+            ep->stats.scanned++;
+
+            uint32_t ready = epoll_item_poll(item);
+            if (!ready) {
+                continue;
+            }
+            events[n].events = ready;
+            events[n].data = item->data;
+            n++;
+
+            if (!(item->events & EPOLLET)) {
+                item->queued = true;
+                if (level_tail) {
+                    level_tail->ready_next = item;
+                } else {
+                    level_head = item;
+                }
+                level_tail = item;
+            }
+        }
+
+        // Level-triggered items are checked again on the next call
+        if (level_head) {
+            if (ep->ready_tail) {
+                ep->ready_tail->ready_next = level_head;
+            } else {
+                ep->ready_head = level_head;
+            }
+            ep->ready_tail = level_tail;
+        }
+
+        if (n > 0 || timeout_ms == 0 || poll_expired(deadline)) {
+            break;
+        }
+        ep->stats.waits++;
+        poll_sleep(&ep->waiters, deadline);
+        if (!ep->used) {
+            break;                  // Set closed meanwhile
+        }
+    }
+
+    ep->stats.reported += n;
+    irq_restore(flags);
+    return n;
+}
+
+void epoll_get_stats(int epfd, epoll_stats_t* stats) {
+    uint32_t flags = irq_save();
+    epoll_t* ep = epoll_from_fd(epfd);
+    if (ep) {
+        *stats = ep->stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+    irq_restore(flags);
+}
+
+// ---------------------------------------------------------------------------
+// Test and benchmark
+// ---------------------------------------------------------------------------
+
+#define POLL_BENCH_DEFAULT  2000
+#define POLL_BENCH_PIPES    12
+
+static struct {
+    int fds[POLL_BENCH_PIPES];      // Write ends in the writer's table
+    uint32_t events;
+    int reader_pid;
+} poll_bench;
+
+static void poll_check(const char* name, bool ok) {
+    terminal_printf("  %s: %s\n", name, ok ? "ok" : "FAIL");
+}
+
+static void poll_test_sender(void* arg) {
+    (void)arg;
+    ipc_msg_send_wait(poll_bench.reader_pid, "poll", 4);
+}
+
+// Sleeps in poll() on a pipe until killed
+static void poll_test_sleeper(void* arg) {
+    (void)arg;
+    pollfd_t pfd = { poll_bench.fds[0], POLLIN, 0 };
+    poll_fds(&pfd, 1, 10000);
+}
+
+// Kill a task blocked in poll(), then make its pipe readable: the notify
+// must find the dead task's stack entries gone
+static bool poll_test_kill_sleeper(void) {
+    int p[2];
+    char c = 'k';
+    int status = 0;
+    if (pipe_create(p) != 0) {
+        return false;
+    }
+
+    uint32_t flags = irq_save();
+    int pid = kthread_create_child(poll_test_sleeper, NULL, "poll_sleeper");
+    process_t* sleeper = process_find(pid);
+    if (sleeper) {
+        poll_bench.fds[0] = fd_dup_to(sleeper, p[0]);
+    }
+    irq_restore(flags);
+
+    for (int i = 0; i < 100 && sleeper && sleeper->state != PROCESS_BLOCKED; i++) {
+        process_yield();
+    }
+    bool ok = sleeper && sleeper->state == PROCESS_BLOCKED;
+    poll_head_t* head = fd_lookup(p[0])->ops->poll_head(fd_lookup(p[0])->object);
+    if (ok) {
+        int slot = sleeper - process_table;
+        process_kill(pid);
+        ok = head->first == NULL && poll_timers[slot].wq == NULL;
+    }
+    fd_write(p[1], &c, 1);          // Would write to the freed stack before
+    if (pid != INVALID_PID) {
+        process_wait(pid, &status);
+    }
+    fd_close(p[0]);
+    fd_close(p[1]);
+    return ok;
+}
+
+static void poll_run_test(void) {
+    int p[2];
+    char c = 'x';
+    char buffer[MAX_MESSAGE_SIZE];
+    epoll_event_t ev;
+    int status = 0;
+
+    if (pipe_create(p) != 0) {
+        terminal_writestring("poll test: cannot create pipe\n");
+        return;
+    }
+    int ep = epoll_create();
+    int mbox = ipc_mailbox_open();
+
+    pollfd_t pfd = { p[0], POLLIN, 0 };
+    poll_check("empty pipe not readable", poll_fds(&pfd, 1, 0) == 0);
+    fd_write(p[1], &c, 1);
+    poll_check("poll sees written byte", poll_fds(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN));
+
+    epoll_event_t add = { POLLIN | EPOLLET, 1 };
+    epoll_ctl(ep, EPOLL_CTL_ADD, p[0], &add);
+    poll_check("edge: ready at add", epoll_wait(ep, &ev, 1, 0) == 1 && ev.data == 1);
+    poll_check("edge: reported once", epoll_wait(ep, &ev, 1, 0) == 0);
+    fd_write(p[1], &c, 1);
+    poll_check("edge: new data reported", epoll_wait(ep, &ev, 1, 0) == 1);
+
+    epoll_event_t mod = { POLLIN, 2 };
+    epoll_ctl(ep, EPOLL_CTL_MOD, p[0], &mod);
+    poll_check("level: reported while readable",
+               epoll_wait(ep, &ev, 1, 0) == 1 && epoll_wait(ep, &ev, 1, 0) == 1 && ev.data == 2);
+    fd_read(p[0], buffer, sizeof(buffer));
+    poll_check("level: drained pipe dropped", epoll_wait(ep, &ev, 1, 0) == 0);
+
+    // Mailbox: a child's message wakes a blocking epoll_wait()
+    epoll_event_t mev = { POLLIN, 3 };
+    bool mailbox_ok = mbox >= 0 && epoll_ctl(ep, EPOLL_CTL_ADD, mbox, &mev) == 0;
+    poll_bench.reader_pid = current_process->pid;
+    int pid = kthread_create_child(poll_test_sender, NULL, "poll_sender");
+    mailbox_ok = mailbox_ok && epoll_wait(ep, &ev, 1, 1000) == 1 && ev.data == 3;
+    mailbox_ok = mailbox_ok && fd_read(mbox, buffer, sizeof(buffer)) == 4;
+    if (pid != INVALID_PID) {
+        process_wait(pid, &status);
+    }
+    poll_check("mailbox message wakes epoll_wait", mailbox_ok);
+
+    uint64_t start = clock_monotonic_ns();
+    int timed = epoll_wait(ep, &ev, 1, 50);
+    uint64_t waited_ms = div_u64(clock_monotonic_ns() - start, 1000000);
+    poll_check("timeout after ~50 ms", timed == 0 && waited_ms >= 40);
+    terminal_printf("    (waited %llu ms)\n", waited_ms);
+
+    fd_close(p[1]);
+    poll_check("writer close reports POLLHUP", poll_fds(&pfd, 1, 0) == 1 && (pfd.revents & POLLHUP));
+
+    fd_close(p[0]);
+    poll_check("closed pipe left the set", epoll_wait(ep, &ev, 1, 0) == 0);
+    fd_close(mbox);
+    fd_close(ep);
+
+    poll_check("killed poller unhooked from its pipe", poll_test_kill_sleeper());
+}
+
+// Fires one byte at a time into the pipes, round robin with a stride
+static void poll_bench_writer(void* arg) {
+    (void)arg;
+    char c = 'b';
+    for (uint32_t i = 0; i < poll_bench.events; i++) {
+        fd_write(poll_bench.fds[(i * 5) % POLL_BENCH_PIPES], &c, 1);
+        process_yield();
+    }
+}
+
+static void poll_bench_run(bool use_epoll) {
+    int rfds[POLL_BENCH_PIPES];
+    pollfd_t pfds[POLL_BENCH_PIPES];
+    epoll_event_t events[POLL_BENCH_PIPES];
+    char buffer[64];
+    int status = 0;
+    int created = 0;
+
+    // Read ends stay here; the writer gets copies of the write ends
+    int ep = use_epoll ? epoll_create() : -1;
+    uint32_t flags = irq_save();
+    int pid = kthread_create_child(poll_bench_writer, NULL, "poll_bench");
+    process_t* writer = process_find(pid);
+    for (; writer && created < POLL_BENCH_PIPES; created++) {
+        int p[2];
+        if (pipe_create(p) != 0) {
+            break;
+        }
+        rfds[created] = p[0];
+        poll_bench.fds[created] = fd_dup_to(writer, p[1]);
+        fd_close(p[1]);
+        pfds[created].fd = p[0];
+        pfds[created].events = POLLIN;
+        if (use_epoll) {
+            epoll_event_t add = { POLLIN | EPOLLET, (uint32_t)created };
+            epoll_ctl(ep, EPOLL_CTL_ADD, p[0], &add);
+        }
+    }
+    irq_restore(flags);
+
+    uint32_t received = 0;
+    uint32_t wakeups = 0;
+    uint32_t examined = 0;
+    uint64_t start = clock_cycles();
+    while (created == POLL_BENCH_PIPES && received < poll_bench.events) {
+        if (use_epoll) {
+            int n = epoll_wait(ep, events, POLL_BENCH_PIPES, -1);
+            if (n <= 0) {
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                int got = fd_read(rfds[events[i].data], buffer, sizeof(buffer));
+                received += got > 0 ? got : 0;
+            }
+        } else {
+            int n = poll_fds(pfds, POLL_BENCH_PIPES, -1);
+            if (n <= 0) {
+                break;
+            }
+            examined += POLL_BENCH_PIPES;
+            for (int i = 0; i < POLL_BENCH_PIPES; i++) {
+                if (pfds[i].revents & POLLIN) {
+                    int got = fd_read(pfds[i].fd, buffer, sizeof(buffer));
+                    received += got > 0 ? got : 0;
+                }
+            }
+        }
+        wakeups++;
+    }
+    uint64_t ns = clock_cycles_to_ns(clock_cycles() - start);
+
+    if (use_epoll) {
+        epoll_stats_t stats;
+        epoll_get_stats(ep, &stats);
+        examined = stats.scanned;
+        fd_close(ep);
+    }
+    for (int i = 0; i < created; i++) {
+        fd_close(rfds[i]);
+    }
+    if (pid != INVALID_PID) {
+        process_wait(pid, &status);
+    }
+
+    terminal_printf("  %s %llu ns/event, %u wakeups, %u.%u sources examined per wakeup\n",
+                    use_epoll ? "epoll_wait:" : "poll:      ",
+                    received ? div_u64(ns, received) : 0, wakeups,
+                    wakeups ? examined / wakeups : 0,
+                    wakeups ? (examined * 10 / wakeups) % 10 : 0);
+}
+
+void poll_command_handler(int argc, char argv[][64]) {
+    if (argc < 2) {
+        terminal_writestring("Poll Commands:\n");
+        terminal_writestring("  poll test      - poll/epoll readiness checks (pipe, mailbox, timeout)\n");
+        terminal_writestring("  poll bench [n] - n events over 12 pipes: poll vs epoll\n");
+        return;
+    }
+
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "test") == 0) {
+        poll_run_test();
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        int n = (argc >= 3) ? atoi(argv[2]) : POLL_BENCH_DEFAULT;
+        if (n <= 0) {
+            n = POLL_BENCH_DEFAULT;
+        }
+        poll_bench.events = (uint32_t)n;
+        terminal_printf("%d one-byte events spread over %d pipes:\n", n, POLL_BENCH_PIPES);
+        poll_bench_run(false);
+        poll_bench_run(true);
+    }
+    else {
+        terminal_printf("Unknown poll command: %s\n", argv[1]);
+    }
+}
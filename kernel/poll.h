@@ -0,0 +1,91 @@
+// ClaudeOS Readiness Multiplexing - Day 21
+// poll() over descriptor sets and epoll-style interest sets with a ready list
+
+#ifndef POLL_H
+#define POLL_H
+
+#include "types.h"
+#include "wait.h"
+
+// Event bits (reported in revents / epoll_event.events)
+#define POLLIN              0x0001      // Data (or a message) can be read
+#define POLLOUT             0x0004      // A write would not block
+#define POLLERR             0x0008      // Error (e.g. pipe without readers)
+#define POLLHUP             0x0010      // Peer closed (pipe without writers)
+#define POLLNVAL            0x0020      // Not a pollable descriptor
+#define POLLFREE            0x4000      // Internal: the object is going away
+
+// epoll_ctl() flags and operations
+#define EPOLLET             0x80000000u // Edge-triggered: report once per change
+#define EPOLL_CTL_ADD       1
+#define EPOLL_CTL_DEL       2
+#define EPOLL_CTL_MOD       3
+
+#define POLL_MAX_FDS        32
+#define MAX_EPOLL           8
+#define EPOLL_MAX_ITEMS     32
+
+// Every pollable object owns a poll_head and calls poll_notify() when its
+// readiness changes. Interested parties (a sleeping poll() or an epoll
+// item) hang a poll_entry on the head; notify runs their callback.
+struct poll_entry;
+typedef void (*poll_notify_fn)(struct poll_entry* entry, uint32_t events);
+
+typedef struct poll_entry {
+    struct poll_entry* next;
+    struct poll_head* head;         // NULL once detached
+    poll_notify_fn notify;
+} poll_entry_t;
+
+typedef struct poll_head {
+    poll_entry_t* first;
+} poll_head_t;
+
+#define POLL_HEAD_INIT { NULL }
+
+// Object side (IRQ-safe)
+void poll_head_init(poll_head_t* head);
+void poll_notify(poll_head_t* head, uint32_t events);
+void poll_head_detach(poll_head_t* head);     // Object destroyed
+
+// poll(): returns the number of ready entries, 0 on timeout, -1 on bad
+// arguments. timeout_ms < 0 waits forever, 0 only checks.
+typedef struct pollfd {
+    int fd;
+    uint16_t events;
+    uint16_t revents;
+} pollfd_t;
+
+int poll_fds(pollfd_t* fds, uint32_t nfds, int timeout_ms);
+
+// epoll: an interest set reached through a descriptor. Notifications put
+// items on a ready list, so epoll_wait() only looks at ready sources.
+typedef struct epoll_event {
+    uint32_t events;
+    uint32_t data;                  // Caller's cookie, returned as is
+} epoll_event_t;
+
+typedef struct epoll_stats {
+    uint32_t notifications;         // Callbacks from watched objects
+    uint32_t waits;                 // epoll_wait() calls that slept
+    uint32_t scanned;               // Items examined by epoll_wait()
+    uint32_t reported;              // Events returned
+} epoll_stats_t;
+
+int epoll_create(void);
+int epoll_ctl(int epfd, int op, int fd, const epoll_event_t* event);
+int epoll_wait(int epfd, epoll_event_t* events, int max_events, int timeout_ms);
+void epoll_get_stats(int epfd, epoll_stats_t* stats);
+
+// Timer interrupt: wake poll()/epoll_wait() callers whose timeout expired
+void poll_timer_tick(void);
+
+// Kill path: unhook a task that died asleep in poll()/epoll_wait()
+void poll_release(process_t* process);
+
+// SYS_POLL
+int sys_poll(uint32_t fds_ptr, uint32_t nfds, uint32_t timeout_ms);
+
+void poll_command_handler(int argc, char argv[][64]);
+
+#endif // POLL_H
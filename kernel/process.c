@@ -6,14 +6,37 @@
 #include "heap.h"
 #include "timer.h"
 #include "vmm.h"
+#include "fpu.h"
+#include "cpu.h"
+#include "wait.h"
+#include "sched.h"
+#include "gdt.h"
+#include "uring.h"
+#include "ipc.h"
+#include "vdso.h"
+#include "fd.h"
+#include "rcu.h"
+#include "idt.h"
+#include "poll.h"
+#include "lock.h"
 
 // Global process management variables
 process_t* current_process = NULL;
-process_t* ready_queue_head = NULL;
-process_t* ready_queue_tail = NULL;
 process_t process_table[MAX_PROCESSES];
 int next_pid = FIRST_USER_PID;
 static int process_system_initialized = 0;
+static process_t* idle_process = NULL;      // Runs only when the ready queue is empty
+static uint32_t context_switches = 0;
+
+// Exited tasks awaiting teardown by the reaper thread (linked through 'next')
+static process_t* zombie_list = NULL;
+static process_t* reaper_process = NULL;
+static uint32_t reaped_count = 0;
+
+static process_t* kthread_alloc(void (*fn)(void* arg), void* arg, const char* name);
+static void idle_thread(void* arg);
+static void reaper_thread(void* arg);
+static void process_zombie_queue(process_t* process);
 
 // String functions (copied from string.c for now)
 static void strcpy_local(char* dest, const char* src) {
@@ -79,19 +102,6 @@ void process_init(void) {
         }
     }
     
-    // Verify all slots are INVALID_PID
-    terminal_printf("[PROCESS] Verifying slots (INVALID_PID = %d):\n", INVALID_PID);
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        terminal_printf("  Slot %d: PID=%d\n", i, process_table[i].pid);
-        if (process_table[i].pid != INVALID_PID) {
-            terminal_printf("[ERROR] Slot %d still has PID %d!\n", i, process_table[i].pid);
-        }
-    }
-    
-    // Initialize queue
-    ready_queue_head = NULL;
-    ready_queue_tail = NULL;
-    
     // Setup kernel process (Day 15 enhanced) - ONLY slot 0
     terminal_writestring("[PROCESS] Setting up kernel process...\n");
     current_process = &process_table[KERNEL_PID];
@@ -106,6 +116,8 @@ void process_init(void) {
     current_process->cpu_time = 0;
     current_process->exit_code = 0;
     current_process->memory_usage = 0;
+    current_process->nice = NICE_DEFAULT;
+    sched_init_task(current_process);
     
     // Final verification: ALL other slots must be INVALID_PID
     terminal_writestring("[PROCESS] Final verification...\n");
@@ -127,17 +139,23 @@ void process_init(void) {
     // Mark system as initialized
     process_system_initialized = 1;
     
+    // Idle thread (Day 21): picked by process_switch when nothing is runnable
+    idle_process = kthread_alloc(idle_thread, NULL, "idle");
+    if (!idle_process) {
+        kernel_panic("PROCESS: cannot create idle thread");
+    }
+    idle_process->flags |= PROCESS_FLAG_IDLE;
+    
+    // Reaper thread (Day 21): frees the resources of exited tasks
+    int reaper_pid = kthread_create(reaper_thread, NULL, "reaper");
+    reaper_process = process_find(reaper_pid);
+    if (!reaper_process) {
+        kernel_panic("PROCESS: cannot create reaper thread");
+    }
+    
     terminal_writestring("[PROCESS] ✓ Process system initialization complete\n");
     terminal_printf("[PROCESS] ✓ Kernel process ready (PID: %d)\n", current_process->pid);
     
-    // Final debug count
-    int debug_active = 0;
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table[i].pid != INVALID_PID) {
-            debug_active++;
-        }
-    }
-    terminal_printf("[DEBUG] ✓ Active processes: %d (should be 1)\n", debug_active);
 }
 
 // Phase 2: Simple process creation without stack allocation
@@ -147,7 +165,7 @@ int process_create_simple(void (*entry_point)(void), const char* name) {
     // Find free slot in process table
     int slot = INVALID_PID;
     for (int i = FIRST_USER_PID; i < MAX_PROCESSES; i++) {
-        if (process_table[i].pid == INVALID_PID) {
+        if (process_table[i].pid == INVALID_PID && !process_table[i].rcu_pending) {
             slot = i;
             terminal_printf("[PHASE2] Found free slot: %d\n", slot);
             break;
@@ -163,7 +181,7 @@ int process_create_simple(void (*entry_point)(void), const char* name) {
     process_t* process = &process_table[slot];
     int new_pid = next_pid++;
     
-    process->pid = new_pid;
+    process->pid = PROCESS_PID_CLAIMED;
     process->parent_pid = current_process ? current_process->pid : INVALID_PID;
     process->state = PROCESS_CREATED;
     strcpy_local(process->name, name);
@@ -175,6 +193,17 @@ int process_create_simple(void (*entry_point)(void), const char* name) {
     process->stack = NULL;
     process->stack_size = 0;
     process->memory_usage = 0;
+    process->fpu_state = NULL;  // Allocated lazily on first FPU use
+    process->fpu_alloc = NULL;
+    process->flags = 0;         // Executed by direct call, not scheduled
+    process->parent = NULL;
+    process->children = NULL;
+    process->sibling_prev = NULL;
+    process->sibling_next = NULL;
+    process->user_stack = NULL;
+    process->uring = NULL;
+    process->nice = NICE_DEFAULT;
+    sched_init_task(process);
     
     // Minimal context (not used in Phase 2)
     process->context.esp = 0;
@@ -185,6 +214,7 @@ int process_create_simple(void (*entry_point)(void), const char* name) {
     // Set state to ready but DON'T add to ready queue yet
     process->state = PROCESS_READY;
     process->next = NULL;
+    rcu_assign_pointer(process->pid, new_pid);    // Publish last
     
     terminal_printf("[PHASE2] Created process '%s' (PID: %d) without stack\n", name, new_pid);
     return new_pid;
@@ -225,9 +255,12 @@ int process_execute_simple(int pid) {
     terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
     
     // Execute the process function directly
+    fpu_task_switch(old_current, process);
     entry_point();
     
     // Process completed - restore state and mark as terminated
+    fpu_release(process);
+    fpu_task_switch(process, old_current);
     current_process = old_current;
     process->state = PROCESS_TERMINATED;
     process->exit_code = 0;  // Normal termination
@@ -288,43 +321,108 @@ int process_run_all_ready(void) {
     return executed_count;
 }
 
+// Adapter so legacy void(void) entry points run as kernel threads
+static void process_entry_adapter(void* arg) {
+    void (*entry_point)(void) = (void (*)(void))arg;
+    entry_point();
+}
+
 // Original process create (kept for compatibility)
+// Day 21: the process now gets its own stack and runs under the scheduler
 int process_create(void (*entry_point)(void), const char* name) {
-    terminal_printf("[DEBUG] Starting process creation for '%s'\n", name);
-    terminal_printf("[DEBUG] Current next_pid: %d\n", next_pid);
+    if (!entry_point) {
+        return INVALID_PID;
+    }
     
-    // Check process table state BEFORE creation
-    int pre_active = 0;
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table[i].pid != INVALID_PID) {
-            pre_active++;
-            terminal_printf("[DEBUG] Pre-creation: Slot %d has PID %d\n", i, process_table[i].pid);
+    int pid = kthread_create_child(process_entry_adapter, (void*)entry_point, name);
+    if (pid == INVALID_PID) {
+        terminal_writestring("[PROCESS] ERROR: Process creation failed\n");
+        return INVALID_PID;
+    }
+    
+    terminal_printf("[PROCESS] Created process '%s' (PID: %d)\n", name, pid);
+    return pid;
+}
+
+// Create a kernel thread joinable by the caller: it stays a zombie until
+// collected with process_wait()
+int kthread_create_child(void (*fn)(void* arg), void* arg, const char* name) {
+    process_t* process = kthread_alloc(fn, arg, name);
+    if (!process) {
+        return INVALID_PID;
+    }
+    
+    uint32_t flags = irq_save();
+    if (current_process) {
+        process->flags &= ~PROCESS_FLAG_DETACHED;
+        process->parent = current_process;
+        process->sibling_prev = NULL;
+        process->sibling_next = current_process->children;
+        if (current_process->children) {
+            current_process->children->sibling_prev = process;
         }
+        current_process->children = process;
+    }
+    sched_enqueue(process, ENQUEUE_NEW);
+    irq_restore(flags);
+    return process->pid;
+}
+
+// First code every kernel thread runs (entered from switch_context)
+static void kthread_trampoline(void) {
+    process_t* self = current_process;
+    self->thread_fn(self->thread_arg);
+    process_exit(0);
+    
+    // process_exit never returns for kernel threads
+    for (;;) {
+        asm volatile ("hlt");
+    }
+}
+
+// Allocate a process slot and stack for a kernel thread (not yet queued)
+static process_t* kthread_alloc(void (*fn)(void* arg), void* arg, const char* name) {
+    if (!process_system_initialized || !fn) {
+        return NULL;
     }
-    terminal_printf("[DEBUG] Active processes before creation: %d\n", pre_active);
     
-    // Find free slot in process table
-    int slot = INVALID_PID;
-    for (int i = FIRST_USER_PID; i < MAX_PROCESSES; i++) {
-        if (process_table[i].pid == INVALID_PID) {
-            slot = i;
-            terminal_printf("[DEBUG] Found free slot: %d\n", slot);
+    process_t* process = NULL;
+    int pid = INVALID_PID;
+    bool pending = false;
+    for (int attempt = 0; attempt < 2 && !process; attempt++) {
+        if (pending && !in_interrupt() && preempt_count == 0) {
+            rcu_barrier();                // Released slots become reusable
+        }
+        pending = false;
+        uint32_t flags = irq_save();
+        for (int i = FIRST_USER_PID; i < MAX_PROCESSES; i++) {
+            if (process_table[i].pid != INVALID_PID) {
+                continue;
+            }
+            if (process_table[i].rcu_pending) {
+                pending = true;
+                continue;
+            }
+            process = &process_table[i];
+            process->pid = PROCESS_PID_CLAIMED;   // Claim the slot before re-enabling IRQs
+            pid = next_pid++;
+            break;
+        }
+        irq_restore(flags);
+        if (!pending) {
             break;
         }
     }
     
-    if (slot == INVALID_PID) {
-        terminal_writestring("[PROCESS] ERROR: Process table full\n");
-        return INVALID_PID;
+    if (!process) {
+        return NULL;
     }
     
-    // Initialize process (Day 15 enhanced) with EXTRA SAFETY
-    process_t* process = &process_table[slot];
-    terminal_printf("[DEBUG] Before setting PID, slot %d has PID %d\n", slot, process->pid);
-    
-    int new_pid = next_pid++;
-    process->pid = new_pid;
-    terminal_printf("[DEBUG] Set new PID %d to slot %d\n", new_pid, slot);
+    void* stack = kmalloc(KTHREAD_STACK_SIZE);
+    if (!stack) {
+        WRITE_ONCE(process->pid, INVALID_PID);
+        return NULL;
+    }
     
     process->parent_pid = current_process ? current_process->pid : INVALID_PID;
     process->state = PROCESS_CREATED;
@@ -332,66 +430,80 @@ int process_create(void (*entry_point)(void), const char* name) {
     process->creation_time = get_uptime_seconds();
     process->cpu_time = 0;
     process->exit_code = 0;
-    
-    terminal_printf("[DEBUG] After setting fields, process PID: %d\n", process->pid);
-    
-    // SKIP stack allocation for now - use static stack
-    terminal_writestring("[DEBUG] Skipping stack allocation to avoid memory corruption\n");
-    process->stack = NULL;  // Use kernel stack for now
-    process->stack_size = 0;
-    process->memory_usage = 0;
-    
-    // CHECK: Verify PID hasn't been corrupted
-    terminal_printf("[DEBUG] After stack allocation, PID: %d\n", process->pid);
-    
-    // Initialize context (minimal) - use current stack
-    process->context.esp = 0;  // Will use current stack
+    process->stack = stack;
+    process->stack_size = KTHREAD_STACK_SIZE;
+    process->memory_usage = KTHREAD_STACK_SIZE;
+    process->next = NULL;
+    process->fpu_state = NULL;
+    process->fpu_alloc = NULL;
+    process->flags = PROCESS_FLAG_KTHREAD | PROCESS_FLAG_DETACHED;
+    process->thread_fn = fn;
+    process->thread_arg = arg;
+    process->nice = NICE_DEFAULT;
+    sched_init_task(process);
+    process->wait_next = NULL;
+    process->wait_queue = NULL;
+    process->parent = NULL;
+    process->children = NULL;
+    process->sibling_prev = NULL;
+    process->sibling_next = NULL;
+    process->user_stack = NULL;
+    process->uring = NULL;
+    
+    // Initial stack: 16-byte aligned top holding a null return address
+    uint32_t top = ((uint32_t)stack + KTHREAD_STACK_SIZE) & ~0xF;
+    top -= sizeof(uint32_t);
+    *(uint32_t*)top = 0;
+    
+    process->context.eax = 0;
+    process->context.ebx = 0;
+    process->context.ecx = 0;
+    process->context.edx = 0;
+    process->context.esi = 0;
+    process->context.edi = 0;
+    process->context.esp = top;
     process->context.ebp = 0;
-    process->context.eip = (uint32_t)entry_point;
+    process->context.eip = (uint32_t)kthread_trampoline;
     process->context.eflags = DEFAULT_EFLAGS;
     
-    // Set state to ready and add to ready queue
     process->state = PROCESS_READY;
-    process->next = NULL;
-    if (ready_queue_tail) {
-        ready_queue_tail->next = process;
-    } else {
-        ready_queue_head = process;
-    }
-    ready_queue_tail = process;
-    
-    // Final verification
-    terminal_printf("[DEBUG] Process creation complete. Final PID: %d, State: %d\n", 
-                   process->pid, process->state);
-    
-    // Check entire table state AFTER creation
-    int post_active = 0;
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table[i].pid != INVALID_PID) {
-            post_active++;
-            if (i <= 2) {  // Only show first few for brevity
-                terminal_printf("[DEBUG] Post-creation: Slot %d has PID %d\n", i, process_table[i].pid);
-            }
-        }
+    rcu_assign_pointer(process->pid, pid);    // Publish last: lookups are lockless
+    return process;
+}
+
+// Create a kernel thread and make it runnable (Day 21)
+int kthread_create(void (*fn)(void* arg), void* arg, const char* name) {
+    process_t* process = kthread_alloc(fn, arg, name);
+    if (!process) {
+        return INVALID_PID;
     }
-    terminal_printf("[DEBUG] Active processes after creation: %d\n", post_active);
     
-    terminal_printf("[PROCESS] Created process '%s' (PID: %d)\n", name, process->pid);
+    uint32_t flags = irq_save();
+    sched_enqueue(process, ENQUEUE_NEW);
+    irq_restore(flags);
     return process->pid;
 }
 
 // Find process by PID (Day 15)
+// Day 21: lockless (RCU) lookup. A released slot is not reused until a
+// grace period has passed, so a reader that matched a pid never sees the
+// slot rewritten for another task while its read-side section lasts.
 process_t* process_find(int pid) {
-    if (pid < 0 || pid >= MAX_PROCESSES) {
+    // PIDs grow monotonically, so only negative values are invalid here
+    if (pid < 0) {
         return NULL;
     }
     
+    process_t* found = NULL;
+    rcu_read_lock();
     for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table[i].pid == pid && process_table[i].pid != INVALID_PID) {
-            return &process_table[i];
+        if (READ_ONCE(process_table[i].pid) == pid) {
+            found = &process_table[i];
+            break;
         }
     }
-    return NULL;
+    rcu_read_unlock();
+    return found;
 }
 
 // Get process state as string (Day 15)
@@ -402,6 +514,7 @@ const char* process_state_string(process_state_t state) {
         case PROCESS_BLOCKED: return "BLOCKED";
         case PROCESS_TERMINATED: return "TERMINATED";
         case PROCESS_CREATED: return "CREATED";
+        case PROCESS_ZOMBIE: return "ZOMBIE";
         default: return "UNKNOWN";
     }
 }
@@ -413,20 +526,27 @@ void process_exit(int exit_code) {
         return;
     }
     
+    terminal_printf("[PROCESS] Process '%s' (PID: %d) exited with code %d\n", 
+                   current_process->name, current_process->pid, exit_code);
+    
+    if (current_process->flags & PROCESS_FLAG_KTHREAD) {
+        // Still running on this stack: the reaper frees it once we are off it
+        irq_save();     // Never restored: this task does not run again
+        current_process->exit_code = exit_code;
+        process_zombie_queue(current_process);
+        process_switch();
+        kernel_panic("PROCESS: terminated thread was rescheduled");
+    }
+    
     current_process->state = PROCESS_TERMINATED;
     current_process->exit_code = exit_code;
+    fpu_release(current_process);
     
     // Free stack memory
     if (current_process->stack) {
         kfree(current_process->stack);
         current_process->stack = NULL;
     }
-    
-    terminal_printf("[PROCESS] Process '%s' (PID: %d) exited with code %d\n", 
-                   current_process->name, current_process->pid, exit_code);
-    
-    // Simple implementation: just mark as terminated
-    // In a full OS, we would switch to another process here
 }
 
 // Kill process by PID (Day 15)
@@ -437,24 +557,35 @@ void process_kill(int pid) {
         return;
     }
     
-    if (process->pid == KERNEL_PID) {
+    if (process->pid == KERNEL_PID || (process->flags & PROCESS_FLAG_IDLE) ||
+        process == reaper_process) {
         terminal_writestring("[PROCESS] Cannot kill kernel process\n");
         return;
     }
     
-    if (process->state == PROCESS_TERMINATED) {
+    if (process == current_process) {
+        process_exit(-1);
+        return;
+    }
+    
+    if (process->state == PROCESS_TERMINATED || process->state == PROCESS_ZOMBIE) {
         terminal_printf("[PROCESS] Process PID %d already terminated\n", pid);
         return;
     }
     
-    process->state = PROCESS_TERMINATED;
+    uint32_t flags = irq_save();
+    wait_queue_remove(process);
+    ipc_pi_cancel_wait(process);    // A dead waiter boosts nobody
+    mutex_release_handoffs(process);
+    poll_release(process);          // Its poll entries live on its stack
+    sched_dequeue(process);
     process->exit_code = -1; // Killed
-    
-    // Free stack memory
-    if (process->stack) {
-        kfree(process->stack);
-        process->stack = NULL;
+    if (process->flags & PROCESS_FLAG_KTHREAD) {
+        process_zombie_queue(process);
+    } else {
+        process->state = PROCESS_TERMINATED;
     }
+    irq_restore(flags);
     
     terminal_printf("[PROCESS] Killed process '%s' (PID: %d)\n", process->name, pid);
 }
@@ -487,28 +618,190 @@ void process_show_info(int pid) {
     terminal_printf("  Name: %s\n", process->name);
     terminal_printf("  State: %s\n", process_state_string(process->state));
     terminal_printf("  Creation Time: %d seconds\n", process->creation_time);
-    terminal_printf("  CPU Time: %d ticks\n", process->cpu_time);
+    terminal_printf("  CPU Time: %d ms\n", process->cpu_time);
     terminal_printf("  Memory Usage: %d bytes\n", process->memory_usage);
     
-    if (process->state == PROCESS_TERMINATED) {
+    if (process->state == PROCESS_TERMINATED || process->state == PROCESS_ZOMBIE) {
         terminal_printf("  Exit Code: %d\n", process->exit_code);
     }
 }
 
+// Unlink a child from its parent's children list (IRQs off)
+static void process_unlink_child(process_t* child) {
+    process_t* parent = child->parent;
+    if (!parent) {
+        return;
+    }
+    
+    if (child->sibling_prev) {
+        child->sibling_prev->sibling_next = child->sibling_next;
+    } else {
+        parent->children = child->sibling_next;
+    }
+    if (child->sibling_next) {
+        child->sibling_next->sibling_prev = child->sibling_prev;
+    }
+    child->sibling_prev = NULL;
+    child->sibling_next = NULL;
+    child->parent = NULL;
+}
+
+// Return a slot to the free pool (IRQs off, resources already released)
+static void process_slot_reclaim(rcu_head_t* head) {
+    container_of(head, process_t, rcu)->rcu_pending = false;
+}
+
+static void process_release(process_t* process) {
+    process_unlink_child(process);
+    process->rcu_pending = true;
+    WRITE_ONCE(process->pid, INVALID_PID);
+    process->state = PROCESS_TERMINATED;
+    process->flags = 0;
+    process->children = NULL;
+    process->next = NULL;
+    call_rcu(&process->rcu, process_slot_reclaim);
+}
+
+// Hand an exited kernel thread to the reaper: O(1), no memory is touched
+// here because the task may still be running on the stack being freed.
+static void process_zombie_queue(process_t* process) {
+    process->state = PROCESS_TERMINATED;
+    process->next = zombie_list;
+    zombie_list = process;
+    process_wake(reaper_process);
+}
+
+// Reaper thread (Day 21): frees the stack and FPU area of exited tasks,
+// then either releases the slot (detached) or parks it as a zombie and
+// wakes a parent blocked in process_wait().
+static void reaper_thread(void* arg) {
+    (void)arg;
+    
+    for (;;) {
+        uint32_t flags = irq_save();
+        while (!zombie_list) {
+            process_block();
+        }
+        process_t* process = zombie_list;
+        zombie_list = process->next;
+        process->next = NULL;
+        irq_restore(flags);
+        
+        fpu_release(process);
+        if (process->stack) {
+            kfree(process->stack);
+            process->stack = NULL;
+        }
+        if (process->user_stack) {
+            kfree(process->user_stack);
+            process->user_stack = NULL;
+        }
+        uring_release(process);
+        ipc_mailbox_release(process);
+        ipc_endpoint_release(process);
+        fd_release(process);
+        ipc_shared_memory_release(process);
+        ipc_semaphore_release(process);
+        process->memory_usage = 0;
+        
+        flags = irq_save();
+        
+        // Orphans are never waited for: detach them (and free finished ones)
+        while (process->children) {
+            process_t* child = process->children;
+            process_unlink_child(child);
+            child->flags |= PROCESS_FLAG_DETACHED;
+            if (child->state == PROCESS_ZOMBIE) {
+                process_release(child);
+            }
+        }
+        
+        process_t* parent = process->parent;
+        if ((process->flags & PROCESS_FLAG_DETACHED) || !parent) {
+            process_release(process);
+        } else {
+            process->state = PROCESS_ZOMBIE;
+            if (parent->flags & PROCESS_FLAG_WAITING) {
+                parent->flags &= ~PROCESS_FLAG_WAITING;
+                process_wake(parent);
+            }
+        }
+        reaped_count++;
+        
+        irq_restore(flags);
+    }
+}
+
+// Wait for a child to exit (pid -1: any child). Stores its exit code in
+// *status, frees its slot and returns its PID, or INVALID_PID if the
+// caller has no such child.
+int process_wait(int pid, int* status) {
+    process_t* self = current_process;
+    if (!self) {
+        return INVALID_PID;
+    }
+    
+    uint32_t flags = irq_save();
+    for (;;) {
+        bool found = false;
+        for (process_t* child = self->children; child; child = child->sibling_next) {
+            if (pid != INVALID_PID && child->pid != pid) {
+                continue;
+            }
+            found = true;
+            
+            if (child->state == PROCESS_ZOMBIE) {
+                int child_pid = child->pid;
+                if (status) {
+                    *status = child->exit_code;
+                }
+                process_release(child);
+                irq_restore(flags);
+                return child_pid;
+            }
+        }
+        
+        if (!found) {
+            irq_restore(flags);
+            return INVALID_PID;
+        }
+        
+        self->flags |= PROCESS_FLAG_WAITING;
+        process_block();
+    }
+}
+
 // Cleanup terminated processes (Day 15)
+// Day 21: collects the caller's zombie children without blocking, plus
+// slots left by directly executed (Phase 3) processes. Scheduled threads
+// are torn down by the reaper as soon as they exit.
 void process_cleanup_terminated(void) {
     int cleaned = 0;
+    uint32_t flags = irq_save();
+    
+    process_t* child = current_process ? current_process->children : NULL;
+    while (child) {
+        process_t* next = child->sibling_next;
+        if (child->state == PROCESS_ZOMBIE) {
+            process_release(child);
+            cleaned++;
+        }
+        child = next;
+    }
+    
     for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table[i].pid != INVALID_PID && 
-            process_table[i].state == PROCESS_TERMINATED &&
-            process_table[i].pid != KERNEL_PID) {
-            
-            // Mark as unused
-            process_table[i].pid = INVALID_PID;
+        process_t* process = &process_table[i];
+        if (process->pid > KERNEL_PID &&             // Not free, claimed or the kernel
+            process->state == PROCESS_TERMINATED &&
+            !(process->flags & PROCESS_FLAG_KTHREAD) &&
+            process != current_process) {
+            process_release(process);
             cleaned++;
         }
     }
     
+    irq_restore(flags);
+    
     if (cleaned > 0) {
         terminal_printf("[PROCESS] Cleaned up %d terminated processes\n", cleaned);
     } else {
@@ -516,50 +809,177 @@ void process_cleanup_terminated(void) {
     }
 }
 
+static void process_context_switch(process_t* old_process, process_t* next_process);
+
+// Switch to 'target', or to the scheduling class's choice if NULL (IRQs off)
+static void process_switch_to(process_t* target) {
+    process_t* old_process = current_process;
+    
+    sched_update_curr(old_process);
+    need_resched = false;
+    
+    // Requeue a still-runnable task first so the class can weigh it too
+    if (old_process->state == PROCESS_RUNNING) {
+        old_process->state = PROCESS_READY;
+        if (!(old_process->flags & PROCESS_FLAG_IDLE)) {
+            sched_enqueue(old_process, 0);
+        }
+    }
+    
+    process_t* next_process = target;
+    if (next_process) {
+        sched_dequeue(next_process);
+    } else {
+        next_process = sched_pick_next();
+    }
+    if (!next_process) {
+        next_process = idle_process;
+    }
+    
+    if (!next_process || next_process == old_process) {
+        old_process->state = PROCESS_RUNNING;
+        sched_switch_in(old_process);
+        return;
+    }
+    
+    process_context_switch(old_process, next_process);
+}
+
+// Make 'next_process' current and switch stacks (IRQs off)
+static void process_context_switch(process_t* old_process, process_t* next_process) {
+    rcu_note_context_switch();
+    current_process = next_process;
+    current_process->state = PROCESS_RUNNING;
+    sched_switch_in(current_process);
+    context_switches++;
+    
+    // Ring 3 tasks enter the kernel on their own kernel stack
+    if (current_process->flags & PROCESS_FLAG_USER) {
+        tss_set_kernel_stack(process_kernel_stack_top(current_process));
+    }
+    vdso_set_pid(current_process->pid);
+    
+    // Context switch (assembly function)
+    fpu_task_switch(old_process, current_process);
+    switch_context(&old_process->context, &current_process->context);
+}
+
 // Simple process switch (round-robin)
+// Day 21: the policy now lives in the scheduling class (sched.c). The
+// outgoing task is requeued only if still RUNNING (kernel included);
+// blocked or terminated tasks stay off the queue, and the idle thread runs
+// when nothing else is runnable.
 void process_switch(void) {
-    if (!ready_queue_head) {
-        return; // No processes to switch to
+    uint32_t flags = irq_save();
+    
+    if (current_process) {
+        process_switch_to(NULL);
     }
     
-    // Get next process from queue
-    process_t* next_process = ready_queue_head;
-    ready_queue_head = ready_queue_head->next;
+    // Resumed: 'flags' is this task's own saved interrupt state
+    irq_restore(flags);
+}
+
+// Block the current task until process_wake() (Day 21)
+void process_block(void) {
+    if (!current_process) {
+        return;
+    }
     
-    if (!ready_queue_head) {
-        ready_queue_tail = NULL;
+    uint32_t flags = irq_save();
+    current_process->state = PROCESS_BLOCKED;
+    process_switch();
+    irq_restore(flags);
+}
+
+// Make a blocked task runnable again; safe from IRQ context. Flags a
+// reschedule if the class says it should run ahead of the current task.
+void process_wake(process_t* process) {
+    if (!process) {
+        return;
     }
     
-    // Add current process back to queue (if not kernel)
-    if (current_process && current_process->pid != KERNEL_PID) {
-        current_process->state = PROCESS_READY;
-        current_process->next = NULL;
-        
-        if (ready_queue_tail) {
-            ready_queue_tail->next = current_process;
-        } else {
-            ready_queue_head = current_process;
+    uint32_t flags = irq_save();
+    if (process->state == PROCESS_BLOCKED) {
+        process->state = PROCESS_READY;
+        if (!(process->flags & PROCESS_FLAG_IDLE)) {
+            sched_enqueue(process, ENQUEUE_WAKEUP);
+            if (sched_wakeup_preempt(process)) {
+                need_resched = true;
+            }
         }
-        ready_queue_tail = current_process;
+    }
+    irq_restore(flags);
+}
+
+// Run 'process' next, ahead of the rest of the ready queue (Day 21)
+void process_yield_to(process_t* process) {
+    uint32_t flags = irq_save();
+    
+    if (current_process && process && process != current_process &&
+        process->state == PROCESS_READY) {
+        process_switch_to(process);
     }
     
-    // Switch to next process
+    irq_restore(flags);
+}
+
+// Synchronous IPC hand-off (Day 21): the caller has marked itself blocked
+// and 'target' is blocked in the same rendezvous. Run it immediately on
+// the caller's time slice, bypassing the run queue on both sides. Returns
+// when something wakes the caller again. IRQs must be disabled.
+void process_handoff(process_t* target) {
     process_t* old_process = current_process;
-    current_process = next_process;
-    current_process->state = PROCESS_RUNNING;
+    if (!old_process || !target || target == old_process || target->state != PROCESS_BLOCKED) {
+        process_switch();
+        return;
+    }
     
-    terminal_printf("[PROCESS] Switch: PID %d -> PID %d\n", 
-                   old_process ? old_process->pid : 0, current_process->pid);
+    sched_update_curr(old_process);
+    need_resched = false;
+    if (old_process->state == PROCESS_RUNNING) {
+        old_process->state = PROCESS_READY;
+        sched_enqueue(old_process, 0);
+    }
     
-    // Context switch (assembly function)
-    if (old_process) {
-        switch_context(&old_process->context, &current_process->context);
+    process_context_switch(old_process, target);
+}
+
+bool process_has_ready(void) {
+    return sched_has_ready();
+}
+
+// Halt until an interrupt, or run queued work instead if there is any.
+// 'sti; hlt' is atomic, so a wakeup between the check and hlt is not lost.
+void process_idle_wait(void) {
+    asm volatile ("cli");
+    if (process_has_ready()) {
+        asm volatile ("sti");
+        process_yield();
+    } else {
+        asm volatile ("sti\n\thlt");
     }
 }
 
+static void idle_thread(void* arg) {
+    (void)arg;
+    for (;;) {
+        process_idle_wait();
+    }
+}
+
+uint32_t process_get_switch_count(void) {
+    return context_switches;
+}
+
 // Yield CPU 
 void process_yield(void) {
-    process_switch();
+    uint32_t flags = irq_save();
+    if (current_process) {
+        sched_yield_curr(current_process);
+        process_switch_to(NULL);
+    }
+    irq_restore(flags);
 }
 
 // Legacy function removed - replaced with enhanced process_exit(int exit_code)
@@ -623,7 +1043,7 @@ void process_list(void) {
             // State (color coded)
             if (proc->state == PROCESS_RUNNING) {
                 terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
-            } else if (proc->state == PROCESS_TERMINATED) {
+            } else if (proc->state == PROCESS_TERMINATED || proc->state == PROCESS_ZOMBIE) {
                 terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_RED, VGA_COLOR_BLACK));
             } else {
                 terminal_setcolor(vga_entry_color(VGA_COLOR_YELLOW, VGA_COLOR_BLACK));
@@ -685,11 +1105,12 @@ void process_list(void) {
     
     terminal_writestring("\n");
     terminal_printf("Total processes: %d\n", active_count);
-    terminal_printf("Running: %d, Ready: %d, Blocked: %d, Terminated: %d\n",
+    terminal_printf("Running: %d, Ready: %d, Blocked: %d, Terminated: %d, Zombie: %d\n",
                    process_count_by_state(PROCESS_RUNNING),
                    process_count_by_state(PROCESS_READY),
                    process_count_by_state(PROCESS_BLOCKED),
-                   process_count_by_state(PROCESS_TERMINATED));
+                   process_count_by_state(PROCESS_TERMINATED),
+                   process_count_by_state(PROCESS_ZOMBIE));
 }
 
 // Process command handler (Day 15)
@@ -703,12 +1124,14 @@ void process_command_handler(int argc, char argv[][64]) {
         terminal_writestring("  info <pid>    - Show process information\n");
         terminal_writestring("  kill <pid>    - Kill process by PID\n");
         terminal_writestring("  cleanup       - Clean up terminated processes\n");
+        terminal_writestring("  wait <pid>    - Wait for a child process to exit\n");
         terminal_writestring("  stats         - Show process statistics\n");
         terminal_writestring("  run <name>    - Run test process directly (Phase 1)\n");
         terminal_writestring("  create2 <name> - Create process in table (Phase 2)\n");
         terminal_writestring("  execute <pid> - Execute ready process (Phase 3)\n");
         terminal_writestring("  runall       - Execute all ready processes (Phase 4)\n");
         terminal_writestring("  yield         - Yield CPU to next process\n");
+        terminal_writestring("  nice <pid> <n> - Set priority (-20 highest .. 19)\n");
         terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         return;
     }
@@ -766,6 +1189,22 @@ void process_command_handler(int argc, char argv[][64]) {
     } else if (simple_strcmp(argv[1], "cleanup") == 0) {
         process_cleanup_terminated();
         
+    } else if (simple_strcmp(argv[1], "wait") == 0) {
+        if (argc < 3) {
+            terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_RED, VGA_COLOR_BLACK));
+            terminal_writestring("Usage: proc wait <pid>\n");
+            terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+            return;
+        }
+        
+        int status = 0;
+        int pid = process_wait(atoi(argv[2]), &status);
+        if (pid == INVALID_PID) {
+            terminal_printf("[PROCESS] No child with PID %s\n", argv[2]);
+        } else {
+            terminal_printf("[PROCESS] Child %d exited with status %d\n", pid, status);
+        }
+        
     } else if (simple_strcmp(argv[1], "stats") == 0) {
         terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
         terminal_writestring("Process Statistics:\n");
@@ -786,7 +1225,10 @@ void process_command_handler(int argc, char argv[][64]) {
         terminal_printf("  Ready: %d\n", process_count_by_state(PROCESS_READY));
         terminal_printf("  Blocked: %d\n", process_count_by_state(PROCESS_BLOCKED));
         terminal_printf("  Terminated: %d\n", process_count_by_state(PROCESS_TERMINATED));
+        terminal_printf("  Zombie: %d\n", process_count_by_state(PROCESS_ZOMBIE));
+        terminal_printf("  Reaped: %u\n", reaped_count);
         terminal_printf("  Next PID: %d\n", next_pid);
+        terminal_printf("  Context switches: %u\n", context_switches);
         
     } else if (simple_strcmp(argv[1], "create") == 0) {
         if (argc < 3) {
@@ -828,29 +1270,11 @@ void process_command_handler(int argc, char argv[][64]) {
             terminal_printf("Process '%s' created successfully with PID %d\n", proc_name, pid);
             terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
             
-            // Start the process immediately
-            process_t* process = process_find(pid);
-            if (process && process->state == PROCESS_READY) {
-                terminal_printf("Starting process execution...\n");
-                // For now, we'll execute the process directly
-                // In a full implementation, this would be handled by the scheduler
-                entry_point();
-                
-                // After process function returns, mark as terminated
-                process->state = PROCESS_TERMINATED;
-                process->exit_code = 0;  // Normal termination
-                
-                // Free stack memory
-                if (process->stack) {
-                    kfree(process->stack);
-                    process->stack = NULL;
-                }
-                
-                terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
-                terminal_printf("[PROCESS] Process '%s' (PID: %d) completed and terminated\n", 
-                               process->name, process->pid);
-                terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
-            }
+            // Let the scheduler run it; the shell resumes when it exits
+            terminal_printf("Starting process execution...\n");
+            int status = 0;
+            process_wait(pid, &status);
+            terminal_printf("Process %d exited with status %d\n", pid, status);
         } else {
             terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_RED, VGA_COLOR_BLACK));
             terminal_writestring("Failed to create process\n");
@@ -1001,7 +1425,7 @@ void process_command_handler(int argc, char argv[][64]) {
         terminal_writestring("Yielding CPU to next process...\n");
         terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         
-        if (ready_queue_head) {
+        if (process_has_ready()) {
             process_yield();
             terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_GREEN, VGA_COLOR_BLACK));
             terminal_writestring("Returned from process yield\n");
@@ -1012,6 +1436,24 @@ void process_command_handler(int argc, char argv[][64]) {
             terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
         }
         
+    } else if (simple_strcmp(argv[1], "nice") == 0) {
+        if (argc < 4) {
+            terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_RED, VGA_COLOR_BLACK));
+            terminal_writestring("Usage: proc nice <pid> <value>\n");
+            terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+            return;
+        }
+        
+        process_t* process = process_find(atoi(argv[2]));
+        if (!process) {
+            terminal_printf("[PROCESS] Process PID %s not found\n", argv[2]);
+            return;
+        }
+        
+        sched_set_nice(process, atoi(argv[3]));
+        terminal_printf("[PROCESS] '%s' (PID: %d) nice = %d (weight %u)\n",
+                       process->name, process->pid, process->nice, process->weight);
+        
     } else {
         terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_RED, VGA_COLOR_BLACK));
         terminal_printf("Unknown process command: %s\n", argv[1]);
@@ -5,12 +5,15 @@
 #define PROCESS_H
 
 #include "types.h"
+#include "rcu.h"
 
 // Process configuration constants (no hardcoding)
-#define MAX_PROCESSES 8
+#define MAX_PROCESSES 16
 #define STACK_SIZE 0x1000      // 4KB stack
+#define KTHREAD_STACK_SIZE 0x2000  // 8KB kernel thread stack
 #define KERNEL_PID 0           // Kernel process ID
 #define INVALID_PID -1         // Invalid/unused process ID
+#define PROCESS_PID_CLAIMED -2 // Slot taken, being set up (never matches a lookup)
 #define FIRST_USER_PID 1       // First user process ID
 #define DEFAULT_EFLAGS 0x202   // Default EFLAGS (interrupts enabled)
 
@@ -20,9 +23,23 @@ typedef enum {
     PROCESS_RUNNING = 1,
     PROCESS_BLOCKED = 2,
     PROCESS_TERMINATED = 3,
-    PROCESS_CREATED = 4
+    PROCESS_CREATED = 4,
+    PROCESS_ZOMBIE = 5              // Torn down; exit code kept for process_wait()
 } process_state_t;
 
+// Scheduling priority (nice-style: lower value runs first)
+#define NICE_MIN        -20
+#define NICE_MAX        19
+#define NICE_DEFAULT    0
+#define NICE_NO_BOOST   (NICE_MAX + 1)  // pi_nice when nothing is inherited
+
+// Process flags (Day 21)
+#define PROCESS_FLAG_KTHREAD    0x01   // Runs on its own stack via the scheduler
+#define PROCESS_FLAG_IDLE       0x02   // Idle thread: never queued, runs when nothing else can
+#define PROCESS_FLAG_DETACHED   0x04   // No parent will wait: slot freed as soon as it is reaped
+#define PROCESS_FLAG_WAITING    0x08   // Blocked in process_wait()
+#define PROCESS_FLAG_USER       0x10   // Runs in ring 3 (TSS esp0 = top of its kernel stack)
+
 // Simple CPU context (registers only, no page directory)
 typedef struct {
     uint32_t eax, ebx, ecx, edx;
@@ -38,18 +55,50 @@ typedef struct process {
     cpu_context_t context;          // CPU registers
     void* stack;                    // Stack pointer (allocated by kmalloc)
     size_t stack_size;              // Stack size
-    struct process* next;           // Next in ready queue
+    struct process* next;           // Next in ready queue (or zombie list once exited)
     char name[32];                  // Process name
     uint32_t creation_time;         // Process creation time
-    uint32_t cpu_time;              // CPU time used
+    uint32_t cpu_time;              // CPU time used (ms)
     int exit_code;                  // Exit code
     uint32_t memory_usage;          // Memory usage in bytes
+    struct fpu_state* fpu_state;    // FXSAVE area (NULL until first FPU use)
+    void* fpu_alloc;                // Unaligned kmalloc block backing fpu_state
+    uint32_t flags;                 // PROCESS_FLAG_*
+    void (*thread_fn)(void* arg);   // Kernel thread entry
+    void* thread_arg;               // Kernel thread argument
+    int nice;                       // Effective priority, NICE_MIN (highest) .. NICE_MAX
+    int base_nice;                  // Priority set by the user (sched_set_nice)
+    int pi_nice;                    // Inherited from PI mutex waiters (NICE_NO_BOOST: none)
+    struct semaphore* pi_blocked_on;// PI mutex this task is waiting for
+    struct process* wait_next;      // Next waiter on the same wait queue
+    struct wait_queue* wait_queue;  // Queue this task sleeps on (NULL if none)
+    uint32_t wait_key;              // Futex address it sleeps on (0 for plain waits)
+    struct process* parent;         // Parent that may wait (NULL if detached/orphaned)
+    struct process* children;       // Joinable children, newest first
+    struct process* sibling_prev;   // Links in parent's children list
+    struct process* sibling_next;
+    uint32_t weight;                // Load weight derived from nice
+    bool on_rq;                     // Queued in the scheduling class
+    int sched_index;                // Fair class heap slot (-1 if not queued)
+    uint64_t vruntime;              // Weighted runtime (ns), fair class key
+    uint64_t sum_exec_ns;           // Total CPU time (ns)
+    uint64_t exec_start_ns;         // Last time runtime was charged
+    uint64_t slice_start_ns;        // When the current slice started
+    uint64_t enqueue_ns;            // When it last became runnable
+    uint64_t max_wait_ns;           // Longest runnable-to-running delay
+    void* user_stack;               // Ring 3 stack (PROCESS_FLAG_USER), freed by the reaper
+    struct uring* uring;            // Submission/completion rings (NULL until set up)
+    rcu_head_t rcu;                 // Deferred slot reuse after release
+    bool rcu_pending;               // Released, but lockless readers may still see it
 } process_t;
 
+// Top of a scheduled task's kernel stack (16-byte aligned)
+static inline uint32_t process_kernel_stack_top(const process_t* process) {
+    return ((uint32_t)process->stack + process->stack_size) & ~0xF;
+}
+
 // Global variables
 extern process_t* current_process;
-extern process_t* ready_queue_head;
-extern process_t* ready_queue_tail;
 extern process_t process_table[MAX_PROCESSES];
 extern int next_pid;
 
@@ -70,6 +119,18 @@ void process_show_info(int pid);
 int process_count_by_state(process_state_t state);
 void process_cleanup_terminated(void);
 
+// Kernel threads and scheduler primitives (Day 21)
+int kthread_create(void (*fn)(void* arg), void* arg, const char* name);
+int kthread_create_child(void (*fn)(void* arg), void* arg, const char* name);
+void process_block(void);
+void process_wake(process_t* process);
+void process_yield_to(process_t* process);
+void process_handoff(process_t* target);
+bool process_has_ready(void);
+void process_idle_wait(void);
+uint32_t process_get_switch_count(void);
+int process_wait(int pid, int* status);
+
 // Process management commands
 void process_command_handler(int argc, char argv[][64]);
 
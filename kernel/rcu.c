@@ -0,0 +1,371 @@
+// ClaudeOS Read-Copy-Update - Day 21
+// Lockless readers for read-mostly tables, with deferred reclamation
+
+#include "rcu.h"
+#include "sched.h"
+#include "process.h"
+#include "lock.h"
+#include "heap.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "idt.h"
+#include "kernel.h"
+#include "string.h"
+
+#define RCU_ALL_CPUS        ((1u << RCU_NR_CPUS) - 1)
+
+// Callbacks move next -> wait when a grace period starts, wait -> done
+// when it completes, and are invoked from done. All three lists and the
+// grace-period state change with interrupts disabled.
+typedef struct rcu_list {
+    rcu_head_t* head;
+    rcu_head_t** tail;
+} rcu_list_t;
+
+static rcu_list_t rcu_next = { NULL, &rcu_next.head };     // Queued since the GP started
+static rcu_list_t rcu_wait = { NULL, &rcu_wait.head };     // Waiting for the current GP
+static rcu_list_t rcu_done = { NULL, &rcu_done.head };     // Safe to invoke
+
+static bool rcu_gp_active = false;
+static uint32_t rcu_qs_pending = 0;        // CPUs that still owe a quiescent state
+static uint64_t rcu_gp_start_ns = 0;
+static rcu_stats_t rcu_stats;
+
+static inline uint32_t rcu_cpu_bit(void) {
+    return 1u;                              // CPU 0
+}
+
+static void rcu_list_splice(rcu_list_t* dst, rcu_list_t* src) {
+    if (!src->head) {
+        return;
+    }
+    *dst->tail = src->head;
+    dst->tail = src->tail;
+    src->head = NULL;
+    src->tail = &src->head;
+}
+
+// Start a grace period for the callbacks queued so far, if none is running
+static void rcu_start_gp(void) {
+    if (rcu_gp_active || !rcu_next.head) {
+        return;
+    }
+    rcu_list_splice(&rcu_wait, &rcu_next);
+    rcu_gp_active = true;
+    rcu_qs_pending = RCU_ALL_CPUS;
+    rcu_gp_start_ns = clock_monotonic_ns();
+    rcu_stats.gp_started++;
+}
+
+// This CPU is outside every read-side section. The report only counts
+// for a grace period that started before it.
+static void rcu_quiescent_state(void) {
+    uint32_t flags = irq_save();
+    if (rcu_gp_active && (rcu_qs_pending & rcu_cpu_bit())) {
+        rcu_qs_pending &= ~rcu_cpu_bit();
+        rcu_stats.quiescent_states++;
+        if (!rcu_qs_pending) {
+            uint64_t length = clock_monotonic_ns() - rcu_gp_start_ns;
+            if (length > rcu_stats.max_gp_ns) {
+                rcu_stats.max_gp_ns = length;
+            }
+            rcu_list_splice(&rcu_done, &rcu_wait);
+            rcu_gp_active = false;
+            rcu_stats.gp_completed++;
+            rcu_start_gp();
+        }
+    }
+    irq_restore(flags);
+}
+
+// Run every callback whose grace period has ended, in queue order
+static void rcu_process_callbacks(void) {
+    uint32_t flags = irq_save();
+    rcu_head_t* head = rcu_done.head;
+    rcu_done.head = NULL;
+    rcu_done.tail = &rcu_done.head;
+    irq_restore(flags);
+
+    uint32_t invoked = 0;
+    while (head) {
+        rcu_head_t* next = head->next;
+        head->func(head);
+        head = next;
+        invoked++;
+    }
+
+    if (invoked) {
+        flags = irq_save();
+        rcu_stats.callbacks_invoked += invoked;
+        irq_restore(flags);
+    }
+}
+
+void rcu_read_lock(void) {
+    preempt_disable();
+}
+
+void rcu_read_unlock(void) {
+    preempt_enable();
+}
+
+void call_rcu(rcu_head_t* head, void (*func)(rcu_head_t* head)) {
+    head->func = func;
+    head->next = NULL;
+
+    uint32_t flags = irq_save();
+    *rcu_next.tail = head;
+    rcu_next.tail = &head->next;
+    rcu_stats.callbacks_queued++;
+    rcu_start_gp();
+    irq_restore(flags);
+}
+
+// synchronize_rcu() queues one of these and waits for it to run
+typedef struct rcu_sync {
+    rcu_head_t head;
+    volatile bool done;
+} rcu_sync_t;
+
+static void rcu_sync_done(rcu_head_t* head) {
+    container_of(head, rcu_sync_t, head)->done = true;
+}
+
+void synchronize_rcu(void) {
+    if (in_interrupt() || preempt_count != 0) {
+        kernel_panic("synchronize_rcu: called from atomic context");
+    }
+
+    rcu_sync_t sync;
+    sync.done = false;
+    call_rcu(&sync.head, rcu_sync_done);
+    while (!sync.done) {
+        // The caller holds no read-side section, so this CPU is quiescent;
+        // other CPUs would report from their own switches and ticks
+        rcu_quiescent_state();
+        rcu_process_callbacks();
+        if (!sync.done) {
+            process_yield();
+        }
+    }
+}
+
+// Callbacks run in queue order, so once a grace period queued now has
+// ended, every earlier callback has run too
+void rcu_barrier(void) {
+    synchronize_rcu();
+}
+
+void rcu_note_context_switch(void) {
+    if (preempt_count == 0) {
+        rcu_quiescent_state();
+    }
+}
+
+// Timer interrupt: a tick that lands outside any preempt-disabled section
+// cannot be inside a reader
+void rcu_timer_tick(void) {
+    if (preempt_count == 0) {
+        rcu_quiescent_state();
+    }
+    rcu_process_callbacks();
+}
+
+void rcu_get_stats(rcu_stats_t* stats) {
+    uint32_t flags = irq_save();
+    *stats = rcu_stats;
+    irq_restore(flags);
+}
+
+// ---------------------------------------------------------------------------
+// Test and benchmark
+// ---------------------------------------------------------------------------
+
+// Readers follow a published pointer and check the object while an updater
+// keeps replacing it. Retired objects are poisoned by their RCU callback
+// before being freed, so a callback that ran too early shows up as a
+// poisoned read.
+#define RCU_TEST_READERS    2
+#define RCU_TEST_LIVE       0x4C495645u     // "LIVE"
+#define RCU_TEST_DEAD       0xDEADDEADu
+
+typedef struct rcu_test_obj {
+    uint32_t magic;
+    uint32_t a;
+    uint32_t b;                     // Always equal to a while live
+    rcu_head_t rcu;
+} rcu_test_obj_t;
+
+static struct {
+    rcu_test_obj_t* current;
+    volatile bool stop;
+    volatile uint32_t reads;
+    volatile uint32_t bad_reads;
+    volatile uint32_t freed;
+} rcu_test;
+
+static void rcu_test_free(rcu_head_t* head) {
+    rcu_test_obj_t* obj = container_of(head, rcu_test_obj_t, rcu);
+    obj->magic = RCU_TEST_DEAD;
+    obj->b = ~obj->a;
+    kfree(obj);
+    rcu_test.freed++;
+}
+
+static void rcu_test_reader(void* arg) {
+    (void)arg;
+    while (!rcu_test.stop) {
+        rcu_read_lock();
+        rcu_test_obj_t* obj = rcu_dereference(rcu_test.current);
+        uint32_t a = obj->a;
+        for (int i = 0; i < 200; i++) {
+            cpu_relax();            // Long enough for ticks to land inside
+        }
+        if (obj->magic != RCU_TEST_LIVE || obj->b != a) {
+            rcu_test.bad_reads++;
+        }
+        rcu_read_unlock();
+        rcu_test.reads++;
+    }
+}
+
+static void rcu_test_run(int updates) {
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+
+    rcu_stats_t before;
+    rcu_get_stats(&before);
+    rcu_test_obj_t* first = (rcu_test_obj_t*)kmalloc(sizeof(rcu_test_obj_t));
+    if (!first) {
+        terminal_writestring("Out of memory\n");
+        return;
+    }
+    first->magic = RCU_TEST_LIVE;
+    first->a = first->b = 0;
+    rcu_test.current = first;
+    rcu_test.stop = false;
+    rcu_test.reads = 0;
+    rcu_test.bad_reads = 0;
+    rcu_test.freed = 0;
+
+    terminal_printf("RCU test (%d readers, %d updates):\n", RCU_TEST_READERS, updates);
+    int pids[RCU_TEST_READERS];
+    for (int i = 0; i < RCU_TEST_READERS; i++) {
+        pids[i] = kthread_create_child(rcu_test_reader, NULL, "rcu_reader");
+    }
+
+    int done = 0;
+    for (; done < updates; done++) {
+        rcu_test_obj_t* obj = (rcu_test_obj_t*)kmalloc(sizeof(rcu_test_obj_t));
+        if (!obj) {
+            synchronize_rcu();      // Let retired objects drain, then retry
+            obj = (rcu_test_obj_t*)kmalloc(sizeof(rcu_test_obj_t));
+            if (!obj) {
+                break;
+            }
+        }
+        obj->magic = RCU_TEST_LIVE;
+        obj->a = obj->b = (uint32_t)done + 1;
+        rcu_test_obj_t* old = rcu_test.current;
+        rcu_assign_pointer(rcu_test.current, obj);
+        call_rcu(&old->rcu, rcu_test_free);
+        if ((done & 15) == 0) {
+            process_yield();
+        }
+    }
+
+    rcu_test.stop = true;
+    int status = 0;
+    for (int i = 0; i < RCU_TEST_READERS; i++) {
+        if (pids[i] != INVALID_PID) {
+            process_wait(pids[i], &status);
+        }
+    }
+    rcu_barrier();
+    kfree(rcu_test.current);
+
+    rcu_stats_t after;
+    rcu_get_stats(&after);
+    bool ok = rcu_test.bad_reads == 0 && rcu_test.freed == (uint32_t)done;
+    terminal_printf("  %u reads, %u saw a retired object (expect 0)\n",
+                    rcu_test.reads, rcu_test.bad_reads);
+    terminal_printf("  %u objects retired, %u freed after a grace period\n",
+                    (uint32_t)done, rcu_test.freed);
+    terminal_printf("  %u grace periods, %u quiescent states\n",
+                    after.gp_completed - before.gp_completed,
+                    after.quiescent_states - before.quiescent_states);
+    terminal_printf("RCU test %s\n", ok ? "PASSED" : "FAILED");
+}
+
+static rwlock_t rcu_bench_rwlock = RWLOCK_INIT("rcu_bench");
+
+static void rcu_bench_row(const char* label, uint64_t cycles, int iterations) {
+    terminal_printf("  %s %llu ns\n", label,
+                    div_u64(clock_cycles_to_ns(cycles), (uint32_t)iterations));
+}
+
+// Read-side cost: an RCU reader only touches this CPU's preempt count,
+// while a reader-writer lock writes the shared lock word (a cache line
+// every CPU would fight over)
+static void rcu_bench(int iterations) {
+    int pid = current_process ? current_process->pid : KERNEL_PID;
+    terminal_printf("Read-side cost (%d iterations):\n", iterations);
+
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        rcu_read_lock();
+        rcu_read_unlock();
+    }
+    rcu_bench_row("rcu_read_lock/unlock:      ", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        read_unlock_irqrestore(&rcu_bench_rwlock, read_lock_irqsave(&rcu_bench_rwlock));
+    }
+    rcu_bench_row("read_lock_irqsave/restore: ", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        if (!process_find(pid)) {
+            break;
+        }
+    }
+    rcu_bench_row("process_find (RCU):        ", clock_cycles() - start, iterations);
+
+    if (current_process && !in_interrupt()) {
+        int rounds = iterations < 1000 ? iterations : 1000;
+        start = clock_cycles();
+        for (int i = 0; i < rounds; i++) {
+            synchronize_rcu();
+        }
+        rcu_bench_row("synchronize_rcu:           ", clock_cycles() - start, rounds);
+    }
+}
+
+static void rcu_show_stats(void) {
+    rcu_stats_t stats;
+    rcu_get_stats(&stats);
+    terminal_writestring("RCU statistics:\n");
+    terminal_printf("  grace periods: %u started, %u completed (longest %llu us)\n",
+                    stats.gp_started, stats.gp_completed, clock_ns_to_us(stats.max_gp_ns));
+    terminal_printf("  quiescent states: %u\n", stats.quiescent_states);
+    terminal_printf("  callbacks: %u queued, %u invoked\n",
+                    stats.callbacks_queued, stats.callbacks_invoked);
+}
+
+void rcu_command_handler(int argc, char argv[][64]) {
+    if (argc < 2 || strcmp(argv[1], "stats") == 0) {
+        rcu_show_stats();
+    } else if (strcmp(argv[1], "test") == 0) {
+        int updates = (argc >= 3) ? atoi(argv[2]) : 2000;
+        rcu_test_run(updates > 0 ? updates : 2000);
+    } else if (strcmp(argv[1], "bench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 100000;
+        rcu_bench(iterations > 0 ? iterations : 100000);
+    } else {
+        terminal_writestring("Usage: rcu [stats|test [n]|bench [n]]\n");
+    }
+}
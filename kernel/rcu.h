@@ -0,0 +1,69 @@
+// ClaudeOS Read-Copy-Update - Day 21
+// Lockless readers for read-mostly tables, with deferred reclamation
+
+#ifndef RCU_H
+#define RCU_H
+
+#include "types.h"
+
+// Readers run between rcu_read_lock() and rcu_read_unlock() with
+// preemption disabled and must not sleep. An updater unpublishes an
+// object, then frees or reuses it only after a grace period: once every
+// CPU has passed a quiescent state (context switch, a timer tick outside
+// any preempt-disabled section, or synchronize_rcu() itself), no reader
+// that could have seen the old object is still running.
+
+// Single access the compiler may not tear, merge or re-read
+#define READ_ONCE(x)        (*(const volatile __typeof__(x)*)&(x))
+#define WRITE_ONCE(x, v)    (*(volatile __typeof__(x)*)&(x) = (v))
+
+// Publish after initialising, read after publication (x86 keeps stores
+// and loads in order, so a compiler barrier is all that is needed)
+#define rcu_assign_pointer(p, v) \
+    do { asm volatile ("" : : : "memory"); WRITE_ONCE(p, v); } while (0)
+#define rcu_dereference(p) \
+    ({ __typeof__(p) _rcu_p = READ_ONCE(p); asm volatile ("" : : : "memory"); _rcu_p; })
+
+// The kernel runs on one CPU; grace periods track a CPU mask so the state
+// machine is the one an SMP build would use
+#define RCU_NR_CPUS         1
+
+// Deferred callback, embedded in the object it reclaims
+typedef struct rcu_head {
+    struct rcu_head* next;
+    void (*func)(struct rcu_head* head);
+} rcu_head_t;
+
+// Object containing an embedded rcu_head (for callbacks)
+#define container_of(ptr, type, member) \
+    ((type*)((char*)(ptr) - __builtin_offsetof(type, member)))
+
+typedef struct rcu_stats {
+    uint32_t gp_started;
+    uint32_t gp_completed;
+    uint32_t quiescent_states;      // Reports that ended a CPU's part of a GP
+    uint32_t callbacks_queued;
+    uint32_t callbacks_invoked;
+    uint64_t max_gp_ns;             // Longest grace period seen
+} rcu_stats_t;
+
+void rcu_read_lock(void);
+void rcu_read_unlock(void);
+
+// Queue func(head) to run after a grace period (any context; callbacks
+// run from the timer interrupt or synchronize_rcu(), and must not sleep)
+void call_rcu(rcu_head_t* head, void (*func)(rcu_head_t* head));
+
+// Wait for a grace period, or for every queued callback to have run.
+// Process context only, outside any read-side section.
+void synchronize_rcu(void);
+void rcu_barrier(void);
+
+// Quiescent-state hooks
+void rcu_note_context_switch(void);
+void rcu_timer_tick(void);
+
+void rcu_get_stats(rcu_stats_t* stats);
+void rcu_command_handler(int argc, char argv[][64]);
+
+#endif // RCU_H
@@ -0,0 +1,744 @@
+// ClaudeOS Scheduler Classes - Day 21
+// Pluggable run-queue policy behind process_switch(): round-robin or fair
+
+#include "sched.h"
+#include "process.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "idt.h"
+#include "ipc.h"
+#include "wait.h"
+#include "lock.h"
+#include "kernel.h"
+#include "string.h"
+
+volatile bool need_resched = false;
+volatile uint32_t preempt_count = 0;
+
+// Nice to load weight: each nice step is ~10% CPU (same ratios as Linux)
+static const uint32_t nice_to_weight[NICE_MAX - NICE_MIN + 1] = {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */  9548,  7620,  6100,  4904,  3906,
+    /*  -5 */  3121,  2501,  1991,  1586,  1277,
+    /*   0 */  1024,   820,   655,   526,   423,
+    /*   5 */   335,   272,   215,   172,   137,
+    /*  10 */   110,    87,    70,    56,    45,
+    /*  15 */    36,    29,    23,    18,    15,
+};
+
+uint32_t sched_nice_to_weight(int nice) {
+    if (nice < NICE_MIN) nice = NICE_MIN;
+    if (nice > NICE_MAX) nice = NICE_MAX;
+    return nice_to_weight[nice - NICE_MIN];
+}
+
+// ---------------------------------------------------------------------------
+// Round-robin class: FIFO ready queue linked through process->next
+// ---------------------------------------------------------------------------
+
+static process_t* rr_head = NULL;
+static process_t* rr_tail = NULL;
+
+static void rr_enqueue(process_t* process, int flags) {
+    (void)flags;
+    process->next = NULL;
+    if (rr_tail) {
+        rr_tail->next = process;
+    } else {
+        rr_head = process;
+    }
+    rr_tail = process;
+}
+
+static void rr_dequeue(process_t* process) {
+    process_t* prev = NULL;
+    process_t* cur = rr_head;
+    while (cur) {
+        if (cur == process) {
+            if (prev) {
+                prev->next = cur->next;
+            } else {
+                rr_head = cur->next;
+            }
+            if (rr_tail == cur) {
+                rr_tail = prev;
+            }
+            cur->next = NULL;
+            return;
+        }
+        prev = cur;
+        cur = cur->next;
+    }
+}
+
+static process_t* rr_pick_next(void) {
+    process_t* process = rr_head;
+    if (process) {
+        rr_head = process->next;
+        if (!rr_head) {
+            rr_tail = NULL;
+        }
+        process->next = NULL;
+    }
+    return process;
+}
+
+static bool rr_has_ready(void) {
+    return rr_head != NULL;
+}
+
+static void rr_yield(process_t* curr) {
+    (void)curr;     // Requeueing at the tail is the whole policy
+}
+
+static bool rr_check_preempt_tick(process_t* curr) {
+    return rr_head && clock_monotonic_ns() - curr->slice_start_ns >= SCHED_RR_TIMESLICE_NS;
+}
+
+static bool rr_check_preempt_wakeup(process_t* curr, process_t* woken) {
+    return woken->nice < curr->nice;
+}
+
+static const sched_class_t sched_rr_class = {
+    .name = "rr",
+    .enqueue = rr_enqueue,
+    .dequeue = rr_dequeue,
+    .pick_next = rr_pick_next,
+    .has_ready = rr_has_ready,
+    .yield = rr_yield,
+    .update_curr = NULL,
+    .check_preempt_tick = rr_check_preempt_tick,
+    .check_preempt_wakeup = rr_check_preempt_wakeup,
+};
+
+// ---------------------------------------------------------------------------
+// Fair class: runnable tasks in a vruntime min-heap. Runtime is charged to
+// vruntime scaled by NICE_0_WEIGHT / weight, so heavier tasks age slower
+// and the leftmost (least served) task always runs next.
+// ---------------------------------------------------------------------------
+
+static process_t* fair_heap[MAX_PROCESSES];
+static int fair_nr = 0;
+static uint32_t fair_load = 0;          // Sum of queued weights
+static uint64_t min_vruntime = 0;       // Monotonic floor for placing tasks
+
+// Wrap-safe ordering
+static inline bool vruntime_before(uint64_t a, uint64_t b) {
+    return (int64_t)(a - b) < 0;
+}
+
+static void fair_heap_set(int index, process_t* process) {
+    fair_heap[index] = process;
+    process->sched_index = index;
+}
+
+static void fair_sift_up(int index) {
+    process_t* process = fair_heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!vruntime_before(process->vruntime, fair_heap[parent]->vruntime)) {
+            break;
+        }
+        fair_heap_set(index, fair_heap[parent]);
+        index = parent;
+    }
+    fair_heap_set(index, process);
+}
+
+static void fair_sift_down(int index) {
+    process_t* process = fair_heap[index];
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= fair_nr) {
+            break;
+        }
+        if (child + 1 < fair_nr &&
+            vruntime_before(fair_heap[child + 1]->vruntime, fair_heap[child]->vruntime)) {
+            child++;
+        }
+        if (!vruntime_before(fair_heap[child]->vruntime, process->vruntime)) {
+            break;
+        }
+        fair_heap_set(index, fair_heap[child]);
+        index = child;
+    }
+    fair_heap_set(index, process);
+}
+
+static void fair_update_min_vruntime(process_t* curr) {
+    uint64_t vruntime;
+    if (fair_nr > 0) {
+        vruntime = fair_heap[0]->vruntime;
+        if (curr && vruntime_before(curr->vruntime, vruntime)) {
+            vruntime = curr->vruntime;
+        }
+    } else if (curr) {
+        vruntime = curr->vruntime;
+    } else {
+        return;
+    }
+
+    if (vruntime_before(min_vruntime, vruntime)) {
+        min_vruntime = vruntime;
+    }
+}
+
+// New tasks start at the floor; sleepers get at most half a period of
+// credit, enough for a prompt wakeup without starving everyone else
+static void fair_place(process_t* process, int flags) {
+    uint64_t floor = min_vruntime;
+    if (flags & ENQUEUE_WAKEUP) {
+        floor = (min_vruntime > SCHED_LATENCY_NS / 2) ? min_vruntime - SCHED_LATENCY_NS / 2 : 0;
+    } else if (!(flags & ENQUEUE_NEW)) {
+        return;
+    }
+
+    if (vruntime_before(process->vruntime, floor)) {
+        process->vruntime = floor;
+    }
+}
+
+static void fair_enqueue(process_t* process, int flags) {
+    if (process->sched_index >= 0) {
+        return;
+    }
+
+    fair_place(process, flags);
+    fair_heap_set(fair_nr++, process);
+    fair_sift_up(process->sched_index);
+    fair_load += process->weight;
+}
+
+static void fair_dequeue(process_t* process) {
+    int index = process->sched_index;
+    if (index < 0) {
+        return;
+    }
+
+    process->sched_index = -1;
+    fair_load -= process->weight;
+
+    process_t* last = fair_heap[--fair_nr];
+    if (index < fair_nr) {
+        fair_heap_set(index, last);
+        fair_sift_up(index);
+        fair_sift_down(last->sched_index);
+    }
+}
+
+static process_t* fair_pick_next(void) {
+    if (fair_nr == 0) {
+        return NULL;
+    }
+
+    process_t* process = fair_heap[0];
+    fair_dequeue(process);
+    fair_update_min_vruntime(process);
+    return process;
+}
+
+static bool fair_has_ready(void) {
+    return fair_nr > 0;
+}
+
+// Yield: go just behind the leftmost task so it gets to run first
+static void fair_yield(process_t* curr) {
+    if (fair_nr > 0 && !vruntime_before(fair_heap[0]->vruntime, curr->vruntime)) {
+        curr->vruntime = fair_heap[0]->vruntime + 1;
+    }
+}
+
+static bool fair_check_preempt_tick(process_t* curr) {
+    if (fair_nr == 0) {
+        return false;
+    }
+
+    // Ideal slice: this task's weighted share of the scheduling period
+    uint64_t slice = div_u64(SCHED_LATENCY_NS * curr->weight, fair_load + curr->weight);
+    if (slice < SCHED_MIN_GRANULARITY_NS) {
+        slice = SCHED_MIN_GRANULARITY_NS;
+    }
+    return clock_monotonic_ns() - curr->slice_start_ns >= slice;
+}
+
+static bool fair_check_preempt_wakeup(process_t* curr, process_t* woken) {
+    return (int64_t)(curr->vruntime - woken->vruntime) > (int64_t)SCHED_WAKEUP_GRANULARITY_NS;
+}
+
+static const sched_class_t sched_fair_class = {
+    .name = "fair",
+    .enqueue = fair_enqueue,
+    .dequeue = fair_dequeue,
+    .pick_next = fair_pick_next,
+    .has_ready = fair_has_ready,
+    .yield = fair_yield,
+    .update_curr = fair_update_min_vruntime,
+    .check_preempt_tick = fair_check_preempt_tick,
+    .check_preempt_wakeup = fair_check_preempt_wakeup,
+};
+
+// ---------------------------------------------------------------------------
+// Class-independent run-queue interface
+// ---------------------------------------------------------------------------
+
+static const sched_class_t* sched_classes[] = { &sched_fair_class, &sched_rr_class };
+static const sched_class_t* sched_class = &sched_fair_class;
+
+// Guards the active class's run queue. Callers already run with interrupts
+// off; the lock is what keeps a second CPU out.
+static spinlock_t sched_rq_lock = SPINLOCK_INIT("sched_rq");
+
+// Tasks that only ever run as direct calls (Phase 3) are not preemptible
+static inline bool sched_task_preemptible(process_t* process) {
+    return (process->flags & PROCESS_FLAG_KTHREAD) || process->pid == KERNEL_PID;
+}
+
+void sched_init_task(process_t* process) {
+    process->base_nice = process->nice;
+    process->pi_nice = NICE_NO_BOOST;
+    process->pi_blocked_on = NULL;
+    process->weight = sched_nice_to_weight(process->nice);
+    process->on_rq = false;
+    process->sched_index = -1;
+    process->vruntime = 0;
+    process->sum_exec_ns = 0;
+    process->exec_start_ns = clock_monotonic_ns();
+    process->slice_start_ns = process->exec_start_ns;
+    process->enqueue_ns = 0;
+    process->max_wait_ns = 0;
+}
+
+void sched_enqueue(process_t* process, int flags) {
+    if (process->on_rq) {
+        return;
+    }
+    process->on_rq = true;
+    process->enqueue_ns = clock_monotonic_ns();
+    uint32_t irq_flags = spin_lock_irqsave(&sched_rq_lock);
+    sched_class->enqueue(process, flags);
+    spin_unlock_irqrestore(&sched_rq_lock, irq_flags);
+}
+
+void sched_dequeue(process_t* process) {
+    if (!process->on_rq) {
+        return;
+    }
+    uint32_t flags = spin_lock_irqsave(&sched_rq_lock);
+    sched_class->dequeue(process);
+    spin_unlock_irqrestore(&sched_rq_lock, flags);
+    process->on_rq = false;
+}
+
+process_t* sched_pick_next(void) {
+    uint32_t flags = spin_lock_irqsave(&sched_rq_lock);
+    process_t* process = sched_class->pick_next();
+    spin_unlock_irqrestore(&sched_rq_lock, flags);
+    if (process) {
+        process->on_rq = false;
+    }
+    return process;
+}
+
+bool sched_has_ready(void) {
+    uint32_t flags = spin_lock_irqsave(&sched_rq_lock);
+    bool ready = sched_class->has_ready();
+    spin_unlock_irqrestore(&sched_rq_lock, flags);
+    return ready;
+}
+
+// Charge the running task for the time since it was last charged
+void sched_update_curr(process_t* curr) {
+    uint64_t now = clock_monotonic_ns();
+    uint64_t delta = now - curr->exec_start_ns;
+    curr->exec_start_ns = now;
+    curr->sum_exec_ns += delta;
+    curr->cpu_time = (uint32_t)div_u64(curr->sum_exec_ns, NSEC_PER_MSEC);
+
+    if (curr->flags & PROCESS_FLAG_IDLE) {
+        return;
+    }
+
+    if (curr->weight == NICE_0_WEIGHT) {
+        curr->vruntime += delta;
+    } else {
+        curr->vruntime += div_u64(delta * NICE_0_WEIGHT, curr->weight);
+    }
+
+    if (sched_class->update_curr) {
+        uint32_t flags = spin_lock_irqsave(&sched_rq_lock);
+        sched_class->update_curr(curr);
+        spin_unlock_irqrestore(&sched_rq_lock, flags);
+    }
+}
+
+void sched_yield_curr(process_t* curr) {
+    sched_update_curr(curr);
+    uint32_t flags = spin_lock_irqsave(&sched_rq_lock);
+    sched_class->yield(curr);
+    spin_unlock_irqrestore(&sched_rq_lock, flags);
+}
+
+// 'next' is about to run: start its slice and record how long it waited
+void sched_switch_in(process_t* next) {
+    uint64_t now = clock_monotonic_ns();
+    next->exec_start_ns = now;
+    next->slice_start_ns = now;
+
+    if (next->enqueue_ns) {
+        uint64_t wait = now - next->enqueue_ns;
+        if (wait > next->max_wait_ns) {
+            next->max_wait_ns = wait;
+        }
+        next->enqueue_ns = 0;
+    }
+}
+
+// Should a just-woken task run ahead of the current one?
+bool sched_wakeup_preempt(process_t* woken) {
+    process_t* curr = current_process;
+    if (!curr || curr == woken) {
+        return false;
+    }
+    if (curr->flags & PROCESS_FLAG_IDLE) {
+        return true;
+    }
+    if (!sched_task_preemptible(curr)) {
+        return false;
+    }
+
+    sched_update_curr(curr);
+    return sched_class->check_preempt_wakeup(curr, woken);
+}
+
+// Effective priority is the user's nice, raised by any inherited one. A
+// queued task is requeued under its new weight; a sleeping one is moved
+// to its new place in the (priority ordered) wait queue.
+static void sched_reweight(process_t* process) {
+    int nice = process->base_nice;
+    if (process->pi_nice < nice) {
+        nice = process->pi_nice;
+    }
+    if (nice == process->nice) {
+        return;
+    }
+
+    bool queued = process->on_rq;
+    if (queued) {
+        sched_dequeue(process);
+    }
+    process->nice = nice;
+    process->weight = sched_nice_to_weight(nice);
+    if (queued) {
+        sched_enqueue(process, 0);
+    }
+    wait_queue_requeue(process);
+}
+
+void sched_set_nice(process_t* process, int nice) {
+    if (nice < NICE_MIN) nice = NICE_MIN;
+    if (nice > NICE_MAX) nice = NICE_MAX;
+
+    uint32_t flags = irq_save();
+    process->base_nice = nice;
+    sched_reweight(process);
+    irq_restore(flags);
+}
+
+// Priority inheritance: pi_nice is NICE_NO_BOOST when nothing is inherited
+void sched_set_pi_nice(process_t* process, int pi_nice) {
+    uint32_t flags = irq_save();
+    process->pi_nice = pi_nice;
+    sched_reweight(process);
+    irq_restore(flags);
+}
+
+// ---------------------------------------------------------------------------
+// Preemption
+// ---------------------------------------------------------------------------
+
+void preempt_disable(void) {
+    preempt_count++;
+    asm volatile ("" : : : "memory");
+}
+
+void preempt_enable(void) {
+    asm volatile ("" : : : "memory");
+    if (preempt_count > 0) {
+        preempt_count--;
+    }
+
+    // Deferred tick preemption, unless the caller is atomic for other reasons
+    if (preempt_count == 0 && need_resched && irqs_enabled() && !in_interrupt()) {
+        process_switch();
+    }
+}
+
+// Timer tick (IRQ context): charge the running task, flag a reschedule
+// once its slice is used up
+void sched_tick(void) {
+    process_t* curr = current_process;
+    if (!curr) {
+        return;
+    }
+
+    if (curr->flags & PROCESS_FLAG_IDLE) {
+        if (sched_has_ready()) {
+            need_resched = true;
+        }
+        return;
+    }
+
+    if (!sched_task_preemptible(curr)) {
+        return;
+    }
+
+    sched_update_curr(curr);
+    if (sched_class->check_preempt_tick(curr)) {
+        need_resched = true;
+    }
+}
+
+// Called when the outermost IRQ handler is done (EOI already sent). The
+// interrupted task resumes here later and returns through its iret.
+void sched_irq_exit(void) {
+    if (need_resched && preempt_count == 0 && current_process &&
+        sched_task_preemptible(current_process)) {
+        process_switch();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Class selection
+// ---------------------------------------------------------------------------
+
+const sched_class_t* sched_current_class(void) {
+    return sched_class;
+}
+
+// Move every runnable task over to another class
+bool sched_set_class(const char* name) {
+    const sched_class_t* new_class = NULL;
+    for (size_t i = 0; i < sizeof(sched_classes) / sizeof(sched_classes[0]); i++) {
+        if (strcmp(sched_classes[i]->name, name) == 0) {
+            new_class = sched_classes[i];
+        }
+    }
+    if (!new_class) {
+        return false;
+    }
+
+    uint32_t flags = irq_save();
+    if (new_class != sched_class) {
+        process_t* runnable[MAX_PROCESSES];
+        int count = 0;
+        process_t* process;
+        while ((process = sched_pick_next()) != NULL && count < MAX_PROCESSES) {
+            runnable[count++] = process;
+        }
+
+        sched_class = new_class;
+        for (int i = 0; i < count; i++) {
+            sched_enqueue(runnable[i], ENQUEUE_NEW);
+        }
+    }
+    irq_restore(flags);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Shell command
+// ---------------------------------------------------------------------------
+
+static void sched_show_stats(void) {
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
+    terminal_writestring("Scheduler Statistics:\n");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+    terminal_printf("  Class: %s\n", sched_class->name);
+    terminal_printf("  Context switches: %u\n", process_get_switch_count());
+    terminal_printf("  min_vruntime: %llu us\n", clock_ns_to_us(min_vruntime));
+    terminal_writestring("  PID  NICE  WEIGHT  RUNTIME(ms)  VRUNTIME(us)  MAXWAIT(us)  NAME\n");
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* process = &process_table[i];
+        if (process->pid == INVALID_PID ||
+            process->state == PROCESS_TERMINATED || process->state == PROCESS_ZOMBIE) {
+            continue;
+        }
+        terminal_printf("  %d    %d    %u    %llu    %llu    %llu    %s\n",
+                        process->pid, process->nice, process->weight,
+                        div_u64(process->sum_exec_ns, NSEC_PER_MSEC),
+                        clock_ns_to_us(process->vruntime),
+                        clock_ns_to_us(process->max_wait_ns),
+                        process->name);
+    }
+}
+
+// Mixed workload: the shell, two CPU hogs at different nice levels and a
+// semaphore ping-pong pair share the CPU for a fixed window
+#define SCHED_TEST_TASKS    4
+
+static volatile bool sched_test_stop;
+static volatile uint32_t sched_test_done;
+static volatile uint32_t sched_test_rounds;
+static int sched_test_ping;
+static int sched_test_pong;
+
+static void sched_test_finish(void) {
+    uint32_t flags = irq_save();
+    sched_test_done++;
+    irq_restore(flags);
+}
+
+static void sched_test_hog(void* arg) {
+    (void)arg;
+    volatile uint32_t sink = 0;
+    while (!sched_test_stop) {
+        sink++;
+    }
+    sched_test_finish();
+}
+
+static void sched_test_pinger(void* arg) {
+    (void)arg;
+    while (!sched_test_stop) {
+        ipc_semaphore_signal(sched_test_ping);
+        if (ipc_semaphore_wait(sched_test_pong) != 0) {
+            break;
+        }
+        sched_test_rounds++;
+    }
+    sched_test_finish();
+}
+
+static void sched_test_ponger(void* arg) {
+    (void)arg;
+    while (ipc_semaphore_wait(sched_test_ping) == 0) {
+        ipc_semaphore_signal(sched_test_pong);
+    }
+    sched_test_finish();
+}
+
+static void sched_run_test(uint32_t window_ms) {
+    static const char* names[SCHED_TEST_TASKS] = { "hog/0", "hog/5", "ping", "pong" };
+    static void (*const fns[SCHED_TEST_TASKS])(void*) = {
+        sched_test_hog, sched_test_hog, sched_test_pinger, sched_test_ponger
+    };
+    static const int nices[SCHED_TEST_TASKS] = { 0, 5, 0, 0 };
+
+    sched_test_ping = ipc_create_semaphore("sched_ping", 0);
+    sched_test_pong = ipc_create_semaphore("sched_pong", 0);
+    if (sched_test_ping < 0 || sched_test_pong < 0) {
+        terminal_writestring("Failed to create test semaphores\n");
+        return;
+    }
+
+    sched_test_stop = false;
+    sched_test_done = 0;
+    sched_test_rounds = 0;
+
+    int pids[SCHED_TEST_TASKS];
+    for (int i = 0; i < SCHED_TEST_TASKS; i++) {
+        pids[i] = kthread_create(fns[i], NULL, names[i]);
+        process_t* process = process_find(pids[i]);
+        if (process) {
+            sched_set_nice(process, nices[i]);
+        }
+    }
+
+    process_t* shell = current_process;
+    uint64_t shell_start = shell->sum_exec_ns;
+    uint64_t start = clock_monotonic_ns();
+    uint64_t end = start + (uint64_t)window_ms * NSEC_PER_MSEC;
+
+    // The shell keeps yielding, as it does while waiting for keystrokes
+    while (clock_monotonic_ns() < end) {
+        process_yield();
+    }
+
+    // Snapshot before the threads exit and their slots are recycled
+    uint64_t runtime[SCHED_TEST_TASKS];
+    uint64_t max_wait[SCHED_TEST_TASKS];
+    uint32_t flags = irq_save();
+    sched_update_curr(shell);
+    uint64_t shell_runtime = shell->sum_exec_ns - shell_start;
+    uint64_t total = shell_runtime;
+    for (int i = 0; i < SCHED_TEST_TASKS; i++) {
+        process_t* process = process_find(pids[i]);
+        runtime[i] = process ? process->sum_exec_ns : 0;
+        max_wait[i] = process ? process->max_wait_ns : 0;
+        total += runtime[i];
+    }
+    uint32_t rounds = sched_test_rounds;
+    sched_test_stop = true;
+    irq_restore(flags);
+
+    // Hogs and the pinger see the flag; destroying 'ping' releases the ponger
+    while (sched_test_done < SCHED_TEST_TASKS - 1) {
+        process_yield();
+    }
+    ipc_destroy_semaphore(sched_test_ping);
+    while (sched_test_done < SCHED_TEST_TASKS) {
+        process_yield();
+    }
+    ipc_destroy_semaphore(sched_test_pong);
+
+    if (total == 0) {
+        total = 1;
+    }
+
+    terminal_printf("Mixed workload, %u ms, class %s:\n", window_ms, sched_class->name);
+    terminal_writestring("  TASK    NICE  RUNTIME(ms)  SHARE(%)  MAXWAIT(us)\n");
+    terminal_printf("  shell   %d    %llu    %llu    -\n", shell->nice,
+                    div_u64(shell_runtime, NSEC_PER_MSEC),
+                    div64_u64(shell_runtime * 100, total));
+    for (int i = 0; i < SCHED_TEST_TASKS; i++) {
+        terminal_printf("  %s   %d    %llu    %llu    %llu\n", names[i], nices[i],
+                        div_u64(runtime[i], NSEC_PER_MSEC),
+                        div64_u64(runtime[i] * 100, total),
+                        clock_ns_to_us(max_wait[i]));
+    }
+    terminal_printf("  Ping-pong round trips: %u\n", rounds);
+}
+
+void sched_command_handler(int argc, char argv[][64]) {
+    if (argc < 2) {
+        terminal_writestring("Scheduler Commands:\n");
+        terminal_writestring("  sched stats          - Show per-task scheduling data\n");
+        terminal_writestring("  sched class <rr|fair> - Select the scheduling class\n");
+        terminal_writestring("  sched test [ms]      - Run a mixed CPU/IPC workload\n");
+        terminal_printf("Current class: %s\n", sched_class->name);
+        return;
+    }
+
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "stats") == 0) {
+        sched_show_stats();
+    }
+    else if (strcmp(argv[1], "class") == 0) {
+        if (argc < 3) {
+            terminal_writestring("Usage: sched class <rr|fair>\n");
+            return;
+        }
+        if (sched_set_class(argv[2])) {
+            terminal_printf("Scheduling class: %s\n", sched_class->name);
+        } else {
+            terminal_printf("Unknown scheduling class: %s\n", argv[2]);
+        }
+    }
+    else if (strcmp(argv[1], "test") == 0) {
+        int window_ms = (argc >= 3) ? atoi(argv[2]) : 500;
+        if (window_ms <= 0) {
+            window_ms = 500;
+        }
+        sched_run_test((uint32_t)window_ms);
+    }
+    else {
+        terminal_printf("Unknown scheduler command: %s\n", argv[1]);
+    }
+}
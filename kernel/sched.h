@@ -0,0 +1,65 @@
+// ClaudeOS Scheduler Classes - Day 21
+// Pluggable run-queue policy behind process_switch(): round-robin or fair
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "types.h"
+#include "process.h"
+
+// Scheduler tuning (nanoseconds)
+#define SCHED_LATENCY_NS            20000000ULL   // Every runnable task runs once per period
+#define SCHED_MIN_GRANULARITY_NS    4000000ULL    // Shortest slice before tick preemption
+#define SCHED_WAKEUP_GRANULARITY_NS 1000000ULL    // vruntime lead a wakee needs to preempt
+#define SCHED_RR_TIMESLICE_NS       50000000ULL   // Round-robin quantum
+
+#define NICE_0_WEIGHT   1024
+
+// sched_enqueue() flags
+#define ENQUEUE_NEW     0x01    // First enqueue of a new task
+#define ENQUEUE_WAKEUP  0x02    // Task was blocked
+
+// Scheduling class: owns the runnable tasks (never the running or idle one).
+// All operations are called with interrupts disabled.
+typedef struct sched_class {
+    const char* name;
+    void (*enqueue)(process_t* process, int flags);
+    void (*dequeue)(process_t* process);
+    process_t* (*pick_next)(void);          // Remove and return the next task
+    bool (*has_ready)(void);
+    void (*yield)(process_t* curr);         // Curr is about to be requeued
+    void (*update_curr)(process_t* curr);   // Curr was just charged runtime (optional)
+    bool (*check_preempt_tick)(process_t* curr);
+    bool (*check_preempt_wakeup)(process_t* curr, process_t* woken);
+} sched_class_t;
+
+// Run-queue interface (used by process.c, IRQs disabled)
+void sched_init_task(process_t* process);
+void sched_enqueue(process_t* process, int flags);
+void sched_dequeue(process_t* process);
+process_t* sched_pick_next(void);
+bool sched_has_ready(void);
+void sched_yield_curr(process_t* curr);
+void sched_update_curr(process_t* curr);
+void sched_switch_in(process_t* next);
+bool sched_wakeup_preempt(process_t* woken);
+void sched_set_nice(process_t* process, int nice);
+void sched_set_pi_nice(process_t* process, int pi_nice);
+uint32_t sched_nice_to_weight(int nice);
+
+// Preemption: the timer tick sets need_resched, which is acted on when the
+// outermost IRQ returns or preemption is re-enabled
+extern volatile bool need_resched;
+extern volatile uint32_t preempt_count;
+
+void preempt_disable(void);
+void preempt_enable(void);
+void sched_tick(void);
+void sched_irq_exit(void);
+
+// Class selection and shell command
+const sched_class_t* sched_current_class(void);
+bool sched_set_class(const char* name);
+void sched_command_handler(int argc, char argv[][64]);
+
+#endif // SCHED_H
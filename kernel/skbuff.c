@@ -0,0 +1,529 @@
+// ClaudeOS Socket Buffers - Day 21
+// Packet buffers with headroom, clones/refcounts and O(1) pooled allocation
+
+#include "skbuff.h"
+#include "pmm.h"
+#include "heap.h"
+#include "cpu.h"
+#include "atomic.h"
+#include "clock.h"
+#include "div64.h"
+#include "timer.h"
+#include "kernel.h"
+#include "string.h"
+
+// Each pool hands out fixed-size objects from a LIFO free list, linked
+// through the objects' first word. An empty list is refilled by carving
+// one more PMM page, up to SKB_POOL_MAX_PAGES. Lists change with
+// interrupts disabled: drivers allocate from their IRQ handlers.
+typedef struct skb_pool {
+    uint32_t chunk_size;
+    void* free_list;
+    skb_pool_stats_t stats;
+} skb_pool_t;
+
+// Data buffers: the skb_shared_t header, then the bytes
+static skb_pool_t skb_data_pools[SKB_NR_CLASSES] = {
+    { .chunk_size = 256 },                  // Header-sized frames
+    { .chunk_size = 2048 },                 // Full Ethernet frames + headroom
+};
+
+static skb_pool_t skb_head_pool = {
+    .chunk_size = (sizeof(sk_buff_t) + 7) & ~7u,
+};
+
+static void skb_pool_grow(skb_pool_t* pool) {
+    if (pool->stats.pages >= SKB_POOL_MAX_PAGES) {
+        return;
+    }
+    uint32_t page = pmm_alloc_page();
+    if (!page) {
+        return;
+    }
+    for (uint32_t offset = 0; offset + pool->chunk_size <= PAGE_SIZE; offset += pool->chunk_size) {
+        void** chunk = (void**)(page + offset);
+        *chunk = pool->free_list;
+        pool->free_list = chunk;
+    }
+    pool->stats.pages++;
+}
+
+static void* skb_pool_take(skb_pool_t* pool) {
+    uint32_t flags = irq_save();
+    if (!pool->free_list) {
+        skb_pool_grow(pool);
+    }
+    void** chunk = (void**)pool->free_list;
+    if (chunk) {
+        pool->free_list = *chunk;
+        pool->stats.allocs++;
+        if (++pool->stats.in_use > pool->stats.peak_in_use) {
+            pool->stats.peak_in_use = pool->stats.in_use;
+        }
+    } else {
+        pool->stats.failures++;
+    }
+    irq_restore(flags);
+    return chunk;
+}
+
+static void skb_pool_give(skb_pool_t* pool, void* object) {
+    uint32_t flags = irq_save();
+    *(void**)object = pool->free_list;
+    pool->free_list = object;
+    pool->stats.in_use--;
+    irq_restore(flags);
+}
+
+// Pre-carve one page per pool so the first packets do not pay for it
+void skb_pool_init(void) {
+    for (int i = 0; i < SKB_NR_CLASSES; i++) {
+        skb_data_pools[i].stats.object_size = skb_data_pools[i].chunk_size - sizeof(skb_shared_t);
+        if (!skb_data_pools[i].stats.pages) {
+            uint32_t flags = irq_save();
+            skb_pool_grow(&skb_data_pools[i]);
+            irq_restore(flags);
+        }
+    }
+    skb_head_pool.stats.object_size = sizeof(sk_buff_t);
+    if (!skb_head_pool.stats.pages) {
+        uint32_t flags = irq_save();
+        skb_pool_grow(&skb_head_pool);
+        irq_restore(flags);
+    }
+}
+
+static int skb_size_class(size_t size) {
+    for (int i = 0; i < SKB_NR_CLASSES; i++) {
+        if (size + sizeof(skb_shared_t) <= skb_data_pools[i].chunk_size) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// A buffer of at least `size` bytes, all of it tailroom
+sk_buff_t* skb_alloc(size_t size) {
+    int size_class = skb_size_class(size);
+    if (size_class < 0) {
+        return NULL;
+    }
+
+    sk_buff_t* skb = (sk_buff_t*)skb_pool_take(&skb_head_pool);
+    if (!skb) {
+        return NULL;
+    }
+    skb_shared_t* shared = (skb_shared_t*)skb_pool_take(&skb_data_pools[size_class]);
+    if (!shared) {
+        skb_pool_give(&skb_head_pool, skb);
+        return NULL;
+    }
+    shared->refcount = 1;
+    shared->size_class = (uint32_t)size_class;
+
+    memset(skb, 0, sizeof(*skb));
+    skb->shared = shared;
+    skb->head = (uint8_t*)(shared + 1);
+    skb->data = skb->head;
+    skb->tail = skb->head;
+    skb->end = (uint8_t*)shared + skb_data_pools[size_class].chunk_size;
+    skb->users = 1;
+    skb->interface_id = -1;
+    skb->timestamp = get_uptime_seconds();
+    return skb;
+}
+
+void skb_free(sk_buff_t* skb) {
+    if (!skb || atomic_fetch_add(&skb->users, (uint32_t)-1) != 1) {
+        return;
+    }
+
+    sk_buff_t* frag = skb->frag_list;
+    while (frag) {
+        sk_buff_t* next = frag->frag_next;
+        frag->frag_next = NULL;
+        skb_free(frag);
+        frag = next;
+    }
+
+    skb_shared_t* shared = skb->shared;
+    if (atomic_fetch_add(&shared->refcount, (uint32_t)-1) == 1) {
+        skb_pool_give(&skb_data_pools[shared->size_class], shared);
+    }
+    skb_pool_give(&skb_head_pool, skb);
+}
+
+sk_buff_t* skb_get(sk_buff_t* skb) {
+    if (skb) {
+        atomic_inc(&skb->users);
+    }
+    return skb;
+}
+
+// Fragments are cloned too, so each head owns its own chain
+sk_buff_t* skb_clone(sk_buff_t* skb) {
+    if (!skb) {
+        return NULL;
+    }
+    sk_buff_t* clone = (sk_buff_t*)skb_pool_take(&skb_head_pool);
+    if (!clone) {
+        return NULL;
+    }
+
+    memcpy(clone, skb, sizeof(*clone));
+    clone->next = NULL;
+    clone->frag_list = NULL;
+    clone->frag_next = NULL;
+    clone->len = skb_headlen(skb);
+    clone->data_len = 0;
+    clone->users = 1;
+    clone->cloned = true;
+    skb->cloned = true;
+    atomic_inc(&skb->shared->refcount);
+
+    for (sk_buff_t* frag = skb->frag_list; frag; frag = frag->frag_next) {
+        sk_buff_t* frag_clone = skb_clone(frag);
+        if (!frag_clone || skb_add_frag(clone, frag_clone) != 0) {
+            skb_free(frag_clone);
+            skb_free(clone);
+            return NULL;
+        }
+    }
+    return clone;
+}
+
+sk_buff_t* skb_copy(const sk_buff_t* skb) {
+    if (!skb) {
+        return NULL;
+    }
+    size_t headroom = skb_headroom(skb);
+    sk_buff_t* copy = skb_alloc(headroom + skb->len);
+    if (!copy) {
+        return NULL;
+    }
+    skb_reserve(copy, headroom);
+    skb_copy_bits(skb, 0, skb_put(copy, skb->len), skb->len);
+    copy->interface_id = skb->interface_id;
+    copy->timestamp = skb->timestamp;
+    return copy;
+}
+
+bool skb_cloned(const sk_buff_t* skb) {
+    return skb->cloned && skb->shared->refcount > 1;
+}
+
+uint8_t* skb_reserve(sk_buff_t* skb, size_t len) {
+    if (skb->len != 0 || len > skb_tailroom(skb)) {
+        return NULL;
+    }
+    skb->data += len;
+    skb->tail += len;
+    return skb->data;
+}
+
+// Appending after fragments would reorder the bytes, so only linear
+// buffers grow at the tail
+uint8_t* skb_put(sk_buff_t* skb, size_t len) {
+    if (skb->data_len != 0 || skb_cloned(skb) || len > skb_tailroom(skb)) {
+        return NULL;
+    }
+    uint8_t* old_tail = skb->tail;
+    skb->tail += len;
+    skb->len += len;
+    return old_tail;
+}
+
+uint8_t* skb_push(sk_buff_t* skb, size_t len) {
+    if (skb_cloned(skb) || len > skb_headroom(skb)) {
+        return NULL;
+    }
+    skb->data -= len;
+    skb->len += len;
+    return skb->data;
+}
+
+// Returns the new start of data; the stripped bytes stay in the headroom
+uint8_t* skb_pull(sk_buff_t* skb, size_t len) {
+    if (len > skb_headlen(skb)) {
+        return NULL;
+    }
+    skb->data += len;
+    skb->len -= len;
+    return skb->data;
+}
+
+// The head takes over the caller's reference to frag
+int skb_add_frag(sk_buff_t* skb, sk_buff_t* frag) {
+    if (!skb || !frag || frag == skb || frag->frag_next) {
+        return -1;
+    }
+    sk_buff_t** link = &skb->frag_list;
+    while (*link) {
+        link = &(*link)->frag_next;
+    }
+    *link = frag;
+    skb->len += frag->len;
+    skb->data_len += frag->len;
+    return 0;
+}
+
+// Gather len bytes starting at offset, across the linear part and the
+// fragments
+int skb_copy_bits(const sk_buff_t* skb, size_t offset, void* to, size_t len) {
+    if (!skb || offset + len > skb->len) {
+        return -1;
+    }
+    uint8_t* out = (uint8_t*)to;
+
+    size_t headlen = skb_headlen(skb);
+    if (offset < headlen) {
+        size_t chunk = headlen - offset < len ? headlen - offset : len;
+        memcpy(out, skb->data + offset, chunk);
+        out += chunk;
+        len -= chunk;
+        offset = 0;
+    } else {
+        offset -= headlen;
+    }
+
+    for (const sk_buff_t* frag = skb->frag_list; frag && len > 0; frag = frag->frag_next) {
+        if (offset >= frag->len) {
+            offset -= frag->len;
+            continue;
+        }
+        size_t chunk = frag->len - offset < len ? frag->len - offset : len;
+        if (skb_copy_bits(frag, offset, out, chunk) != 0) {
+            return -1;
+        }
+        out += chunk;
+        len -= chunk;
+        offset = 0;
+    }
+    return len == 0 ? 0 : -1;
+}
+
+// Pull every fragment into the linear part (needs the tailroom, and the
+// bytes must not be shared)
+int skb_linearize(sk_buff_t* skb) {
+    if (skb->data_len == 0) {
+        return 0;
+    }
+    if (skb_cloned(skb) || skb->data_len > skb_tailroom(skb)) {
+        return -1;
+    }
+
+    size_t headlen = skb_headlen(skb);
+    if (skb_copy_bits(skb, headlen, skb->tail, skb->data_len) != 0) {
+        return -1;
+    }
+    skb->tail += skb->data_len;
+    skb->data_len = 0;
+
+    sk_buff_t* frag = skb->frag_list;
+    skb->frag_list = NULL;
+    while (frag) {
+        sk_buff_t* next = frag->frag_next;
+        frag->frag_next = NULL;
+        skb_free(frag);
+        frag = next;
+    }
+    return 0;
+}
+
+void skb_pool_get_stats(skb_pool_stats_t data[SKB_NR_CLASSES], skb_pool_stats_t* heads) {
+    uint32_t flags = irq_save();
+    for (int i = 0; i < SKB_NR_CLASSES; i++) {
+        data[i] = skb_data_pools[i].stats;
+    }
+    *heads = skb_head_pool.stats;
+    irq_restore(flags);
+}
+
+// Packets in flight (sk_buff headers handed out)
+uint32_t skb_pool_in_use(void) {
+    return skb_head_pool.stats.in_use;
+}
+
+static void skb_show_pool(const char* label, const skb_pool_stats_t* stats) {
+    terminal_printf("  %s %u bytes: %u in use (peak %u), %u pages, %u allocs, %u failures\n",
+                    label, stats->object_size, stats->in_use, stats->peak_in_use,
+                    stats->pages, stats->allocs, stats->failures);
+}
+
+void skb_show_stats(void) {
+    skb_pool_stats_t data[SKB_NR_CLASSES];
+    skb_pool_stats_t heads;
+    skb_pool_get_stats(data, &heads);
+
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
+    terminal_writestring("Packet Buffer Pools:\n");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+    skb_show_pool("sk_buff", &heads);
+    for (int i = 0; i < SKB_NR_CLASSES; i++) {
+        skb_show_pool("data", &data[i]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test and benchmark
+// ---------------------------------------------------------------------------
+
+static int skb_test_failures;
+
+static void skb_check(bool condition, const char* what) {
+    if (!condition) {
+        terminal_printf("  FAIL: %s\n", what);
+        skb_test_failures++;
+    }
+}
+
+static void skb_test(void) {
+    skb_test_failures = 0;
+    uint32_t in_use = skb_pool_in_use();
+    terminal_writestring("Packet buffer test:\n");
+
+    // Headers pushed in front of a payload, then pulled off again
+    sk_buff_t* skb = skb_alloc(SKB_DEFAULT_HEADROOM + 100);
+    skb_check(skb != NULL, "alloc");
+    if (!skb) {
+        return;
+    }
+    skb_reserve(skb, SKB_DEFAULT_HEADROOM);
+    uint8_t* payload = skb_put(skb, 100);
+    skb_check(payload != NULL && skb->len == 100, "put payload");
+    for (int i = 0; i < 100; i++) {
+        payload[i] = (uint8_t)i;
+    }
+    uint8_t* ip = skb_push(skb, 20);
+    uint8_t* eth = skb_push(skb, 14);
+    skb_check(ip == payload - 20 && eth == ip - 14, "push headers in place");
+    skb_check(skb->len == 134 && skb_headroom(skb) == SKB_DEFAULT_HEADROOM - 34, "lengths after push");
+    skb_check(skb_push(skb, SKB_DEFAULT_HEADROOM) == NULL, "push past headroom refused");
+    skb_check(skb_pull(skb, 34) == payload && skb->len == 100, "pull headers");
+    skb_check(skb_put(skb, 4096) == NULL, "put past tailroom refused");
+
+    // Clones share the bytes, keep their own pointers, and are read-only
+    sk_buff_t* clone = skb_clone(skb);
+    skb_check(clone != NULL && clone->data == skb->data && clone->shared == skb->shared, "clone shares data");
+    if (clone) {
+        skb_check(skb_cloned(skb) && skb_cloned(clone), "both marked cloned");
+        skb_check(skb_push(clone, 14) == NULL && skb_put(skb, 1) == NULL, "cloned data read-only");
+        skb_pull(clone, 10);
+        skb_check(skb->len == 100 && clone->len == 90, "independent pointers");
+        sk_buff_t* copy = skb_copy(clone);
+        skb_check(copy != NULL && copy->shared != clone->shared && copy->data[0] == 10, "copy is private");
+        skb_check(copy != NULL && skb_push(copy, 14) != NULL, "copy writable");
+        skb_free(copy);
+        skb_free(clone);
+        skb_check(!skb_cloned(skb) && skb_push(skb, 14) != NULL, "writable after clone freed");
+        skb_pull(skb, 14);
+    }
+
+    // References
+    skb_get(skb);
+    skb_free(skb);
+    skb_check(skb->users == 1, "get/free reference");
+
+    // Fragments: 100 linear bytes + two 50-byte fragments
+    for (int f = 0; f < 2; f++) {
+        sk_buff_t* frag = skb_alloc(50);
+        uint8_t* bytes = frag ? skb_put(frag, 50) : NULL;
+        skb_check(bytes != NULL, "fragment alloc");
+        if (!bytes) {
+            break;
+        }
+        for (int i = 0; i < 50; i++) {
+            bytes[i] = (uint8_t)(100 + f * 50 + i);
+        }
+        skb_check(skb_add_frag(skb, frag) == 0, "add fragment");
+    }
+    skb_check(skb->len == 200 && skb->data_len == 100 && skb_headlen(skb) == 100, "fragment lengths");
+    skb_check(skb_put(skb, 1) == NULL, "put on nonlinear refused");
+    uint8_t gathered[200];
+    bool in_order = skb_copy_bits(skb, 0, gathered, 200) == 0;
+    for (int i = 0; i < 200 && in_order; i++) {
+        in_order = gathered[i] == (uint8_t)i;
+    }
+    skb_check(in_order, "copy_bits across fragments");
+    skb_check(skb_copy_bits(skb, 150, gathered, 51) != 0, "copy_bits past end refused");
+
+    sk_buff_t* frag_clone = skb_clone(skb);
+    skb_check(frag_clone != NULL && frag_clone->len == 200 && frag_clone->frag_list != skb->frag_list,
+              "clone with fragments");
+    skb_free(frag_clone);
+
+    skb_check(skb_linearize(skb) == 0 && skb->data_len == 0 && skb->frag_list == NULL, "linearize");
+    skb_check(skb->len == 200 && skb->data[150] == 150, "linear bytes in order");
+    skb_free(skb);
+
+    skb_check(skb_alloc(4096) == NULL, "oversized alloc refused");
+    skb_check(skb_pool_in_use() == in_use, "no buffers leaked");
+
+    terminal_printf("Packet buffer test %s\n", skb_test_failures == 0 ? "PASSED" : "FAILED");
+}
+
+static void skb_bench_row(const char* label, uint64_t cycles, int iterations) {
+    terminal_printf("  %s %llu ns/op\n", label,
+                    div_u64(clock_cycles_to_ns(cycles), (uint32_t)iterations));
+}
+
+// Allocation cost: pool versus the kernel heap, and clone versus copy
+static void skb_bench(int iterations) {
+    terminal_printf("Packet buffer cost (%d iterations):\n", iterations);
+
+    uint64_t start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        skb_free(skb_alloc(1600));
+    }
+    skb_bench_row("skb_alloc/free 1600B:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        skb_free(skb_alloc(128));
+    }
+    skb_bench_row("skb_alloc/free 128B:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        kfree(kmalloc(1600));
+    }
+    skb_bench_row("kmalloc/kfree 1600B:", clock_cycles() - start, iterations);
+
+    sk_buff_t* skb = skb_alloc(1600);
+    if (!skb || !skb_put(skb, 1514)) {
+        skb_free(skb);
+        return;
+    }
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        skb_free(skb_clone(skb));
+    }
+    skb_bench_row("skb_clone/free:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        skb_free(skb_copy(skb));
+    }
+    skb_bench_row("skb_copy/free 1514B:", clock_cycles() - start, iterations);
+
+    start = clock_cycles();
+    for (int i = 0; i < iterations; i++) {
+        skb_push(skb, 14);
+        skb_pull(skb, 14);
+    }
+    skb_bench_row("skb_push/pull:", clock_cycles() - start, iterations);
+    skb_free(skb);
+}
+
+void skb_command_handler(int argc, char argv[][64]) {
+    if (argc < 2 || strcmp(argv[1], "stats") == 0) {
+        skb_show_stats();
+    } else if (strcmp(argv[1], "test") == 0) {
+        skb_test();
+    } else if (strcmp(argv[1], "bench") == 0) {
+        int iterations = (argc >= 3) ? atoi(argv[2]) : 10000;
+        skb_bench(iterations > 0 ? iterations : 10000);
+    } else {
+        terminal_writestring("Usage: skb [stats|test|bench [n]]\n");
+    }
+}
@@ -0,0 +1,97 @@
+// ClaudeOS Socket Buffers - Day 21
+// Packet buffers with headroom, clones/refcounts and O(1) pooled allocation
+
+#ifndef SKBUFF_H
+#define SKBUFF_H
+
+#include "types.h"
+
+// Layout of one buffer:
+//
+//   head           data              tail           end
+//    | headroom     | packet bytes     | tailroom     |
+//
+// Layers prepend headers with skb_push() and strip them with skb_pull()
+// without copying the payload. Data buffers are shared by clones and
+// freed when the last sk_buff using them goes; a cloned buffer's bytes
+// are read-only (skb_push/skb_put fail), skb_copy() makes a private one.
+// A head buffer may carry a chain of fragment buffers (frag_list):
+// len counts them all, data_len only the fragments.
+
+#define SKB_DEFAULT_HEADROOM    64          // Room for link + network headers
+#define SKB_NR_CLASSES          2           // Data buffer size classes
+#define SKB_POOL_MAX_PAGES      64          // Per pool; pools never shrink
+
+// Shared data buffer header (the bytes follow it)
+typedef struct skb_shared {
+    volatile uint32_t refcount;             // sk_buffs using the bytes
+    uint32_t size_class;
+} skb_shared_t;
+
+typedef struct sk_buff {
+    struct sk_buff* next;                   // Queue link (owner's use)
+    struct sk_buff* frag_list;              // First fragment
+    struct sk_buff* frag_next;              // Next fragment of the same head
+    uint8_t* head;
+    uint8_t* data;
+    uint8_t* tail;
+    uint8_t* end;
+    uint32_t len;                           // Linear bytes + fragment bytes
+    uint32_t data_len;                      // Fragment bytes
+    volatile uint32_t users;                // References to this sk_buff
+    bool cloned;                            // Data may be shared
+    int interface_id;                       // Source/destination interface
+    uint32_t timestamp;                     // Allocation time (seconds)
+    skb_shared_t* shared;
+} sk_buff_t;
+
+typedef struct skb_pool_stats {
+    uint32_t object_size;                   // Usable bytes per object
+    uint32_t pages;                         // Pages carved so far
+    uint32_t in_use;
+    uint32_t peak_in_use;
+    uint32_t allocs;
+    uint32_t failures;                      // Pool exhausted
+} skb_pool_stats_t;
+
+void skb_pool_init(void);
+
+// Allocation and references (IRQ-safe)
+sk_buff_t* skb_alloc(size_t size);
+void skb_free(sk_buff_t* skb);              // Drops one reference
+sk_buff_t* skb_get(sk_buff_t* skb);         // Takes one reference
+sk_buff_t* skb_clone(sk_buff_t* skb);       // New header, shared bytes
+sk_buff_t* skb_copy(const sk_buff_t* skb);  // Private, linear copy
+bool skb_cloned(const sk_buff_t* skb);
+
+static inline size_t skb_headroom(const sk_buff_t* skb) {
+    return (size_t)(skb->data - skb->head);
+}
+
+static inline size_t skb_tailroom(const sk_buff_t* skb) {
+    return (size_t)(skb->end - skb->tail);
+}
+
+static inline size_t skb_headlen(const sk_buff_t* skb) {
+    return skb->len - skb->data_len;
+}
+
+// Pointer manipulation. Each returns NULL (buffer unchanged) when the
+// room, length or sharing rules above do not allow it.
+uint8_t* skb_reserve(sk_buff_t* skb, size_t len);   // Empty buffers only
+uint8_t* skb_put(sk_buff_t* skb, size_t len);       // Extend at the tail
+uint8_t* skb_push(sk_buff_t* skb, size_t len);      // Prepend a header
+uint8_t* skb_pull(sk_buff_t* skb, size_t len);      // Strip a header
+
+// Scatter-gather: fragments are appended in order and owned by the head
+int skb_add_frag(sk_buff_t* skb, sk_buff_t* frag);
+int skb_copy_bits(const sk_buff_t* skb, size_t offset, void* to, size_t len);
+int skb_linearize(sk_buff_t* skb);
+
+// Statistics and `skb` shell command
+void skb_pool_get_stats(skb_pool_stats_t data[SKB_NR_CLASSES], skb_pool_stats_t* heads);
+uint32_t skb_pool_in_use(void);
+void skb_show_stats(void);
+void skb_command_handler(int argc, char argv[][64]);
+
+#endif // SKBUFF_H
@@ -1,5 +1,6 @@
 // ClaudeOS System Call Interface - Day 8 Minimal Implementation
-// Basic system calls without complex features
+// Day 21: single table-driven dispatcher for INT 0x80, SYSENTER and
+// in-kernel callers, with per-call profiling
 
 #ifndef SYSCALL_H
 #define SYSCALL_H
@@ -19,22 +20,62 @@
 #define SYS_WRITE_FILE 7  // Write to file
 #define SYS_LIST   8  // List files
 
-// Maximum number of system calls (Day 9 expanded)
-#define MAX_SYSCALLS 9
+// Day 21: user mode
+#define SYS_EXIT   9  // Terminate the calling process
+#define SYS_URING_SETUP 10  // Create the submission/completion rings
+#define SYS_URING_ENTER 11  // Submit queued operations, wait for completions
+#define SYS_IPC_SEND    12  // Send a message to a process
+#define SYS_IPC_RECEIVE 13  // Receive a message (non-blocking)
+#define SYS_CLOCK_GETTIME 14  // Monotonic nanoseconds (vDSO fallback)
+#define SYS_FUTEX_WAIT  15  // Sleep if *addr == expected
+#define SYS_FUTEX_WAKE  16  // Wake sleepers on addr
+#define SYS_PIPE        17  // Create a pipe: fds[0] reads, fds[1] writes
+#define SYS_POLL        18  // Wait for readiness on a pollfd array
+
+// Maximum number of system calls (Day 21 expanded)
+#define MAX_SYSCALLS 19
 
 // System call return codes
 #define SYSCALL_SUCCESS  0
 #define SYSCALL_ERROR   -1
 #define SYSCALL_INVALID -2
 
+// SYS_OPEN mode bits
+#define SYSCALL_OPEN_READ   0x01
+#define SYSCALL_OPEN_WRITE  0x02
+#define SYSCALL_OPEN_CREATE 0x04
+
+// Argument metadata: bit n of ptr_args marks argument n+1 as a pointer,
+// which the dispatcher rejects when NULL before calling the handler
+#define SYSCALL_MAX_ARGS    3
+#define SYSCALL_ARG1_PTR    0x01
+#define SYSCALL_ARG2_PTR    0x02
+#define SYSCALL_ARG3_PTR    0x04
+
 // System call function pointer type
 typedef int (*syscall_fn_t)(uint32_t arg1, uint32_t arg2, uint32_t arg3);
 
+// Dispatch table entry
+typedef struct syscall_desc {
+    syscall_fn_t fn;
+    const char* name;
+    uint8_t nargs;              // Arguments the handler uses
+    uint8_t ptr_args;           // SYSCALL_ARGn_PTR mask
+} syscall_desc_t;
+
+// Per-call profile (cycles measured around the handler only)
+typedef struct syscall_stats {
+    uint32_t calls;
+    uint32_t errors;            // Rejected arguments or negative result
+    uint64_t cycles;
+    uint64_t max_cycles;
+} syscall_stats_t;
+
 // System call dispatch table
-extern syscall_fn_t syscall_table[MAX_SYSCALLS];
+extern const syscall_desc_t syscall_table[MAX_SYSCALLS];
 
-// System call handler (called from assembly)
-int syscall_handler(uint32_t syscall_num, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+// Dispatcher: the target of syscall_entry.asm and of in-kernel callers
+int syscall_dispatch(uint32_t syscall_num, uint32_t arg1, uint32_t arg2, uint32_t arg3);
 
 // System call implementations
 int sys_hello(uint32_t arg1, uint32_t arg2, uint32_t arg3);
@@ -48,6 +89,9 @@ int sys_close(uint32_t fd, uint32_t arg2, uint32_t arg3);
 int sys_read(uint32_t fd, uint32_t buffer_ptr, uint32_t count);
 int sys_write_file(uint32_t fd, uint32_t buffer_ptr, uint32_t count);
 int sys_list(uint32_t arg1, uint32_t arg2, uint32_t arg3);
+int sys_exit(uint32_t exit_code, uint32_t arg2, uint32_t arg3);
+int sys_ipc_send(uint32_t receiver_pid, uint32_t data_ptr, uint32_t size);
+int sys_ipc_receive(uint32_t sender_pid, uint32_t buffer_ptr, uint32_t size);
 
 // C wrapper functions
 int syscall_hello(void);
@@ -62,10 +106,11 @@ int syscall_read(int fd, void* buffer, size_t count);
 int syscall_write_file(int fd, const void* buffer, size_t count);
 int syscall_list(void);
 
-// System call initialization
+// System call initialization, profiling and shell command
 void syscall_init(void);
+void syscall_get_stats(uint32_t syscall_num, syscall_stats_t* stats);
+void syscall_reset_stats(void);
+void test_syscalls(void);
+void syscall_command_handler(int argc, char argv[][64]);
 
-// External assembly handler
-extern void syscall_interrupt_handler(void);
-
-#endif // SYSCALL_H
\ No newline at end of file
+#endif // SYSCALL_H
@@ -0,0 +1,116 @@
+; ClaudeOS System Call Entry - Day 21
+; Ring 3 -> ring 0 gates: legacy INT 0x80 and the SYSENTER fast path
+
+[BITS 32]
+
+extern syscall_dispatch
+extern tss_entry
+
+global syscall_int80_entry
+global sysenter_entry
+global enter_user_mode
+global user_exit_stub
+
+KERNEL_DATA_SEL equ 0x10
+USER_DATA_SEL   equ 0x23
+USER_CODE_SEL   equ 0x1B
+TSS_ESP0        equ 4           ; Offset of esp0 in tss_entry_t
+EFLAGS_IF       equ 0x200
+SYS_EXIT        equ 9
+
+section .text
+
+; INT 0x80 (DPL 3 trap gate)
+; In:  EAX = syscall number, EBX/ECX/EDX = arguments
+; Out: EAX = result; every other register is preserved
+; The CPU has already switched to the TSS esp0 stack and pushed
+; SS, ESP, EFLAGS, CS and EIP.
+syscall_int80_entry:
+    push ds
+    push es
+    push ecx                ; Caller-saved in C, preserved for the caller
+    push edx
+
+    push edx                ; arg3
+    push ecx                ; arg2
+    push ebx                ; arg1
+    push eax                ; syscall number
+
+    mov cx, KERNEL_DATA_SEL
+    mov ds, cx
+    mov es, cx
+
+    call syscall_dispatch   ; Result in EAX
+    add esp, 16
+
+    pop edx
+    pop ecx
+    pop es
+    pop ds
+    iret
+
+; SYSENTER (MSR_IA32_SYSENTER_EIP)
+; In:  EAX = syscall number, EBX/ESI/EDI = arguments,
+;      ECX = user ESP, EDX = user return EIP
+; Out: EAX = result; EBX, ESI, EDI and EBP are preserved
+; SYSENTER loads CS/SS from the MSR, clears IF and sets ESP to a
+; placeholder: the real kernel stack is the current task's TSS esp0.
+sysenter_entry:
+    mov esp, [tss_entry + TSS_ESP0]
+    sti
+
+    push ecx                ; User ESP, handed back to SYSEXIT
+    push edx                ; User EIP
+
+    push edi                ; arg3
+    push esi                ; arg2
+    push ebx                ; arg1
+    push eax                ; syscall number
+
+    mov cx, KERNEL_DATA_SEL
+    mov ds, cx
+    mov es, cx
+
+    call syscall_dispatch   ; Result in EAX
+    add esp, 16
+
+    mov cx, USER_DATA_SEL
+    mov ds, cx
+    mov es, cx
+
+    pop edx                 ; SYSEXIT: EIP = EDX, ESP = ECX
+    pop ecx
+    sysexit
+
+; void enter_user_mode(uint32_t eip, uint32_t esp)
+; Drop to ring 3 at eip on the given stack with interrupts enabled.
+; Never returns: the current kernel stack becomes the task's TSS esp0 stack.
+enter_user_mode:
+    cli
+    mov ecx, [esp+4]        ; User EIP
+    mov edx, [esp+8]        ; User ESP
+
+    mov ax, USER_DATA_SEL
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+
+    push USER_DATA_SEL      ; SS
+    push edx                ; ESP
+    pushfd
+    or dword [esp], EFLAGS_IF
+    push USER_CODE_SEL      ; CS
+    push ecx                ; EIP
+    iret
+
+; Ring 3 return target planted under a user task's entry point:
+; returning from the entry exits the process with its EAX as exit code.
+user_exit_stub:
+    mov ebx, eax
+    mov eax, SYS_EXIT
+    int 0x80
+    jmp user_exit_stub      ; SYS_EXIT does not return
+
+; GNU stack note section
+section .note.GNU-stack noalloc noexec nowrite progbits
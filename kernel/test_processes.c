@@ -3,6 +3,9 @@
 #include "process.h"
 #include "ipc.h"
 #include "timer.h"
+#include "clock.h"
+#include "div64.h"
+#include "string.h"
 
 // Test process IPC sender: Message sender
 void test_process_ipc_sender(void) {
@@ -65,37 +68,38 @@ void test_process_ipc_receiver(void) {
     process_exit(0);
 }
 
+// Day 21: bounded-buffer producer/consumer on blocking semaphores.
+// 'pc_empty' counts free slots, 'pc_full' counts filled slots and
+// 'pc_mutex' guards the ring; neither side polls or yields.
+#define PRODCONS_SLOTS  4
+#define PRODCONS_ITEMS  8
+
+static int prodcons_ring[PRODCONS_SLOTS];
+static int prodcons_in = 0;
+static int prodcons_out = 0;
+
 // Test process 3: Semaphore test (producer)
 void test_process_producer(void) {
     terminal_printf("🟡 Producer Process started (PID: %d)\n", 
                    current_process ? current_process->pid : 0);
     
-    // Create a semaphore for resource sharing
-    int sem_id = ipc_create_semaphore("test_resource", 1);
-    if (sem_id < 0) {
-        terminal_printf("🟡 Producer: Failed to create semaphore\n");
+    int empty = ipc_find_semaphore_by_name("pc_empty");
+    int full = ipc_find_semaphore_by_name("pc_full");
+    int mutex = ipc_find_semaphore_by_name("pc_mutex");
+    if (empty < 0 || full < 0 || mutex < 0) {
+        terminal_printf("🟡 Producer: Semaphores not found\n");
         process_exit(1);
         return;
     }
     
-    for (int i = 0; i < 3; i++) {
-        terminal_printf("🟡 Producer: Requesting resource (%d/3)\n", i + 1);
-        
-        // Wait for resource
-        int wait_result = ipc_semaphore_wait(sem_id);
-        if (wait_result == 0) {
-            terminal_printf("🟡 Producer: Got resource, using it...\n");
-            
-            // Simulate resource usage
-            process_yield(); // Let other processes run
-            
-            terminal_printf("🟡 Producer: Done with resource, releasing...\n");
-            ipc_semaphore_signal(sem_id);
-        } else {
-            terminal_printf("🟡 Producer: Failed to acquire resource\n");
-        }
-        
-        process_yield();
+    for (int i = 1; i <= PRODCONS_ITEMS; i++) {
+        ipc_semaphore_wait(empty);
+        ipc_semaphore_wait(mutex);
+        prodcons_ring[prodcons_in] = i;
+        prodcons_in = (prodcons_in + 1) % PRODCONS_SLOTS;
+        ipc_semaphore_signal(mutex);
+        ipc_semaphore_signal(full);
+        terminal_printf("🟡 Producer: Produced item %d\n", i);
     }
     
     terminal_printf("🟡 Producer: Work completed, exiting\n");
@@ -107,35 +111,54 @@ void test_process_consumer(void) {
     terminal_printf("🟠 Consumer Process started (PID: %d)\n", 
                    current_process ? current_process->pid : 0);
     
-    // Find the existing semaphore (created by producer)
-    // Note: In a real implementation, we'd have semaphore discovery
-    int sem_id = 1; // Assume first semaphore created
+    int empty = ipc_find_semaphore_by_name("pc_empty");
+    int full = ipc_find_semaphore_by_name("pc_full");
+    int mutex = ipc_find_semaphore_by_name("pc_mutex");
+    if (empty < 0 || full < 0 || mutex < 0) {
+        terminal_printf("🟠 Consumer: Semaphores not found\n");
+        process_exit(1);
+        return;
+    }
+    
+    int sum = 0;
+    for (int i = 0; i < PRODCONS_ITEMS; i++) {
+        ipc_semaphore_wait(full);
+        ipc_semaphore_wait(mutex);
+        int item = prodcons_ring[prodcons_out];
+        prodcons_out = (prodcons_out + 1) % PRODCONS_SLOTS;
+        ipc_semaphore_signal(mutex);
+        ipc_semaphore_signal(empty);
+        sum += item;
+        terminal_printf("🟠 Consumer: Consumed item %d\n", item);
+    }
+    
+    terminal_printf("🟠 Consumer: Work completed (sum %d), exiting\n", sum);
+    process_exit(0);
+}
+
+// Run the producer/consumer pair to completion (ipc test prodcons)
+void test_prodcons_run(void) {
+    int empty = ipc_create_semaphore("pc_empty", PRODCONS_SLOTS);
+    int full = ipc_create_semaphore("pc_full", 0);
+    int mutex = ipc_create_semaphore("pc_mutex", 1);
     
-    for (int i = 0; i < 2; i++) {
-        terminal_printf("🟠 Consumer: Requesting resource (%d/2)\n", i + 1);
+    if (empty >= 0 && full >= 0 && mutex >= 0) {
+        prodcons_in = 0;
+        prodcons_out = 0;
         
-        // Wait for resource
-        int wait_result = ipc_semaphore_wait(sem_id);
-        if (wait_result == 0) {
-            terminal_printf("🟠 Consumer: Got resource, using it...\n");
-            
-            // Simulate resource usage
-            process_yield(); // Let other processes run
-            
-            terminal_printf("🟠 Consumer: Done with resource, releasing...\n");
-            ipc_semaphore_signal(sem_id);
-        } else if (wait_result == 1) {
-            terminal_printf("🟠 Consumer: Waiting for resource...\n");
-            // In real implementation, this process would be blocked
-        } else {
-            terminal_printf("🟠 Consumer: Failed to access semaphore\n");
-        }
+        int consumer = process_create(test_process_consumer, "consumer");
+        int producer = process_create(test_process_producer, "producer");
         
-        process_yield();
+        int status;
+        if (consumer != INVALID_PID) process_wait(consumer, &status);
+        if (producer != INVALID_PID) process_wait(producer, &status);
+    } else {
+        terminal_writestring("Failed to create producer/consumer semaphores\n");
     }
     
-    terminal_printf("🟠 Consumer: Work completed, exiting\n");
-    process_exit(0);
+    if (empty >= 0) ipc_destroy_semaphore(empty);
+    if (full >= 0) ipc_destroy_semaphore(full);
+    if (mutex >= 0) ipc_destroy_semaphore(mutex);
 }
 
 // Simple test process for multitasking
@@ -150,4 +173,108 @@ void test_process_simple(void) {
     
     terminal_printf("⭐ Simple Process: Completed, exiting\n");
     process_exit(0);
-}
\ No newline at end of file
+}
+// Day 21: producer/consumer over a shared memory ring. The items live in
+// a named segment both sides attach; the semaphores only count slots, so
+// no item data passes through the kernel.
+#define SHM_RING_NAME   "pc_shm_ring"
+#define SHM_RING_SLOTS  64
+#define SHM_ITEM_SIZE   256
+
+typedef struct {
+    uint32_t head;                  // Consumer position
+    uint32_t tail;                  // Producer position
+    uint8_t items[SHM_RING_SLOTS][SHM_ITEM_SIZE];
+} shm_ring_t;
+
+static struct {
+    int items;
+    int empty;
+    int full;
+    int errors;                     // Items seen out of order
+} shm_test;
+
+static void test_process_shm_producer(void) {
+    int id = ipc_find_shared_memory(SHM_RING_NAME);
+    shm_ring_t* ring = (shm_ring_t*)ipc_attach_shared_memory(id);
+    if (!ring) {
+        process_exit(1);
+        return;
+    }
+    
+    for (int i = 0; i < shm_test.items; i++) {
+        ipc_semaphore_wait(shm_test.empty);
+        uint8_t* item = ring->items[ring->tail % SHM_RING_SLOTS];
+        memset(item, (uint8_t)i, SHM_ITEM_SIZE);
+        *(int*)item = i;
+        ring->tail++;
+        ipc_semaphore_signal(shm_test.full);
+    }
+    
+    ipc_detach_shared_memory(id);
+    process_exit(0);
+}
+
+static void test_process_shm_consumer(void) {
+    int id = ipc_find_shared_memory(SHM_RING_NAME);
+    shm_ring_t* ring = (shm_ring_t*)ipc_attach_shared_memory(id);
+    if (!ring) {
+        process_exit(1);
+        return;
+    }
+    
+    for (int i = 0; i < shm_test.items; i++) {
+        ipc_semaphore_wait(shm_test.full);
+        uint8_t* item = ring->items[ring->head % SHM_RING_SLOTS];
+        if (*(int*)item != i || item[SHM_ITEM_SIZE - 1] != (uint8_t)i) {
+            shm_test.errors++;
+        }
+        ring->head++;
+        ipc_semaphore_signal(shm_test.empty);
+    }
+    
+    ipc_detach_shared_memory(id);
+    process_exit(0);
+}
+
+// Stream 'items' items through the shared ring (ipc test shmring [n])
+void test_prodcons_shm_run(int items) {
+    int id = ipc_create_shared_memory(SHM_RING_NAME, sizeof(shm_ring_t), 0);
+    shm_ring_t* ring = (shm_ring_t*)ipc_attach_shared_memory(id);
+    shm_test.empty = ipc_create_semaphore("shm_empty", SHM_RING_SLOTS);
+    shm_test.full = ipc_create_semaphore("shm_full", 0);
+    
+    if (ring && shm_test.empty >= 0 && shm_test.full >= 0) {
+        shm_test.items = items;
+        shm_test.errors = 0;
+        ring->head = 0;
+        ring->tail = 0;
+        
+        uint64_t start = clock_cycles();
+        int consumer = process_create(test_process_shm_consumer, "shm_consumer");
+        int producer = process_create(test_process_shm_producer, "shm_producer");
+        
+        int status;
+        if (consumer != INVALID_PID) process_wait(consumer, &status);
+        if (producer != INVALID_PID) process_wait(producer, &status);
+        uint64_t ns = clock_cycles_to_ns(clock_cycles() - start);
+        if (ns == 0) {
+            ns = 1;
+        }
+        
+        uint64_t bytes = (uint64_t)items * SHM_ITEM_SIZE;
+        terminal_printf("Shared ring: %d items of %d bytes, %d out of order\n",
+                        items, SHM_ITEM_SIZE, shm_test.errors);
+        terminal_printf("  %llu items/sec, %llu MB/s\n",
+                        div64_u64((uint64_t)items * NSEC_PER_SEC, ns),
+                        div64_u64(bytes * 1000, ns));
+    } else {
+        terminal_writestring("Failed to set up the shared ring\n");
+    }
+    
+    // Unlink the name, then ours is the last attachment: detaching frees it
+    if (id >= 0) ipc_destroy_shared_memory(id);
+    if (ring) ipc_detach_shared_memory(id);
+    if (shm_test.empty >= 0) ipc_destroy_semaphore(shm_test.empty);
+    if (shm_test.full >= 0) ipc_destroy_semaphore(shm_test.full);
+}
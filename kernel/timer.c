@@ -4,9 +4,18 @@
 #include "timer.h"
 #include "pic.h"
 #include "kernel.h"
+#include "clock.h"
+#include "sched.h"
+#include "vdso.h"
+#include "poll.h"
+#include "rcu.h"
 
-// Global timer tick counter
-static volatile uint32_t timer_ticks = 0;
+// Global timer tick counter (64-bit: a 32-bit count wraps after ~497 days)
+static volatile uint64_t timer_ticks = 0;
+
+// Ticks left until the next uptime update (a countdown, because the 64-bit
+// tick count has no cheap modulo here)
+static uint32_t uptime_countdown = TIMER_FREQUENCY;
 
 // Forward declaration for uptime update
 extern void update_uptime(void);
@@ -31,30 +40,48 @@ void timer_init(void) {
 void timer_handler(void) {
     // Increment tick counter
     timer_ticks++;
+    vdso_tick();
+    poll_timer_tick();
+    rcu_timer_tick();
     
     // Update uptime every second (100 ticks = 1 second at 100Hz)
-    if (timer_ticks % 100 == 0) {
+    if (--uptime_countdown == 0) {
+        uptime_countdown = TIMER_FREQUENCY;
         update_uptime();
     }
     
+    // Charge the running task; may flag a reschedule for IRQ exit
+    sched_tick();
+    
     // Send EOI to PIC
     pic_send_eoi(IRQ0_TIMER);
 }
 
-// Get current tick count
+// Get current tick count (low 32 bits)
 uint32_t timer_get_ticks(void) {
-    return timer_ticks;
+    return (uint32_t)timer_ticks;
+}
+
+// Get full 64-bit tick count; the IRQ may land between the two halves,
+// so re-read until the high word is stable
+uint64_t timer_get_ticks64(void) {
+    uint32_t hi, lo;
+    do {
+        hi = (uint32_t)(timer_ticks >> 32);
+        lo = (uint32_t)timer_ticks;
+    } while (hi != (uint32_t)(timer_ticks >> 32));
+    return ((uint64_t)hi << 32) | lo;
 }
 
 // Wait for specified number of ticks
 void timer_wait(uint32_t ticks) {
-    uint32_t start_ticks = timer_ticks;
-    while (timer_ticks < start_ticks + ticks) {
+    uint64_t start_ticks = timer_get_ticks64();
+    while (timer_get_ticks64() < start_ticks + ticks) {
         asm volatile ("hlt");  // Halt until next interrupt
     }
 }
 
-// Get uptime in seconds
+// Get uptime in seconds (from the monotonic clock)
 uint32_t get_uptime_seconds(void) {
-    return timer_ticks / TIMER_FREQUENCY;
-}
\ No newline at end of file
+    return clock_uptime_seconds();
+}
@@ -37,6 +37,7 @@
 void timer_init(void);
 void timer_handler(void);
 uint32_t timer_get_ticks(void);
+uint64_t timer_get_ticks64(void);
 void timer_wait(uint32_t ticks);
 uint32_t get_uptime_seconds(void);
 
@@ -14,6 +14,8 @@ typedef signed long long int64_t;
 
 typedef uint32_t size_t;
 
+#define UINT32_MAX 0xFFFFFFFFu
+
 // Boolean type
 typedef enum { false = 0, true = 1 } bool;
 
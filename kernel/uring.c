@@ -0,0 +1,498 @@
+// ClaudeOS Submission/Completion Rings - Day 21
+// io_uring-style batched asynchronous system calls, one ring pair per process
+
+#include "uring.h"
+#include "process.h"
+#include "syscall.h"
+#include "usermode.h"
+#include "ipc.h"
+#include "network.h"
+#include "heap.h"
+#include "cpu.h"
+#include "clock.h"
+#include "div64.h"
+#include "kernel.h"
+#include "string.h"
+#include "../fs/memfs_simple.h"
+
+static uint32_t rings_created = 0;
+static uint32_t rings_released = 0;
+
+// Run one operation on behalf of the ring owner
+static int uring_execute(uring_t* ring, const uring_sqe_t* sqe) {
+    switch (sqe->opcode) {
+        case URING_OP_NOP:
+            return 0;
+        case URING_OP_FS_READ:
+            return memfs_simple_read_handle(sqe->fd, (void*)sqe->addr, sqe->len);
+        case URING_OP_FS_WRITE:
+            return memfs_simple_write_handle(sqe->fd, (const void*)sqe->addr, sqe->len);
+        case URING_OP_IPC_SEND:
+            return ipc_msg_send(ring->owner_pid, sqe->fd, (const void*)sqe->addr, sqe->len);
+        case URING_OP_IPC_RECV:
+            return ipc_msg_receive(ring->owner_pid, sqe->fd, (void*)sqe->addr, sqe->len, NULL);
+        case URING_OP_NET_SEND:
+            return network_send_packet(sqe->fd, (const uint8_t*)sqe->addr, sqe->len) == 0 ?
+                   (int)sqe->len : -1;
+        default:
+            return SYSCALL_INVALID;
+    }
+}
+
+// Consume up to 'max' published SQEs in order, posting one CQE each.
+// Only one context consumes a given ring: its owner (uring_enter) or,
+// with SQPOLL, its poller thread.
+static uint32_t uring_submit(uring_t* ring, uint32_t max) {
+    uint32_t done = 0;
+
+    while (done < max && ring->sq_head != ring->sq_tail) {
+        // Never overwrite an unconsumed completion
+        if (ring->cq_tail - ring->cq_head >= URING_ENTRIES) {
+            ring->cq_overflow++;
+            break;
+        }
+
+        asm volatile ("" : : : "memory");
+        uring_sqe_t sqe = ring->sqes[ring->sq_head & URING_MASK];
+
+        int res = uring_execute(ring, &sqe);
+
+        uring_cqe_t* cqe = &ring->cqes[ring->cq_tail & URING_MASK];
+        cqe->user_data = sqe.user_data;
+        cqe->res = res;
+        asm volatile ("" : : : "memory");   // CQE contents before the tail
+        ring->cq_tail++;
+
+        // Head moves only once the CQE is out: a waiting owner that sees
+        // sq_head == sq_tail knows every completion has been posted
+        asm volatile ("" : : : "memory");
+        ring->sq_head++;
+        done++;
+    }
+
+    if (done) {
+        ring->submitted += done;
+        uint32_t flags = irq_save();
+        if (!wait_queue_empty(&ring->cq_wait)) {
+            wait_queue_wake_all(&ring->cq_wait);
+        }
+        irq_restore(flags);
+    }
+    return done;
+}
+
+// Wake the poller if it went to sleep (IRQs off)
+static void uring_wake_poller(uring_t* ring) {
+    if (ring->sq_flags & URING_SQ_NEED_WAKEUP) {
+        ring->sq_flags &= ~URING_SQ_NEED_WAKEUP;
+        ring->poller_wakeups++;
+        wait_queue_wake_one(&ring->sq_wait);
+    }
+}
+
+// SQPOLL thread: consumes submissions without any system call while the
+// owner keeps it busy, then sleeps after URING_SQPOLL_IDLE_NS of silence
+static void uring_sqpoll_thread(void* arg) {
+    uring_t* ring = (uring_t*)arg;
+    uint64_t idle_start = clock_monotonic_ns();
+
+    while (!ring->dying) {
+        if (uring_submit(ring, URING_ENTRIES)) {
+            idle_start = clock_monotonic_ns();
+            continue;
+        }
+
+        if (clock_monotonic_ns() - idle_start < URING_SQPOLL_IDLE_NS) {
+            process_yield();
+            continue;
+        }
+
+        uint32_t flags = irq_save();
+        ring->sq_flags |= URING_SQ_NEED_WAKEUP;
+        if (ring->sq_head == ring->sq_tail && !ring->dying) {
+            wait_queue_sleep(&ring->sq_wait);
+        }
+        ring->sq_flags &= ~URING_SQ_NEED_WAKEUP;
+        irq_restore(flags);
+        idle_start = clock_monotonic_ns();
+    }
+
+    // The owner is gone and nobody else references the ring
+    kfree(ring);
+}
+
+// Create the calling process's ring pair (or return the existing one)
+uring_t* uring_setup(uint32_t flags) {
+    process_t* self = current_process;
+    if (!self) {
+        return NULL;
+    }
+    if (self->uring) {
+        return self->uring;
+    }
+
+    uring_t* ring = (uring_t*)kmalloc(sizeof(uring_t));
+    if (!ring) {
+        return NULL;
+    }
+    memset(ring, 0, sizeof(uring_t));
+    ring->setup_flags = flags & URING_SETUP_SQPOLL;
+    ring->owner_pid = self->pid;
+    wait_queue_init(&ring->sq_wait);
+    wait_queue_init(&ring->cq_wait);
+
+    if (ring->setup_flags & URING_SETUP_SQPOLL) {
+        int pid = kthread_create(uring_sqpoll_thread, ring, "uring-sq");
+        ring->poller = process_find(pid);
+        if (!ring->poller) {
+            kfree(ring);
+            return NULL;
+        }
+    }
+
+    self->uring = ring;
+    rings_created++;
+    return ring;
+}
+
+// Submit up to to_submit SQEs and optionally wait until min_complete
+// completions are ready. Returns the number of SQEs consumed (with SQPOLL:
+// the number published for the poller).
+int uring_enter(uring_t* ring, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    int submitted;
+    bool sqpoll = (ring->setup_flags & URING_SETUP_SQPOLL) != 0;
+
+    ring->enters++;
+    if (sqpoll) {
+        uint32_t pending = ring->sq_tail - ring->sq_head;
+        submitted = (int)(to_submit < pending ? to_submit : pending);
+        if (flags & URING_ENTER_SQ_WAKEUP) {
+            uint32_t irq = irq_save();
+            uring_wake_poller(ring);
+            irq_restore(irq);
+        }
+    } else {
+        submitted = (int)uring_submit(ring, to_submit);
+    }
+
+    if (flags & URING_ENTER_GETEVENTS) {
+        uint32_t irq = irq_save();
+        // Only wait while in-flight work can still produce completions
+        while (ring->cq_tail - ring->cq_head < min_complete &&
+               sqpoll && ring->sq_head != ring->sq_tail) {
+            uring_wake_poller(ring);
+            wait_queue_sleep(&ring->cq_wait);
+        }
+        irq_restore(irq);
+    }
+    return submitted;
+}
+
+// Called by the reaper once the owner has exited
+void uring_release(process_t* process) {
+    uring_t* ring = process->uring;
+    if (!ring) {
+        return;
+    }
+    process->uring = NULL;
+    rings_released++;
+
+    if (ring->poller) {
+        // The poller may be mid-submission: it frees the ring on its way out
+        uint32_t flags = irq_save();
+        ring->dying = true;
+        wait_queue_wake_all(&ring->sq_wait);
+        irq_restore(flags);
+    } else {
+        kfree(ring);
+    }
+}
+
+// SYS_URING_SETUP (10) - Returns the ring address
+int sys_uring_setup(uint32_t flags, uint32_t arg2, uint32_t arg3) {
+    (void)arg2; (void)arg3; // Suppress unused parameter warnings
+
+    uring_t* ring = uring_setup(flags);
+    return ring ? (int)ring : SYSCALL_ERROR;
+}
+
+// SYS_URING_ENTER (11)
+int sys_uring_enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    if (!current_process || !current_process->uring) {
+        return SYSCALL_ERROR;
+    }
+    return uring_enter(current_process->uring, to_submit, min_complete, flags);
+}
+
+// ---------------------------------------------------------------------------
+// Ring 3 test and benchmark programs (shared state lives in kernel statics;
+// paging is off, so ring 3 code reads and writes them directly)
+// ---------------------------------------------------------------------------
+
+#define URING_BENCH_DEFAULT     2000    // Operations per benchmark row
+#define URING_BENCH_BATCH       32      // SQEs per submission
+#define URING_FILE_BLOCK        4096
+#define URING_MSG_SIZE          32
+
+static struct {
+    int file;                       // memfs handle
+    int net_if;                     // Loopback interface ID
+    uint32_t ops;
+    int results[6];                 // Test CQE results, indexed by user_data
+    uint32_t completions;
+    uint64_t percall_file;          // Cycles per row
+    uint64_t batched_file;
+    uint64_t percall_ipc;
+    uint64_t batched_ipc;
+    uint64_t sqpoll_ipc;
+} uring_prog;
+
+static uint8_t uring_block[URING_FILE_BLOCK];
+
+// Publish and submit, then drain every completion (ring 3)
+static uint32_t uring_user_flush(uring_t* ring, uint32_t wait_for) {
+    uint32_t count = uring_publish(ring);
+    if (ring->setup_flags & URING_SETUP_SQPOLL) {
+        uint32_t flags = URING_ENTER_GETEVENTS;
+        if (ring->sq_flags & URING_SQ_NEED_WAKEUP) {
+            flags |= URING_ENTER_SQ_WAKEUP;
+        }
+        user_int80(SYS_URING_ENTER, 0, wait_for, flags);
+    } else {
+        user_int80(SYS_URING_ENTER, count, wait_for, URING_ENTER_GETEVENTS);
+    }
+
+    uint32_t seen = 0;
+    uring_cqe_t* cqe;
+    while ((cqe = uring_peek_cqe(ring)) != NULL) {
+        if (cqe->user_data < 6) {
+            uring_prog.results[cqe->user_data] = cqe->res;
+        }
+        uring_cqe_seen(ring);
+        seen++;
+    }
+    uring_prog.completions += seen;
+    return seen;
+}
+
+static int uring_test_main(void) {
+    uring_t* ring = (uring_t*)user_int80(SYS_URING_SETUP, 0, 0, 0);
+    if ((int)ring <= 0) {
+        return -1;
+    }
+    int self = user_int80(SYS_GETPID, 0, 0, 0);
+    static const char text[] = "hello uring";
+    static char readback[16];
+    static char message[16];
+
+    uring_prep(uring_get_sqe(ring), URING_OP_FS_WRITE, uring_prog.file, text, sizeof(text), 0);
+    uring_prep(uring_get_sqe(ring), URING_OP_FS_READ, uring_prog.file, readback, sizeof(readback), 1);
+    uring_prep(uring_get_sqe(ring), URING_OP_IPC_SEND, self, text, sizeof(text), 2);
+    uring_prep(uring_get_sqe(ring), URING_OP_IPC_RECV, self, message, sizeof(message), 3);
+    uring_prep(uring_get_sqe(ring), URING_OP_NET_SEND, uring_prog.net_if, text, sizeof(text), 4);
+    uring_prep(uring_get_sqe(ring), URING_OP_NOP, 0, NULL, 0, 5);
+    uring_user_flush(ring, 6);
+
+    return strcmp(readback, text) == 0 && strcmp(message, text) == 0 ? 0 : 1;
+}
+
+static int uring_sqpoll_test_main(void) {
+    uring_t* ring = (uring_t*)user_int80(SYS_URING_SETUP, URING_SETUP_SQPOLL, 0, 0);
+    if ((int)ring <= 0) {
+        return -1;
+    }
+    int self = user_int80(SYS_GETPID, 0, 0, 0);
+    static const char text[] = "polled";
+    static char message[16];
+
+    uring_prep(uring_get_sqe(ring), URING_OP_IPC_SEND, self, text, sizeof(text), 0);
+    uring_prep(uring_get_sqe(ring), URING_OP_IPC_RECV, self, message, sizeof(message), 1);
+    uring_user_flush(ring, 2);
+    return strcmp(message, text) == 0 ? 0 : 1;
+}
+
+// IPC round trips to self, 'pairs' SEND+RECV at a time
+static void uring_user_ipc_batches(uring_t* ring, int self, uint32_t ops) {
+    static uint8_t out[URING_MSG_SIZE];
+    static uint8_t in[URING_MSG_SIZE];
+
+    for (uint32_t done = 0; done < ops; ) {
+        uint32_t batch = 0;
+        while (batch < URING_BENCH_BATCH && done < ops) {
+            uring_prep(uring_get_sqe(ring), URING_OP_IPC_SEND, self, out, URING_MSG_SIZE, 6);
+            uring_prep(uring_get_sqe(ring), URING_OP_IPC_RECV, self, in, URING_MSG_SIZE, 6);
+            batch += 2;
+            done++;
+        }
+        uring_user_flush(ring, batch);
+    }
+}
+
+static int uring_bench_main(void) {
+    uint32_t ops = uring_prog.ops;
+    int self = user_int80(SYS_GETPID, 0, 0, 0);
+    static uint8_t out[URING_MSG_SIZE];
+    static uint8_t in[URING_MSG_SIZE];
+    uint64_t start;
+
+    // One trap per 4KB write
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < ops; i++) {
+        user_int80(SYS_WRITE_FILE, uring_prog.file, (uint32_t)uring_block, URING_FILE_BLOCK);
+    }
+    uring_prog.percall_file = rdtsc_ordered() - start;
+
+    uring_t* ring = (uring_t*)user_int80(SYS_URING_SETUP, 0, 0, 0);
+    if ((int)ring <= 0) {
+        return -1;
+    }
+
+    // One trap per batch of 4KB writes
+    start = rdtsc_ordered();
+    for (uint32_t done = 0; done < ops; ) {
+        uint32_t batch = 0;
+        while (batch < URING_BENCH_BATCH && done < ops) {
+            uring_prep(uring_get_sqe(ring), URING_OP_FS_WRITE, uring_prog.file,
+                       uring_block, URING_FILE_BLOCK, 6);
+            batch++;
+            done++;
+        }
+        uring_user_flush(ring, batch);
+    }
+    uring_prog.batched_file = rdtsc_ordered() - start;
+
+    // Two traps per message round trip
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < ops; i++) {
+        user_int80(SYS_IPC_SEND, self, (uint32_t)out, URING_MSG_SIZE);
+        user_int80(SYS_IPC_RECEIVE, self, (uint32_t)in, URING_MSG_SIZE);
+    }
+    uring_prog.percall_ipc = rdtsc_ordered() - start;
+
+    start = rdtsc_ordered();
+    uring_user_ipc_batches(ring, self, ops);
+    uring_prog.batched_ipc = rdtsc_ordered() - start;
+    return 0;
+}
+
+static int uring_sqpoll_bench_main(void) {
+    uring_t* ring = (uring_t*)user_int80(SYS_URING_SETUP, URING_SETUP_SQPOLL, 0, 0);
+    if ((int)ring <= 0) {
+        return -1;
+    }
+    int self = user_int80(SYS_GETPID, 0, 0, 0);
+
+    uint64_t start = rdtsc_ordered();
+    uring_user_ipc_batches(ring, self, uring_prog.ops);
+    uring_prog.sqpoll_ipc = rdtsc_ordered() - start;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Shell command
+// ---------------------------------------------------------------------------
+
+static bool uring_prepare_file(void) {
+    const char* name = "uring.dat";
+    if (memfs_simple_find_file(name) < 0 && memfs_simple_create(name) != MEMFS_SUCCESS) {
+        terminal_writestring("[URING] Cannot create uring.dat\n");
+        return false;
+    }
+    uring_prog.file = memfs_simple_find_file(name);
+
+    network_interface_t* lo = network_find_interface_by_name("lo");
+    uring_prog.net_if = lo ? lo->id : -1;
+    return true;
+}
+
+static void uring_run_test(void) {
+    int status = 0;
+
+    memset(&uring_prog, 0, sizeof(uring_prog));
+    if (!uring_prepare_file()) {
+        return;
+    }
+
+    if (user_process_run(uring_test_main, "uring-test", &status) == INVALID_PID) {
+        return;
+    }
+    terminal_printf("  Batch of 6 ops, one enter: %u completions, status %d (expect 6, 0)\n",
+                    uring_prog.completions, status);
+    terminal_printf("  write %d  read %d  ipc send %d  ipc recv %d  net send %d  nop %d\n",
+                    uring_prog.results[0], uring_prog.results[1], uring_prog.results[2],
+                    uring_prog.results[3], uring_prog.results[4], uring_prog.results[5]);
+
+    uring_prog.completions = 0;
+    if (user_process_run(uring_sqpoll_test_main, "uring-sqpoll", &status) == INVALID_PID) {
+        return;
+    }
+    terminal_printf("  SQPOLL ipc round trip: %u completions, status %d (expect 2, 0)\n",
+                    uring_prog.completions, status);
+}
+
+static void uring_bench_row(const char* label, uint64_t cycles, uint32_t ops) {
+    uint64_t ns = clock_cycles_to_ns(cycles);
+    if (ns == 0) {
+        ns = 1;
+    }
+    terminal_printf("  %s %llu ops/sec  %llu ns/op\n", label,
+                    div64_u64((uint64_t)ops * NSEC_PER_SEC, ns), div_u64(ns, ops));
+}
+
+static void uring_run_bench(uint32_t ops) {
+    int status = 0;
+
+    memset(&uring_prog, 0, sizeof(uring_prog));
+    if (!uring_prepare_file()) {
+        return;
+    }
+    uring_prog.ops = ops;
+
+    if (user_process_run(uring_bench_main, "uring-bench", &status) == INVALID_PID || status != 0) {
+        terminal_writestring("[URING] Benchmark failed\n");
+        return;
+    }
+    if (user_process_run(uring_sqpoll_bench_main, "uring-bench-sq", &status) == INVALID_PID ||
+        status != 0) {
+        terminal_writestring("[URING] SQPOLL benchmark failed\n");
+        return;
+    }
+
+    terminal_printf("Ring 3 throughput, %u ops per row, batches of %d SQEs:\n",
+                    ops, URING_BENCH_BATCH);
+    uring_bench_row("4KB write, INT 0x80 per call:", uring_prog.percall_file, ops);
+    uring_bench_row("4KB write, uring batched:    ", uring_prog.batched_file, ops);
+    uring_bench_row("32B IPC,   INT 0x80 per call:", uring_prog.percall_ipc, ops);
+    uring_bench_row("32B IPC,   uring batched:    ", uring_prog.batched_ipc, ops);
+    uring_bench_row("32B IPC,   uring SQPOLL:     ", uring_prog.sqpoll_ipc, ops);
+    terminal_writestring("  (IPC op = send + receive round trip to self)\n");
+}
+
+void uring_command_handler(int argc, char argv[][64]) {
+    if (argc < 2) {
+        terminal_writestring("Submission Ring Commands:\n");
+        terminal_writestring("  uring test      - Batched and SQPOLL ops from ring 3\n");
+        terminal_writestring("  uring bench [n] - Batched vs per-call file and IPC throughput\n");
+        terminal_printf("Rings created: %u  released: %u\n", rings_created, rings_released);
+        return;
+    }
+
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "test") == 0) {
+        uring_run_test();
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        int n = (argc >= 3) ? atoi(argv[2]) : URING_BENCH_DEFAULT;
+        if (n <= 0) {
+            n = URING_BENCH_DEFAULT;
+        }
+        uring_run_bench((uint32_t)n);
+    }
+    else {
+        terminal_printf("Unknown uring command: %s\n", argv[1]);
+    }
+}
@@ -0,0 +1,132 @@
+// ClaudeOS Submission/Completion Rings - Day 21
+// io_uring-style batched asynchronous system calls, one ring pair per process
+
+#ifndef URING_H
+#define URING_H
+
+#include "types.h"
+#include "wait.h"
+
+struct process;
+
+// Ring geometry (power of two; head/tail counters are free-running)
+#define URING_ENTRIES       64
+#define URING_MASK          (URING_ENTRIES - 1)
+
+// Operations
+#define URING_OP_NOP        0
+#define URING_OP_FS_READ    1   // fd = file handle, addr = buffer, len = bytes
+#define URING_OP_FS_WRITE   2   // fd = file handle, addr = data, len = bytes
+#define URING_OP_IPC_SEND   3   // fd = receiver PID, addr = data, len = bytes
+#define URING_OP_IPC_RECV   4   // fd = sender PID (-1: any), addr = buffer, len = size
+#define URING_OP_NET_SEND   5   // fd = interface ID, addr = frame, len = bytes
+#define URING_OP_MAX        6
+
+// Setup flags
+#define URING_SETUP_SQPOLL      0x01    // A kernel thread consumes the SQ
+
+// sq_flags (kernel -> process)
+#define URING_SQ_NEED_WAKEUP    0x01    // Poller is asleep: enter with SQ_WAKEUP
+
+// Enter flags
+#define URING_ENTER_GETEVENTS   0x01    // Wait for min_complete completions
+#define URING_ENTER_SQ_WAKEUP   0x02    // Wake a sleeping SQPOLL thread
+
+// Poller keeps spinning this long after the last submission before sleeping
+#define URING_SQPOLL_IDLE_NS    2000000ULL
+
+// Submission queue entry
+typedef struct uring_sqe {
+    uint8_t opcode;
+    uint8_t flags;
+    uint16_t reserved;
+    int32_t fd;
+    uint32_t addr;
+    uint32_t len;
+    uint32_t user_data;             // Copied to the completion
+} uring_sqe_t;
+
+// Completion queue entry
+typedef struct uring_cqe {
+    uint32_t user_data;
+    int32_t res;                    // Operation result (negative on error)
+} uring_cqe_t;
+
+// Ring pair shared by the process and the kernel (paging is off, so the
+// kernel allocation is directly addressable from ring 3). The process
+// produces SQEs and consumes CQEs; the kernel does the opposite.
+typedef struct uring {
+    volatile uint32_t sq_head;      // Kernel: next SQE to consume
+    volatile uint32_t sq_tail;      // Process: published submissions
+    volatile uint32_t cq_head;      // Process: next CQE to consume
+    volatile uint32_t cq_tail;      // Kernel: posted completions
+    volatile uint32_t sq_flags;     // URING_SQ_*
+    uint32_t setup_flags;           // URING_SETUP_*
+    uint32_t sqe_tail;              // Process-private: SQEs filled, not yet published
+    uring_sqe_t sqes[URING_ENTRIES];
+    uring_cqe_t cqes[URING_ENTRIES];
+
+    // Kernel-private
+    int owner_pid;
+    volatile bool dying;            // Owner gone: poller frees the ring
+    struct process* poller;
+    wait_queue_t sq_wait;           // Sleeping SQPOLL thread
+    wait_queue_t cq_wait;           // Tasks waiting for completions
+    uint32_t enters;                // uring_enter() calls
+    uint32_t submitted;             // SQEs consumed
+    uint32_t cq_overflow;           // Submissions held back by a full CQ
+    uint32_t poller_wakeups;
+} uring_t;
+
+// Kernel interface
+uring_t* uring_setup(uint32_t flags);
+int uring_enter(uring_t* ring, uint32_t to_submit, uint32_t min_complete, uint32_t flags);
+void uring_release(struct process* process);
+void uring_command_handler(int argc, char argv[][64]);
+
+// System call handlers (SYS_URING_SETUP, SYS_URING_ENTER)
+int sys_uring_setup(uint32_t flags, uint32_t arg2, uint32_t arg3);
+int sys_uring_enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags);
+
+// Process-side helpers: fill SQEs, publish them, then reap CQEs
+static inline uring_sqe_t* uring_get_sqe(uring_t* ring) {
+    if (ring->sqe_tail - ring->sq_head >= URING_ENTRIES) {
+        return NULL;                // SQ full: submit first
+    }
+    uring_sqe_t* sqe = &ring->sqes[ring->sqe_tail & URING_MASK];
+    ring->sqe_tail++;
+    return sqe;
+}
+
+static inline void uring_prep(uring_sqe_t* sqe, uint8_t opcode, int32_t fd,
+                              const void* addr, uint32_t len, uint32_t user_data) {
+    sqe->opcode = opcode;
+    sqe->flags = 0;
+    sqe->reserved = 0;
+    sqe->fd = fd;
+    sqe->addr = (uint32_t)addr;
+    sqe->len = len;
+    sqe->user_data = user_data;
+}
+
+// Make filled SQEs visible to the kernel; returns how many were published
+static inline uint32_t uring_publish(uring_t* ring) {
+    uint32_t count = ring->sqe_tail - ring->sq_tail;
+    asm volatile ("" : : : "memory");   // SQE contents before the tail
+    ring->sq_tail = ring->sqe_tail;
+    return count;
+}
+
+static inline uring_cqe_t* uring_peek_cqe(uring_t* ring) {
+    if (ring->cq_head == ring->cq_tail) {
+        return NULL;
+    }
+    asm volatile ("" : : : "memory");   // Tail before the CQE contents
+    return &ring->cqes[ring->cq_head & URING_MASK];
+}
+
+static inline void uring_cqe_seen(uring_t* ring) {
+    ring->cq_head++;
+}
+
+#endif // URING_H
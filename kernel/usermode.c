@@ -0,0 +1,264 @@
+// ClaudeOS User Mode - Day 21
+// Ring 3 tasks entering the kernel through INT 0x80 or SYSENTER/SYSEXIT
+
+#include "usermode.h"
+#include "syscall.h"
+#include "process.h"
+#include "heap.h"
+#include "gdt.h"
+#include "idt.h"
+#include "cpu.h"
+#include "clock.h"
+#include "div64.h"
+#include "kernel.h"
+#include "string.h"
+
+// Placeholder SYSENTER_ESP: the entry stub switches to TSS esp0 at once
+static uint8_t sysenter_stack[256] __attribute__((aligned(16)));
+static bool sysenter_ready = false;
+
+void usermode_init(void) {
+    // INT 0x80 must be reachable from ring 3 (DPL 3), as a trap gate so
+    // system calls run with interrupts enabled
+    idt_set_gate(SYSCALL_VECTOR, (uint32_t)syscall_int80_entry, GDT_KERNEL_CODE_SEL,
+                 IDT_FLAG_PRESENT | IDT_FLAG_RING3 | IDT_FLAG_TRAP_GATE);
+
+    uint32_t eax, ebx, ecx, edx = 0;
+    if (cpu_has_cpuid()) {
+        cpuid(1, &eax, &ebx, &ecx, &edx);
+    }
+    if ((edx & CPUID_EDX_SEP) && (edx & CPUID_EDX_MSR)) {
+        wrmsr(MSR_IA32_SYSENTER_CS, GDT_KERNEL_CODE_SEL);
+        wrmsr(MSR_IA32_SYSENTER_ESP, (uint32_t)(sysenter_stack + sizeof(sysenter_stack)));
+        wrmsr(MSR_IA32_SYSENTER_EIP, (uint32_t)sysenter_entry);
+        sysenter_ready = true;
+    }
+
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_MAGENTA, VGA_COLOR_BLACK));
+    terminal_printf("[USER] Ring 3 ready: INT 0x80 gate, SYSENTER %s\n",
+                    sysenter_ready ? "enabled" : "unsupported");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+}
+
+bool usermode_sysenter_available(void) {
+    return sysenter_ready;
+}
+
+// Kernel half of a user task: set up its ring 3 stack, then drop to ring 3.
+// The kernel stack below this frame is abandoned and becomes the esp0
+// stack for the task's interrupts and system calls.
+static void user_thread_start(void* arg) {
+    process_t* self = current_process;
+
+    void* stack = kmalloc(USER_STACK_SIZE);
+    if (!stack) {
+        terminal_printf("[USER] No memory for user stack of '%s'\n", self->name);
+        process_exit(-1);
+    }
+
+    // Returning from the entry point lands in the SYS_EXIT stub
+    uint32_t top = ((uint32_t)stack + USER_STACK_SIZE) & ~0xF;
+    top -= sizeof(uint32_t);
+    *(uint32_t*)top = (uint32_t)user_exit_stub;
+
+    uint32_t flags = irq_save();
+    self->user_stack = stack;
+    self->memory_usage += USER_STACK_SIZE;
+    self->flags |= PROCESS_FLAG_USER;
+    tss_set_kernel_stack(process_kernel_stack_top(self));
+    irq_restore(flags);
+
+    enter_user_mode((uint32_t)arg, top);
+}
+
+// Create a joinable ring 3 task running entry(); its return value is the
+// exit code collected by process_wait()
+int user_process_create(int (*entry)(void), const char* name) {
+    if (!entry) {
+        return INVALID_PID;
+    }
+    return kthread_create_child(user_thread_start, (void*)entry, name);
+}
+
+// ---------------------------------------------------------------------------
+// Ring 3 test programs. They share the kernel image (paging is off, all
+// segments are flat) but may only use unprivileged instructions.
+// ---------------------------------------------------------------------------
+
+static struct {
+    bool use_sysenter;
+    uint32_t cpl;                   // Privilege level the program observed
+    int pid_int80;
+    int pid_sysenter;
+    int write_result;
+} user_test;
+
+static struct {
+    uint32_t iterations;
+    bool use_sysenter;
+    uint64_t int80_getpid;          // Total cycles per row
+    uint64_t sysenter_getpid;
+    uint64_t int80_yield;
+    uint64_t sysenter_yield;
+} user_bench;
+
+static int user_test_main(void) {
+    uint32_t cs;
+    asm volatile ("mov %%cs, %0" : "=r" (cs));
+    user_test.cpl = cs & 3;
+
+    user_test.pid_int80 = user_int80(SYS_GETPID, 0, 0, 0);
+    if (user_test.use_sysenter) {
+        user_test.pid_sysenter = user_sysenter(SYS_GETPID, 0, 0, 0);
+    }
+    user_test.write_result = user_int80(SYS_WRITE, (uint32_t)"Hello from ring 3!", 0, 0);
+    return 42;
+}
+
+// Executes a privileged instruction: the #GP must kill only this task
+static int user_fault_main(void) {
+    asm volatile ("cli");
+    return 0;
+}
+
+static int user_bench_main(void) {
+    uint32_t n = user_bench.iterations;
+    uint64_t start;
+
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < n; i++) {
+        user_int80(SYS_GETPID, 0, 0, 0);
+    }
+    user_bench.int80_getpid = rdtsc_ordered() - start;
+
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < n; i++) {
+        user_int80(SYS_YIELD, 0, 0, 0);
+    }
+    user_bench.int80_yield = rdtsc_ordered() - start;
+
+    if (user_bench.use_sysenter) {
+        start = rdtsc_ordered();
+        for (uint32_t i = 0; i < n; i++) {
+            user_sysenter(SYS_GETPID, 0, 0, 0);
+        }
+        user_bench.sysenter_getpid = rdtsc_ordered() - start;
+
+        start = rdtsc_ordered();
+        for (uint32_t i = 0; i < n; i++) {
+            user_sysenter(SYS_YIELD, 0, 0, 0);
+        }
+        user_bench.sysenter_yield = rdtsc_ordered() - start;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Shell command
+// ---------------------------------------------------------------------------
+
+// Run a user program to completion: returns its PID (INVALID_PID on
+// failure) and its exit code via *status
+int user_process_run(int (*entry)(void), const char* name, int* status) {
+    int pid = user_process_create(entry, name);
+    if (pid == INVALID_PID) {
+        terminal_printf("[USER] Cannot create '%s'\n", name);
+        return INVALID_PID;
+    }
+    if (process_wait(pid, status) != pid) {
+        terminal_printf("[USER] Lost track of '%s' (PID %d)\n", name, pid);
+        return INVALID_PID;
+    }
+    return pid;
+}
+
+static void user_run_test(void) {
+    int status = 0;
+
+    memset(&user_test, 0, sizeof(user_test));
+    user_test.use_sysenter = sysenter_ready;
+    user_test.pid_int80 = INVALID_PID;
+    user_test.pid_sysenter = INVALID_PID;
+
+    int pid = user_process_run(user_test_main, "user-test", &status);
+    if (pid == INVALID_PID) {
+        return;
+    }
+    terminal_printf("  Ring 3 task ran at CPL %u, exit code %d (expect 3, 42)\n",
+                    user_test.cpl, status);
+    terminal_printf("  getpid via INT 0x80: %d (expect %d)\n", user_test.pid_int80, pid);
+    if (sysenter_ready) {
+        terminal_printf("  getpid via SYSENTER: %d (expect %d)\n", user_test.pid_sysenter, pid);
+    }
+    terminal_printf("  write returned %d\n", user_test.write_result);
+
+    if (user_process_run(user_fault_main, "user-fault", &status) == INVALID_PID) {
+        return;
+    }
+    terminal_printf("  Privileged instruction in ring 3: task killed, exit code %d (expect -1)\n",
+                    status);
+}
+
+static void user_bench_row(const char* label, uint64_t cycles, uint32_t n) {
+    uint64_t per_call = div_u64(cycles, n);
+    uint64_t ns = div_u64(clock_cycles_to_ns(cycles), n);
+    terminal_printf("  %s %llu cycles  %llu ns\n", label, per_call, ns);
+}
+
+static void user_run_bench(uint32_t n) {
+    int status = 0;
+
+    // Baseline: the dispatcher called directly from ring 0
+    uint64_t start = rdtsc_ordered();
+    for (uint32_t i = 0; i < n; i++) {
+        syscall_dispatch(SYS_GETPID, 0, 0, 0);
+    }
+    uint64_t direct = rdtsc_ordered() - start;
+
+    memset(&user_bench, 0, sizeof(user_bench));
+    user_bench.iterations = n;
+    user_bench.use_sysenter = sysenter_ready;
+    if (user_process_run(user_bench_main, "user-bench", &status) == INVALID_PID) {
+        return;
+    }
+
+    terminal_printf("System call latency, %u calls per row (per call):\n", n);
+    user_bench_row("direct call      getpid:", direct, n);
+    user_bench_row("INT 0x80         getpid:", user_bench.int80_getpid, n);
+    if (sysenter_ready) {
+        user_bench_row("SYSENTER/SYSEXIT getpid:", user_bench.sysenter_getpid, n);
+    }
+    user_bench_row("INT 0x80         yield: ", user_bench.int80_yield, n);
+    if (sysenter_ready) {
+        user_bench_row("SYSENTER/SYSEXIT yield: ", user_bench.sysenter_yield, n);
+    }
+}
+
+void usermode_command_handler(int argc, char argv[][64]) {
+    if (argc < 2) {
+        terminal_writestring("User Mode Commands:\n");
+        terminal_writestring("  user test      - Run ring 3 tasks (syscalls, fault isolation)\n");
+        terminal_writestring("  user bench [n] - INT 0x80 vs SYSENTER system call latency\n");
+        terminal_printf("SYSENTER: %s\n", sysenter_ready ? "enabled" : "unsupported");
+        return;
+    }
+
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "test") == 0) {
+        user_run_test();
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        int n = (argc >= 3) ? atoi(argv[2]) : USER_BENCH_DEFAULT;
+        if (n <= 0) {
+            n = USER_BENCH_DEFAULT;
+        }
+        user_run_bench((uint32_t)n);
+    }
+    else {
+        terminal_printf("Unknown user command: %s\n", argv[1]);
+    }
+}
@@ -0,0 +1,51 @@
+// ClaudeOS User Mode - Day 21
+// Ring 3 tasks entering the kernel through INT 0x80 or SYSENTER/SYSEXIT
+
+#ifndef USERMODE_H
+#define USERMODE_H
+
+#include "types.h"
+
+#define USER_STACK_SIZE     0x2000      // 8KB ring 3 stack per user task
+#define SYSCALL_VECTOR      0x80
+#define USER_BENCH_DEFAULT  10000       // Iterations per benchmark row
+
+// Fast system call entry from ring 3. Only user tasks may execute SYSENTER:
+// the entry stub runs on the caller's TSS esp0 kernel stack.
+// Register ABI: EAX = number, EBX/ESI/EDI = arguments, returns EAX.
+static inline int user_sysenter(uint32_t nr, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    int result;
+    asm volatile ("movl %%esp, %%ecx\n\t"
+                  "movl $1f, %%edx\n\t"
+                  "sysenter\n"
+                  "1:"
+                  : "=a" (result)
+                  : "a" (nr), "b" (arg1), "S" (arg2), "D" (arg3)
+                  : "ecx", "edx", "memory");
+    return result;
+}
+
+// Legacy trap gate entry. Register ABI: EAX = number, EBX/ECX/EDX = arguments.
+static inline int user_int80(uint32_t nr, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    int result;
+    asm volatile ("int $0x80"
+                  : "=a" (result)
+                  : "a" (nr), "b" (arg1), "c" (arg2), "d" (arg3)
+                  : "memory");
+    return result;
+}
+
+// User mode interface
+void usermode_init(void);
+bool usermode_sysenter_available(void);
+int user_process_create(int (*entry)(void), const char* name);
+int user_process_run(int (*entry)(void), const char* name, int* status);
+void usermode_command_handler(int argc, char argv[][64]);
+
+// Assembly entry points (syscall_entry.asm)
+extern void syscall_int80_entry(void);
+extern void sysenter_entry(void);
+extern void enter_user_mode(uint32_t eip, uint32_t esp);
+extern void user_exit_stub(void);
+
+#endif // USERMODE_H
@@ -0,0 +1,225 @@
+// ClaudeOS vDSO Data Page - Day 21
+// Kernel-maintained page read by ring 3 without a system call (seqlock)
+
+#include "vdso.h"
+#include "clock.h"
+#include "timer.h"
+#include "syscall.h"
+#include "usermode.h"
+#include "process.h"
+#include "kernel.h"
+#include "string.h"
+
+vdso_page_t vdso_page;
+
+// Writers run with interrupts disabled (timer IRQ, context switch), so on
+// one CPU they never interleave; the seqlock only protects readers.
+static inline void vdso_write_begin(void) {
+    vdso_page.data.seq++;
+    asm volatile ("" : : : "memory");
+}
+
+static inline void vdso_write_end(void) {
+    asm volatile ("" : : : "memory");
+    vdso_page.data.seq++;
+}
+
+// Publish the clock parameters (after clock_init)
+void vdso_init(void) {
+    const clock_info_t* info = clock_get_info();
+    uint32_t flags = irq_save();
+
+    vdso_write_begin();
+    vdso_page.data.pid = current_process ? current_process->pid : KERNEL_PID;
+    vdso_page.data.ticks = timer_get_ticks64();
+    vdso_page.data.tick_hz = TIMER_FREQUENCY;
+    vdso_page.data.clocksource = info->source;
+    vdso_page.data.tsc_base = info->tsc_base;
+    vdso_page.data.mult = info->mult;
+    vdso_page.data.shift = info->shift;
+    vdso_page.data.ticks_base = info->ticks_base;
+    vdso_page.data.ns_per_tick = NSEC_PER_SEC / TIMER_FREQUENCY;
+    vdso_write_end();
+
+    irq_restore(flags);
+}
+
+// Context switch (IRQs off)
+void vdso_set_pid(int pid) {
+    vdso_write_begin();
+    vdso_page.data.pid = pid;
+    vdso_page.data.switches++;
+    vdso_write_end();
+}
+
+// Timer interrupt
+void vdso_tick(void) {
+    vdso_write_begin();
+    vdso_page.data.ticks++;
+    vdso_write_end();
+}
+
+// SYS_CLOCK_GETTIME (14) - Store monotonic nanoseconds at *out
+int sys_clock_gettime(uint32_t out_ptr, uint32_t arg2, uint32_t arg3) {
+    (void)arg2; (void)arg3; // Suppress unused parameter warnings
+
+    *(uint64_t*)out_ptr = clock_monotonic_ns();
+    return SYSCALL_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------
+// Ring 3 test and benchmark
+// ---------------------------------------------------------------------------
+
+#define VDSO_BENCH_DEFAULT  10000
+
+static struct {
+    uint32_t iterations;
+    bool use_sysenter;
+    int pid_syscall;
+    int pid_vdso;
+    uint64_t clock_syscall;
+    uint64_t clock_vdso;
+    uint64_t clock_vdso_after;
+    uint64_t ticks_before;
+    uint64_t ticks_after;
+    uint64_t cycles[5];             // Total cycles per benchmark row
+} vdso_prog;
+
+static int vdso_test_main(void) {
+    vdso_prog.pid_syscall = user_int80(SYS_GETPID, 0, 0, 0);
+    vdso_prog.pid_vdso = vdso_getpid();
+
+    vdso_prog.ticks_before = vdso_ticks();
+    user_int80(SYS_CLOCK_GETTIME, (uint32_t)&vdso_prog.clock_syscall, 0, 0);
+    vdso_prog.clock_vdso = vdso_clock_ns();
+
+    // Spin across a few timer ticks without entering the kernel
+    while (vdso_ticks() < vdso_prog.ticks_before + 3) {
+        cpu_relax();
+    }
+    vdso_prog.ticks_after = vdso_ticks();
+    vdso_prog.clock_vdso_after = vdso_clock_ns();
+    return 0;
+}
+
+static int vdso_bench_main(void) {
+    uint32_t n = vdso_prog.iterations;
+    uint64_t out = 0;
+    uint64_t sum = 0;
+    uint64_t start;
+
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < n; i++) {
+        user_int80(SYS_GETPID, 0, 0, 0);
+    }
+    vdso_prog.cycles[0] = rdtsc_ordered() - start;
+
+    if (vdso_prog.use_sysenter) {
+        start = rdtsc_ordered();
+        for (uint32_t i = 0; i < n; i++) {
+            user_sysenter(SYS_GETPID, 0, 0, 0);
+        }
+        vdso_prog.cycles[1] = rdtsc_ordered() - start;
+    }
+
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < n; i++) {
+        vdso_getpid();
+    }
+    vdso_prog.cycles[2] = rdtsc_ordered() - start;
+
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < n; i++) {
+        user_int80(SYS_CLOCK_GETTIME, (uint32_t)&out, 0, 0);
+    }
+    vdso_prog.cycles[3] = rdtsc_ordered() - start;
+
+    start = rdtsc_ordered();
+    for (uint32_t i = 0; i < n; i++) {
+        sum += vdso_clock_ns();
+    }
+    vdso_prog.cycles[4] = rdtsc_ordered() - start;
+
+    vdso_prog.clock_vdso = sum;     // Keep the reads live
+    return 0;
+}
+
+static void vdso_run_test(void) {
+    int status = 0;
+
+    memset(&vdso_prog, 0, sizeof(vdso_prog));
+    int pid = user_process_run(vdso_test_main, "vdso-test", &status);
+    if (pid == INVALID_PID) {
+        return;
+    }
+
+    terminal_printf("  getpid: syscall %d, vDSO %d (expect %d)\n",
+                    vdso_prog.pid_syscall, vdso_prog.pid_vdso, pid);
+    terminal_printf("  clock: syscall %llu ns, vDSO %llu ns (vDSO read second)\n",
+                    vdso_prog.clock_syscall, vdso_prog.clock_vdso);
+    terminal_printf("  ticks %llu -> %llu, clock advanced %llu us while spinning in ring 3\n",
+                    vdso_prog.ticks_before, vdso_prog.ticks_after,
+                    clock_ns_to_us(vdso_prog.clock_vdso_after - vdso_prog.clock_vdso));
+}
+
+static void vdso_run_bench(uint32_t n) {
+    static const char* labels[5] = {
+        "getpid  INT 0x80: ",
+        "getpid  SYSENTER: ",
+        "getpid  vDSO:     ",
+        "clock   INT 0x80: ",
+        "clock   vDSO:     ",
+    };
+    int status = 0;
+
+    memset(&vdso_prog, 0, sizeof(vdso_prog));
+    vdso_prog.iterations = n;
+    vdso_prog.use_sysenter = usermode_sysenter_available();
+    if (user_process_run(vdso_bench_main, "vdso-bench", &status) == INVALID_PID) {
+        return;
+    }
+
+    terminal_printf("Ring 3 read cost, %u calls per row (per call):\n", n);
+    for (int i = 0; i < 5; i++) {
+        if (i == 1 && !vdso_prog.use_sysenter) {
+            continue;
+        }
+        terminal_printf("  %s %llu cycles  %llu ns\n", labels[i],
+                        div_u64(vdso_prog.cycles[i], n),
+                        div_u64(clock_cycles_to_ns(vdso_prog.cycles[i]), n));
+    }
+}
+
+void vdso_command_handler(int argc, char argv[][64]) {
+    const vdso_data_t* vd = vdso_data();
+
+    if (argc < 2) {
+        terminal_writestring("vDSO Commands:\n");
+        terminal_writestring("  vdso test      - Read pid/clock/ticks from ring 3\n");
+        terminal_writestring("  vdso bench [n] - vDSO reads vs system calls\n");
+        terminal_printf("Page at %u: seq %u, pid %d, ticks %llu, switches %u, clocksource %s\n",
+                        (uint32_t)&vdso_page, vd->seq, vd->pid, vd->ticks, vd->switches,
+                        vd->clocksource == CLOCKSOURCE_TSC ? "TSC" : "PIT");
+        return;
+    }
+
+    if (!current_process) {
+        terminal_writestring("Process system not initialized\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "test") == 0) {
+        vdso_run_test();
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        int n = (argc >= 3) ? atoi(argv[2]) : VDSO_BENCH_DEFAULT;
+        if (n <= 0) {
+            n = VDSO_BENCH_DEFAULT;
+        }
+        vdso_run_bench((uint32_t)n);
+    }
+    else {
+        terminal_printf("Unknown vdso command: %s\n", argv[1]);
+    }
+}
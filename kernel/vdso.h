@@ -0,0 +1,103 @@
+// ClaudeOS vDSO Data Page - Day 21
+// Kernel-maintained page read by ring 3 without a system call (seqlock)
+
+#ifndef VDSO_H
+#define VDSO_H
+
+#include "types.h"
+#include "cpu.h"
+#include "div64.h"
+#include "clock.h"
+
+#define VDSO_PAGE_SIZE      4096
+
+// Published data. The kernel bumps seq to odd before an update and back
+// to even after it; readers retry if seq was odd or changed meanwhile.
+typedef struct vdso_data {
+    volatile uint32_t seq;
+    volatile int32_t pid;               // Running process (updated on switch)
+    volatile uint64_t ticks;            // Timer interrupts since boot
+    uint32_t tick_hz;
+    uint32_t clocksource;               // clocksource_t
+    uint64_t tsc_base;                  // ns = ((tsc - tsc_base) * mult) >> shift
+    uint32_t mult;
+    uint32_t shift;
+    uint64_t ticks_base;                // PIT fallback: ns = (ticks - base) * ns_per_tick
+    uint32_t ns_per_tick;
+    volatile uint32_t switches;         // Context switches published
+} vdso_data_t;
+
+typedef union vdso_page {
+    vdso_data_t data;
+    uint8_t bytes[VDSO_PAGE_SIZE];
+} __attribute__((aligned(VDSO_PAGE_SIZE))) vdso_page_t;
+
+// Paging is off, so the page is reachable from ring 3 at its kernel
+// address; only the kernel writes it.
+extern vdso_page_t vdso_page;
+
+// Kernel interface
+void vdso_init(void);
+void vdso_set_pid(int pid);
+void vdso_tick(void);
+int sys_clock_gettime(uint32_t out_ptr, uint32_t arg2, uint32_t arg3);
+void vdso_command_handler(int argc, char argv[][64]);
+
+// Reader helpers (usable from ring 3)
+static inline const vdso_data_t* vdso_data(void) {
+    return &vdso_page.data;
+}
+
+static inline uint32_t vdso_read_begin(const vdso_data_t* vd) {
+    uint32_t seq;
+    while ((seq = vd->seq) & 1) {
+        cpu_relax();
+    }
+    asm volatile ("" : : : "memory");
+    return seq;
+}
+
+static inline bool vdso_read_retry(const vdso_data_t* vd, uint32_t seq) {
+    asm volatile ("" : : : "memory");
+    return vd->seq != seq;
+}
+
+static inline int vdso_getpid(void) {
+    const vdso_data_t* vd = vdso_data();
+    uint32_t seq;
+    int pid;
+    do {
+        seq = vdso_read_begin(vd);
+        pid = vd->pid;
+    } while (vdso_read_retry(vd, seq));
+    return pid;
+}
+
+static inline uint64_t vdso_ticks(void) {
+    const vdso_data_t* vd = vdso_data();
+    uint32_t seq;
+    uint64_t ticks;
+    do {
+        seq = vdso_read_begin(vd);
+        ticks = vd->ticks;
+    } while (vdso_read_retry(vd, seq));
+    return ticks;
+}
+
+// Monotonic nanoseconds, same timeline as clock_monotonic_ns()
+static inline uint64_t vdso_clock_ns(void) {
+    const vdso_data_t* vd = vdso_data();
+    uint32_t seq;
+    uint64_t ns;
+    do {
+        seq = vdso_read_begin(vd);
+        if (vd->clocksource == CLOCKSOURCE_TSC) {
+            ns = mul_u64_u32_shr(rdtsc() - vd->tsc_base, vd->mult, vd->shift);
+        } else {
+            ns = (vd->ticks - vd->ticks_base) * vd->ns_per_tick;
+        }
+    } while (vdso_read_retry(vd, seq));
+    return ns;
+}
+
+#endif // VDSO_H
@@ -55,6 +55,12 @@ static page_table_t* get_page_table(page_directory_t* dir, uint32_t virt_addr, i
 
 // Initialize virtual memory manager
 void vmm_init(void) {
+    // The heap is mapped into the existing directory; keep it
+    if (current_page_directory) {
+        terminal_writestring("VMM: Already initialized\n");
+        return;
+    }
+    
     terminal_writestring("VMM: Initializing virtual memory manager...\n");
     
     // Create kernel page directory
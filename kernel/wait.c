@@ -0,0 +1,210 @@
+// ClaudeOS Wait Queues - Day 21
+// Blocking primitive shared by semaphores and other sleeping IPC objects
+
+#include "wait.h"
+#include "cpu.h"
+#include "idt.h"
+#include "sched.h"
+
+void wait_queue_init(wait_queue_t* wq) {
+    wq->head = NULL;
+    wq->tail = NULL;
+    wq->count = 0;
+}
+
+// Insert after every waiter of equal or higher priority (lower nice)
+static void wait_queue_insert(wait_queue_t* wq, process_t* process) {
+    process->wait_queue = wq;
+    process->wait_next = NULL;
+    wq->count++;
+
+    if (!wq->head || wq->tail->nice <= process->nice) {
+        if (wq->tail) {
+            wq->tail->wait_next = process;
+        } else {
+            wq->head = process;
+        }
+        wq->tail = process;
+        return;
+    }
+
+    process_t* prev = NULL;
+    process_t* cur = wq->head;
+    while (cur && cur->nice <= process->nice) {
+        prev = cur;
+        cur = cur->wait_next;
+    }
+
+    process->wait_next = cur;
+    if (prev) {
+        prev->wait_next = process;
+    } else {
+        wq->head = process;
+    }
+}
+
+// Block the current task on wq until woken
+void wait_queue_sleep(wait_queue_t* wq) {
+    process_t* self = current_process;
+    if (!self) {
+        return;
+    }
+
+    self->wait_key = 0;
+    wait_queue_insert(wq, self);
+    process_block();
+}
+
+// Sleep tagged with a key, so one queue can be shared by many objects
+// (futex hash buckets); only wait_queue_wake_key() with that key wakes it
+void wait_queue_sleep_key(wait_queue_t* wq, uint32_t key) {
+    process_t* self = current_process;
+    if (!self) {
+        return;
+    }
+
+    self->wait_key = key;
+    wait_queue_insert(wq, self);
+    process_block();
+}
+
+// Wake the highest-priority waiter. If the scheduler prefers it over the
+// caller, switch to it now rather than at the caller's next yield (from
+// IRQ context the switch happens on IRQ exit instead).
+process_t* wait_queue_wake_one(wait_queue_t* wq) {
+    uint32_t flags = irq_save();
+
+    process_t* process = wq->head;
+    if (!process) {
+        irq_restore(flags);
+        return NULL;
+    }
+
+    wq->head = process->wait_next;
+    if (!wq->head) {
+        wq->tail = NULL;
+    }
+    wq->count--;
+    process->wait_next = NULL;
+    process->wait_queue = NULL;
+
+    process_wake(process);
+
+    // process_wake() flagged a reschedule if the class prefers the wakee
+    if (!in_interrupt() && need_resched && preempt_count == 0) {
+        process_yield_to(process);
+    }
+
+    irq_restore(flags);
+    return process;
+}
+
+int wait_queue_wake_all(wait_queue_t* wq) {
+    uint32_t flags = irq_save();
+    int woken = 0;
+
+    while (wq->head) {
+        process_t* process = wq->head;
+        wq->head = process->wait_next;
+        process->wait_next = NULL;
+        process->wait_queue = NULL;
+        process_wake(process);
+        woken++;
+    }
+    wq->tail = NULL;
+    wq->count = 0;
+
+    irq_restore(flags);
+    return woken;
+}
+
+// Wake up to nr waiters sleeping with key, in queue order. Returns the
+// number woken.
+int wait_queue_wake_key(wait_queue_t* wq, uint32_t key, int nr) {
+    uint32_t flags = irq_save();
+    process_t* first = NULL;
+    process_t* prev = NULL;
+    process_t* cur = wq->head;
+    int woken = 0;
+
+    while (cur && woken < nr) {
+        process_t* next = cur->wait_next;
+        if (cur->wait_key != key) {
+            prev = cur;
+            cur = next;
+            continue;
+        }
+
+        if (prev) {
+            prev->wait_next = next;
+        } else {
+            wq->head = next;
+        }
+        if (wq->tail == cur) {
+            wq->tail = prev;
+        }
+        wq->count--;
+        cur->wait_next = NULL;
+        cur->wait_queue = NULL;
+        cur->wait_key = 0;
+        process_wake(cur);
+        if (!first) {
+            first = cur;
+        }
+        woken++;
+        cur = next;
+    }
+
+    // Same handoff as wait_queue_wake_one()
+    if (first && !in_interrupt() && need_resched && preempt_count == 0) {
+        process_yield_to(first);
+    }
+
+    irq_restore(flags);
+    return woken;
+}
+
+// Unlink a task from whatever queue it sleeps on (used when it is killed)
+void wait_queue_remove(process_t* process) {
+    uint32_t flags = irq_save();
+
+    wait_queue_t* wq = process->wait_queue;
+    if (wq) {
+        process_t* prev = NULL;
+        process_t* cur = wq->head;
+        while (cur && cur != process) {
+            prev = cur;
+            cur = cur->wait_next;
+        }
+
+        if (cur) {
+            if (prev) {
+                prev->wait_next = cur->wait_next;
+            } else {
+                wq->head = cur->wait_next;
+            }
+            if (wq->tail == cur) {
+                wq->tail = prev;
+            }
+            wq->count--;
+        }
+
+        process->wait_next = NULL;
+        process->wait_queue = NULL;
+    }
+
+    irq_restore(flags);
+}
+
+// Move a sleeping task to the place its (changed) priority calls for
+void wait_queue_requeue(process_t* process) {
+    uint32_t flags = irq_save();
+
+    wait_queue_t* wq = process->wait_queue;
+    if (wq) {
+        wait_queue_remove(process);
+        wait_queue_insert(wq, process);
+    }
+
+    irq_restore(flags);
+}
@@ -0,0 +1,35 @@
+// ClaudeOS Wait Queues - Day 21
+// Blocking primitive shared by semaphores and other sleeping IPC objects
+
+#ifndef WAIT_H
+#define WAIT_H
+
+#include "types.h"
+#include "process.h"
+
+// Tasks sleeping on an event, kept in priority order (FIFO within a level)
+typedef struct wait_queue {
+    process_t* head;
+    process_t* tail;
+    uint32_t count;
+} wait_queue_t;
+
+#define WAIT_QUEUE_INIT { NULL, NULL, 0 }
+
+// Wait queue interface. wait_queue_sleep() must be called with interrupts
+// disabled after the caller has re-checked its wait condition; it returns
+// (still with interrupts disabled) once another task wakes it.
+void wait_queue_init(wait_queue_t* wq);
+void wait_queue_sleep(wait_queue_t* wq);
+void wait_queue_sleep_key(wait_queue_t* wq, uint32_t key);
+process_t* wait_queue_wake_one(wait_queue_t* wq);
+int wait_queue_wake_all(wait_queue_t* wq);
+int wait_queue_wake_key(wait_queue_t* wq, uint32_t key, int nr);
+void wait_queue_remove(process_t* process);
+void wait_queue_requeue(process_t* process);
+
+static inline bool wait_queue_empty(const wait_queue_t* wq) {
+    return wq->head == NULL;
+}
+
+#endif // WAIT_H
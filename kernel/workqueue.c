@@ -0,0 +1,211 @@
+// ClaudeOS Deferred Work Queue - Day 21
+// IRQ-safe work submission serviced by a pool of kernel worker threads
+
+#include "workqueue.h"
+#include "process.h"
+#include "clock.h"
+#include "div64.h"
+#include "cpu.h"
+#include "kernel.h"
+#include "string.h"
+
+#define WORKQUEUE_MASK      (WORKQUEUE_SIZE - 1)
+
+// Ring of pending items; head/tail are free-running, protected by irq_save
+static work_item_t work_ring[WORKQUEUE_SIZE];
+static uint32_t work_head = 0;      // Next slot to fill
+static uint32_t work_tail = 0;      // Next slot to run
+
+// Workers sleeping for work (LIFO keeps the most recently run one hot)
+static process_t* idle_workers[WORKQUEUE_WORKERS];
+static int idle_worker_count = 0;
+
+static int worker_pids[WORKQUEUE_WORKERS];
+static bool workqueue_initialized = false;
+static workqueue_stats_t wq_stats;
+
+static void worker_thread(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        uint32_t flags = irq_save();
+        while (work_head == work_tail) {
+            // Registered and blocked with IRQs off: a submit cannot slip in between
+            idle_workers[idle_worker_count++] = current_process;
+            process_block();
+        }
+
+        work_item_t item = work_ring[work_tail & WORKQUEUE_MASK];
+        work_tail++;
+        irq_restore(flags);
+
+        uint64_t latency = clock_monotonic_ns() - item.submit_ns;
+        wq_stats.total_latency_ns += latency;
+        if (latency > wq_stats.max_latency_ns) {
+            wq_stats.max_latency_ns = latency;
+        }
+
+        item.fn(item.arg);
+        wq_stats.completed++;
+    }
+}
+
+// Start the worker pool (brings up the process system if needed)
+void workqueue_init(void) {
+    if (workqueue_initialized) {
+        return;
+    }
+
+    if (!current_process) {
+        process_init();
+    }
+
+    memset(&wq_stats, 0, sizeof(wq_stats));
+    work_head = 0;
+    work_tail = 0;
+    idle_worker_count = 0;
+
+    char name[16];
+    for (int i = 0; i < WORKQUEUE_WORKERS; i++) {
+        strcpy(name, "kworker/");
+        name[8] = '0' + i;
+        name[9] = '\0';
+        worker_pids[i] = kthread_create(worker_thread, NULL, name);
+        if (worker_pids[i] == INVALID_PID) {
+            terminal_writestring("[WORKQUEUE] Failed to create worker thread\n");
+        }
+    }
+
+    workqueue_initialized = true;
+    terminal_printf("[WORKQUEUE] %d workers, %d slots\n", WORKQUEUE_WORKERS, WORKQUEUE_SIZE);
+}
+
+// Queue fn(arg) for a worker thread. Safe from IRQ handlers: it never
+// sleeps or switches, it only marks a sleeping worker runnable.
+int workqueue_submit(work_func_t fn, void* arg) {
+    if (!workqueue_initialized || !fn) {
+        return -1;
+    }
+
+    uint32_t flags = irq_save();
+
+    if (work_head - work_tail >= WORKQUEUE_SIZE) {
+        wq_stats.dropped++;
+        irq_restore(flags);
+        return -1;
+    }
+
+    work_item_t* item = &work_ring[work_head & WORKQUEUE_MASK];
+    item->fn = fn;
+    item->arg = arg;
+    item->submit_ns = clock_monotonic_ns();
+    work_head++;
+
+    wq_stats.submitted++;
+    if (work_head - work_tail > wq_stats.max_depth) {
+        wq_stats.max_depth = work_head - work_tail;
+    }
+
+    if (idle_worker_count > 0) {
+        process_wake(idle_workers[--idle_worker_count]);
+    }
+
+    irq_restore(flags);
+    return 0;
+}
+
+uint32_t workqueue_pending(void) {
+    return work_head - work_tail;
+}
+
+void workqueue_get_stats(workqueue_stats_t* stats) {
+    if (stats) {
+        uint32_t flags = irq_save();
+        *stats = wq_stats;
+        irq_restore(flags);
+    }
+}
+
+// Test work item: a little busy work, then count completion
+static volatile uint32_t test_items_done = 0;
+
+static void workqueue_test_item(void* arg) {
+    volatile uint32_t sink = (uint32_t)arg;
+    for (int i = 0; i < 1000; i++) {
+        sink += i;
+    }
+    test_items_done++;
+}
+
+static void workqueue_show_stats(void) {
+    workqueue_stats_t stats;
+    workqueue_get_stats(&stats);
+
+    terminal_setcolor(vga_entry_color(VGA_COLOR_LIGHT_CYAN, VGA_COLOR_BLACK));
+    terminal_writestring("Workqueue Statistics:\n");
+    terminal_setcolor(vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK));
+    terminal_printf("  Workers: %d (idle: %d)\n", WORKQUEUE_WORKERS, idle_worker_count);
+    terminal_printf("  Submitted: %u\n", stats.submitted);
+    terminal_printf("  Completed: %u\n", stats.completed);
+    terminal_printf("  Dropped: %u\n", stats.dropped);
+    terminal_printf("  Pending: %u (max depth %u)\n", workqueue_pending(), stats.max_depth);
+    if (stats.completed > 0) {
+        terminal_printf("  Avg latency: %llu us\n",
+                        clock_ns_to_us(div_u64(stats.total_latency_ns, stats.completed)));
+        terminal_printf("  Max latency: %llu us\n", clock_ns_to_us(stats.max_latency_ns));
+    }
+}
+
+// Workqueue command handler
+void workqueue_command_handler(int argc, char argv[][64]) {
+    if (argc < 2) {
+        terminal_writestring("Workqueue Commands:\n");
+        terminal_writestring("  workq stats     - Show workqueue statistics\n");
+        terminal_writestring("  workq test [n]  - Submit n items with IRQs off and time them\n");
+        return;
+    }
+
+    if (!workqueue_initialized) {
+        terminal_writestring("Workqueue not initialized\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "stats") == 0) {
+        workqueue_show_stats();
+    }
+    else if (strcmp(argv[1], "test") == 0) {
+        int count = (argc >= 3) ? atoi(argv[2]) : 16;
+        if (count <= 0 || count > WORKQUEUE_SIZE) {
+            count = 16;
+        }
+
+        test_items_done = 0;
+
+        // Submit with interrupts disabled, as an IRQ handler would
+        uint64_t start = clock_monotonic_ns();
+        uint32_t flags = irq_save();
+        int queued = 0;
+        for (int i = 0; i < count; i++) {
+            if (workqueue_submit(workqueue_test_item, (void*)i) == 0) {
+                queued++;
+            }
+        }
+        irq_restore(flags);
+        uint64_t submitted = clock_monotonic_ns();
+
+        // Let the workers drain the queue
+        while (test_items_done < (uint32_t)queued) {
+            process_yield();
+        }
+        uint64_t done = clock_monotonic_ns();
+
+        terminal_printf("Queued %d/%d items\n", queued, count);
+        terminal_printf("  Submit (IRQs off): %llu ns/item\n",
+                        queued ? div_u64(submitted - start, queued) : 0);
+        terminal_printf("  Drain time:        %llu us\n", clock_ns_to_us(done - submitted));
+        workqueue_show_stats();
+    }
+    else {
+        terminal_printf("Unknown workqueue command: %s\n", argv[1]);
+    }
+}
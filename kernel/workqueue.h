@@ -0,0 +1,41 @@
+// ClaudeOS Deferred Work Queue - Day 21
+// IRQ-safe work submission serviced by a pool of kernel worker threads
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include "types.h"
+
+// Workqueue configuration
+#define WORKQUEUE_SIZE      64      // Pending items (power of two)
+#define WORKQUEUE_WORKERS   2       // Worker threads in the pool
+
+typedef void (*work_func_t)(void* arg);
+
+// Pending work item
+typedef struct {
+    work_func_t fn;
+    void* arg;
+    uint64_t submit_ns;             // clock_monotonic_ns() at submission
+} work_item_t;
+
+// Workqueue statistics
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t dropped;               // Rejected because the ring was full
+    uint32_t max_depth;             // Highest observed queue depth
+    uint64_t total_latency_ns;      // Sum of submit-to-start latencies
+    uint64_t max_latency_ns;
+} workqueue_stats_t;
+
+// Workqueue interface
+void workqueue_init(void);
+int workqueue_submit(work_func_t fn, void* arg);
+uint32_t workqueue_pending(void);
+void workqueue_get_stats(workqueue_stats_t* stats);
+
+// Shell command
+void workqueue_command_handler(int argc, char argv[][64]);
+
+#endif // WORKQUEUE_H